@@ -7,14 +7,21 @@ struct ChunkData
 };
 cbuffer CB5_TERRAIN_DATA : register(b5)
 {
+    // The heightmap is toroidal: it wraps around, and the window's minimum
+    // corner (at heightMapWorldPosition) is at heightMapUVOffset.
     float2 heightMapWorldPosition;
     float2 heightMapWorldExtents;
-
-    ChunkData chunkData[2000];
+    float2 heightMapUVOffset;
+    float2 heightMapWindowExtents;
 }
 
 DefineTex2D(heightmap, 0);
 
+// Chunk data is stored by quadtree node, and each instance reads the node
+// of its chunk from the visible chunks.
+StructuredBuffer<ChunkData> chunkData : register(t1);
+StructuredBuffer<uint> visibleChunks : register(t2);
+
 struct VS_IN
 {
     float3 position_local : POSITION;
@@ -33,13 +40,16 @@ VS_OUT vsterrain_main(VS_IN input)
     VS_OUT output = (VS_OUT) 0;
 
     // Based on my ChunkData, determine my (x,z) world position
-    ChunkData data = chunkData[input.instanceID];
+    ChunkData data = chunkData[visibleChunks[input.instanceID]];
     float x = data.positionXZ.x + input.position_local.x * data.extentsXZ.x;
     float z = data.positionXZ.y + input.position_local.z * data.extentsXZ.y;
     
-    // Convert world position to UV coordinates in the heightmap
-    float u = (x - heightMapWorldPosition.x) / heightMapWorldExtents.x;
-    float v = (z - heightMapWorldPosition.y) / heightMapWorldExtents.y;
+    // Convert world position to UV coordinates in the heightmap. Positions
+    // outside of the window are clamped to it, as the texels past its edges
+    // hold the other side of the window.
+    float2 local = clamp(float2(x, z) - heightMapWorldPosition, 0, heightMapWindowExtents);
+    float u = local.x / heightMapWorldExtents.x + heightMapUVOffset.x;
+    float v = local.y / heightMapWorldExtents.y + heightMapUVOffset.y;
     float height = SampleTex2DLevel(heightmap, float2(u, v), 0, float2(0,0)).r;
     
     // Generate my (x,y,z) world position
@@ -1,3 +1,10 @@
 #pragma once
 
-constexpr unsigned int FRAMES_PER_SECOND = 60;
\ No newline at end of file
+constexpr unsigned int FRAMES_PER_SECOND = 60;
+
+// Physics Timestep:
+// The physics system steps its simulation at a fixed rate, independent of
+// the frame rate. If a frame takes too long, at most PHYSICS_MAX_SUBSTEPS
+// steps are run and the remaining time is dropped.
+constexpr unsigned int PHYSICS_TICKS_PER_SECOND = 60;
+constexpr unsigned int PHYSICS_MAX_SUBSTEPS = 4;
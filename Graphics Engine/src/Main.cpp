@@ -27,6 +27,7 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <filesystem>
 #include <mutex>
 #include <thread>
 
@@ -34,9 +35,14 @@
 #include "core/ThreadPool.h"
 #include "datamodel/SceneGraph.h"
 #include "input/InputSystem.h"
+#include "math/Compute.h"
+#include "physics/PhysicsReplay.h"
 #include "physics/PhysicsSystem.h"
 #include "rendering/VisualSystem.h"
 #include "rendering/scene/SceneListener.h"
+#include "rendering/terrain2D/HeightMapGenerator.h"
+#include "rendering/terrain2D/Terrain2DManager.h"
+#include "rendering/terrain2D/TerrainHeightQuery.h"
 
 #include "datamodel/objects/DMCamera.h"
 #include "datamodel/objects/DMMesh.h"
@@ -61,9 +67,17 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 // Static reference to the input system for use in the window message callback
 static InputSystem* input_system_handle;
 
+// Runs a physics recording without creating a window, and prints its timings
+// to the console.
+static int RunPhysicsReplay(const wchar_t* path);
+
 // Main Function
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
                     PWSTR pCmdLine, int nCmdShow) {
+    // Headless physics replay: --physics-replay <path>
+    if (wcsncmp(pCmdLine, L"--physics-replay ", 17) == 0)
+        return RunPhysicsReplay(pCmdLine + 17);
+
     // Create a Window Class with the OS
     const wchar_t CLASS_NAME[] = L"Main";
 
@@ -96,7 +110,7 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     ShowWindow(hwnd, nCmdShow); // Set Window Visible
 
     // Seed Random Number Generator
-    srand(0);
+    Math::SeedRandom(0);
 
     // --- Create my Systems ---
     InputSystem input_system = InputSystem(hwnd);
@@ -125,7 +139,15 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     root->addChild(camera);
 
     // Bind Terrain
-    // physics_system.bindTerrain(scene_graph.getTerrain());
+    // The collider caches the same region that Terrain2D builds its heightmap
+    // texture from, and follows it every frame. Heights come from the
+    // terrain's tiles, so they include erosion.
+    Terrain2DManager* terrain_2d = visual_system.getTerrain2DManager();
+    TerrainHeightQuery* height_query = terrain_2d->getHeightQuery();
+    HeightfieldCollider* terrain_collider =
+        physics_system.bindTerrain([height_query](float x, float z) {
+            return height_query->sampleHeight(x, z);
+        });
 
     // Extra
     auto createMesh = [&root](const Vector3& position, float scale) {
@@ -141,6 +163,22 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     createMesh(Vector3(0, 200.f, 0), 250.f);
     createMesh(Vector3(0, -200.f, 0), 250.f);
 
+    // Prop with a collider decomposed from the same file as its mesh. It
+    // ignores input, so it only moves when pushed, and uses continuous
+    // collision so that it doesn't tunnel when pushed hard.
+    DMPhysics* prop = new DMPhysics();
+    prop->setColliderFile("Macaroni3.gltf");
+    prop->setInputEnabled(false);
+    prop->setContinuousCollision(true);
+    prop->getTransform().setPosition(Vector3(0, 0, 500.f));
+    prop->getTransform().setScale(50.f, 50.f, 50.f);
+    root->addChild(prop);
+
+    DMMesh* prop_mesh = new DMMesh();
+    prop_mesh->setMeshFile("Macaroni3.gltf");
+    prop_mesh->setColorMapFile("textures/MacTex.png");
+    prop->addChild(prop_mesh);
+
 
 
     for (int i = 0; i < 5; i++) {
@@ -226,6 +264,17 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
         // Render Objects
         visual_system.render();
 
+        // Keep the terrain collider under the heightmap window, and rebuild
+        // it when the height settings change
+        Vector2 terrain_origin, terrain_extents;
+        int terrain_samples;
+        uint32_t terrain_version;
+        if (terrain_2d->getHeightmapRegion(terrain_origin, terrain_extents,
+                                           terrain_samples, terrain_version)) {
+            terrain_collider->updateGrid(terrain_origin, terrain_extents,
+                                         terrain_samples, terrain_version);
+        }
+
         // Update Physics System
         physics_system.pullDatamodelData();
         physics_system.update();
@@ -259,6 +308,44 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     return 0;
 }
 
+// RunPhysicsReplay:
+// The terrain sampler is not serialized in the recording, so terrain is
+// replayed with the default height map settings. Heights are read through a
+// TerrainHeightQuery like in the live run, so they are interpolated from the
+// same eroded tiles. Recordings made after editing the height map in ImGui
+// will not replay identically.
+static int RunPhysicsReplay(const wchar_t* path) {
+    // Attach to the console we were launched from so that the results are
+    // visible.
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        FILE* stream;
+        freopen_s(&stream, "CONOUT$", "w", stdout);
+        freopen_s(&stream, "CONOUT$", "w", stderr);
+    }
+
+    const std::string log_path = std::filesystem::path(path).string();
+
+    PhysicsReplay replay;
+    if (!replay.load(log_path)) {
+        fprintf(stderr, "Could not load physics recording %s\n",
+                log_path.c_str());
+        return 1;
+    }
+
+    HeightMapGenerator height_map;
+    TerrainHeightQuery height_query(height_map.getPipeline());
+    HeightSampler sampler = nullptr;
+    if (replay.getLog().has_terrain)
+        sampler = [&height_query](float x, float z) {
+            return height_query.sampleHeight(x, z);
+        };
+
+    const PhysicsReplayResult result = replay.run(sampler);
+    result.print(stdout);
+
+    return 0;
+}
+
 // Defines the behavior of the window (appearance, user interaction, etc)
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam,
                             LPARAM lParam) {
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <functional>
 #include <future>
 #include <mutex>
@@ -99,4 +102,50 @@ inline auto ThreadPool::scheduleJob(F&& f, Args&&... args)
     return future_object;
 }
 
+// ParallelFor:
+// Runs job(0), ..., job(count - 1) on the thread pool, and waits for them
+// to finish. Runs them on this thread if there is no thread pool.
+// The calling thread also runs jobs, and only waits for jobs that have
+// started. So, this is safe to call from a job on the thread pool, even if
+// every worker is busy.
+template <typename F> inline void ParallelFor(size_t count, F&& job) {
+    ThreadPool* pool = ThreadPool::GetThreadPool();
+    if (pool == nullptr || count <= 1) {
+        for (size_t i = 0; i < count; i++)
+            job(i);
+        return;
+    }
+
+    // Shared so that workers which start after the loop is done can still
+    // safely check that there is nothing left to do
+    struct State {
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> done = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+    auto run = [state, count, &job]() {
+        size_t index;
+        while ((index = state->next.fetch_add(1)) < count) {
+            job(index);
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t workers = std::min(count - 1, (size_t)NUM_THREADS);
+    for (size_t i = 0; i < workers; i++)
+        pool->scheduleJob(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() {
+        return state->done.load() == count;
+    });
+}
+
 } // namespace Engine
\ No newline at end of file
@@ -4,7 +4,7 @@
 
 namespace Engine {
 namespace Datamodel {
-DMBinding::DMBinding(Object* obj) {
+DMBinding::DMBinding(Object* obj) : dm_object(nullptr) {
     if (obj) {
         dm_object = obj;
         dm_object->bind(this);
@@ -1,6 +1,7 @@
 #include "Object.h"
 
 #include <math.h>
+#include <algorithm>
 #include <unordered_map>
 
 #include <assert.h>
@@ -12,12 +13,14 @@ namespace Engine {
 using namespace Math;
 
 namespace Datamodel {
+static std::vector<Object*> destruction_queue;
+
 /* --- Constructors / Destructors --- */
 // Constructor:
 // Creates an object with no parent and a
 // local position of (0,0,0)
 Object::Object(const DMObjectTag& object_tag)
-    : dm_handle(object_tag), m_local(&getDMHandle(), "LocalMatrix") {
+    : dm_handle(object_tag) {
     // Objects start with no parent and no children
     parent = nullptr;
     children = std::vector<Object*>(0);
@@ -25,7 +28,8 @@ Object::Object(const DMObjectTag& object_tag)
 
     // Default transform
     transform = Transform();
-    m_local.writeProperty(Matrix4::Identity());
+    transform_handle =
+        TransformStore::GetTransformStore()->create(&dm_handle, &transform);
 
     destroy = false;
 
@@ -47,6 +51,17 @@ Object::~Object() {
     // Deallocate children
     for (Object* child : children)
         delete child;
+
+    // Objects can be deleted before the SceneGraph gets to them, such as
+    // when their parent is deleted
+    if (destroy) {
+        const auto iter = std::find(destruction_queue.begin(),
+                                    destruction_queue.end(), this);
+        if (iter != destruction_queue.end())
+            destruction_queue.erase(iter);
+    }
+
+    TransformStore::GetTransformStore()->destroy(transform_handle);
 }
 
 const DMTrackedObject& Object::getDMHandle() const { return dm_handle; }
@@ -88,17 +103,32 @@ void Object::addChild(Object* object) {
     assert(object->parent == nullptr);
     object->parent = this;
     children.push_back(object);
+
+    TransformStore::GetTransformStore()->setParent(object->transform_handle,
+                                                   transform_handle);
 }
 
-void Object::markForDestruction() { destroy = true; }
+// MarkForDestruction:
+// Queues the object to be deleted by the SceneGraph in its next update, with
+// its children.
+void Object::markForDestruction() {
+    if (!destroy) {
+        destroy = true;
+        destruction_queue.push_back(this);
+    }
+}
 bool Object::shouldDestroy() const { return destroy; }
 
+std::vector<Object*>& Object::GetDestructionQueue() {
+    return destruction_queue;
+}
+
 /* --- Datamodel Bindings --- */
 void Object::bind(DMBinding* _dm_binding) { dm_binding = _dm_binding; }
 void Object::unbind() {
     if (dm_binding != nullptr) {
         dm_binding = nullptr;
-        destroy = true;
+        markForDestruction();
     }
 }
 
@@ -110,22 +140,10 @@ Transform& Object::getTransform() { return transform; }
 // GetLocalToWorldMatrix:
 // Returns the Object's Local -> World matrix. This can be used
 // to transform points in the object's local space into world space.
-const Matrix4& Object::getLocalMatrix() const { return m_local.readProperty(); }
-
-// UpdateLocalToWorldMatrix:
-// Update the Local -> World matrix for the object, given the
-// parent's Local -> World matrix.
-// This method is called in an update pre-pass every frame, and lets us
-// cache the matrix to save computation.
-const Matrix4& Object::updateLocalMatrix(const Math::Matrix4& m_parent) {
-    // Generate local transform
-    const Matrix4 m_local_transform = transform.transformMatrix();
-    const Matrix4 m_parent_transform = m_parent;
-
-    // Update local matrix.
-    m_local.writeProperty(m_parent_transform * m_local_transform);
-
-    return m_local.readProperty();
+// The matrix is cached in the TransformStore, which updates it every frame.
+const Matrix4& Object::getLocalMatrix() const {
+    return TransformStore::GetTransformStore()->getWorldMatrix(
+        transform_handle);
 }
 
 // Overrideable Methods
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "TransformStore.h"
 #include "core/DMTracking.h"
 
 #include "math/CFrame.h"
@@ -47,8 +48,8 @@ class Object {
     uint16_t class_id;
     // Transform of the object
     Transform transform;
-    // Cached Local --> World Matrix
-    DMTrackedProperty<Matrix4> m_local;
+    // Entry in the TransformStore, which caches the Local --> World Matrix
+    TransformHandle transform_handle;
 
     // Used in the SceneGraph Management
     bool destroy;
@@ -82,6 +83,8 @@ class Object {
 
     void markForDestruction();
     bool shouldDestroy() const; // Used in SceneGraph
+    // Objects marked for destruction since the SceneGraph last cleaned up
+    static std::vector<Object*>& GetDestructionQueue();
 
     // Datamodel Binding Methods
     void bind(DMBinding* dm_binding);
@@ -91,7 +94,6 @@ class Object {
     Transform& getTransform();
 
     const Matrix4& getLocalMatrix() const;
-    const Matrix4& updateLocalMatrix(const Matrix4& m_parent);
 
     // Overrideable Methods
     virtual void propertyDisplay();
@@ -1,9 +1,12 @@
 #include "SceneGraph.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <random>
 #include <string>
 
 #include "rendering/ImGui.h"
+#include "utility/Stopwatch.h"
 
 namespace Engine {
 namespace Datamodel {
@@ -52,6 +55,125 @@ int Scene::imGuiTraverseHierarchy(Object* object, int next_id) {
 }
 #endif
 
+#ifdef IMGUI_ENABLED
+// TransformBenchmarkResult:
+// Average time per frame to update a scene where a fraction of the objects
+// move every frame, on one thread and on the thread pool, against walking the
+// whole hierarchy like the SceneGraph used to.
+struct TransformBenchmarkResult {
+    int num_objects = 0;
+    int num_moved = 0;
+    size_t num_updated = 0;
+
+    double update_ms = 0.0;
+    double parallel_update_ms = 0.0;
+    double full_walk_ms = 0.0;
+};
+
+static void FullWalkHelper(Object* object, const Matrix4& m_parent,
+                           std::vector<Matrix4>& output) {
+    output.push_back(m_parent * object->getTransform().transformMatrix());
+    const Matrix4 m_world = output.back();
+
+    for (Object* child : object->getChildren())
+        FullWalkHelper(child, m_world, output);
+}
+
+// RunTransformBenchmark:
+// Builds actors, each a small binary tree of objects, and moves a random
+// fraction of the objects every frame. Every frame is updated twice, once
+// serially and once in parallel, by moving the objects back and forth.
+// The objects live in a store of their own, and the datamodel listener is
+// unregistered while they exist, so the timings don't include the scene's
+// objects or the listener handling the events. The store is updated
+// directly, which leaves the scene's destruction queue alone.
+static TransformBenchmarkResult
+RunTransformBenchmark(int num_objects, float moved_fraction, int num_frames) {
+    constexpr int kObjectsPerActor = 100;
+
+    TransformBenchmarkResult result;
+    result.num_objects = num_objects;
+    result.num_moved = int(num_objects * moved_fraction);
+
+    TransformStore store;
+    TransformStore* const scene_store =
+        TransformStore::SetTransformStore(&store);
+    DMListener* const listener = GetDatamodelListener();
+    RegisterDatamodelListener(nullptr);
+
+    std::vector<Object*> roots;
+    std::vector<Object*> objects;
+    objects.reserve(num_objects);
+
+    for (int i = 0; i < num_objects; i++) {
+        Object* object = new Object("Benchmark");
+        object->getTransform().setPosition(float(i % 7), float(i % 11), 1.f);
+
+        const int index_in_actor = i % kObjectsPerActor;
+        if (index_in_actor == 0)
+            roots.push_back(object);
+        else
+            objects[i - index_in_actor + (index_in_actor - 1) / 2]->addChild(
+                object);
+
+        objects.push_back(object);
+    }
+
+    // The first update lays out the store and reports every object
+    store.update();
+
+    const size_t parallel_threshold = store.getParallelThreshold();
+
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<int> distribution(0, num_objects - 1);
+    std::vector<Object*> moved(result.num_moved);
+    std::vector<Matrix4> walk_output;
+    walk_output.reserve(num_objects);
+    Utility::Stopwatch stopwatch;
+
+    for (int frame = 0; frame < num_frames; frame++) {
+        for (Object*& object : moved)
+            object = objects[distribution(generator)];
+
+        for (Object* object : moved)
+            object->getTransform().offsetPosition(0.f, 0.01f, 0.f);
+
+        store.setParallelThreshold(SIZE_MAX);
+        stopwatch.Reset();
+        store.update();
+        result.update_ms += stopwatch.Duration() * 1000.0;
+        result.num_updated += store.getStats().updated;
+
+        for (Object* object : moved)
+            object->getTransform().offsetPosition(0.f, -0.01f, 0.f);
+
+        store.setParallelThreshold(parallel_threshold);
+        stopwatch.Reset();
+        store.update();
+        result.parallel_update_ms += stopwatch.Duration() * 1000.0;
+
+        stopwatch.Reset();
+        walk_output.clear();
+        for (Object* root : roots)
+            FullWalkHelper(root, Matrix4::Identity(), walk_output);
+        result.full_walk_ms += stopwatch.Duration() * 1000.0;
+    }
+
+    for (Object* root : roots)
+        delete root;
+
+    RegisterDatamodelListener(listener);
+    TransformStore::SetTransformStore(scene_store);
+
+    result.update_ms /= num_frames;
+    result.parallel_update_ms /= num_frames;
+    result.full_walk_ms /= num_frames;
+    result.num_updated /= num_frames;
+
+    return result;
+}
+#endif
+
 void Scene::imGuiDisplay() {
 #ifdef IMGUI_ENABLED
     if (ImGui::BeginMenu("Scene")) {
@@ -62,6 +184,24 @@ void Scene::imGuiDisplay() {
         for (Object* object : objects)
             next_id = imGuiTraverseHierarchy(object, next_id);
 
+        ImGui::SeparatorText("Transform Benchmark");
+        static TransformBenchmarkResult benchmark;
+        static float moved_percent = 1.f;
+        ImGui::SliderFloat("Moving (%)", &moved_percent, 0.1f, 100.f, "%.1f");
+        if (ImGui::Button("Run (100k objects)"))
+            benchmark =
+                RunTransformBenchmark(100000, moved_percent / 100.f, 60);
+
+        if (benchmark.num_objects > 0) {
+            ImGui::Text("Objects: %i, Moved: %i, Updated: %zu",
+                        benchmark.num_objects, benchmark.num_moved,
+                        benchmark.num_updated);
+            ImGui::Text("Dirty Update: %.3f ms", benchmark.update_ms);
+            ImGui::Text("Parallel Update: %.3f ms",
+                        benchmark.parallel_update_ms);
+            ImGui::Text("Full Walk: %.3f ms", benchmark.full_walk_ms);
+        }
+
         ImGui::EndMenu();
     }
 
@@ -87,40 +227,53 @@ void Scene::addObject(Object* object) {
 
 const std::vector<Object*>& Scene::getObjects() const { return objects; }
 
-// UpdateAndRenderObjects:
-// Update and cache object transforms in the SceneGraph, and submit
-// render requests for each.
-static void updateObjectsHelper(Object* object, const Matrix4& m_parent) {
-    assert(object != nullptr);
-
-    const Matrix4 m_local = object->updateLocalMatrix(m_parent);
-    std::vector<Object*> children = object->getChildren();
-
-    std::vector<Object*>::iterator iter = children.begin();
-    while (iter != children.end()) {
-        if ((*iter)->shouldDestroy()) {
-            delete *iter;
-            iter = children.erase(iter);
-        } else {
-            updateObjectsHelper((*iter), m_local);
-            iter++;
-        }
+static bool HasDestroyedAncestor(const Object* object) {
+    for (const Object* ancestor = object->getParent(); ancestor != nullptr;
+         ancestor = ancestor->getParent()) {
+        if (ancestor->shouldDestroy())
+            return true;
     }
+    return false;
 }
 
+// UpdateAndCleanObjects:
+// Delete the objects marked for destruction, then update the world matrices
+// of the objects that moved. Both only visit the objects that changed, instead
+// of the whole scene.
 void Scene::updateAndCleanObjects() {
-    Matrix4 identity = Matrix4::Identity();
-
-    std::vector<Object*>::iterator iter = objects.begin();
-    while (iter != objects.end()) {
-        if ((*iter)->shouldDestroy()) {
-            delete *iter;
-            iter = objects.erase(iter);
-        } else {
-            updateObjectsHelper((*iter), identity);
-            iter++;
+    std::vector<Object*>& destruction_queue = Object::GetDestructionQueue();
+
+    if (!destruction_queue.empty()) {
+        destroy_scratch.swap(destruction_queue);
+
+        // Objects whose ancestor is also being destroyed are deleted along
+        // with it. Filter them out before anything is deleted.
+        destroy_scratch.erase(std::remove_if(destroy_scratch.begin(),
+                                             destroy_scratch.end(),
+                                             HasDestroyedAncestor),
+                              destroy_scratch.end());
+
+        for (Object* object : destroy_scratch) {
+            Object* parent = object->getParent();
+            std::vector<Object*>& siblings =
+                (parent != nullptr) ? parent->getChildren() : objects;
+
+            // Roots of another scene are left for that scene to delete
+            const auto iter =
+                std::find(siblings.begin(), siblings.end(), object);
+            if (iter == siblings.end()) {
+                destruction_queue.push_back(object);
+                continue;
+            }
+
+            siblings.erase(iter);
+            delete object;
         }
+
+        destroy_scratch.clear();
     }
+
+    TransformStore::GetTransformStore()->update();
 }
 
 } // namespace Datamodel
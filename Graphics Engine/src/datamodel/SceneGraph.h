@@ -18,6 +18,7 @@ namespace Datamodel {
 class Scene {
   private:
     std::vector<Object*> objects;
+    std::vector<Object*> destroy_scratch;
 
 #if defined(IMGUI_ENABLED)
     Object* selected_object;
@@ -0,0 +1,366 @@
+#include "TransformStore.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "core/ThreadPool.h"
+
+namespace Engine {
+namespace Datamodel {
+// Flags of an entry. New entries report their matrix in their first update,
+// even if it is unchanged.
+enum EntryFlags : uint8_t { kQueued = 1, kCreated = 2 };
+
+// Entries per chunk of a level. Fixed, so that the chunks (and the order of
+// the events) do not depend on the number of threads.
+constexpr size_t kChunkSize = 256;
+
+TransformStore::TransformStore() {
+    order_dirty = false;
+    parallel_threshold = 2048;
+}
+TransformStore::~TransformStore() = default;
+
+// GetTransformStore:
+// The store shared by every object in the datamodel. Objects create their
+// entries on construction, before they are added to a scene. A different
+// store can be swapped in, so that a benchmark's objects stay out of the
+// scene's store.
+static TransformStore* current_store = nullptr;
+
+TransformStore* TransformStore::GetTransformStore() {
+    static TransformStore transform_store;
+    return (current_store != nullptr) ? current_store : &transform_store;
+}
+TransformStore* TransformStore::SetTransformStore(TransformStore* store) {
+    TransformStore* const previous = GetTransformStore();
+    current_store = store;
+    return previous;
+}
+
+// Create:
+// Adds an entry with no parent. Its world matrix is the identity until the
+// next update.
+TransformHandle TransformStore::create(const DMTrackedObject* owner,
+                                       Transform* source) {
+    TransformHandle handle;
+    if (!free_handles.empty()) {
+        handle = free_handles.back();
+        free_handles.pop_back();
+    } else {
+        handle = TransformHandle(indices.size());
+        indices.push_back(-1);
+    }
+
+    indices[handle] = int(handles.size());
+
+    local_matrices.push_back(Matrix4::Identity());
+    world_matrices.push_back(Matrix4::Identity());
+    parents.push_back(-1);
+    first_child.push_back(0);
+    child_count.push_back(0);
+    flags.push_back(kCreated);
+
+    sources.push_back(source);
+    owners.push_back(owner);
+    handles.push_back(handle);
+
+    markDirty(handle);
+
+    order_dirty = true;
+    return handle;
+}
+
+// Destroy:
+// Frees the handle. The entry is removed from the arrays in the next update.
+void TransformStore::destroy(TransformHandle handle) {
+    const int index = indices[handle];
+    assert(index != -1);
+
+    sources[index]->setListener(nullptr, 0);
+
+    handles[index] = kInvalidTransform;
+    indices[handle] = -1;
+    free_handles.push_back(handle);
+
+    order_dirty = true;
+}
+
+void TransformStore::setParent(TransformHandle handle, TransformHandle parent) {
+    const int index = indices[handle];
+    assert(index != -1);
+
+    parents[index] = (parent == kInvalidTransform) ? -1 : indices[parent];
+    markDirty(handle);
+
+    order_dirty = true;
+}
+
+TransformHandle TransformStore::getParent(TransformHandle handle) const {
+    const int parent = parents[indices[handle]];
+    return (parent == -1) ? kInvalidTransform : handles[parent];
+}
+
+void TransformStore::markDirty(TransformHandle handle) {
+    const int index = indices[handle];
+    if (!(flags[index] & kQueued)) {
+        flags[index] |= kQueued;
+        dirty_list.push_back(handle);
+    }
+}
+
+void TransformStore::onTransformChanged(uint32_t handle) {
+    markDirty(handle);
+}
+
+const Matrix4& TransformStore::getWorldMatrix(TransformHandle handle) const {
+    return world_matrices[indices[handle]];
+}
+
+void TransformStore::setParallelThreshold(size_t threshold) {
+    parallel_threshold = threshold;
+}
+size_t TransformStore::getParallelThreshold() const {
+    return parallel_threshold;
+}
+
+const TransformStore::Stats& TransformStore::getStats() const {
+    return stats;
+}
+
+// Update:
+// Updates the levels in order. The work for a level is the changed entries in
+// it, and the children of the entries in the level above whose world matrix
+// changed. Both lists are in index order, so the work is too.
+void TransformStore::update() {
+    if (order_dirty)
+        sortBreadthFirst();
+
+    changed.clear();
+    for (const TransformHandle handle : dirty_list) {
+        const int index = indices[handle];
+        if (index == -1)
+            continue;
+
+        Transform* source = sources[index];
+        local_matrices[index] = source->transformMatrix();
+        source->setListener(this, handle);
+
+        changed.push_back(index);
+    }
+    dirty_list.clear();
+
+    // A handle can be queued twice if it was freed and reused
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    stats.entries = handles.size();
+    stats.changed = changed.size();
+    stats.updated = 0;
+
+    level_work.clear();
+    size_t changed_begin = 0;
+
+    for (size_t level = 0; level + 1 < level_offsets.size(); level++) {
+        size_t changed_end = changed_begin;
+        while (changed_end < changed.size() &&
+               changed[changed_end] < level_offsets[level + 1])
+            changed_end++;
+
+        level_next.clear();
+        std::set_union(level_work.begin(), level_work.end(),
+                       changed.begin() + changed_begin,
+                       changed.begin() + changed_end,
+                       std::back_inserter(level_next));
+        level_work.swap(level_next);
+        changed_begin = changed_end;
+
+        if (level_work.empty()) {
+            if (changed_begin == changed.size())
+                break;
+            continue;
+        }
+
+        const size_t count = level_work.size();
+        size_t num_chunks = 1;
+        if (count >= parallel_threshold)
+            num_chunks = (count + kChunkSize - 1) / kChunkSize;
+        const size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+
+        if (chunks.size() < num_chunks)
+            chunks.resize(num_chunks);
+
+        if (num_chunks == 1) {
+            updateChunk(level_work.data(), count, chunks[0]);
+        } else {
+            ParallelFor(num_chunks, [&](size_t chunk) {
+                const size_t begin = chunk * chunk_size;
+                const size_t end = std::min(begin + chunk_size, count);
+                updateChunk(level_work.data() + begin, end - begin,
+                            chunks[chunk]);
+            });
+        }
+
+        stats.updated += count;
+
+        level_work.clear();
+        for (size_t i = 0; i < num_chunks; i++) {
+            Chunk& chunk = chunks[i];
+
+            for (const DMEvent& event : chunk.events)
+                FireDatamodelEvent(event);
+            level_work.insert(level_work.end(), chunk.children.begin(),
+                              chunk.children.end());
+
+            chunk.events.clear();
+            chunk.children.clear();
+        }
+    }
+}
+
+// UpdateChunk:
+// Recomputes the world matrices of some of the entries in a level. Entries
+// whose world matrix is unchanged do not need their children updated; any
+// children that changed themselves are in the changed list.
+void TransformStore::updateChunk(const int* work, size_t count, Chunk& chunk) {
+    for (size_t i = 0; i < count; i++) {
+        const int index = work[i];
+        const int parent = parents[index];
+        const Matrix4 m_world =
+            (parent != -1) ? world_matrices[parent] * local_matrices[index]
+                           : local_matrices[index];
+
+        const bool created = flags[index] & kCreated;
+        flags[index] = 0;
+
+        if (m_world == world_matrices[index] && !created)
+            continue;
+
+        world_matrices[index] = m_world;
+
+        DMEvent& event = chunk.events.emplace_back();
+        event.event_type = DMEventType::kPropertyUpdated;
+        event.object = owners[index]->getHandle();
+        event.object_type = owners[index]->getObjectTag();
+        event.property_tag = "LocalMatrix";
+        event.property_data = m_world;
+
+        for (int child = 0; child < child_count[index]; child++)
+            chunk.children.push_back(first_child[index] + child);
+    }
+}
+
+// SortBreadthFirst:
+// Removes destroyed entries, and lays the rest out breadth first. Roots and
+// siblings keep their relative order, so the order of the update (and its
+// events) only depends on the order objects were created and parented in.
+void TransformStore::sortBreadthFirst() {
+    const int count = int(handles.size());
+
+    // Children of each entry, in order. Children of a destroyed entry become
+    // roots.
+    std::vector<int> order;
+    std::vector<int> child_offsets(count + 1, 0);
+    std::vector<int> child_list(count);
+
+    for (int i = 0; i < count; i++) {
+        if (handles[i] == kInvalidTransform)
+            continue;
+
+        const int parent = parents[i];
+        if (parent == -1 || handles[parent] == kInvalidTransform)
+            order.push_back(i);
+        else
+            child_offsets[parent + 1]++;
+    }
+    for (int i = 0; i < count; i++)
+        child_offsets[i + 1] += child_offsets[i];
+
+    std::vector<int> child_fill(child_offsets.begin(), child_offsets.end() - 1);
+    for (int i = 0; i < count; i++) {
+        const int parent = parents[i];
+        if (handles[i] != kInvalidTransform && parent != -1 &&
+            handles[parent] != kInvalidTransform)
+            child_list[child_fill[parent]++] = i;
+    }
+
+    for (int i = 0; i < int(order.size()); i++) {
+        const int index = order[i];
+        for (int j = child_offsets[index]; j < child_offsets[index + 1]; j++)
+            order.push_back(child_list[j]);
+    }
+
+    // Old index -> new index, or -1 if the entry was destroyed
+    std::vector<int> remap(count, -1);
+    for (int i = 0; i < int(order.size()); i++)
+        remap[order[i]] = i;
+
+    const int new_count = int(order.size());
+
+    std::vector<Matrix4> new_local(new_count);
+    std::vector<Matrix4> new_world(new_count);
+    std::vector<int> new_parents(new_count);
+    std::vector<int> new_first_child(new_count, 0);
+    std::vector<int> new_child_count(new_count, 0);
+    std::vector<uint8_t> new_flags(new_count);
+    std::vector<Transform*> new_sources(new_count);
+    std::vector<const DMTrackedObject*> new_owners(new_count);
+    std::vector<TransformHandle> new_handles(new_count);
+    std::vector<TransformHandle> orphans;
+    std::vector<int> depths(new_count);
+
+    level_offsets.clear();
+    level_offsets.push_back(0);
+
+    for (int i = 0; i < new_count; i++) {
+        const int old_index = order[i];
+        const int old_parent = parents[old_index];
+        const int parent = (old_parent == -1) ? -1 : remap[old_parent];
+
+        new_local[i] = local_matrices[old_index];
+        new_world[i] = world_matrices[old_index];
+        new_parents[i] = parent;
+        new_flags[i] = flags[old_index];
+        new_sources[i] = sources[old_index];
+        new_owners[i] = owners[old_index];
+        new_handles[i] = handles[old_index];
+
+        indices[new_handles[i]] = i;
+
+        if (old_parent != -1 && parent == -1)
+            orphans.push_back(new_handles[i]);
+
+        if (parent != -1) {
+            if (new_child_count[parent] == 0)
+                new_first_child[parent] = i;
+            new_child_count[parent]++;
+        }
+
+        // Breadth first, so each level starts where the depth goes up
+        depths[i] = (parent == -1) ? 0 : depths[parent] + 1;
+        if (i > 0 && depths[i] != depths[i - 1])
+            level_offsets.push_back(i);
+    }
+    level_offsets.push_back(new_count);
+
+    local_matrices.swap(new_local);
+    world_matrices.swap(new_world);
+    parents.swap(new_parents);
+    first_child.swap(new_first_child);
+    child_count.swap(new_child_count);
+    flags.swap(new_flags);
+    sources.swap(new_sources);
+    owners.swap(new_owners);
+    handles.swap(new_handles);
+
+    // Orphaned entries are now roots, so their world matrix changes
+    for (const TransformHandle handle : orphans)
+        markDirty(handle);
+
+    order_dirty = false;
+}
+
+} // namespace Datamodel
+} // namespace Engine
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "core/DMTracking.h"
+
+#include "math/Matrix4.h"
+#include "math/Transform.h"
+
+namespace Engine {
+using namespace Math;
+
+namespace Datamodel {
+// TransformHandle:
+// Refers to an entry in the TransformStore. Handles stay valid while their
+// entry moves around in the store's arrays.
+typedef uint32_t TransformHandle;
+constexpr TransformHandle kInvalidTransform = UINT32_MAX;
+
+// TransformStore Class:
+// Stores the local and world matrices of every object in the datamodel, as a
+// structure of arrays. The arrays are laid out breadth first, so every parent
+// comes before its children, and the children of an entry are contiguous.
+//
+// Entries read their local matrix from the object's Transform, which stays in
+// the object so that pointers to it remain valid. The store listens to the
+// transforms, and keeps a list of the entries that changed. An update only
+// visits those entries, and the descendants whose world matrix they change.
+//
+// The update goes one level of the hierarchy at a time. Entries in a level
+// only read from the level above, so large levels are split into chunks that
+// run on the thread pool. Each chunk collects its own events, and the events
+// are fired in chunk order, so they come out in the same order no matter how
+// many threads ran the update.
+class TransformStore : public TransformListener {
+  public:
+    struct Stats {
+        size_t entries = 0;
+        // Entries in the last update whose transform changed, or that were
+        // created or reparented
+        size_t changed = 0;
+        // Entries in the last update whose world matrix was recomputed
+        size_t updated = 0;
+    };
+
+  private:
+    // Work and results of one chunk of a level
+    struct Chunk {
+        std::vector<int> children; // Of the entries whose matrix changed
+        std::vector<DMEvent> events;
+    };
+
+    // Hot data, used when updating
+    std::vector<Matrix4> local_matrices;
+    std::vector<Matrix4> world_matrices;
+    std::vector<int> parents; // Index of the parent, or -1
+    std::vector<int> first_child;
+    std::vector<int> child_count;
+    std::vector<uint8_t> flags;
+
+    // Cold data
+    std::vector<Transform*> sources;
+    std::vector<const DMTrackedObject*> owners;
+    std::vector<TransformHandle> handles; // kInvalidTransform if destroyed
+
+    // Start of every level in the arrays, and the end of the last level
+    std::vector<int> level_offsets;
+
+    // Handle -> index, and handles free to be reused
+    std::vector<int> indices;
+    std::vector<TransformHandle> free_handles;
+
+    // Entries to update, by handle, since their index can change before the
+    // update
+    std::vector<TransformHandle> dirty_list;
+
+    // Set when entries are added, reparented or destroyed. The arrays are
+    // re-sorted and compacted before the next update.
+    bool order_dirty;
+
+    // Levels with at least this many entries to update are split into
+    // chunks, which run in parallel
+    size_t parallel_threshold;
+
+    // Scratch used when updating
+    std::vector<int> changed;
+    std::vector<int> level_work;
+    std::vector<int> level_next;
+    std::vector<Chunk> chunks;
+
+    Stats stats;
+
+  public:
+    TransformStore();
+    ~TransformStore();
+
+    static TransformStore* GetTransformStore();
+    // Replaces the store objects use, and returns the previous one. Objects
+    // must be destroyed while the store they were created in is current.
+    static TransformStore* SetTransformStore(TransformStore* store);
+
+    // The owner receives the "LocalMatrix" events when the world matrix
+    // changes. Both it and the source must outlive the entry.
+    TransformHandle create(const DMTrackedObject* owner, Transform* source);
+    void destroy(TransformHandle handle);
+
+    void setParent(TransformHandle handle, TransformHandle parent);
+    TransformHandle getParent(TransformHandle handle) const;
+
+    // Forces the world matrix to be recomputed in the next update
+    void markDirty(TransformHandle handle);
+    void onTransformChanged(uint32_t handle) override;
+
+    // Valid until the next update
+    const Matrix4& getWorldMatrix(TransformHandle handle) const;
+
+    // Pulls the local matrices of the changed entries from their transforms,
+    // and recomputes the world matrices of the changed entries and their
+    // descendants.
+    void update();
+
+    // Pass SIZE_MAX to always update on the calling thread
+    void setParallelThreshold(size_t threshold);
+    size_t getParallelThreshold() const;
+
+    const Stats& getStats() const;
+
+  private:
+    void updateChunk(const int* work, size_t count, Chunk& chunk);
+    void sortBreadthFirst();
+};
+
+} // namespace Datamodel
+} // namespace Engine
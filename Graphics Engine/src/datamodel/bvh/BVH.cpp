@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <math.h>
 
+#include "math/BatchMath.h"
+
 #if defined(DEBUG_BVH)
 #include "rendering/VisualDebug.h"
 #endif
@@ -493,19 +495,19 @@ void BVH::debugDrawBVH() const {
 // --- Transformed BVH ---
 TransformedBVH::TransformedBVH(BVH* _bvh, const Matrix4& m_transform) {
     bvh = _bvh;
-    m_inverse = m_transform.inverse();
+    m_inverse = m_transform.inverseAffine();
 
     bounds = AABB();
     Vector3 aabb_bounds[8];
     bvh->getBVHRoot().bounds.fillArrWithPoints(aabb_bounds);
 
-    for (int i = 0; i < 8; i++) {
-        // Transform my point into world space, and expand our TLAS node AABB
-        // with it
-        const Vector3 transformed =
-            (m_transform * Vector4(aabb_bounds[i], 1.f)).xyz();
-        bounds.expandToContain(transformed);
-    }
+    // Transform my points into world space, and expand our TLAS node AABB
+    // with them
+    Vector3 minimum, maximum;
+    BatchBoundsOfTransformedPoints(m_transform, aabb_bounds, 8, &minimum,
+                                   &maximum);
+    bounds.expandToContain(minimum);
+    bounds.expandToContain(maximum);
 }
 
 const AABB& TransformedBVH::getBounds() const { return bounds; }
@@ -11,6 +11,7 @@ class DMListener {
     virtual void onDatamodelEvent(const DMEvent& event) = 0;
 };
 void RegisterDatamodelListener(DMListener* listener);
+DMListener* GetDatamodelListener();
 
 } // namespace Datamodel
 } // namespace Engine
\ No newline at end of file
@@ -5,6 +5,7 @@ namespace Datamodel {
 static uint32_t handle_counter = 0;
 static DMListener* dm_listener = nullptr;
 void RegisterDatamodelListener(DMListener* listener) { dm_listener = listener; }
+DMListener* GetDatamodelListener() { return dm_listener; }
 
 void FireDatamodelEvent(const DMEvent& event) {
     if (dm_listener)
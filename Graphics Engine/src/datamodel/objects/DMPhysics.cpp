@@ -2,10 +2,32 @@
 
 namespace Engine {
 namespace Datamodel {
-DMPhysics::DMPhysics() : Object("Physics"), Bindable<DMPhysics>(this) {
+DMPhysics::DMPhysics()
+    : Object("Physics"), Bindable<DMPhysics>(this),
+      collider_name(&getDMHandle(), "ColliderName") {
+    collider_name.writeProperty("");
+    input_enabled = true;
+    ccd_enabled = false;
+
     DMPhysics::SignalObjectCreation(this);
 };
 DMPhysics::~DMPhysics() = default;
 
+void DMPhysics::setColliderFile(const std::string& collider_file) {
+    collider_name.writeProperty(collider_file);
+}
+const std::string& DMPhysics::getColliderFile() {
+    return collider_name.readProperty();
+}
+
+void DMPhysics::setInputEnabled(bool enabled) { input_enabled = enabled; }
+bool DMPhysics::isInputEnabled() const { return input_enabled; }
+
+// SetContinuousCollision:
+// Opt the object in or out of continuous collision detection. CCD is more
+// expensive, and should only be enabled for fast-moving objects.
+void DMPhysics::setContinuousCollision(bool enabled) { ccd_enabled = enabled; }
+bool DMPhysics::isContinuousCollision() const { return ccd_enabled; }
+
 } // namespace Datamodel
 } // namespace Engine
\ No newline at end of file
@@ -1,16 +1,35 @@
 #pragma once
 
+#include <string>
+
 #include "../Bindable.h"
 #include "../Object.h"
 
 namespace Engine {
 namespace Datamodel {
 // Class DMPhysics:
-// Represents a light in the datamodel.
+// Represents an object simulated by the physics system.
 class DMPhysics : public Object, public Bindable<DMPhysics> {
+  private:
+    // Mesh file the collider is decomposed from. Empty for no collider.
+    DMTrackedProperty<std::string> collider_name;
+    // If enabled, the object is moved by the WASDQE keys and the mouse
+    bool input_enabled;
+    // If enabled, the object uses continuous collision detection
+    bool ccd_enabled;
+
   public:
     DMPhysics();
     ~DMPhysics();
+
+    void setColliderFile(const std::string& collider_file);
+    const std::string& getColliderFile();
+
+    void setInputEnabled(bool enabled);
+    bool isInputEnabled() const;
+
+    void setContinuousCollision(bool enabled);
+    bool isContinuousCollision() const;
 };
 
 } // namespace Datamodel
@@ -0,0 +1,363 @@
+#include "BatchMath.h"
+
+#include <assert.h>
+#include <float.h>
+
+#include <algorithm>
+
+#include "SIMD.h"
+
+namespace Engine {
+namespace Math {
+using namespace SIMD;
+
+// Vectors are converted to SoA in blocks of this many. 3 blocks of floats
+// (x, y, z) fit comfortably in the L1 cache.
+constexpr size_t BLOCK_SIZE = 256;
+
+// --- Vector3SoA ---
+Vector3SoA::Vector3SoA() = default;
+Vector3SoA::Vector3SoA(const Vector3* vectors, size_t count)
+    : x(count), y(count), z(count) {
+    for (size_t i = 0; i < count; i++)
+        set(i, vectors[i]);
+}
+Vector3SoA::~Vector3SoA() = default;
+
+size_t Vector3SoA::size() const { return x.size(); }
+void Vector3SoA::resize(size_t size) {
+    x.resize(size);
+    y.resize(size);
+    z.resize(size);
+}
+void Vector3SoA::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+}
+
+void Vector3SoA::push_back(const Vector3& vector) {
+    x.push_back(vector.x);
+    y.push_back(vector.y);
+    z.push_back(vector.z);
+}
+Vector3 Vector3SoA::get(size_t index) const {
+    return Vector3(x[index], y[index], z[index]);
+}
+void Vector3SoA::set(size_t index, const Vector3& vector) {
+    x[index] = vector.x;
+    y[index] = vector.y;
+    z[index] = vector.z;
+}
+
+void Vector3SoA::toArray(Vector3* output) const {
+    for (size_t i = 0; i < size(); i++)
+        output[i] = get(i);
+}
+
+// --- SoA Kernels ---
+// MatrixLanes:
+// Every entry of the matrix, splatted across all lanes. Entry (row, col) is
+// at m[col][row].
+struct MatrixLanes {
+    float4 m[4][4];
+
+    MatrixLanes(const Matrix4& matrix) {
+        for (int col = 0; col < 4; col++)
+            for (int row = 0; row < 4; row++)
+                m[col][row] = Splat(matrix[col][row]);
+    }
+
+    // Row of the matrix applied to 4 vectors (x, y, z, w)
+    float4 row(int r, float4 x, float4 y, float4 z, float4 w) const {
+        return MulAdd(m[0][r], x,
+                      MulAdd(m[1][r], y, MulAdd(m[2][r], z, Mul(m[3][r], w))));
+    }
+    // Same as above, for w = 1 and w = 0
+    float4 rowPoint(int r, float4 x, float4 y, float4 z) const {
+        return MulAdd(m[0][r], x, MulAdd(m[1][r], y, MulAdd(m[2][r], z,
+                                                            m[3][r])));
+    }
+    float4 rowVector(int r, float4 x, float4 y, float4 z) const {
+        return MulAdd(m[0][r], x, MulAdd(m[1][r], y, Mul(m[2][r], z)));
+    }
+};
+
+// The kernels process 4 vectors at a time, and finish the last (count % 4)
+// vectors with scalar code.
+void BatchTransformPoints(const Matrix4& m, const float* x, const float* y,
+                          const float* z, float* out_x, float* out_y,
+                          float* out_z, size_t count) {
+    const MatrixLanes lanes = MatrixLanes(m);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float4 vx = Load(x + i);
+        const float4 vy = Load(y + i);
+        const float4 vz = Load(z + i);
+
+        Store(out_x + i, lanes.rowPoint(0, vx, vy, vz));
+        Store(out_y + i, lanes.rowPoint(1, vx, vy, vz));
+        Store(out_z + i, lanes.rowPoint(2, vx, vy, vz));
+    }
+
+    for (; i < count; i++) {
+        const float px = x[i], py = y[i], pz = z[i];
+        out_x[i] = m[0][0] * px + m[1][0] * py + m[2][0] * pz + m[3][0];
+        out_y[i] = m[0][1] * px + m[1][1] * py + m[2][1] * pz + m[3][1];
+        out_z[i] = m[0][2] * px + m[1][2] * py + m[2][2] * pz + m[3][2];
+    }
+}
+
+void BatchTransformVectors(const Matrix4& m, const float* x, const float* y,
+                           const float* z, float* out_x, float* out_y,
+                           float* out_z, size_t count) {
+    const MatrixLanes lanes = MatrixLanes(m);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float4 vx = Load(x + i);
+        const float4 vy = Load(y + i);
+        const float4 vz = Load(z + i);
+
+        Store(out_x + i, lanes.rowVector(0, vx, vy, vz));
+        Store(out_y + i, lanes.rowVector(1, vx, vy, vz));
+        Store(out_z + i, lanes.rowVector(2, vx, vy, vz));
+    }
+
+    for (; i < count; i++) {
+        const float px = x[i], py = y[i], pz = z[i];
+        out_x[i] = m[0][0] * px + m[1][0] * py + m[2][0] * pz;
+        out_y[i] = m[0][1] * px + m[1][1] * py + m[2][1] * pz;
+        out_z[i] = m[0][2] * px + m[1][2] * py + m[2][2] * pz;
+    }
+}
+
+void BatchProjectPoints(const Matrix4& m, const float* x, const float* y,
+                        const float* z, float* out_x, float* out_y,
+                        float* out_z, size_t count) {
+    const MatrixLanes lanes = MatrixLanes(m);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float4 vx = Load(x + i);
+        const float4 vy = Load(y + i);
+        const float4 vz = Load(z + i);
+
+        const float4 w = lanes.rowPoint(3, vx, vy, vz);
+        Store(out_x + i, Div(lanes.rowPoint(0, vx, vy, vz), w));
+        Store(out_y + i, Div(lanes.rowPoint(1, vx, vy, vz), w));
+        Store(out_z + i, Div(lanes.rowPoint(2, vx, vy, vz), w));
+    }
+
+    for (; i < count; i++) {
+        const Vector4 p = m * Vector4(x[i], y[i], z[i], 1.f);
+        out_x[i] = p.x / p.w;
+        out_y[i] = p.y / p.w;
+        out_z[i] = p.z / p.w;
+    }
+}
+
+void BatchBoundsOfTransformedPoints(const Matrix4& m, const float* x,
+                                    const float* y, const float* z,
+                                    size_t count, Vector3* out_min,
+                                    Vector3* out_max) {
+    const MatrixLanes lanes = MatrixLanes(m);
+
+    float4 min_x = Splat(FLT_MAX), min_y = min_x, min_z = min_x;
+    float4 max_x = Splat(-FLT_MAX), max_y = max_x, max_z = max_x;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float4 vx = Load(x + i);
+        const float4 vy = Load(y + i);
+        const float4 vz = Load(z + i);
+
+        const float4 tx = lanes.rowPoint(0, vx, vy, vz);
+        const float4 ty = lanes.rowPoint(1, vx, vy, vz);
+        const float4 tz = lanes.rowPoint(2, vx, vy, vz);
+
+        min_x = Min(min_x, tx);
+        min_y = Min(min_y, ty);
+        min_z = Min(min_z, tz);
+        max_x = Max(max_x, tx);
+        max_y = Max(max_y, ty);
+        max_z = Max(max_z, tz);
+    }
+
+    // Reduce the lanes
+    float lane_min[3][4], lane_max[3][4];
+    Store(lane_min[0], min_x);
+    Store(lane_min[1], min_y);
+    Store(lane_min[2], min_z);
+    Store(lane_max[0], max_x);
+    Store(lane_max[1], max_y);
+    Store(lane_max[2], max_z);
+
+    Vector3 minimum = Vector3::VectorMax();
+    Vector3 maximum = Vector3::VectorMin();
+    for (int axis = 0; axis < 3; axis++) {
+        for (int lane = 0; lane < 4; lane++) {
+            minimum[axis] = std::min(minimum[axis], lane_min[axis][lane]);
+            maximum[axis] = std::max(maximum[axis], lane_max[axis][lane]);
+        }
+    }
+
+    for (; i < count; i++) {
+        const Vector3 p = (m * Vector4(x[i], y[i], z[i], 1.f)).xyz();
+        minimum = minimum.componentMin(p);
+        maximum = maximum.componentMax(p);
+    }
+
+    *out_min = minimum;
+    *out_max = maximum;
+}
+
+void BatchPlaneDistances(const Plane& plane, const float* x, const float* y,
+                         const float* z, float* out, size_t count) {
+    const Vector3& n = plane.getNormal();
+    const float d = plane.getDistance();
+
+    const float4 nx = Splat(n.x);
+    const float4 ny = Splat(n.y);
+    const float4 nz = Splat(n.z);
+    const float4 nd = Splat(-d);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float4 dist = MulAdd(
+            nx, Load(x + i), MulAdd(ny, Load(y + i), MulAdd(nz, Load(z + i),
+                                                            nd)));
+        Store(out + i, dist);
+    }
+
+    for (; i < count; i++)
+        out[i] = n.x * x[i] + n.y * y[i] + n.z * z[i] - d;
+}
+
+void BatchTransformPoints(const Matrix4& m, const Vector3SoA& points,
+                          Vector3SoA& output) {
+    output.resize(points.size());
+    BatchTransformPoints(m, points.x.data(), points.y.data(), points.z.data(),
+                         output.x.data(), output.y.data(), output.z.data(),
+                         points.size());
+}
+void BatchTransformVectors(const Matrix4& m, const Vector3SoA& vectors,
+                           Vector3SoA& output) {
+    output.resize(vectors.size());
+    BatchTransformVectors(m, vectors.x.data(), vectors.y.data(),
+                          vectors.z.data(), output.x.data(), output.y.data(),
+                          output.z.data(), vectors.size());
+}
+void BatchPlaneDistances(const Plane& plane, const Vector3SoA& points,
+                         float* out) {
+    BatchPlaneDistances(plane, points.x.data(), points.y.data(),
+                        points.z.data(), out, points.size());
+}
+
+// --- Array of Vector3 Kernels ---
+// SoABlock:
+// Scratch block that a range of Vector3s is converted to and from.
+struct SoABlock {
+    float x[BLOCK_SIZE];
+    float y[BLOCK_SIZE];
+    float z[BLOCK_SIZE];
+
+    void load(const Vector3* vectors, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            x[i] = vectors[i].x;
+            y[i] = vectors[i].y;
+            z[i] = vectors[i].z;
+        }
+    }
+    void store(Vector3* vectors, size_t count) const {
+        for (size_t i = 0; i < count; i++)
+            vectors[i] = Vector3(x[i], y[i], z[i]);
+    }
+};
+
+// RunBlocked:
+// Runs an SoA kernel over an array of Vector3s, one block at a time.
+template <typename Kernel>
+static void RunBlocked(const Vector3* input, Vector3* output, size_t count,
+                       Kernel&& kernel) {
+    SoABlock block;
+
+    for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const size_t block_count = std::min(BLOCK_SIZE, count - start);
+
+        block.load(input + start, block_count);
+        kernel(block, block_count);
+        block.store(output + start, block_count);
+    }
+}
+
+void BatchTransformPoints(const Matrix4& m, const Vector3* points,
+                          Vector3* output, size_t count) {
+    RunBlocked(points, output, count, [&m](SoABlock& b, size_t n) {
+        BatchTransformPoints(m, b.x, b.y, b.z, b.x, b.y, b.z, n);
+    });
+}
+void BatchTransformVectors(const Matrix4& m, const Vector3* vectors,
+                           Vector3* output, size_t count) {
+    RunBlocked(vectors, output, count, [&m](SoABlock& b, size_t n) {
+        BatchTransformVectors(m, b.x, b.y, b.z, b.x, b.y, b.z, n);
+    });
+}
+void BatchProjectPoints(const Matrix4& m, const Vector3* points,
+                        Vector3* output, size_t count) {
+    RunBlocked(points, output, count, [&m](SoABlock& b, size_t n) {
+        BatchProjectPoints(m, b.x, b.y, b.z, b.x, b.y, b.z, n);
+    });
+}
+
+void BatchBoundsOfTransformedPoints(const Matrix4& m, const Vector3* points,
+                                    size_t count, Vector3* out_min,
+                                    Vector3* out_max) {
+    SoABlock block;
+
+    Vector3 minimum = Vector3::VectorMax();
+    Vector3 maximum = Vector3::VectorMin();
+
+    for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const size_t block_count = std::min(BLOCK_SIZE, count - start);
+        block.load(points + start, block_count);
+
+        Vector3 block_min, block_max;
+        BatchBoundsOfTransformedPoints(m, block.x, block.y, block.z,
+                                       block_count, &block_min, &block_max);
+        minimum = minimum.componentMin(block_min);
+        maximum = maximum.componentMax(block_max);
+    }
+
+    *out_min = minimum;
+    *out_max = maximum;
+}
+
+// --- Matrix Kernels ---
+void BatchMultiplyMatrices(const Matrix4& m, const Matrix4* matrices,
+                           Matrix4* output, size_t count) {
+    const float4 c0 = Load(m[0]);
+    const float4 c1 = Load(m[1]);
+    const float4 c2 = Load(m[2]);
+    const float4 c3 = Load(m[3]);
+
+    for (size_t i = 0; i < count; i++) {
+        // Load the whole input before storing, in case output aliases it
+        float4 columns[4];
+        for (int col = 0; col < 4; col++) {
+            const float* weights = matrices[i][col];
+
+            float4 value = Mul(c0, Splat(weights[0]));
+            value = MulAdd(c1, Splat(weights[1]), value);
+            value = MulAdd(c2, Splat(weights[2]), value);
+            columns[col] = MulAdd(c3, Splat(weights[3]), value);
+        }
+
+        for (int col = 0; col < 4; col++)
+            Store(output[i][col], columns[col]);
+    }
+}
+
+} // namespace Math
+} // namespace Engine
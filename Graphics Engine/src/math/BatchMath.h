@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "Matrix4.h"
+#include "Plane.h"
+#include "Vector3.h"
+
+namespace Engine {
+namespace Math {
+// Vector3SoA Class:
+// Stores an array of Vector3s as a structure of arrays (all x, then all y,
+// then all z), so that batch kernels can process 4 vectors per instruction.
+class Vector3SoA {
+  public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    Vector3SoA();
+    Vector3SoA(const Vector3* vectors, size_t count);
+    ~Vector3SoA();
+
+    size_t size() const;
+    void resize(size_t size);
+    void clear();
+
+    void push_back(const Vector3& vector);
+    Vector3 get(size_t index) const;
+    void set(size_t index, const Vector3& vector);
+
+    // Copy the vectors out to an array of Vector3s
+    void toArray(Vector3* output) const;
+};
+
+// Batch Kernels (SoA):
+// Apply the same operation to count vectors, given as separate x, y, z
+// streams. The output may alias the input.
+// TransformPoints:  Transform by the matrix with w = 1
+// TransformVectors: Transform by the matrix with w = 0 (ignores translation)
+// ProjectPoints:    Transform with w = 1, then divide by the resulting w
+// BoundsOfTransformedPoints: AABB (min / max) of the transformed points
+// PlaneDistances:   Signed distance of each point to the plane
+void BatchTransformPoints(const Matrix4& m, const float* x, const float* y,
+                          const float* z, float* out_x, float* out_y,
+                          float* out_z, size_t count);
+void BatchTransformVectors(const Matrix4& m, const float* x, const float* y,
+                           const float* z, float* out_x, float* out_y,
+                           float* out_z, size_t count);
+void BatchProjectPoints(const Matrix4& m, const float* x, const float* y,
+                        const float* z, float* out_x, float* out_y,
+                        float* out_z, size_t count);
+void BatchBoundsOfTransformedPoints(const Matrix4& m, const float* x,
+                                    const float* y, const float* z,
+                                    size_t count, Vector3* out_min,
+                                    Vector3* out_max);
+void BatchPlaneDistances(const Plane& plane, const float* x, const float* y,
+                         const float* z, float* out, size_t count);
+
+void BatchTransformPoints(const Matrix4& m, const Vector3SoA& points,
+                          Vector3SoA& output);
+void BatchTransformVectors(const Matrix4& m, const Vector3SoA& vectors,
+                           Vector3SoA& output);
+void BatchPlaneDistances(const Plane& plane, const Vector3SoA& points,
+                         float* out);
+
+// Batch Kernels (Arrays of Vector3):
+// Same as above, for data stored as Vector3s. The vectors are processed in
+// cache-sized blocks, which are converted to SoA, run through the kernel, and
+// converted back. The output may alias the input.
+void BatchTransformPoints(const Matrix4& m, const Vector3* points,
+                          Vector3* output, size_t count);
+void BatchTransformVectors(const Matrix4& m, const Vector3* vectors,
+                           Vector3* output, size_t count);
+void BatchProjectPoints(const Matrix4& m, const Vector3* points,
+                        Vector3* output, size_t count);
+void BatchBoundsOfTransformedPoints(const Matrix4& m, const Vector3* points,
+                                    size_t count, Vector3* out_min,
+                                    Vector3* out_max);
+
+// BatchMultiplyMatrices:
+// Computes output[i] = m * matrices[i]. The output may alias the input.
+void BatchMultiplyMatrices(const Matrix4& m, const Matrix4* matrices,
+                           Matrix4* output, size_t count);
+
+} // namespace Math
+} // namespace Engine
@@ -4,9 +4,10 @@
 
 #include <assert.h>
 #include <math.h>
-#include <stdlib.h>
 #include <time.h>
 
+#include <random>
+
 #include "Vector2.h"
 #include "Vector4.h"
 
@@ -43,11 +44,21 @@ float CubicInterp(float a, float b, float t) {
     return (b - a + 1.5f) * t3 - 1.5f * t2 + a;
 }
 
+// SeedRandom:
+// Seeds this thread's random number generator.
+static thread_local std::mt19937 random_generator = std::mt19937(0);
+
+void SeedRandom(uint32_t seed) { random_generator.seed(seed); }
+std::mt19937 GetRandomState() { return random_generator; }
+void SetRandomState(const std::mt19937& state) { random_generator = state; }
+
 // Random:
 // Generates a random value within the range [low, high]
 float Random(float low, float high) {
-    // Generate random float
-    float rand_num = (float)(rand()) / float(RAND_MAX);
+    // Generate random float. We convert the raw output ourselves, as the
+    // std distributions are not guaranteed to match across platforms.
+    const float rand_num =
+        float(random_generator()) / float(std::mt19937::max());
     return rand_num * (high - low) + low;
 }
 int Random(int low, int high) {
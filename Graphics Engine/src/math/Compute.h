@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <random>
+#include <stdint.h>
 
 #include "Vector3.h"
 
@@ -29,6 +31,14 @@ float Lerp(float a, float b, float t);
 // mandates that the slopes at t = 0, 1 are 0.
 float CubicInterp(float a, float b, float t);
 
+// Seeds the generator used by Random(). The generator is per-thread and does
+// not use the global rand(), so its sequence is reproducible.
+void SeedRandom(uint32_t seed);
+// Saves and restores the state of this thread's generator, so that a seeded
+// run (such as a physics replay) does not change the sequence seen after it.
+std::mt19937 GetRandomState();
+void SetRandomState(const std::mt19937& state);
+
 // Generates a random value within a range [low, high]
 float Random(float low, float high);
 int Random(int low, int high);
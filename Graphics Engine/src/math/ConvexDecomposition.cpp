@@ -0,0 +1,514 @@
+#include "ConvexDecomposition.h"
+
+#include <assert.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+
+#include <algorithm>
+
+namespace Engine {
+namespace Math {
+// Weight of how unevenly a split divides a part's volume, added to the
+// concavity it leaves. Keeps splits from shaving thin slices off of parts.
+static constexpr float BALANCE_WEIGHT = 0.05f;
+
+static constexpr int NEIGHBOR_OFFSETS[6][3] = {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+ConvexDecomposer::ConvexDecomposer() {
+    dimensions[0] = dimensions[1] = dimensions[2] = 0;
+    voxel_size = 0.f;
+    mesh_volume = 0.f;
+}
+ConvexDecomposer::~ConvexDecomposer() = default;
+
+const std::vector<std::vector<Vector3>>& ConvexDecomposer::getHulls() const {
+    return hulls;
+}
+const ConvexDecomposer::Stats& ConvexDecomposer::getStats() const {
+    return stats;
+}
+
+// Decompose:
+// Voxelizes the mesh, splits its voxels into nearly convex parts, and merges
+// the hulls of the parts down to the hull budget.
+bool ConvexDecomposer::decompose(const std::vector<Vector3>& vertices,
+                                 const std::vector<UINT>& indices,
+                                 const Config& config) {
+    return decompose(vertices.data(), vertices.size(), indices.data(),
+                     indices.size(), config);
+}
+
+bool ConvexDecomposer::decompose(const Vector3* vertices,
+                                 size_t num_vertices, const UINT* indices,
+                                 size_t num_indices, const Config& config) {
+    hulls.clear();
+    stats = Stats();
+
+    if (num_indices < 3 || !voxelize(vertices, num_vertices, indices,
+                                     num_indices, config.resolution))
+        return false;
+
+    fillInside();
+
+    // The whole mesh starts as one part
+    Part root;
+    root.id = 0;
+    root.depth = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        root.minimum[axis] = INT_MAX;
+        root.maximum[axis] = INT_MIN;
+    }
+
+    owners.assign(states.size(), -1);
+
+    for (size_t i = 0; i < states.size(); i++) {
+        if (states[i] == Outside)
+            continue;
+
+        if (states[i] == Surface)
+            stats.surface_voxels++;
+        else
+            stats.inside_voxels++;
+
+        const int voxel = int(i);
+        owners[i] = root.id;
+        root.voxels.push_back(voxel);
+
+        for (int axis = 0; axis < 3; axis++) {
+            const int coord = voxelCoord(voxel, axis);
+            root.minimum[axis] = std::min(root.minimum[axis], coord);
+            root.maximum[axis] = std::max(root.maximum[axis], coord);
+        }
+    }
+
+    mesh_volume =
+        float(root.voxels.size()) * voxel_size * voxel_size * voxel_size;
+
+    pending.clear();
+    leaves.clear();
+    pending.push_back(std::move(root));
+    splitParts(config);
+    stats.parts = int(leaves.size());
+
+    // Hull each part from the corners of its boundary voxels. Voxels inside
+    // the part can't be on its hull.
+    leaf_hulls.clear();
+
+    for (const Part& part : leaves) {
+        points_1.clear();
+        for (int voxel : part.voxels) {
+            if (isBoundary(voxel, part.id))
+                addCorners(voxel, points_1);
+        }
+
+        Hull hull;
+        hull.volume = hullVolume(points_1);
+        hull.vertices = hull_builder.getVertices();
+        hull.alive = !hull.vertices.empty();
+
+        if (hull.alive)
+            leaf_hulls.push_back(std::move(hull));
+    }
+
+    mergeHulls(config);
+
+    // Simplify the hulls that are over the vertex budget
+    QuickHullBuilder::Config simplify;
+    simplify.max_vertices = config.max_vertices;
+
+    for (const Hull& hull : leaf_hulls) {
+        if (!hull.alive)
+            continue;
+
+        if (config.max_vertices > 0 &&
+            hull.vertices.size() > size_t(config.max_vertices) &&
+            hull_builder.build(hull.vertices, simplify))
+            hulls.push_back(hull_builder.getVertices());
+        else
+            hulls.push_back(hull.vertices);
+    }
+
+    stats.hulls = int(hulls.size());
+    return !hulls.empty();
+}
+
+// Voxelize:
+// Sizes the grid to the mesh's bounds, and marks every voxel a triangle
+// passes through as surface. Triangles are sampled densely enough that no
+// voxel they pass through is skipped.
+bool ConvexDecomposer::voxelize(const Vector3* vertices, size_t num_vertices,
+                                const UINT* indices, size_t num_indices,
+                                int resolution) {
+    if (num_vertices == 0 || resolution <= 0)
+        return false;
+
+    Vector3 minimum = vertices[0];
+    Vector3 maximum = vertices[0];
+    for (size_t i = 1; i < num_vertices; i++) {
+        minimum = minimum.componentMin(vertices[i]);
+        maximum = maximum.componentMax(vertices[i]);
+    }
+
+    const Vector3 extent = maximum - minimum;
+    const float longest = std::max(extent.x, std::max(extent.y, extent.z));
+    if (longest <= 0.f)
+        return false;
+
+    voxel_size = longest / resolution;
+
+    // One voxel of padding on every side, so the outside is connected
+    for (int axis = 0; axis < 3; axis++)
+        dimensions[axis] = int(ceilf(extent[axis] / voxel_size)) + 3;
+    origin = minimum - Vector3(voxel_size, voxel_size, voxel_size);
+
+    states.assign(dimensions[0] * dimensions[1] * dimensions[2], Inside);
+
+    const auto mark = [this](const Vector3& point) {
+        int coords[3];
+        for (int axis = 0; axis < 3; axis++) {
+            const int coord = int((point[axis] - origin[axis]) / voxel_size);
+            coords[axis] = std::clamp(coord, 1, dimensions[axis] - 2);
+        }
+        states[voxelIndex(coords[0], coords[1], coords[2])] = Surface;
+    };
+
+    for (size_t i = 0; i + 2 < num_indices; i += 3) {
+        const Vector3& a = vertices[indices[i]];
+        const Vector3& b = vertices[indices[i + 1]];
+        const Vector3& c = vertices[indices[i + 2]];
+
+        // Samples half a voxel apart along both edges
+        const float edge = std::max((b - a).magnitude(),
+                                    std::max((c - a).magnitude(),
+                                             (c - b).magnitude()));
+        const int steps = std::max(1, int(ceilf(2.f * edge / voxel_size)));
+
+        for (int u = 0; u <= steps; u++) {
+            for (int v = 0; u + v <= steps; v++) {
+                const float s = float(u) / steps;
+                const float t = float(v) / steps;
+                mark(a + (b - a) * s + (c - a) * t);
+            }
+        }
+    }
+
+    return true;
+}
+
+// FillInside:
+// Flood fills the outside of the mesh from a corner of the grid. Voxels the
+// fill can't reach are inside. If the mesh has holes, the fill leaks in, and
+// only the surface voxels are kept.
+void ConvexDecomposer::fillInside() {
+    std::vector<int> queue;
+    queue.push_back(0);
+    states[0] = Outside;
+
+    for (size_t next = 0; next < queue.size(); next++) {
+        const int voxel = queue[next];
+        const int x = voxelCoord(voxel, 0);
+        const int y = voxelCoord(voxel, 1);
+        const int z = voxelCoord(voxel, 2);
+
+        for (const int* offset : NEIGHBOR_OFFSETS) {
+            const int nx = x + offset[0];
+            const int ny = y + offset[1];
+            const int nz = z + offset[2];
+            if (nx < 0 || ny < 0 || nz < 0 || nx >= dimensions[0] ||
+                ny >= dimensions[1] || nz >= dimensions[2])
+                continue;
+
+            const int neighbor = voxelIndex(nx, ny, nz);
+            if (states[neighbor] == Inside) {
+                states[neighbor] = Outside;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+}
+
+// SplitParts:
+// Splits parts until they are nearly convex, or too deep to split further.
+void ConvexDecomposer::splitParts(const Config& config) {
+    int next_id = 1;
+
+    while (!pending.empty()) {
+        Part part = std::move(pending.back());
+        pending.pop_back();
+
+        if (!splitPart(part, config, &next_id))
+            leaves.push_back(std::move(part));
+    }
+}
+
+// SplitPart:
+// Tries planes between the part's voxel layers along each axis, and splits
+// the part by the one leaving the least concavity. The halves are estimated
+// from the centers of their boundary voxels, where a half's boundary is the
+// part's boundary on its side, plus the layer next to the plane. Returns
+// false if the part should not be split.
+bool ConvexDecomposer::splitPart(Part& part, const Config& config,
+                                 int* next_id) {
+    const float voxel_volume = voxel_size * voxel_size * voxel_size;
+    const float part_volume = float(part.voxels.size()) * voxel_volume;
+
+    boundary.resize(part.voxels.size());
+    points_1.clear();
+    for (size_t i = 0; i < part.voxels.size(); i++) {
+        boundary[i] = isBoundary(part.voxels[i], part.id);
+        if (boundary[i])
+            addCorners(part.voxels[i], points_1);
+    }
+
+    const float concavity = (hullVolume(points_1) - part_volume) / mesh_volume;
+    if (concavity <= config.concavity || part.depth >= config.max_depth ||
+        part.voxels.size() < 2)
+        return false;
+
+    int best_axis = -1;
+    int best_plane = 0;
+    float best_cost = FLT_MAX;
+
+    std::vector<int> layer_counts;
+
+    for (int axis = 0; axis < 3; axis++) {
+        const int low = part.minimum[axis];
+        const int high = part.maximum[axis];
+        if (high == low)
+            continue;
+
+        // Voxels on each layer, to find the volume on each side of a plane
+        layer_counts.assign(high - low + 1, 0);
+        for (int voxel : part.voxels)
+            layer_counts[voxelCoord(voxel, axis) - low]++;
+
+        // Planes sit before a layer, between low + 1 and high
+        const int num_planes = std::min(config.planes_per_axis, high - low);
+
+        for (int k = 1; k <= num_planes; k++) {
+            const int plane = low + std::max(1, (high - low + 1) * k /
+                                                    (num_planes + 1));
+            if (plane > high)
+                continue;
+
+            int count_1 = 0;
+            for (int layer = low; layer < plane; layer++)
+                count_1 += layer_counts[layer - low];
+            const int count_2 = int(part.voxels.size()) - count_1;
+
+            points_1.clear();
+            points_2.clear();
+            for (size_t i = 0; i < part.voxels.size(); i++) {
+                const int voxel = part.voxels[i];
+                const int coord = voxelCoord(voxel, axis);
+
+                if (coord < plane) {
+                    if (boundary[i] || coord == plane - 1)
+                        addCenter(voxel, points_1);
+                } else if (boundary[i] || coord == plane)
+                    addCenter(voxel, points_2);
+            }
+
+            const float volume_1 = hullVolume(points_1);
+            const float volume_2 = hullVolume(points_2);
+            const float balance =
+                fabsf(float(count_1 - count_2)) * voxel_volume;
+            const float cost = (volume_1 + volume_2 - part_volume +
+                                BALANCE_WEIGHT * balance) /
+                               mesh_volume;
+
+            if (cost < best_cost) {
+                best_axis = axis;
+                best_plane = plane;
+                best_cost = cost;
+            }
+        }
+    }
+
+    if (best_axis == -1)
+        return false;
+
+    Part halves[2];
+    for (Part& half : halves) {
+        half.id = (*next_id)++;
+        half.depth = part.depth + 1;
+        for (int axis = 0; axis < 3; axis++) {
+            half.minimum[axis] = INT_MAX;
+            half.maximum[axis] = INT_MIN;
+        }
+    }
+
+    for (int voxel : part.voxels) {
+        Part& half = halves[voxelCoord(voxel, best_axis) < best_plane ? 0 : 1];
+        half.voxels.push_back(voxel);
+        owners[voxel] = half.id;
+
+        for (int axis = 0; axis < 3; axis++) {
+            const int coord = voxelCoord(voxel, axis);
+            half.minimum[axis] = std::min(half.minimum[axis], coord);
+            half.maximum[axis] = std::max(half.maximum[axis], coord);
+        }
+    }
+
+    for (Part& half : halves) {
+        if (!half.voxels.empty())
+            pending.push_back(std::move(half));
+    }
+
+    return true;
+}
+
+// MergeHulls:
+// Repeatedly merges the pair of hulls whose merged hull adds the least
+// volume, while there are more hulls than the budget allows, or while the
+// cheapest merge adds less than the concavity threshold.
+void ConvexDecomposer::mergeHulls(const Config& config) {
+    const int num_hulls = int(leaf_hulls.size());
+    int alive = num_hulls;
+
+    // Cost of merging hulls i and j, for i < j
+    std::vector<float> costs(num_hulls * num_hulls, FLT_MAX);
+
+    const auto computeCost = [&](int i, int j) {
+        points_1 = leaf_hulls[i].vertices;
+        points_1.insert(points_1.end(), leaf_hulls[j].vertices.begin(),
+                        leaf_hulls[j].vertices.end());
+        costs[i * num_hulls + j] = hullVolume(points_1) -
+                                   leaf_hulls[i].volume - leaf_hulls[j].volume;
+    };
+
+    for (int i = 0; i < num_hulls; i++) {
+        for (int j = i + 1; j < num_hulls; j++)
+            computeCost(i, j);
+    }
+
+    while (alive > 1) {
+        int best_i = -1;
+        int best_j = -1;
+        float best_cost = FLT_MAX;
+
+        for (int i = 0; i < num_hulls; i++) {
+            if (!leaf_hulls[i].alive)
+                continue;
+
+            for (int j = i + 1; j < num_hulls; j++) {
+                if (leaf_hulls[j].alive &&
+                    costs[i * num_hulls + j] < best_cost) {
+                    best_i = i;
+                    best_j = j;
+                    best_cost = costs[i * num_hulls + j];
+                }
+            }
+        }
+
+        if (alive <= config.max_hulls &&
+            best_cost > config.concavity * mesh_volume)
+            break;
+
+        // Merge j into i
+        Hull& merged = leaf_hulls[best_i];
+        points_1 = merged.vertices;
+        points_1.insert(points_1.end(), leaf_hulls[best_j].vertices.begin(),
+                        leaf_hulls[best_j].vertices.end());
+        merged.volume = hullVolume(points_1);
+        merged.vertices = hull_builder.getVertices();
+
+        leaf_hulls[best_j].alive = false;
+        alive--;
+
+        for (int k = 0; k < num_hulls; k++) {
+            if (k == best_i || !leaf_hulls[k].alive)
+                continue;
+
+            if (k < best_i)
+                computeCost(k, best_i);
+            else
+                computeCost(best_i, k);
+        }
+    }
+}
+
+int ConvexDecomposer::voxelIndex(int x, int y, int z) const {
+    return (z * dimensions[1] + y) * dimensions[0] + x;
+}
+
+int ConvexDecomposer::voxelCoord(int voxel, int axis) const {
+    switch (axis) {
+    case 0:
+        return voxel % dimensions[0];
+    case 1:
+        return (voxel / dimensions[0]) % dimensions[1];
+    default:
+        return voxel / (dimensions[0] * dimensions[1]);
+    }
+}
+
+// IsBoundary:
+// True if any of the voxel's neighbors belong to a different part, or are
+// outside of the mesh. The padding means every voxel of a part has all 6
+// neighbors.
+bool ConvexDecomposer::isBoundary(int voxel, int owner) const {
+    const int x = voxelCoord(voxel, 0);
+    const int y = voxelCoord(voxel, 1);
+    const int z = voxelCoord(voxel, 2);
+
+    for (const int* offset : NEIGHBOR_OFFSETS) {
+        const int neighbor =
+            voxelIndex(x + offset[0], y + offset[1], z + offset[2]);
+        if (owners[neighbor] != owner)
+            return true;
+    }
+
+    return false;
+}
+
+void ConvexDecomposer::addCorners(int voxel,
+                                  std::vector<Vector3>& output) const {
+    const Vector3 corner = origin + Vector3(float(voxelCoord(voxel, 0)),
+                                            float(voxelCoord(voxel, 1)),
+                                            float(voxelCoord(voxel, 2))) *
+                                        voxel_size;
+
+    for (int i = 0; i < 8; i++) {
+        output.push_back(corner + Vector3(float(i & 1), float((i >> 1) & 1),
+                                          float((i >> 2) & 1)) *
+                                      voxel_size);
+    }
+}
+
+void ConvexDecomposer::addCenter(int voxel,
+                                 std::vector<Vector3>& output) const {
+    output.push_back(origin + Vector3(voxelCoord(voxel, 0) + 0.5f,
+                                      voxelCoord(voxel, 1) + 0.5f,
+                                      voxelCoord(voxel, 2) + 0.5f) *
+                                  voxel_size);
+}
+
+// HullVolume:
+// Builds the hull of the points, and returns its volume. Points that don't
+// span a volume have none. The hull is left in the hull builder.
+float ConvexDecomposer::hullVolume(const std::vector<Vector3>& points) {
+    if (!hull_builder.build(points, QuickHullBuilder::Config()))
+        return 0.f;
+
+    const std::vector<Vector3>& vertices = hull_builder.getVertices();
+    const std::vector<UINT>& indices = hull_builder.getIndices();
+
+    // Sum of the tetrahedra from the first vertex to every face
+    float volume = 0.f;
+    const Vector3& apex = vertices[0];
+
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const Vector3 a = vertices[indices[i]] - apex;
+        const Vector3 b = vertices[indices[i + 1]] - apex;
+        const Vector3 c = vertices[indices[i + 2]] - apex;
+        volume += a.dot(b.cross(c));
+    }
+
+    return fabsf(volume) / 6.f;
+}
+
+} // namespace Math
+} // namespace Engine
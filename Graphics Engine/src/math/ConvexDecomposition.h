@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "QuickHull.h"
+#include "Vector3.h"
+
+namespace Engine {
+namespace Math {
+// ConvexDecomposer Class:
+// Approximates a triangle mesh, which can be concave, with a small set of
+// convex hulls, in the style of V-HACD. The mesh is voxelized, filling in its
+// inside if it is closed. The voxels are then split recursively by the axis
+// aligned plane that most reduces their concavity, where the concavity of a
+// part is how much the volume of its hull exceeds the volume of its voxels.
+// Finally, the hulls of the parts are merged, cheapest first, until they fit
+// the hull budget.
+//
+// Hulls are built from voxel corners, so they can stand out of the mesh by
+// up to a voxel. Like QuickHullBuilder, the decomposer keeps its storage
+// between calls.
+class ConvexDecomposer {
+  public:
+    struct Config {
+        // Voxels along the longest side of the mesh's bounds
+        int resolution = 32;
+        // Parts stop splitting once their concavity is at most this
+        // fraction of the mesh's volume. Hulls whose merge adds less than
+        // this are merged, even if within the hull budget.
+        float concavity = 0.02f;
+        // Parts are split at most this many times, so there are at most
+        // 2^max_depth parts
+        int max_depth = 6;
+        // Split planes tried along each axis
+        int planes_per_axis = 8;
+
+        int max_hulls = 16;
+        // If above 0, hulls are simplified to at most this many vertices
+        int max_vertices = 32;
+    };
+
+    struct Stats {
+        int surface_voxels = 0;
+        int inside_voxels = 0;
+        // Parts after splitting, before merging
+        int parts = 0;
+        int hulls = 0;
+    };
+
+  private:
+    enum VoxelState : uint8_t { Outside = 0, Surface, Inside };
+
+    struct Part {
+        int id;
+        int depth;
+        std::vector<int> voxels;
+        int minimum[3];
+        int maximum[3];
+    };
+
+    struct Hull {
+        std::vector<Vector3> vertices;
+        float volume;
+        bool alive;
+    };
+
+    // Voxel grid, with a layer of outside voxels on every side
+    int dimensions[3];
+    Vector3 origin;
+    float voxel_size;
+    std::vector<VoxelState> states;
+    // The part each voxel belongs to, or -1 if it is outside
+    std::vector<int> owners;
+    float mesh_volume;
+
+    QuickHullBuilder hull_builder;
+    std::vector<Part> pending;
+    std::vector<Part> leaves;
+    std::vector<Hull> leaf_hulls;
+    std::vector<uint8_t> boundary;
+    std::vector<Vector3> points_1;
+    std::vector<Vector3> points_2;
+
+    std::vector<std::vector<Vector3>> hulls;
+    Stats stats;
+
+  public:
+    ConvexDecomposer();
+    ~ConvexDecomposer();
+
+    // Decomposes a mesh given as triangles of vertex indices. Returns false,
+    // with no hulls, if the mesh has no triangles or no volume.
+    bool decompose(const Vector3* vertices, size_t num_vertices,
+                   const UINT* indices, size_t num_indices,
+                   const Config& config);
+    bool decompose(const std::vector<Vector3>& vertices,
+                   const std::vector<UINT>& indices, const Config& config);
+
+    // The hull vertices of the last decomposition
+    const std::vector<std::vector<Vector3>>& getHulls() const;
+    const Stats& getStats() const;
+
+  private:
+    bool voxelize(const Vector3* vertices, size_t num_vertices,
+                  const UINT* indices, size_t num_indices, int resolution);
+    void fillInside();
+
+    void splitParts(const Config& config);
+    bool splitPart(Part& part, const Config& config, int* next_id);
+    void mergeHulls(const Config& config);
+
+    int voxelIndex(int x, int y, int z) const;
+    int voxelCoord(int voxel, int axis) const;
+    bool isBoundary(int voxel, int owner) const;
+    void addCorners(int voxel, std::vector<Vector3>& output) const;
+    void addCenter(int voxel, std::vector<Vector3>& output) const;
+    float hullVolume(const std::vector<Vector3>& points);
+};
+
+} // namespace Math
+} // namespace Engine
@@ -24,6 +24,7 @@ typedef unsigned int UINT;
 class ConvexHull {
 private:
     friend class QuickHullSolver;
+    friend class QuickHullBuilder;
 
     std::vector<Vector3> vertices;
     std::vector<UINT> indices;
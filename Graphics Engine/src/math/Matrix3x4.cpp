@@ -0,0 +1,129 @@
+#include "Matrix3x4.h"
+
+#include "Matrix3.h"
+
+namespace Engine {
+namespace Math {
+Matrix3x4::Matrix3x4() : data{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, 0}} {}
+
+Matrix3x4::Matrix3x4(const Matrix4& matrix) {
+    for (int col = 0; col < 4; col++)
+        for (int row = 0; row < 3; row++)
+            data[col][row] = matrix[col][row];
+}
+
+// FromTRS:
+// Builds the affine matrix directly from a position, rotation and scale,
+// without multiplying the 3 individual matrices.
+Matrix3x4 Matrix3x4::FromTRS(const Vector3& position,
+                             const Quaternion& rotation,
+                             const Vector3& scale) {
+    const Matrix3 m_rotation = rotation.rotationMatrix3();
+
+    Matrix3x4 matrix;
+    matrix.setColumn(0, m_rotation.column(0) * scale.x);
+    matrix.setColumn(1, m_rotation.column(1) * scale.y);
+    matrix.setColumn(2, m_rotation.column(2) * scale.z);
+    matrix.setColumn(3, position);
+    return matrix;
+}
+
+Vector3 Matrix3x4::column(int col) const {
+    return Vector3(data[col][0], data[col][1], data[col][2]);
+}
+void Matrix3x4::setColumn(int col, const Vector3& column) {
+    data[col][0] = column.x;
+    data[col][1] = column.y;
+    data[col][2] = column.z;
+}
+
+Matrix4 Matrix3x4::toMatrix4() const {
+    return Matrix4(Vector4(column(0), 0.f), Vector4(column(1), 0.f),
+                   Vector4(column(2), 0.f), Vector4(column(3), 1.f));
+}
+
+// Inverse:
+// The inverse of [A | t] is [A^-1 | -A^-1 t]. The rows of A^-1 are the
+// cross products of A's columns, divided by the determinant.
+Matrix3x4 Matrix3x4::inverse() const {
+    const Vector3 c0 = column(0);
+    const Vector3 c1 = column(1);
+    const Vector3 c2 = column(2);
+
+    const Vector3 r0 = c1.cross(c2);
+    const Vector3 r1 = c2.cross(c0);
+    const Vector3 r2 = c0.cross(c1);
+
+    const float inv_det = 1.f / c0.dot(r0);
+
+    Matrix3x4 inv;
+    for (int col = 0; col < 3; col++) {
+        inv[col][0] = r0[col] * inv_det;
+        inv[col][1] = r1[col] * inv_det;
+        inv[col][2] = r2[col] * inv_det;
+    }
+    inv.setColumn(3, -inv.transformVector(column(3)));
+
+    return inv;
+}
+
+// InverseRigidScale:
+// If A = R * S with R a rotation and S a scale, A^-1 = S^-1 * R^T, which is
+// A^T with each row divided by the squared length of A's column.
+Matrix3x4 Matrix3x4::inverseRigidScale() const {
+    Matrix3x4 inv;
+
+    for (int row = 0; row < 3; row++) {
+        const Vector3 basis = column(row);
+        const float length_squared = basis.dot(basis);
+        const float inv_length_squared =
+            length_squared > 0.f ? 1.f / length_squared : 0.f;
+
+        for (int col = 0; col < 3; col++)
+            inv[col][row] = basis[col] * inv_length_squared;
+    }
+    inv.setColumn(3, -inv.transformVector(column(3)));
+
+    return inv;
+}
+
+Vector3 Matrix3x4::transformPoint(const Vector3& point) const {
+    return Vector3(
+        data[0][0] * point.x + data[1][0] * point.y + data[2][0] * point.z +
+            data[3][0],
+        data[0][1] * point.x + data[1][1] * point.y + data[2][1] * point.z +
+            data[3][1],
+        data[0][2] * point.x + data[1][2] * point.y + data[2][2] * point.z +
+            data[3][2]);
+}
+Vector3 Matrix3x4::transformVector(const Vector3& vector) const {
+    return Vector3(
+        data[0][0] * vector.x + data[1][0] * vector.y + data[2][0] * vector.z,
+        data[0][1] * vector.x + data[1][1] * vector.y + data[2][1] * vector.z,
+        data[0][2] * vector.x + data[1][2] * vector.y + data[2][2] * vector.z);
+}
+Vector3 Matrix3x4::transposeTransformVector(const Vector3& vector) const {
+    return Vector3(column(0).dot(vector), column(1).dot(vector),
+                   column(2).dot(vector));
+}
+
+float* const Matrix3x4::operator[](int index) { return data[index]; }
+const float* const Matrix3x4::operator[](int index) const {
+    return data[index];
+}
+
+// Multiply:
+// Composes two affine matrices. The implicit bottom rows never need to be
+// multiplied.
+Matrix3x4 Matrix3x4::operator*(const Matrix3x4& matrix) const {
+    Matrix3x4 result;
+
+    for (int col = 0; col < 3; col++)
+        result.setColumn(col, transformVector(matrix.column(col)));
+    result.setColumn(3, transformPoint(matrix.column(3)));
+
+    return result;
+}
+
+} // namespace Math
+} // namespace Engine
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+namespace Engine {
+namespace Math {
+// Matrix3x4
+// Compact affine matrix: the top 3 rows of a Matrix4 whose bottom row is
+// (0, 0, 0, 1). Columns 0-2 are the (rotated and scaled) basis vectors, and
+// column 3 is the translation. Stored column-major, like Matrix4.
+class Matrix3x4 {
+  private:
+    float data[4][3];
+
+  public:
+    Matrix3x4(); // Identity
+    explicit Matrix3x4(const Matrix4& matrix);
+
+    // Builds Translate * Rotate * Scale, the same as Transform
+    static Matrix3x4 FromTRS(const Vector3& position,
+                             const Quaternion& rotation, const Vector3& scale);
+
+    Vector3 column(int col) const;
+    void setColumn(int col, const Vector3& column);
+
+    Matrix4 toMatrix4() const;
+
+    // Inverse for any invertible affine matrix
+    Matrix3x4 inverse() const;
+    // Faster inverse for matrices whose basis columns are orthogonal, such as
+    // rigid transforms with a per-axis scale.
+    Matrix3x4 inverseRigidScale() const;
+
+    // Transform with w = 1 (points) or w = 0 (vectors)
+    Vector3 transformPoint(const Vector3& point) const;
+    Vector3 transformVector(const Vector3& vector) const;
+    // Multiply a vector by the transpose of the 3x3 basis. Brings a
+    // direction into local space for support / dot product queries.
+    Vector3 transposeTransformVector(const Vector3& vector) const;
+
+    // Access the matrix as (column, row) coordinates
+    float* const operator[](int);
+    const float* const operator[](int) const;
+
+    Matrix3x4 operator*(const Matrix3x4& matrix) const;
+};
+
+} // namespace Math
+} // namespace Engine
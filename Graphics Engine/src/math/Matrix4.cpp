@@ -1,7 +1,10 @@
 #include "Matrix4.h"
-#include "Matrix3.h"
 
+#include <string.h>
+
+#include "BatchMath.h"
 #include "Quaternion.h"
+#include "SIMD.h"
 
 namespace Engine {
 namespace Math {
@@ -51,32 +54,130 @@ void Matrix4::setColumn(int col, const Vector4& column) {
 // Tranpose:
 // Returns the transpose of the matrix
 Matrix4 Matrix4::transpose() const {
-    Matrix4 matrix_transpose;
+    using namespace SIMD;
 
-    for (int col = 0; col < 4; col++)
-        for (int row = 0; row < 4; row++)
-            matrix_transpose[col][row] = data[row][col];
+    float4 c0 = Load(data[0]);
+    float4 c1 = Load(data[1]);
+    float4 c2 = Load(data[2]);
+    float4 c3 = Load(data[3]);
+    Transpose(c0, c1, c2, c3);
 
+    Matrix4 matrix_transpose;
+    Store(matrix_transpose.data[0], c0);
+    Store(matrix_transpose.data[1], c1);
+    Store(matrix_transpose.data[2], c2);
+    Store(matrix_transpose.data[3], c3);
     return matrix_transpose;
 }
 
-// Inverse:
-// Takes and returns the inverse of a matrix,
-// using the adjugate method
-Matrix4 Matrix4::inverse() const {
-    Matrix4 matrix_inverse;
+// SubDeterminants:
+// The 2x2 determinants of the first two and last two columns of the matrix,
+// which the determinant and inverse are built from (Laplace expansion).
+struct SubDeterminants {
+    float s[6];
+    float c[6];
+};
+
+static SubDeterminants ComputeSubDeterminants(const float m[4][4]) {
+    SubDeterminants d;
+    d.s[0] = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    d.s[1] = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    d.s[2] = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    d.s[3] = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    d.s[4] = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    d.s[5] = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+    d.c[0] = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+    d.c[1] = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    d.c[2] = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    d.c[3] = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    d.c[4] = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    d.c[5] = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    return d;
+}
 
-    // Find determinant
-    const float det = determinant();
+static float DeterminantFrom(const SubDeterminants& d) {
+    return d.s[0] * d.c[5] - d.s[1] * d.c[4] + d.s[2] * d.c[3] +
+           d.s[3] * d.c[2] - d.s[4] * d.c[1] + d.s[5] * d.c[0];
+}
 
-    // Build inverse matrix by simultaneously taking
-    // the transpose of the cofactor matrix
-    // and dividing it by the determinant
+// Inverse:
+// Takes and returns the inverse of a matrix, using the adjugate method. The
+// cofactors are built from the 2x2 sub-determinants, which are shared
+// between them.
+Matrix4 Matrix4::inverse() const {
+    const float(*m)[4] = data;
+    const SubDeterminants d = ComputeSubDeterminants(data);
+    const float* s = d.s;
+    const float* c = d.c;
+
+    const float inv_det = 1.f / DeterminantFrom(d);
+
+    Matrix4 inv;
+    inv.data[0][0] = (m[1][1] * c[5] - m[1][2] * c[4] + m[1][3] * c[3]);
+    inv.data[0][1] = (-m[0][1] * c[5] + m[0][2] * c[4] - m[0][3] * c[3]);
+    inv.data[0][2] = (m[3][1] * s[5] - m[3][2] * s[4] + m[3][3] * s[3]);
+    inv.data[0][3] = (-m[2][1] * s[5] + m[2][2] * s[4] - m[2][3] * s[3]);
+
+    inv.data[1][0] = (-m[1][0] * c[5] + m[1][2] * c[2] - m[1][3] * c[1]);
+    inv.data[1][1] = (m[0][0] * c[5] - m[0][2] * c[2] + m[0][3] * c[1]);
+    inv.data[1][2] = (-m[3][0] * s[5] + m[3][2] * s[2] - m[3][3] * s[1]);
+    inv.data[1][3] = (m[2][0] * s[5] - m[2][2] * s[2] + m[2][3] * s[1]);
+
+    inv.data[2][0] = (m[1][0] * c[4] - m[1][1] * c[2] + m[1][3] * c[0]);
+    inv.data[2][1] = (-m[0][0] * c[4] + m[0][1] * c[2] - m[0][3] * c[0]);
+    inv.data[2][2] = (m[3][0] * s[4] - m[3][1] * s[2] + m[3][3] * s[0]);
+    inv.data[2][3] = (-m[2][0] * s[4] + m[2][1] * s[2] - m[2][3] * s[0]);
+
+    inv.data[3][0] = (-m[1][0] * c[3] + m[1][1] * c[1] - m[1][2] * c[0]);
+    inv.data[3][1] = (m[0][0] * c[3] - m[0][1] * c[1] + m[0][2] * c[0]);
+    inv.data[3][2] = (-m[3][0] * s[3] + m[3][1] * s[1] - m[3][2] * s[0]);
+    inv.data[3][3] = (m[2][0] * s[3] - m[2][1] * s[1] + m[2][2] * s[0]);
+
+    using namespace SIMD;
+    const float4 scale = Splat(inv_det);
     for (int col = 0; col < 4; col++)
-        for (int row = 0; row < 4; row++)
-            matrix_inverse[col][row] = cofactor(row, col) / det;
+        Store(inv.data[col], Mul(Load(inv.data[col]), scale));
 
-    return matrix_inverse;
+    return inv;
+}
+
+// InverseAffine:
+// Inverse of an affine matrix [A t; 0 1], which is [A^-1, -A^-1 t; 0 1].
+// The rows of A^-1 are the cross products of the columns of A, divided by
+// its determinant.
+Matrix4 Matrix4::inverseAffine() const {
+    using namespace SIMD;
+
+    const float4 c0 = Load(data[0]);
+    const float4 c1 = Load(data[1]);
+    const float4 c2 = Load(data[2]);
+
+    float4 r0 = Cross3(c1, c2);
+    float4 r1 = Cross3(c2, c0);
+    float4 r2 = Cross3(c0, c1);
+
+    const float4 inv_det = Splat(1.f / Lane<0>(Dot3(c0, r0)));
+    r0 = Mul(r0, inv_det);
+    r1 = Mul(r1, inv_det);
+    r2 = Mul(r2, inv_det);
+
+    // Transpose the rows to columns. The w lane of every column is 0.
+    float4 r3 = Splat(0.f);
+    Transpose(r0, r1, r2, r3);
+
+    const float* t = data[3];
+    float4 translation = Mul(r0, Splat(t[0]));
+    translation = MulAdd(r1, Splat(t[1]), translation);
+    translation = MulAdd(r2, Splat(t[2]), translation);
+    translation = Sub(Set(0.f, 0.f, 0.f, 1.f), translation);
+
+    Matrix4 inv;
+    Store(inv.data[0], r0);
+    Store(inv.data[1], r1);
+    Store(inv.data[2], r2);
+    Store(inv.data[3], translation);
+    return inv;
 }
 
 // Trace:
@@ -91,49 +192,7 @@ float Matrix4::trace() const {
 // Takes and returns the determinant of the
 // matrix.
 float Matrix4::determinant() const {
-    float det = 0;
-
-    // Sum the cofactors of the first column
-    for (int row = 0; row < 4; row++)
-        det += data[0][row] * cofactor(0, row);
-
-    return det;
-}
-
-// Minor:
-// Returns the minor of the matrix for a
-// given row and col
-float Matrix4::minor(int col, int row) const {
-    // Create a 3x3 matrix by deleting the row
-    // and col of this matrix
-    Matrix3 matrix3;
-
-    // Counter to iterate through our 3x3 matrix
-    int index = 0;
-
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            // Only add entries to matrix whose row and
-            // col don't match
-            if (i != col && j != row) {
-                // Add to 3x3 matrix
-                matrix3[index / 3][index % 3] = data[i][j];
-
-                index++;
-            }
-        }
-    }
-
-    // The minor is the determinant of this matrix
-    return matrix3.determinant();
-}
-
-// Cofactor:
-// Returns the cofactor of the matrix for a
-// given row and col.
-float Matrix4::cofactor(int col, int row) const {
-    const int sign = (row + col) % 2 == 0 ? 1 : -1;
-    return sign * minor(col, row);
+    return DeterminantFrom(ComputeSubDeterminants(data));
 }
 
 /* --- Operands --- */
@@ -148,19 +207,27 @@ float* const Matrix4::operator[](int col) { return data[col]; }
 const float* const Matrix4::operator[](int col) const { return data[col]; }
 
 // Multiply (Matrix):
-// Multiplies two Matrix4's together
+// Multiplies two Matrix4's together. Each column of the result is a
+// combination of this matrix's columns, weighted by the other's column.
 Matrix4 Matrix4::operator*(const Matrix4& matrix) const {
-    Matrix4 new_matrix = Matrix4();
+    using namespace SIMD;
+
+    const float4 c0 = Load(data[0]);
+    const float4 c1 = Load(data[1]);
+    const float4 c2 = Load(data[2]);
+    const float4 c3 = Load(data[3]);
+
+    Matrix4 new_matrix;
 
     for (int col = 0; col < 4; col++) {
-        for (int row = 0; row < 4; row++) {
-            float value = 0;
+        const float* weights = matrix.data[col];
 
-            for (int i = 0; i < 4; i++)
-                value += data[i][row] * matrix[col][i];
+        float4 value = Mul(c0, Splat(weights[0]));
+        value = MulAdd(c1, Splat(weights[1]), value);
+        value = MulAdd(c2, Splat(weights[2]), value);
+        value = MulAdd(c3, Splat(weights[3]), value);
 
-            new_matrix[col][row] = value;
-        }
+        Store(new_matrix.data[col], value);
     }
 
     return new_matrix;
@@ -170,16 +237,24 @@ Matrix4 Matrix4::operator*(const Matrix4& matrix) const {
 // Multiplies a Matrix4 with a Vector4
 // and returns the result
 Vector4 Matrix4::operator*(const Vector4& vec) const {
-    const float x = data[0][0] * vec.x + data[1][0] * vec.y +
-                    data[2][0] * vec.z + data[3][0] * vec.w;
-    const float y = data[0][1] * vec.x + data[1][1] * vec.y +
-                    data[2][1] * vec.z + data[3][1] * vec.w;
-    const float z = data[0][2] * vec.x + data[1][2] * vec.y +
-                    data[2][2] * vec.z + data[3][2] * vec.w;
-    const float w = data[0][3] * vec.x + data[1][3] * vec.y +
-                    data[2][3] * vec.z + data[3][3] * vec.w;
-
-    return Vector4(x, y, z, w);
+    using namespace SIMD;
+
+    float4 value = Mul(Load(data[0]), Splat(vec.x));
+    value = MulAdd(Load(data[1]), Splat(vec.y), value);
+    value = MulAdd(Load(data[2]), Splat(vec.z), value);
+    value = MulAdd(Load(data[3]), Splat(vec.w), value);
+
+    float result[4];
+    Store(result, value);
+    return Vector4(result[0], result[1], result[2], result[3]);
+}
+
+// TransformPoints:
+// Transforms a batch of points by this matrix, treating them as having
+// w = 1. Forwards to the batch kernels in BatchMath.
+void Matrix4::transformPoints(const Vector3* points, Vector3* output,
+                              size_t count) const {
+    BatchTransformPoints(*this, points, output, count);
 }
 
 // Multiply (Scalar):
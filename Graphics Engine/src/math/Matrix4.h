@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 #include "Vector3.h"
 #include "Vector4.h"
 
@@ -33,6 +35,9 @@ class Matrix4 {
 
     Matrix4 transpose() const;
     Matrix4 inverse() const;
+    // Faster inverse for affine matrices (bottom row of 0, 0, 0, 1), such as
+    // those built from a Transform.
+    Matrix4 inverseAffine() const;
 
     float trace() const;
     float determinant() const;
@@ -43,6 +48,9 @@ class Matrix4 {
 
     Matrix4 operator*(const Matrix4&) const;
     Vector4 operator*(const Vector4&) const;
+    // Transforms a batch of points (w = 1). Output may alias the input.
+    void transformPoints(const Vector3* points, Vector3* output,
+                         size_t count) const;
     Matrix4 operator*(const float) const;
     Matrix4 operator/(const float) const;
     bool operator==(const Matrix4&) const;
@@ -52,10 +60,6 @@ class Matrix4 {
     static Matrix4 T_Rotate(const Vector3& axis, float theta);
     static Matrix4 T_Translate(const Vector3& position);
     static Matrix4 T_Translate(float x, float y, float z);
-
-  private:
-    float minor(int col, int row) const;
-    float cofactor(int col, int row) const;
 };
 
 } // Namespace Math
@@ -0,0 +1,223 @@
+#include "Noise.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "OpenSimplex2Noise.h"
+#include "PerlinNoise.h"
+#include "SimplexNoise.h"
+#include "ValueNoise.h"
+
+namespace Engine {
+namespace Math {
+Noise::~Noise() = default;
+
+std::unique_ptr<Noise> Noise::Create(NoiseType type, unsigned int seed) {
+    switch (type) {
+    case NoiseType::Perlin:
+        return std::make_unique<PerlinNoise>(seed);
+    case NoiseType::Simplex:
+        return std::make_unique<SimplexNoise>(seed);
+    case NoiseType::OpenSimplex2:
+        return std::make_unique<OpenSimplex2Noise>(seed);
+    case NoiseType::Value:
+        return std::make_unique<ValueNoise>(seed);
+    default:
+        assert(false);
+        return nullptr;
+    }
+}
+
+const char* Noise::TypeName(NoiseType type) {
+    switch (type) {
+    case NoiseType::Perlin:
+        return "Perlin";
+    case NoiseType::Simplex:
+        return "Simplex";
+    case NoiseType::OpenSimplex2:
+        return "OpenSimplex2";
+    case NoiseType::Value:
+        return "Value";
+    default:
+        return "Unknown";
+    }
+}
+
+// OctaveNoise2D:
+// Sums octaves of the noise, and normalizes the result back to [0,1]
+float Noise::octaveNoise2D(float x, float y, int octaves,
+                           float persistence) const {
+    float total = 0;
+    float maxValue = 0;
+
+    float frequency = 1;
+    float amplitude = 1;
+
+    for (int i = 0; i < octaves; i++) {
+        total += noise2D(x * frequency, y * frequency) * amplitude;
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        frequency *= 2;
+    }
+
+    return total / maxValue;
+}
+
+float Noise::octaveNoise3D(float x, float y, float z, int octaves,
+                           float persistence) const {
+    float total = 0;
+    float maxValue = 0;
+
+    float frequency = 1;
+    float amplitude = 1;
+
+    for (int i = 0; i < octaves; i++) {
+        total +=
+            noise3D(x * frequency, y * frequency, z * frequency) * amplitude;
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        frequency *= 2;
+    }
+
+    return total / maxValue;
+}
+
+void Noise::noise2D(const float* x, const float* y, float* output,
+                    size_t count) const {
+    for (size_t i = 0; i < count; i++)
+        output[i] = noise2D(x[i], y[i]);
+}
+
+void Noise::noise3D(const float* x, const float* y, const float* z,
+                    float* output, size_t count) const {
+    for (size_t i = 0; i < count; i++)
+        output[i] = noise3D(x[i], y[i], z[i]);
+}
+
+// Batch octave noise is done in blocks, so that each octave is one call to
+// the batch noise function and the scaled coordinates stay in the stack.
+static constexpr size_t OCTAVE_BLOCK_SIZE = 256;
+
+void Noise::octaveNoise2D(const float* x, const float* y, float* output,
+                          size_t count, int octaves, float persistence) const {
+    float block_x[OCTAVE_BLOCK_SIZE], block_y[OCTAVE_BLOCK_SIZE];
+    float values[OCTAVE_BLOCK_SIZE];
+
+    for (size_t start = 0; start < count; start += OCTAVE_BLOCK_SIZE) {
+        const size_t n = std::min(OCTAVE_BLOCK_SIZE, count - start);
+        float* total = output + start;
+        std::fill(total, total + n, 0.f);
+
+        float maxValue = 0;
+        float frequency = 1;
+        float amplitude = 1;
+
+        for (int octave = 0; octave < octaves; octave++) {
+            for (size_t i = 0; i < n; i++) {
+                block_x[i] = x[start + i] * frequency;
+                block_y[i] = y[start + i] * frequency;
+            }
+            noise2D(block_x, block_y, values, n);
+
+            for (size_t i = 0; i < n; i++)
+                total[i] += values[i] * amplitude;
+            maxValue += amplitude;
+
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            total[i] /= maxValue;
+    }
+}
+
+void Noise::octaveNoise3D(const float* x, const float* y, const float* z,
+                          float* output, size_t count, int octaves,
+                          float persistence) const {
+    float block_x[OCTAVE_BLOCK_SIZE], block_y[OCTAVE_BLOCK_SIZE],
+        block_z[OCTAVE_BLOCK_SIZE];
+    float values[OCTAVE_BLOCK_SIZE];
+
+    for (size_t start = 0; start < count; start += OCTAVE_BLOCK_SIZE) {
+        const size_t n = std::min(OCTAVE_BLOCK_SIZE, count - start);
+        float* total = output + start;
+        std::fill(total, total + n, 0.f);
+
+        float maxValue = 0;
+        float frequency = 1;
+        float amplitude = 1;
+
+        for (int octave = 0; octave < octaves; octave++) {
+            for (size_t i = 0; i < n; i++) {
+                block_x[i] = x[start + i] * frequency;
+                block_y[i] = y[start + i] * frequency;
+                block_z[i] = z[start + i] * frequency;
+            }
+            noise3D(block_x, block_y, block_z, values, n);
+
+            for (size_t i = 0; i < n; i++)
+                total[i] += values[i] * amplitude;
+            maxValue += amplitude;
+
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            total[i] /= maxValue;
+    }
+}
+
+// OctaveNoiseGrid2D:
+// Samples the grid one row (fixed x) at a time. Along a row, only y changes.
+void Noise::octaveNoiseGrid2D(float x0, float y0, float dx, float dy,
+                              int count_x, int count_y, int octaves,
+                              float persistence, float* output) const {
+    std::vector<float> xs(count_y);
+    std::vector<float> ys(count_y);
+    for (int j = 0; j < count_y; j++)
+        ys[j] = y0 + j * dy;
+
+    for (int i = 0; i < count_x; i++) {
+        std::fill(xs.begin(), xs.end(), x0 + i * dx);
+        octaveNoise2D(xs.data(), ys.data(), output + (size_t)i * count_y,
+                      count_y, octaves, persistence);
+    }
+}
+
+// GeneratePermutationTable:
+// Generates the permutation using the Fisher-Yates algorithm for generating
+// random permutations. The generator is local, so this doesn't touch any
+// global random state.
+void Noise::GeneratePermutationTable(unsigned int seed, unsigned char* table) {
+    std::mt19937 generator(seed);
+
+    // Initialize the table with entries 0, 1, ... 255.
+    for (int i = 0; i < 256; i++) {
+        table[i] = i;
+    }
+
+    // Randomly choose pairs (i,j), where i <= j <= n-1,
+    // and swap the values.
+    for (int i = 0; i < 255; i++) {
+        const int j = i + generator() % (256 - i);
+
+        const unsigned char temp = table[i];
+        table[i] = table[j];
+        table[j] = temp;
+    }
+
+    // Repeat the table, so lookups never need to wrap
+    for (int i = 0; i < 256; i++) {
+        table[i + 256] = table[i];
+    }
+}
+
+} // namespace Math
+} // namespace Engine
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <memory>
+
+namespace Engine {
+namespace Math {
+enum class NoiseType { Perlin, Simplex, OpenSimplex2, Value, Count };
+
+// Noise Class:
+// Common interface for the coherent noise generators, so that terrain and
+// texture generation can swap between them. Every generator returns values
+// in [0,1], and a given seed always produces the same noise.
+// Implementations must provide single sample noise2D / noise3D. The batch
+// functions default to looping over the single sample ones, and can be
+// overridden with faster versions.
+class Noise {
+  public:
+    virtual ~Noise();
+
+    // Create:
+    // Creates a generator of the given type.
+    static std::unique_ptr<Noise> Create(NoiseType type, unsigned int seed);
+    static const char* TypeName(NoiseType type);
+
+    virtual NoiseType type() const = 0;
+    virtual void seed(unsigned int seed) = 0;
+
+    virtual float noise2D(float x, float y) const = 0;
+    virtual float noise3D(float x, float y, float z) const = 0;
+
+    // Fractal noise, summing octaves of the noise with doubling frequency and
+    // amplitude scaled by persistence.
+    float octaveNoise2D(float x, float y, int octaves, float persistence) const;
+    float octaveNoise3D(float x, float y, float z, int octaves,
+                        float persistence) const;
+
+    // Batch Sampling:
+    // Sample the noise at count points, given as separate coordinate arrays.
+    virtual void noise2D(const float* x, const float* y, float* output,
+                         size_t count) const;
+    virtual void octaveNoise2D(const float* x, const float* y, float* output,
+                               size_t count, int octaves,
+                               float persistence) const;
+
+    virtual void noise3D(const float* x, const float* y, const float* z,
+                         float* output, size_t count) const;
+    virtual void octaveNoise3D(const float* x, const float* y, const float* z,
+                               float* output, size_t count, int octaves,
+                               float persistence) const;
+
+    // Samples a count_x by count_y grid of points, starting at (x0, y0) and
+    // spaced by (dx, dy). Output[i * count_y + j] is the sample at
+    // (x0 + i * dx, y0 + j * dy).
+    void octaveNoiseGrid2D(float x0, float y0, float dx, float dy, int count_x,
+                           int count_y, int octaves, float persistence,
+                           float* output) const;
+
+  protected:
+    // Fills table with a random permutation of 0, 1, ... 255 chosen by the
+    // seed, repeated twice (512 entries) so that lookups never need to wrap.
+    static void GeneratePermutationTable(unsigned int seed,
+                                         unsigned char* table);
+};
+
+} // namespace Math
+} // namespace Engine
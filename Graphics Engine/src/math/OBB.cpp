@@ -57,7 +57,7 @@ void OBB::fillArrWithPoints(Vector3* point_arr) const {
 // ExpandToContain:
 // Expand the OBB to contain the following point
 void OBB::expandToContain(const Vector3* points, int num_points) {
-    const Matrix4 m_inverse = m_local_to_world.inverse();
+    const Matrix4 m_inverse = m_local_to_world.inverseAffine();
 
     for (int i = 0; i < num_points; i++) {
         const Vector3 point_local = (m_inverse * Vector4(points[i], 1.f)).xyz();
@@ -67,7 +67,7 @@ void OBB::expandToContain(const Vector3* points, int num_points) {
 
 void OBB::expandToContain(const Vector3& point) {
     // Translate the point into the OBB's local space
-    const Matrix4 m_inverse = m_local_to_world.inverse();
+    const Matrix4 m_inverse = m_local_to_world.inverseAffine();
 
     const Vector3 point_local = (m_inverse * Vector4(point, 1.f)).xyz();
     aabb.expandToContain(point_local);
@@ -0,0 +1,225 @@
+#include "OpenSimplex2Noise.h"
+
+#include <math.h>
+
+#include "Compute.h"
+
+namespace Engine {
+namespace Math {
+// Primes used to hash lattice coordinates
+static constexpr uint32_t PRIME_X = 501125321u;
+static constexpr uint32_t PRIME_Y = 1136930381u;
+static constexpr uint32_t PRIME_Z = 1720413743u;
+
+// Gradients:
+// 2D uses 24 unit vectors, evenly spaced and rotated off the axes by 7.5
+// degrees. 3D uses the 12 vectors from the center of a cube to its edges,
+// with 4 repeated to pad the table to 16 entries.
+static constexpr float GRADIENTS_2D[24][2] = {
+    {0.99144486f, 0.13052619f},   {0.92387953f, 0.38268343f},
+    {0.79335334f, 0.60876143f},   {0.60876143f, 0.79335334f},
+    {0.38268343f, 0.92387953f},   {0.13052619f, 0.99144486f},
+    {-0.13052619f, 0.99144486f},  {-0.38268343f, 0.92387953f},
+    {-0.60876143f, 0.79335334f},  {-0.79335334f, 0.60876143f},
+    {-0.92387953f, 0.38268343f},  {-0.99144486f, 0.13052619f},
+    {-0.99144486f, -0.13052619f}, {-0.92387953f, -0.38268343f},
+    {-0.79335334f, -0.60876143f}, {-0.60876143f, -0.79335334f},
+    {-0.38268343f, -0.92387953f}, {-0.13052619f, -0.99144486f},
+    {0.13052619f, -0.99144486f},  {0.38268343f, -0.92387953f},
+    {0.60876143f, -0.79335334f},  {0.79335334f, -0.60876143f},
+    {0.92387953f, -0.38268343f},  {0.99144486f, -0.13052619f}};
+static constexpr float GRADIENTS_3D[16][3] = {
+    {1, 1, 0},  {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0}, {1, 0, 1},  {-1, 0, 1},
+    {1, 0, -1}, {-1, 0, -1}, {0, 1, 1}, {0, -1, 1},  {0, 1, -1}, {0, -1, -1},
+    {1, 1, 0},  {0, -1, 1}, {-1, 1, 0}, {0, -1, -1}};
+
+// Skewing factors between the triangle grid and the square grid
+static constexpr float SKEW_2D = 0.36602540378f;    // (sqrt(3) - 1) / 2
+static constexpr float UNSKEW_2D = -0.21132486540f; // (sqrt(3) - 3) / 6
+
+// Scales that bring the summed contributions to about [-1,1]
+static constexpr float NORMALIZER_2D = 99.83685446f;
+static constexpr float NORMALIZER_3D = 32.69428253f;
+
+static uint32_t Hash(uint32_t seed, uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t hash = (seed ^ x ^ y ^ z) * 0x27d4eb2du;
+    return hash ^ (hash >> 15);
+}
+
+// Corner2D / Corner3D:
+// The contribution of a lattice point (with pre-multiplied coordinates), to
+// a point at (dx,dy,dz) relative to it. The contribution falls off to 0 at a
+// radius of sqrt(0.5) in 2D, and sqrt(0.6) in 3D.
+static float Corner2D(uint32_t seed, uint32_t x, uint32_t y, float dx,
+                      float dy) {
+    float a = 0.5f - dx * dx - dy * dy;
+    if (a <= 0)
+        return 0;
+
+    a *= a;
+    const float* g = GRADIENTS_2D[Hash(seed, x, y, 0) % 24];
+    return a * a * (g[0] * dx + g[1] * dy);
+}
+
+static float Corner3D(uint32_t seed, uint32_t x, uint32_t y, uint32_t z,
+                      float falloff, float dx, float dy, float dz) {
+    falloff *= falloff;
+    const float* g = GRADIENTS_3D[Hash(seed, x, y, z) & 0xF];
+    return falloff * falloff * (g[0] * dx + g[1] * dy + g[2] * dz);
+}
+
+OpenSimplex2Noise::OpenSimplex2Noise() { seed(0); }
+OpenSimplex2Noise::OpenSimplex2Noise(unsigned int seed) { this->seed(seed); }
+
+NoiseType OpenSimplex2Noise::type() const { return NoiseType::OpenSimplex2; }
+
+void OpenSimplex2Noise::seed(unsigned int seed) { mSeed = seed; }
+
+// Noise2D:
+// Sums the contributions of the 3 corners of the triangle containing (x,y).
+float OpenSimplex2Noise::noise2D(float x, float y) const {
+    // Skew onto the square grid, and find the cell
+    const float s = (x + y) * SKEW_2D;
+    const float xs = x + s;
+    const float ys = y + s;
+
+    const float xs_floor = floorf(xs);
+    const float ys_floor = floorf(ys);
+    const float xi = xs - xs_floor;
+    const float yi = ys - ys_floor;
+
+    const uint32_t xp = (uint32_t)(int)xs_floor * PRIME_X;
+    const uint32_t yp = (uint32_t)(int)ys_floor * PRIME_Y;
+
+    // Unskew the offset within the cell
+    const float t = (xi + yi) * UNSKEW_2D;
+    const float dx0 = xi + t;
+    const float dy0 = yi + t;
+
+    float value = Corner2D(mSeed, xp, yp, dx0, dy0);
+
+    // Opposite corner of the cell
+    value += Corner2D(mSeed, xp + PRIME_X, yp + PRIME_Y,
+                      dx0 - (1 + 2 * UNSKEW_2D), dy0 - (1 + 2 * UNSKEW_2D));
+
+    // Middle corner, which depends on which triangle we are in
+    if (dy0 > dx0)
+        value += Corner2D(mSeed, xp, yp + PRIME_Y, dx0 - UNSKEW_2D,
+                          dy0 - (1 + UNSKEW_2D));
+    else
+        value += Corner2D(mSeed, xp + PRIME_X, yp, dx0 - (1 + UNSKEW_2D),
+                          dy0 - UNSKEW_2D);
+
+    return Clamp(value * NORMALIZER_2D * 0.5f + 0.5f, 0, 1);
+}
+
+// Noise3D:
+// The body-centered cubic lattice is 2 cubic grids, offset by half a cell.
+// For each grid, the closest point and the next closest point along the
+// dominant axis can be in range. The second grid's points are found from
+// the first's by reflecting the offsets.
+float OpenSimplex2Noise::noise3D(float x, float y, float z) const {
+    // Rotate so that the lattice's main diagonal points up the y axis
+    const float r = (x + y + z) * (2.f / 3.f);
+    const float xr = r - x;
+    const float yr = r - y;
+    const float zr = r - z;
+
+    const float x_round = floorf(xr + 0.5f);
+    const float y_round = floorf(yr + 0.5f);
+    const float z_round = floorf(zr + 0.5f);
+
+    // Offset from the closest point, and its absolute value
+    float x0 = xr - x_round;
+    float y0 = yr - y_round;
+    float z0 = zr - z_round;
+
+    // -1 if the offset is positive, 1 if it is negative
+    int x_sign = x0 > 0 ? -1 : 1;
+    int y_sign = y0 > 0 ? -1 : 1;
+    int z_sign = z0 > 0 ? -1 : 1;
+
+    float ax0 = fabsf(x0);
+    float ay0 = fabsf(y0);
+    float az0 = fabsf(z0);
+
+    uint32_t xp = (uint32_t)(int)x_round * PRIME_X;
+    uint32_t yp = (uint32_t)(int)y_round * PRIME_Y;
+    uint32_t zp = (uint32_t)(int)z_round * PRIME_Z;
+
+    uint32_t seed = mSeed;
+    float value = 0;
+    float a = 0.6f - x0 * x0 - y0 * y0 - z0 * z0;
+
+    for (int lattice = 0;; lattice++) {
+        // Closest point
+        if (a > 0)
+            value += Corner3D(seed, xp, yp, zp, a, x0, y0, z0);
+
+        // Next closest point, along the axis with the largest offset
+        if (ax0 >= ay0 && ax0 >= az0) {
+            const float b = a + ax0 + ax0 - 1;
+            if (b > 0)
+                value += Corner3D(seed, xp - x_sign * PRIME_X, yp, zp, b,
+                                  x0 + x_sign, y0, z0);
+        } else if (ay0 > ax0 && ay0 >= az0) {
+            const float b = a + ay0 + ay0 - 1;
+            if (b > 0)
+                value += Corner3D(seed, xp, yp - y_sign * PRIME_Y, zp, b, x0,
+                                  y0 + y_sign, z0);
+        } else {
+            const float b = a + az0 + az0 - 1;
+            if (b > 0)
+                value += Corner3D(seed, xp, yp, zp - z_sign * PRIME_Z, b, x0,
+                                  y0, z0 + z_sign);
+        }
+
+        if (lattice == 1)
+            break;
+
+        // Move to the closest point on the second grid, which is half a cell
+        // away on every axis, towards the sample point.
+        ax0 = 0.5f - ax0;
+        ay0 = 0.5f - ay0;
+        az0 = 0.5f - az0;
+
+        x0 = x_sign * ax0;
+        y0 = y_sign * ay0;
+        z0 = z_sign * az0;
+
+        a += (0.75f - ax0) - (ay0 + az0);
+
+        // The second grid's points are indexed by the first grid's point
+        // above them, with a different seed.
+        if (x_sign < 0)
+            xp += PRIME_X;
+        if (y_sign < 0)
+            yp += PRIME_Y;
+        if (z_sign < 0)
+            zp += PRIME_Z;
+
+        x_sign = -x_sign;
+        y_sign = -y_sign;
+        z_sign = -z_sign;
+
+        seed = ~seed;
+    }
+
+    return Clamp(value * NORMALIZER_3D * 0.5f + 0.5f, 0, 1);
+}
+
+void OpenSimplex2Noise::noise2D(const float* x, const float* y,
+                                float* output, size_t count) const {
+    for (size_t i = 0; i < count; i++)
+        output[i] = OpenSimplex2Noise::noise2D(x[i], y[i]);
+}
+
+void OpenSimplex2Noise::noise3D(const float* x, const float* y,
+                                const float* z, float* output,
+                                size_t count) const {
+    for (size_t i = 0; i < count; i++)
+        output[i] = OpenSimplex2Noise::noise3D(x[i], y[i], z[i]);
+}
+
+} // namespace Math
+} // namespace Engine
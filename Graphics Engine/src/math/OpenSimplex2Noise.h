@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Noise.h"
+
+namespace Engine {
+namespace Math {
+// OpenSimplex2Noise Class:
+// Simplex-style gradient noise with the lattice layout of OpenSimplex2.
+// In 2D it uses the simplex triangle grid with 24 gradient directions. In
+// 3D, instead of splitting cubes into tetrahedra, it samples the 4 nearest
+// points of a body-centered cubic lattice (2 offset cubic grids) in a
+// rotated space, which looks more uniform in every direction.
+// Corners are hashed from the seed and their coordinates, so no tables are
+// needed.
+// Adapted from K.jpg's OpenSimplex2 (https://github.com/KdotJPG/OpenSimplex2)
+class OpenSimplex2Noise final : public Noise {
+  private:
+    uint32_t mSeed;
+
+  public:
+    OpenSimplex2Noise();
+    OpenSimplex2Noise(unsigned int seed);
+
+    NoiseType type() const override;
+    void seed(unsigned int seed) override;
+
+    float noise2D(float x, float y) const override;
+    float noise3D(float x, float y, float z) const override;
+
+    void noise2D(const float* x, const float* y, float* output,
+                 size_t count) const override;
+    void noise3D(const float* x, const float* y, const float* z,
+                 float* output, size_t count) const override;
+};
+
+} // namespace Math
+} // namespace Engine
@@ -1,8 +1,9 @@
 #include "PerlinNoise.h"
 
-#include <cstdlib>
+#include <math.h>
 
 #include "Compute.h"
+#include "SIMD.h"
 
 namespace Engine {
 namespace Math {
@@ -13,141 +14,53 @@ namespace Math {
 // so things look smoother and aren't as jagged.
 static float fade(float t) { return (t * t * t) * (10 + t * (6 * t - 15)); }
 
-// Gradient Function:
-// Given a hash value, and a (x,y) coordinate, returns the result of the
-// gradient vector dotted with the direction vector (from (x,y) to the corner
-// where that gradient vector is).
+// Gradient Tables:
+// Given a hash value, the gradient vector at a corner of the grid is chosen
+// from these tables. The gradient is dotted with the direction vector (from
+// the corner to (x,y)) to get that corner's contribution.
+// For 2D, the last 3 bits of the hash choose between the vectors from the
+// center of the square to its edges and corners.
+static constexpr float kInvSqrt2 = 0.70710678f;
+static constexpr float GRADIENTS_2D[8][2] = {
+    {1, 0},   {0, 1},   {-1, 0}, {0, -1},
+    {-kInvSqrt2, -kInvSqrt2}, {-kInvSqrt2, kInvSqrt2},
+    {kInvSqrt2, kInvSqrt2},   {kInvSqrt2, -kInvSqrt2}};
+
+// For 3D, the last 4 bits of the hash choose between the 12 vectors from the
+// center of the cube to its edges. 4 of these are repeated to pad the table
+// to 16 entries.
+static constexpr float GRADIENTS_3D[16][3] = {
+    {1, 1, 0},  {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0}, {1, 0, 1},  {-1, 0, 1},
+    {1, 0, -1}, {-1, 0, -1}, {0, 1, 1}, {0, -1, 1},  {0, 1, -1}, {0, -1, -1},
+    {1, 1, 0},  {0, -1, 1}, {-1, 1, 0}, {0, -1, -1}};
+
 static float grad2D(int hash, float x, float y) {
-    constexpr float sqrt2 = 1.41421356f;
-
-    // The last 2 bits of the hash function determine what gradient vector to
-    // use. Gradient vectors are the vectors from the center of the square, to
-    // the edges. (1,0), (0,1), (-1,0), (0,-1) We automatically dot this with
-    // the vector (x,y), which represents the vector from some corner to (x,y).
-    switch (hash & 0x7) {
-    case 0x0: // (1,0)
-        return x;
-    case 0x1: // (0,1)
-        return y;
-    case 0x2: // (-1,0)
-        return -x;
-    case 0x3: // (0,-1)
-        return -y;
-    case 0x4: // (-1/sqrt(2), -1/sqrt(2))
-        return (-x - y) / sqrt2;
-    case 0x5: // (-1/sqrt(2), 1/sqrt(2))
-        return (-x + y) / sqrt2;
-    case 0x6: // (1/sqrt(2), 1/sqrt(2))
-        return (x + y) / sqrt2;
-    case 0x7: // (1/sqrt(2), -1/sqrt(2))
-        return (-x - y) / sqrt2;
-    default:
-        return 0;
-    }
+    const float* gradient = GRADIENTS_2D[hash & 0x7];
+    return gradient[0] * x + gradient[1] * y;
 }
 
 static float grad3D(int hash, float x, float y, float z) {
-    // The last 4 bits of the hash function determine what gradient vector to
-    // use. This is pseudorandomly chosen from the following list:
-    // (1,1,0), (-1,1,0), (1,-1,0), (-1,-1,0),
-    // (1, 0, 1), (-1, 0, 1), (1, 0, -1), (-1, 0, -1), (0, 1, 1), (0, -1, 1),
-    // (0, 1, -1), (0, -1, -1)
-    switch (hash & 0xF) {
-    case 0x0:
-        return x + y;
-    case 0x1:
-        return -x + y;
-    case 0x2:
-        return x - y;
-    case 0x3:
-        return -x - y;
-    case 0x4:
-        return x + z;
-    case 0x5:
-        return -x + z;
-    case 0x6:
-        return x - z;
-    case 0x7:
-        return -x - z;
-    case 0x8:
-        return y + z;
-    case 0x9:
-        return -y + z;
-    case 0xA:
-        return y - z;
-    case 0xB:
-        return -y - z;
-    case 0xC:
-        return y + x;
-    case 0xD:
-        return -y + z;
-    case 0xE:
-        return y - x;
-    case 0xF:
-        return -y - z;
-    default:
-        return 0; // never happens
-    }
-}
-
-// OctaveNoise2D;
-// Returns perlin noise, combined by amplitude to greate larger patterns.
-float PerlinNoise::octaveNoise2D(float x, float y, int octaves,
-                                 float persistence) const {
-    // We will sample perlin noise along multiple octaves, where along each
-    // we will increas the frequency and amplitude by a factor given by the
-    // persistence
-    float total = 0;
-    // MaxValue is used to normalize the result to [0,1]
-    float maxValue = 0;
-
-    float frequency = 1;
-    float amplitude = 1;
-
-    for (int i = 0; i < octaves; i++) {
-        total += noise2D(x * frequency, y * frequency) * amplitude;
-
-        maxValue += amplitude;
-
-        amplitude *= persistence;
-        frequency *= 2;
-    }
-
-    return total / maxValue;
+    const float* gradient = GRADIENTS_3D[hash & 0xF];
+    return gradient[0] * x + gradient[1] * y + gradient[2] * z;
 }
 
 PerlinNoise::PerlinNoise() { seedGenerator(0); }
 PerlinNoise::PerlinNoise(unsigned int seed) { seedGenerator(seed); }
 
 // SeedGenerator:
-// Generates the permutation table for the generator using the Fisher-Yates
-// algorithm for generating random permutations.
+// Generates the permutation table for the generator.
 void PerlinNoise::seedGenerator(unsigned int seed) {
-    // Seed my random number generator
-    srand(seed);
-
-    // Initialize my permutation table with entries 0, 1, ... 255.
-    for (int i = 0; i < 256; i++) {
-        permutation_table[i] = i;
-    }
-
-    // Randomly choose pairs (i,j), where i <= j <= n-1,
-    // and swap the values.
-    for (int i = 0; i < 254; i++) {
-        const int j = i + Random(0, 255 - i);
-
-        const unsigned int temp = permutation_table[i];
-        permutation_table[i] = permutation_table[j];
-        permutation_table[j] = temp;
-    }
+    GeneratePermutationTable(seed, permutation_table);
 }
 
 // IndexTable:
-// Given an index, indexes the permutation table. Applies modulus if needed.
+// Given an index in [0, 511], indexes the permutation table.
 unsigned char PerlinNoise::indexTable(int index) const {
-    return permutation_table[index % 256];
+    return permutation_table[index];
 }
 
+NoiseType PerlinNoise::type() const { return NoiseType::Perlin; }
+
 // Seed:
 // Seeds the generator.
 void PerlinNoise::seed(unsigned int seed) { seedGenerator(seed); }
@@ -157,24 +70,21 @@ void PerlinNoise::seed(unsigned int seed) { seedGenerator(seed); }
 // Multiply x,y with a "frequency" in [0,1] to sample the noise at larger or
 // smaller intervals. Frequencies between [0, 0.3] yield good results.
 float PerlinNoise::noise2D(float x, float y) const {
-    // If x or y is negative, wrap it to the positive numbers so our perlin
-    // noise properly wraps and repeats.
-    if (x < 0)
-        x = ((int)(-x / 256) + 1) * 256 + x;
-    if (y < 0)
-        y = ((int)(-y / 256) + 1) * 256 + y;
-
     // Cell index in the grid (centered at (0,0)). We use this, with our
     // permutation table, to generate a pseudonumber to determine our gradient
-    // vectors.
-    const int xi = ((int)x) & 0xFF;
-    const int yi = ((int)y) & 0xFF;
+    // vectors. Negative coordinates wrap, so the noise repeats every 256
+    // units.
+    const float x_floor = floorf(x);
+    const float y_floor = floorf(y);
+
+    const int xi = ((int)x_floor) & 0xFF;
+    const int yi = ((int)y_floor) & 0xFF;
 
     // Coordinates within our cell, faded for a smoother input.
     // This represents a coordinate within
     // our cell which we want to find the Perlin Noise for.
-    const float xf = Clamp(fade(x - (int)x), 0, 1);
-    const float yf = Clamp(fade(y - (int)y), 0, 1);
+    const float xf = Clamp(fade(x - x_floor), 0, 1);
+    const float yf = Clamp(fade(y - y_floor), 0, 1);
 
     // For my coordinates, randomly choose a number from [0, 255] using the
     // permutation table. This hash will determine the gradient vector
@@ -205,28 +115,23 @@ float PerlinNoise::noise2D(float x, float y) const {
 // Samples the perlin noise given x,y,z coordinates.
 // Generalizes the 2D case for 3D coordinates.
 float PerlinNoise::noise3D(float x, float y, float z) const {
-    // If x,y,z are negative, wrap it to the positive numbers so our perlin
-    // noise properly wraps and repeats.
-    if (x < 0)
-        x = ((int)(-x / 256) + 1) * 256 + x;
-    if (y < 0)
-        y = ((int)(-y / 256) + 1) * 256 + y;
-    if (z < 0)
-        z = ((int)(-z / 256) + 1) * 256 + z;
-
     // Cell index in the grid (centered at (0,0)). We use this, with our
     // permutation table, to generate a pseudonumber to determine our gradient
-    // vectors.
-    const int xi = ((int)x) & 0xFF;
-    const int yi = ((int)y) & 0xFF;
-    const int zi = ((int)z) & 0xFF;
+    // vectors. Negative coordinates wrap, as in the 2D case.
+    const float x_floor = floorf(x);
+    const float y_floor = floorf(y);
+    const float z_floor = floorf(z);
+
+    const int xi = ((int)x_floor) & 0xFF;
+    const int yi = ((int)y_floor) & 0xFF;
+    const int zi = ((int)z_floor) & 0xFF;
 
     // Coordinates within our cell, faded for a smoother input.
     // This represents a coordinate within
     // our cell which we want to find the Perlin Noise for.
-    const float xf = Clamp(fade(x - (int)x), 0, 1);
-    const float yf = Clamp(fade(y - (int)y), 0, 1);
-    const float zf = Clamp(fade(z - (int)z), 0, 1);
+    const float xf = Clamp(fade(x - x_floor), 0, 1);
+    const float yf = Clamp(fade(y - y_floor), 0, 1);
+    const float zf = Clamp(fade(z - z_floor), 0, 1);
 
     // For my coordinates, randomly choose a number from [0, 255] using the
     // permutation table. This hash will determine the gradient vector
@@ -270,29 +175,208 @@ float PerlinNoise::noise3D(float x, float y, float z) const {
     return (Lerp(y1, y2, zf) + 1) / 2;
 }
 
-float PerlinNoise::octaveNoise3D(float x, float y, float z, int octaves,
-                                 float persistence) const {
-    // We will sample perlin noise along multiple octaves, where along each
-    // we will increas the frequency and amplitude by a factor given by the
-    // persistence
-    float total = 0;
-    // MaxValue is used to normalize the result to [0,1]
-    float maxValue = 0;
+// --- Batch Sampling ---
+// The batch functions evaluate 4 samples at a time. Hashing and gradient
+// lookups are done per lane, as they index the permutation table. The fade,
+// gradient dot products, and interpolation are done for all lanes at once.
+using namespace SIMD;
+
+// Fade4:
+// Fades 4 values, clamped to [0,1] like the single sample functions.
+static float4 Fade4(float4 t) {
+    const float4 t3 = Mul(Mul(t, t), t);
+    const float4 inner =
+        MulAdd(t, MulAdd(Splat(6.f), t, Splat(-15.f)), Splat(10.f));
+    return Min(Max(Mul(t3, inner), Splat(0.f)), Splat(1.f));
+}
+
+static float4 Lerp4(float4 a, float4 b, float4 t) {
+    return MulAdd(Sub(b, a), t, a);
+}
 
-    float frequency = 1;
-    float amplitude = 1;
+// Noise2D4:
+// Evaluates noise2D at 4 points.
+static float4 Noise2D4(const unsigned char* table, float4 x, float4 y) {
+    const float4 x_floor = Floor(x);
+    const float4 y_floor = Floor(y);
+
+    float xs[4], ys[4];
+    Store(xs, x_floor);
+    Store(ys, y_floor);
+
+    // Gradient components for each corner (aa, ab, ba, bb), by lane
+    float gx[4][4], gy[4][4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        const int xi = ((int)xs[lane]) & 0xFF;
+        const int yi = ((int)ys[lane]) & 0xFF;
+
+        const int a = table[xi] + yi;
+        const int b = table[xi + 1] + yi;
+        const int hashes[4] = {table[a], table[a + 1], table[b],
+                               table[b + 1]};
+
+        for (int corner = 0; corner < 4; corner++) {
+            const float* gradient = GRADIENTS_2D[hashes[corner] & 0x7];
+            gx[corner][lane] = gradient[0];
+            gy[corner][lane] = gradient[1];
+        }
+    }
+
+    const float4 u = Fade4(Sub(x, x_floor));
+    const float4 v = Fade4(Sub(y, y_floor));
+    const float4 u1 = Sub(u, Splat(1.f));
+    const float4 v1 = Sub(v, Splat(1.f));
 
-    for (int i = 0; i < octaves; i++) {
-        total +=
-            noise3D(x * frequency, y * frequency, z * frequency) * amplitude;
+    const float4 grad_aa = MulAdd(Load(gx[0]), u, Mul(Load(gy[0]), v));
+    const float4 grad_ab = MulAdd(Load(gx[1]), u, Mul(Load(gy[1]), v1));
+    const float4 grad_ba = MulAdd(Load(gx[2]), u1, Mul(Load(gy[2]), v));
+    const float4 grad_bb = MulAdd(Load(gx[3]), u1, Mul(Load(gy[3]), v1));
 
-        maxValue += amplitude;
+    const float4 perlin_value =
+        Lerp4(Lerp4(grad_aa, grad_ab, v), Lerp4(grad_ba, grad_bb, v), u);
+    return MulAdd(perlin_value, Splat(0.5f), Splat(0.5f));
+}
 
-        amplitude *= persistence;
-        frequency *= 2;
+// Noise3D4:
+// Evaluates noise3D at 4 points.
+static float4 Noise3D4(const unsigned char* table, float4 x, float4 y,
+                       float4 z) {
+    const float4 x_floor = Floor(x);
+    const float4 y_floor = Floor(y);
+    const float4 z_floor = Floor(z);
+
+    float xs[4], ys[4], zs[4];
+    Store(xs, x_floor);
+    Store(ys, y_floor);
+    Store(zs, z_floor);
+
+    // Faded coordinates within the cell
+    float us[4], vs[4], ws[4];
+    Store(us, Fade4(Sub(x, x_floor)));
+    Store(vs, Fade4(Sub(y, y_floor)));
+    Store(ws, Fade4(Sub(z, z_floor)));
+
+    // Gradient contribution of each corner (aaa, aab, ..., bbb), by lane.
+    // Corner c is offset by (c & 4, c & 2, c & 1) from the cell's origin.
+    float grads[8][4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        const int xi = ((int)xs[lane]) & 0xFF;
+        const int yi = ((int)ys[lane]) & 0xFF;
+        const int zi = ((int)zs[lane]) & 0xFF;
+
+        const int a = table[xi] + yi;
+        const int b = table[xi + 1] + yi;
+        const int aa = table[a] + zi;
+        const int ab = table[a + 1] + zi;
+        const int ba = table[b] + zi;
+        const int bb = table[b + 1] + zi;
+        const int hashes[8] = {table[aa], table[aa + 1], table[ab],
+                               table[ab + 1], table[ba], table[ba + 1],
+                               table[bb], table[bb + 1]};
+
+        for (int corner = 0; corner < 8; corner++) {
+            const float dx = (corner & 4) ? us[lane] - 1 : us[lane];
+            const float dy = (corner & 2) ? vs[lane] - 1 : vs[lane];
+            const float dz = (corner & 1) ? ws[lane] - 1 : ws[lane];
+            grads[corner][lane] = grad3D(hashes[corner], dx, dy, dz);
+        }
     }
 
-    return total / maxValue;
+    const float4 u = Load(us);
+    const float4 v = Load(vs);
+    const float4 w = Load(ws);
+
+    const float4 y1 = Lerp4(Lerp4(Load(grads[0]), Load(grads[4]), u),
+                            Lerp4(Load(grads[2]), Load(grads[6]), u), v);
+    const float4 y2 = Lerp4(Lerp4(Load(grads[1]), Load(grads[5]), u),
+                            Lerp4(Load(grads[3]), Load(grads[7]), u), v);
+
+    return MulAdd(Lerp4(y1, y2, w), Splat(0.5f), Splat(0.5f));
+}
+
+void PerlinNoise::noise2D(const float* x, const float* y, float* output,
+                          size_t count) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 value = Noise2D4(permutation_table, LoadPartial(x + i, n),
+                                      LoadPartial(y + i, n));
+        StorePartial(output + i, value, n);
+    }
+}
+
+void PerlinNoise::octaveNoise2D(const float* x, const float* y,
+                                float* output, size_t count, int octaves,
+                                float persistence) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 px = LoadPartial(x + i, n);
+        const float4 py = LoadPartial(y + i, n);
+
+        // Same accumulation as the single sample octaveNoise2D
+        float4 total = Splat(0.f);
+        float maxValue = 0;
+
+        float frequency = 1;
+        float amplitude = 1;
+
+        for (int octave = 0; octave < octaves; octave++) {
+            const float4 f = Splat(frequency);
+            const float4 value =
+                Noise2D4(permutation_table, Mul(px, f), Mul(py, f));
+            total = MulAdd(value, Splat(amplitude), total);
+
+            maxValue += amplitude;
+
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+
+        StorePartial(output + i, Div(total, Splat(maxValue)), n);
+    }
+}
+
+void PerlinNoise::noise3D(const float* x, const float* y, const float* z,
+                          float* output, size_t count) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 value =
+            Noise3D4(permutation_table, LoadPartial(x + i, n),
+                     LoadPartial(y + i, n), LoadPartial(z + i, n));
+        StorePartial(output + i, value, n);
+    }
+}
+
+void PerlinNoise::octaveNoise3D(const float* x, const float* y,
+                                const float* z, float* output, size_t count,
+                                int octaves, float persistence) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 px = LoadPartial(x + i, n);
+        const float4 py = LoadPartial(y + i, n);
+        const float4 pz = LoadPartial(z + i, n);
+
+        float4 total = Splat(0.f);
+        float maxValue = 0;
+
+        float frequency = 1;
+        float amplitude = 1;
+
+        for (int octave = 0; octave < octaves; octave++) {
+            const float4 f = Splat(frequency);
+            const float4 value = Noise3D4(permutation_table, Mul(px, f),
+                                          Mul(py, f), Mul(pz, f));
+            total = MulAdd(value, Splat(amplitude), total);
+
+            maxValue += amplitude;
+
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+
+        StorePartial(output + i, Div(total, Splat(maxValue)), n);
+    }
 }
 
 const unsigned char* PerlinNoise::getPermutationTable() {
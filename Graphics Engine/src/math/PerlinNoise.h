@@ -1,5 +1,9 @@
 #pragma once
 
+#include <stddef.h>
+
+#include "Noise.h"
+
 namespace Engine {
 namespace Math {
 
@@ -7,23 +11,43 @@ namespace Math {
 // Contains methods for generating Perlin Noise.
 // Can be used to sample perlin noise. Uses a seed to randomly generate a
 // permutation table, which will define the shape of the noise.
+// All state is held by the instance, so separate generators can be used from
+// separate threads, and a given seed always produces the same noise.
 // Adapted from https://adrianb.io/2014/08/09/perlinnoise.html
-class PerlinNoise {
+class PerlinNoise final : public Noise {
   private:
-    // The permutation table defines the "seed" for the PerlinNoise.
-    unsigned char permutation_table[256];
+    // The permutation table defines the "seed" for the PerlinNoise. It is
+    // stored twice in a row, so that indexing it with (value + offset) never
+    // needs to wrap.
+    unsigned char permutation_table[512];
 
   public:
     PerlinNoise();
     PerlinNoise(unsigned int seed);
 
-    void seed(unsigned int seed);
+    NoiseType type() const override;
+    void seed(unsigned int seed) override;
+
+    using Noise::octaveNoise2D;
+    using Noise::octaveNoise3D;
+
+    float noise2D(float x, float y) const override;
+    float noise3D(float x, float y, float z) const override;
 
-    float noise2D(float x, float y) const;
-    float octaveNoise2D(float x, float y, int octaves, float persistence) const;
+    // Batch Sampling:
+    // Samples are evaluated 4 at a time with SIMD, and match the single
+    // sample functions above.
+    void noise2D(const float* x, const float* y, float* output,
+                 size_t count) const override;
+    void octaveNoise2D(const float* x, const float* y, float* output,
+                       size_t count, int octaves,
+                       float persistence) const override;
 
-    float noise3D(float x, float y, float z) const;
-    float octaveNoise3D(float x, float y, float z, int octaves, float persistence) const;
+    void noise3D(const float* x, const float* y, const float* z,
+                 float* output, size_t count) const override;
+    void octaveNoise3D(const float* x, const float* y, const float* z,
+                       float* output, size_t count, int octaves,
+                       float persistence) const override;
 
     const unsigned char* getPermutationTable();
   private:
@@ -32,4 +56,4 @@ class PerlinNoise {
 };
 
 } // namespace Math
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -19,6 +19,9 @@ Plane::Plane(const Vector3& _normal, float _distance) {
 }
 Plane::~Plane() = default;
 
+const Vector3& Plane::getNormal() const { return normal; }
+float Plane::getDistance() const { return distance; }
+
 float Plane::distanceTo(const Vector3& point) {
     return std::abs(distanceToSigned(point));
 }
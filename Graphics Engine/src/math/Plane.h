@@ -17,6 +17,9 @@ class Plane {
     Plane(const Vector3& normal, float distance);
     ~Plane();
 
+    const Vector3& getNormal() const;
+    float getDistance() const;
+
     float distanceTo(const Vector3& point);
     float distanceToSigned(const Vector3& point);
 };
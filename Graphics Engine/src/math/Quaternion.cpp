@@ -3,6 +3,7 @@
 #include <math.h>
 
 #include "Compute.h"
+#include "SIMD.h"
 
 namespace Engine {
 namespace Math {
@@ -37,17 +38,43 @@ Quaternion Quaternion::conjugate() const {
 
 // RotationMatrix:
 // Generates the rotation matrix for this quaternion. Assumes this quaternion
-// is a unit quaternion
+// is a unit quaternion.
+// Each column is of the form e_i + 2 * (a * s_a + b * s_b), where a and b are
+// lane-wise products of the quaternion's components, and s_a, s_b are signs.
+// The last lane of every sign is 0, so that the column's w is 0.
 Matrix4 Quaternion::rotationMatrix4() const {
-    const Vector3 qv = im;
-    const float qw = r;
-
-    const Matrix4 rotation_matrix = Matrix4(
-        1 - 2 * (qv.y * qv.y + qv.z * qv.z), 2 * (qv.x * qv.y - qw * qv.z),
-        2 * (qv.x * qv.z + qw * qv.y), 0.f, 2 * (qv.x * qv.y + qw * qv.z),
-        1 - 2 * (qv.x * qv.x + qv.z * qv.z), 2 * (qv.y * qv.z - qw * qv.x), 0.f,
-        2 * (qv.x * qv.z - qw * qv.y), 2 * (qv.y * qv.z + qw * qv.x),
-        1 - 2 * (qv.x * qv.x + qv.y * qv.y), 0.f, 0.f, 0.f, 0.f, 1.f);
+    using namespace SIMD;
+
+    const float4 q = Set(im.x, im.y, im.z, r); // (x, y, z, w)
+    const float4 two = Splat(2.f);
+
+    // Column 0: (1 - 2(yy + zz), 2(xy + wz), 2(xz - wy), 0)
+    const float4 a0 = Mul(Shuffle<1, 0, 0, 3>(q), Shuffle<1, 1, 2, 3>(q));
+    const float4 b0 = Mul(Shuffle<2, 3, 3, 3>(q), Shuffle<2, 2, 1, 3>(q));
+    const float4 sum0 = MulAdd(a0, Set(-1.f, 1.f, 1.f, 0.f),
+                               Mul(b0, Set(-1.f, 1.f, -1.f, 0.f)));
+    const float4 col0 = MulAdd(sum0, two, Set(1.f, 0.f, 0.f, 0.f));
+
+    // Column 1: (2(xy - wz), 1 - 2(xx + zz), 2(yz + wx), 0)
+    const float4 a1 = Mul(Shuffle<0, 0, 1, 3>(q), Shuffle<1, 0, 2, 3>(q));
+    const float4 b1 = Mul(Shuffle<3, 2, 3, 3>(q), Shuffle<2, 2, 0, 3>(q));
+    const float4 sum1 = MulAdd(a1, Set(1.f, -1.f, 1.f, 0.f),
+                               Mul(b1, Set(-1.f, -1.f, 1.f, 0.f)));
+    const float4 col1 = MulAdd(sum1, two, Set(0.f, 1.f, 0.f, 0.f));
+
+    // Column 2: (2(xz + wy), 2(yz - wx), 1 - 2(xx + yy), 0)
+    const float4 a2 = Mul(Shuffle<0, 1, 0, 3>(q), Shuffle<2, 2, 0, 3>(q));
+    const float4 b2 = Mul(Shuffle<3, 3, 1, 3>(q), Shuffle<1, 0, 1, 3>(q));
+    const float4 sum2 = MulAdd(a2, Set(1.f, 1.f, -1.f, 0.f),
+                               Mul(b2, Set(1.f, -1.f, -1.f, 0.f)));
+    const float4 col2 = MulAdd(sum2, two, Set(0.f, 0.f, 1.f, 0.f));
+
+    Matrix4 rotation_matrix;
+    float(*data)[4] = rotation_matrix.getRawData();
+    Store(data[0], col0);
+    Store(data[1], col1);
+    Store(data[2], col2);
+    Store(data[3], Set(0.f, 0.f, 0.f, 1.f));
 
     return rotation_matrix;
 }
@@ -1,9 +1,14 @@
 #include "QuickHull.h"
 
 #include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include <algorithm>
 #include <unordered_map>
 
 #include "Plane.h"
+#include "core/ThreadPool.h"
 
 namespace Engine {
 namespace Math {
@@ -193,7 +198,7 @@ void QuickHullSolver::computeConvexHull(
         else {
             // Otherwise, first find the horizon edge from the point.
             solver_data->horizon_edge.clear();
-            for (int i = 0; i < solver_data->faces.size(); i++)
+            for (size_t i = 0; i < solver_data->faces.size(); i++)
                 solver_data->faces[i].traversal_flag = false;
 
             findHorizonEdge(furthest_point,
@@ -531,5 +536,562 @@ void QuickHullSolver::findHorizonEdge(int point, int face, int prev_face) {
     }
 }
 
+// Points are assigned to the initial hull's faces in blocks of this many
+static constexpr size_t PARTITION_BLOCK_SIZE = 4096;
+
+// FaceNormal:
+// Computes the (unnormalized) normal of a face in double, wound the same way
+// as QuickHullSolver's faces.
+static void FaceNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2,
+                       double normal[3]) {
+    const double u[3] = {double(p2.x) - p0.x, double(p2.y) - p0.y,
+                         double(p2.z) - p0.z};
+    const double v[3] = {double(p1.x) - p0.x, double(p1.y) - p0.y,
+                         double(p1.z) - p0.z};
+
+    normal[0] = u[1] * v[2] - u[2] * v[1];
+    normal[1] = u[2] * v[0] - u[0] * v[2];
+    normal[2] = u[0] * v[1] - u[1] * v[0];
+}
+
+// Constructor / Destructor:
+// Create an instance of a QuickHullBuilder. Its storage grows as it is used.
+QuickHullBuilder::QuickHullBuilder() {
+    points = nullptr;
+    num_points = 0;
+    epsilon = 0.f;
+    visit_epoch = 0;
+}
+QuickHullBuilder::~QuickHullBuilder() = default;
+
+// Build:
+// Builds the hull of a point set. Starting from a tetrahedron of the input's
+// extreme points, the point furthest outside some face is repeatedly made a
+// vertex of the hull, until no points are left outside of it (or the hull
+// has as many vertices as allowed).
+bool QuickHullBuilder::build(const std::vector<Vector3>& point_cloud,
+                             const Config& config) {
+    return build(point_cloud.data(), point_cloud.size(), config);
+}
+
+bool QuickHullBuilder::build(const Vector3* point_cloud, size_t count,
+                             const Config& config) {
+    points = point_cloud;
+    num_points = count;
+
+    // Clearing keeps the storage of the last build
+    faces.clear();
+    free_faces.clear();
+    pending_faces.clear();
+    vertices.clear();
+    indices.clear();
+    conflict_next.assign(count, -1);
+    point_map.assign(count, -1);
+
+    bool success = count >= 4 && buildInitialHull();
+
+    if (success) {
+        partitionPoints(config);
+
+        // Each vertex added can remove others, but never adds more than one,
+        // so counting additions gives an upper bound.
+        const bool simplify = config.max_vertices > 0;
+        int num_vertices = 4;
+
+        while (!simplify || num_vertices < config.max_vertices) {
+            const int eye_face = nextEyeFace(simplify);
+            if (eye_face == -1)
+                break;
+
+            addVertex(eye_face);
+            num_vertices++;
+        }
+
+        success = isConvex();
+        if (success)
+            writeOutput();
+    }
+
+    points = nullptr;
+    num_points = 0;
+
+    return success;
+}
+
+const std::vector<Vector3>& QuickHullBuilder::getVertices() const {
+    return vertices;
+}
+const std::vector<UINT>& QuickHullBuilder::getIndices() const {
+    return indices;
+}
+
+// GetHull:
+// Creates an instance of a convex hull from the last build.
+ConvexHull* QuickHullBuilder::getHull() const {
+    ConvexHull* hull = new ConvexHull();
+    hull->vertices = vertices;
+    hull->indices = indices;
+    return hull;
+}
+
+// BuildInitialHull:
+// Builds a tetrahedron from the extreme points of the input. The first edge
+// joins the extremes of the axis the points spread furthest along, and the
+// remaining vertices are the points furthest from that edge, then from the
+// resulting triangle. Also sets the tolerance from the size of the input.
+bool QuickHullBuilder::buildInitialHull() {
+    int minimum[3] = {0, 0, 0};
+    int maximum[3] = {0, 0, 0};
+    Vector3 scale = Vector3(0, 0, 0);
+
+    for (size_t i = 0; i < num_points; i++) {
+        const Vector3& point = points[i];
+
+        for (int axis = 0; axis < 3; axis++) {
+            if (point[axis] < points[minimum[axis]][axis])
+                minimum[axis] = int(i);
+            if (point[axis] > points[maximum[axis]][axis])
+                maximum[axis] = int(i);
+            scale[axis] = std::max(scale[axis], fabsf(point[axis]));
+        }
+    }
+
+    // Float error in a distance grows with the magnitude of the coordinates
+    epsilon = 3.f * FLT_EPSILON * (scale.x + scale.y + scale.z);
+
+    int axis = 0;
+    float extent = -1.f;
+    for (int i = 0; i < 3; i++) {
+        const float axis_extent =
+            points[maximum[i]][i] - points[minimum[i]][i];
+        if (axis_extent > extent) {
+            axis = i;
+            extent = axis_extent;
+        }
+    }
+
+    if (extent <= epsilon)
+        return false;
+
+    const int a = minimum[axis];
+    int b = maximum[axis];
+
+    // Find the point furthest from the line a --> b
+    const Vector3& a_pos = points[a];
+    const Vector3 line_direction = (points[b] - a_pos).unit();
+
+    int c = -1;
+    float furthest_distance = epsilon;
+
+    for (size_t i = 0; i < num_points; i++) {
+        const Vector3 direction = points[i] - a_pos;
+        const float distance =
+            (direction - line_direction * direction.dot(line_direction))
+                .magnitude();
+
+        if (distance > furthest_distance) {
+            c = int(i);
+            furthest_distance = distance;
+        }
+    }
+
+    if (c == -1)
+        return false;
+
+    // Find the point furthest from the plane a --> b --> c
+    const Vector3 normal = (points[c] - a_pos).cross(points[b] - a_pos).unit();
+
+    int d = -1;
+    float furthest_signed = 0.f;
+    furthest_distance = epsilon;
+
+    for (size_t i = 0; i < num_points; i++) {
+        const float distance = (points[i] - a_pos).dot(normal);
+
+        if (fabsf(distance) > furthest_distance) {
+            d = int(i);
+            furthest_signed = distance;
+            furthest_distance = fabsf(distance);
+        }
+    }
+
+    if (d == -1)
+        return false;
+
+    // Wind the base so that d is behind it, and join each of its edges to d.
+    // Faces that share an edge wind it in opposite directions.
+    if (furthest_signed > 0)
+        std::swap(b, c);
+
+    const int initial[4] = {addFace(a, b, c), addFace(b, a, d),
+                            addFace(c, b, d), addFace(a, c, d)};
+
+    for (int f : initial) {
+        Face& face = faces[f];
+
+        for (int g : initial) {
+            if (f == g)
+                continue;
+            const Face& other = faces[g];
+
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    if (face.vertices[i] == other.vertices[(j + 1) % 3] &&
+                        face.vertices[(i + 1) % 3] == other.vertices[j])
+                        face.neighbors[i] = g;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// PartitionPoints:
+// Assigns every point to the face of the initial hull it is furthest outside
+// of. Points inside of every face can never be on the hull, and are dropped.
+// Large inputs are assigned in parallel, but the lists are built in order,
+// so the hull does not depend on how the work was split.
+void QuickHullBuilder::partitionPoints(const Config& config) {
+    point_face.resize(num_points);
+    point_distance.resize(num_points);
+
+    const auto assign = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            int best_face = -1;
+            float best_distance = epsilon;
+
+            for (int f = 0; f < 4; f++) {
+                const float distance = distanceTo(faces[f], int(i));
+                if (distance > best_distance) {
+                    best_face = f;
+                    best_distance = distance;
+                }
+            }
+
+            point_face[i] = best_face;
+            point_distance[i] = best_distance;
+        }
+    };
+
+    if (num_points >= config.parallel_threshold) {
+        const size_t num_blocks =
+            (num_points + PARTITION_BLOCK_SIZE - 1) / PARTITION_BLOCK_SIZE;
+
+        ParallelFor(num_blocks, [&](size_t block) {
+            const size_t begin = block * PARTITION_BLOCK_SIZE;
+            assign(begin, std::min(begin + PARTITION_BLOCK_SIZE, num_points));
+        });
+    } else
+        assign(0, num_points);
+
+    for (size_t i = 0; i < num_points; i++) {
+        if (point_face[i] != -1)
+            addConflict(point_face[i], int(i), point_distance[i]);
+    }
+}
+
+// NextEyeFace:
+// Returns the face whose furthest point should be added to the hull next,
+// or -1 if there are no points outside of the hull. When simplifying, this
+// is the face with the furthest point overall. Otherwise, any face with
+// points will do, which saves searching all of them.
+int QuickHullBuilder::nextEyeFace(bool furthest_first) {
+    if (furthest_first) {
+        int eye_face = -1;
+        float furthest_distance = 0.f;
+
+        for (size_t i = 0; i < faces.size(); i++) {
+            const Face& face = faces[i];
+            if (face.alive && face.conflict_head != -1 &&
+                face.furthest_distance > furthest_distance) {
+                eye_face = int(i);
+                furthest_distance = face.furthest_distance;
+            }
+        }
+
+        return eye_face;
+    }
+
+    // Faces are queued when they are given their first point, and may have
+    // been removed (or reused) since
+    while (!pending_faces.empty()) {
+        const int index = pending_faces.back();
+        if (faces[index].alive && faces[index].conflict_head != -1)
+            return index;
+        pending_faces.pop_back();
+    }
+
+    return -1;
+}
+
+// AddVertex:
+// Makes a face's furthest point (the eye) a vertex of the hull. The faces
+// the eye can see are replaced by a cone of new faces, joining the horizon
+// to the eye, and their points are given to the new faces.
+void QuickHullBuilder::addVertex(int eye_face) {
+    const int eye = faces[eye_face].furthest;
+    findHorizon(eye, eye_face);
+
+    // Each new face starts with its horizon edge, wound as the visible face
+    // wound it, and ends with the eye.
+    new_faces.clear();
+
+    for (const HorizonEdge& edge : horizon) {
+        const int index = addFace(edge.point_1, edge.point_2, eye);
+        faces[index].neighbors[0] = edge.nonvisible_face;
+
+        Face& nonvisible_face = faces[edge.nonvisible_face];
+        for (int i = 0; i < 3; i++) {
+            if (nonvisible_face.vertices[i] == edge.point_2 &&
+                nonvisible_face.vertices[(i + 1) % 3] == edge.point_1)
+                nonvisible_face.neighbors[i] = index;
+        }
+
+        point_map[edge.point_1] = index;
+        new_faces.push_back(index);
+    }
+
+    // The horizon is a loop, so the face after a new face is the one that
+    // starts where its horizon edge ends
+    for (int index : new_faces) {
+        Face& face = faces[index];
+        const int next = point_map[face.vertices[1]];
+        assert(next != -1);
+
+        face.neighbors[1] = next;
+        faces[next].neighbors[2] = index;
+    }
+
+    for (const HorizonEdge& edge : horizon)
+        point_map[edge.point_1] = -1;
+
+    // Give the visible faces' points to the first new face they are outside
+    // of, and free the visible faces. They are freed last, so that none of
+    // the new faces reuse them.
+    for (int index : visible) {
+        Face& face = faces[index];
+
+        int point = face.conflict_head;
+        while (point != -1) {
+            const int next_point = conflict_next[point];
+
+            if (point != eye) {
+                int best_face = -1;
+                float best_distance = epsilon;
+
+                for (int new_face : new_faces) {
+                    const float distance = distanceTo(faces[new_face], point);
+                    if (distance > best_distance) {
+                        best_face = new_face;
+                        best_distance = distance;
+                        break;
+                    }
+                }
+
+                if (best_face != -1)
+                    addConflict(best_face, point, best_distance);
+            }
+
+            point = next_point;
+        }
+
+        face.alive = false;
+        face.conflict_head = -1;
+        free_faces.push_back(index);
+    }
+}
+
+// FindHorizon:
+// Finds the faces the eye can see, by searching outwards from a face that
+// it is known to see, and the edges between them and the faces it can't.
+void QuickHullBuilder::findHorizon(int eye, int start_face) {
+    visible.clear();
+    horizon.clear();
+    stack.clear();
+
+    visit_epoch++;
+    faces[start_face].visited = visit_epoch;
+    stack.push_back(start_face);
+
+    while (!stack.empty()) {
+        const int index = stack.back();
+        stack.pop_back();
+        visible.push_back(index);
+
+        const Face& face = faces[index];
+
+        for (int i = 0; i < 3; i++) {
+            const int neighbor = face.neighbors[i];
+            Face& other = faces[neighbor];
+
+            if (other.visited == visit_epoch)
+                continue;
+
+            if (isAbove(other, eye)) {
+                other.visited = visit_epoch;
+                stack.push_back(neighbor);
+            } else {
+                HorizonEdge edge;
+                edge.point_1 = face.vertices[i];
+                edge.point_2 = face.vertices[(i + 1) % 3];
+                edge.visible_face = index;
+                edge.nonvisible_face = neighbor;
+                horizon.push_back(edge);
+            }
+        }
+    }
+}
+
+// AddFace:
+// Adds a face with no neighbors or points, reusing a freed face if there is
+// one.
+int QuickHullBuilder::addFace(int v0, int v1, int v2) {
+    int index;
+    if (!free_faces.empty()) {
+        index = free_faces.back();
+        free_faces.pop_back();
+    } else {
+        index = int(faces.size());
+        faces.emplace_back();
+    }
+
+    Face& face = faces[index];
+    face.vertices[0] = v0;
+    face.vertices[1] = v1;
+    face.vertices[2] = v2;
+    face.neighbors[0] = face.neighbors[1] = face.neighbors[2] = -1;
+
+    // Same winding as QuickHullSolver
+    double normal[3];
+    FaceNormal(points[v0], points[v1], points[v2], normal);
+    const double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] +
+                               normal[2] * normal[2]);
+    face.normal = Vector3(0, 0, 0);
+    if (length > 0.0)
+        face.normal = Vector3(float(normal[0] / length),
+                              float(normal[1] / length),
+                              float(normal[2] / length));
+
+    face.conflict_head = -1;
+    face.furthest = -1;
+    face.furthest_distance = 0.f;
+    face.alive = true;
+    face.visited = 0;
+
+    return index;
+}
+
+// AddConflict:
+// Adds a point to the list of points outside of a face.
+void QuickHullBuilder::addConflict(int face_index, int point, float distance) {
+    Face& face = faces[face_index];
+
+    if (face.conflict_head == -1)
+        pending_faces.push_back(face_index);
+
+    conflict_next[point] = face.conflict_head;
+    face.conflict_head = point;
+
+    if (distance > face.furthest_distance) {
+        face.furthest = point;
+        face.furthest_distance = distance;
+    }
+}
+
+// IsAbove:
+// Returns true if a point is above the plane of a face, with no tolerance
+// beyond the rounding error of double. This is close to exact for float
+// inputs, so the faces a new vertex removes are exactly the ones it can
+// see. With a tolerance, a point could see a face but not its neighbor
+// across a nearly flat edge, and the new face from that edge would fold
+// over the neighbor.
+bool QuickHullBuilder::isAbove(const Face& face, int point) const {
+    // Only points within the tolerance of the plane need the exact test
+    const float distance = distanceTo(face, point);
+    if (fabsf(distance) > epsilon)
+        return distance > 0.f;
+
+    const Vector3& p0 = points[face.vertices[0]];
+    const Vector3& p1 = points[face.vertices[1]];
+    const Vector3& p2 = points[face.vertices[2]];
+    const Vector3& p = points[point];
+
+    double normal[3];
+    FaceNormal(p0, p1, p2, normal);
+
+    const double d[3] = {double(p.x) - p0.x, double(p.y) - p0.y,
+                         double(p.z) - p0.z};
+    const double above = d[0] * normal[0] + d[1] * normal[1] + d[2] * normal[2];
+
+    // The differences are exact in double, but the products and sums
+    // round. Anything within their error bound counts as on the plane.
+    const double u[3] = {fabs(double(p2.x) - p0.x), fabs(double(p2.y) - p0.y),
+                         fabs(double(p2.z) - p0.z)};
+    const double v[3] = {fabs(double(p1.x) - p0.x), fabs(double(p1.y) - p0.y),
+                         fabs(double(p1.z) - p0.z)};
+    const double bound = fabs(d[0]) * (u[1] * v[2] + u[2] * v[1]) +
+                         fabs(d[1]) * (u[2] * v[0] + u[0] * v[2]) +
+                         fabs(d[2]) * (u[0] * v[1] + u[1] * v[0]);
+    return above > bound * 1e-14;
+}
+
+float QuickHullBuilder::distanceTo(const Face& face, int point) const {
+    return (points[point] - points[face.vertices[0]]).dot(face.normal);
+}
+
+// IsConvex:
+// Checks that no face has a neighbor bending outwards across their edge, by
+// more than the tolerance. Each edge is checked from one side, the face
+// with the lower index.
+bool QuickHullBuilder::isConvex() const {
+    for (size_t index = 0; index < faces.size(); index++) {
+        const Face& face = faces[index];
+        if (!face.alive)
+            continue;
+
+        for (int i = 0; i < 3; i++) {
+            if (face.neighbors[i] == -1)
+                return false;
+            if (face.neighbors[i] < int(index))
+                continue;
+
+            const Face& neighbor = faces[face.neighbors[i]];
+            if (!neighbor.alive)
+                return false;
+
+            for (int j = 0; j < 3; j++) {
+                const int point = neighbor.vertices[j];
+                if (point != face.vertices[i] &&
+                    point != face.vertices[(i + 1) % 3] &&
+                    distanceTo(face, point) > epsilon)
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// WriteOutput:
+// Writes the faces of the hull to the vertex and index buffers.
+void QuickHullBuilder::writeOutput() {
+    for (const Face& face : faces) {
+        if (!face.alive)
+            continue;
+
+        for (int i = 0; i < 3; i++) {
+            const int point = face.vertices[i];
+
+            if (point_map[point] == -1) {
+                point_map[point] = int(vertices.size());
+                vertices.push_back(points[point]);
+            }
+
+            indices.push_back(point_map[point]);
+        }
+    }
+}
+
 } // namespace Math
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
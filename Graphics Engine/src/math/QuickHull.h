@@ -1,5 +1,9 @@
 #pragma once
 
+#include <stddef.h>
+
+#include <vector>
+
 #include "ConvexHull.h"
 #include "Triangle.h"
 
@@ -11,6 +15,8 @@ struct QuickHullData;
 // Implements the 3D QuickHull algorithm for convex hull generation. Saves its
 // state internally so that the algorithm can be used to incrementally build
 // hulls. Hides its implementation in the .cpp source file.
+// For building a hull from a whole point set at once, QuickHullBuilder is
+// much faster.
 class QuickHullSolver {
   private:
     QuickHullData* solver_data;
@@ -37,5 +43,113 @@ class QuickHullSolver {
     void findHorizonEdge(int point, int face, int prev_face);
 };
 
+// QuickHullBuilder Class:
+// A QuickHull for building hulls from whole point sets quickly. Every face
+// keeps a list of the points outside of it, so adding a vertex to the hull
+// only looks at the points of the faces it removes. Faces and lists are
+// kept in storage the builder owns, which is reused by later builds, so a
+// builder that is kept around stops allocating once it has grown.
+//
+// The tolerance points must be outside of a face by scales with the size of
+// the input, rather than being a fixed distance. Which faces a new vertex
+// replaces is decided without a tolerance, so that the hull stays convex.
+class QuickHullBuilder {
+  public:
+    struct Config {
+        // If above 0, the hull is simplified to have at most this many
+        // vertices. The points furthest outside the hull are added first,
+        // so the simplified hull keeps the input's largest features.
+        int max_vertices = 0;
+        // Inputs with at least this many points are assigned to the faces
+        // of the initial hull in parallel
+        size_t parallel_threshold = 16384;
+    };
+
+  private:
+    struct Face {
+        int vertices[3];
+        // Face across the edge from vertex i to vertex i + 1
+        int neighbors[3];
+
+        // Normal of the face, pointing out of the hull
+        Vector3 normal;
+
+        // Points outside of the face, linked through conflict_next, and the
+        // one furthest outside
+        int conflict_head;
+        int furthest;
+        float furthest_distance;
+
+        bool alive;
+        unsigned int visited;
+    };
+
+    struct HorizonEdge {
+        int point_1;
+        int point_2;
+        int visible_face;
+        int nonvisible_face;
+    };
+
+    // Input of the current build
+    const Vector3* points;
+    size_t num_points;
+    float epsilon;
+
+    std::vector<Face> faces;
+    std::vector<int> free_faces;
+    // Faces that may have points outside of them
+    std::vector<int> pending_faces;
+    unsigned int visit_epoch;
+
+    // Per point: the next point in its face's list, and the face it is
+    // outside of (with its distance) during the initial partition
+    std::vector<int> conflict_next;
+    std::vector<int> point_face;
+    std::vector<float> point_distance;
+    // Per point, used to link new faces and to index the output
+    std::vector<int> point_map;
+
+    std::vector<int> visible;
+    std::vector<int> stack;
+    std::vector<HorizonEdge> horizon;
+    std::vector<int> new_faces;
+
+    // Output of the last build
+    std::vector<Vector3> vertices;
+    std::vector<UINT> indices;
+
+  public:
+    QuickHullBuilder();
+    ~QuickHullBuilder();
+
+    // Builds the hull of the points. Returns false, with an empty hull, if
+    // there are less than 4 points, they are all (nearly) on one plane, or
+    // the result is not convex within the tolerance.
+    bool build(const Vector3* point_cloud, size_t count,
+               const Config& config);
+    bool build(const std::vector<Vector3>& point_cloud, const Config& config);
+
+    // The hull of the last build. Triangles are wound the same way as
+    // QuickHullSolver's.
+    const std::vector<Vector3>& getVertices() const;
+    const std::vector<UINT>& getIndices() const;
+    ConvexHull* getHull() const;
+
+  private:
+    bool buildInitialHull();
+    void partitionPoints(const Config& config);
+    int nextEyeFace(bool furthest_first);
+    void addVertex(int eye_face);
+    void findHorizon(int eye, int start_face);
+
+    int addFace(int v0, int v1, int v2);
+    void addConflict(int face, int point, float distance);
+    bool isAbove(const Face& face, int point) const;
+    float distanceTo(const Face& face, int point) const;
+    bool isConvex() const;
+    void writeOutput();
+};
+
 } // namespace Math
 } // namespace Engine
\ No newline at end of file
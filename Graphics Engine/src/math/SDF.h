@@ -1,5 +1,9 @@
 #pragma once
 
+#include <math.h>
+
+#include <algorithm>
+
 #include "Vector3.h"
 
 // This header file contains many SDF helper functions that can be used
@@ -13,5 +17,72 @@ inline float SDFSphere(Vector3 point, float p_radius) {
     return point.magnitude() - p_radius;
 }
 
+// Box centered on the origin, p_half_extents from its center to its faces
+inline float SDFBox(Vector3 point, Vector3 p_half_extents) {
+    const Vector3 q =
+        Vector3(fabsf(point.x), fabsf(point.y), fabsf(point.z)) -
+        p_half_extents;
+    const float inside = std::min(std::max(q.x, std::max(q.y, q.z)), 0.f);
+    return q.componentMax(Vector3(0, 0, 0)).magnitude() + inside;
+}
+
+// Capsule around the segment from p_a to p_b
+inline float SDFCapsule(Vector3 point, Vector3 p_a, Vector3 p_b,
+                        float p_radius) {
+    const Vector3 pa = point - p_a;
+    const Vector3 ba = p_b - p_a;
+    const float length = ba.dot(ba);
+    const float h =
+        length > 0 ? std::clamp(pa.dot(ba) / length, 0.f, 1.f) : 0.f;
+    return (pa - ba * h).magnitude() - p_radius;
+}
+
+// Torus around the y axis. p_major is the radius of the ring, and p_minor
+// the radius of its tube.
+inline float SDFTorus(Vector3 point, float p_major, float p_minor) {
+    const float ring =
+        sqrtf(point.x * point.x + point.z * point.z) - p_major;
+    return sqrtf(ring * ring + point.y * point.y) - p_minor;
+}
+
+// Plane through p_normal * p_offset, with p_normal (unit length) pointing
+// out of the solid side
+inline float SDFPlane(Vector3 point, Vector3 p_normal, float p_offset) {
+    return point.dot(p_normal) - p_offset;
+}
+
+// Capped cylinder around the y axis, extending p_half_height above and
+// below the origin
+inline float SDFCylinder(Vector3 point, float p_radius, float p_half_height) {
+    const float dx = sqrtf(point.x * point.x + point.z * point.z) - p_radius;
+    const float dy = fabsf(point.y) - p_half_height;
+    const float outside_x = std::max(dx, 0.f);
+    const float outside_y = std::max(dy, 0.f);
+    return std::min(std::max(dx, dy), 0.f) +
+           sqrtf(outside_x * outside_x + outside_y * outside_y);
+}
+
+// CSG Operators:
+// Combine the distances of two shapes a and b. Subtract carves b out of a.
+// The smooth variants blend the shapes together within p_k of where their
+// surfaces meet. These are no longer exact distances, but are a bound on
+// them, which is enough for meshing and sphere tracing.
+inline float SDFUnion(float a, float b) { return std::min(a, b); }
+inline float SDFSubtract(float a, float b) { return std::max(a, -b); }
+inline float SDFIntersect(float a, float b) { return std::max(a, b); }
+
+inline float SDFSmoothUnion(float a, float b, float p_k) {
+    if (p_k <= 0)
+        return SDFUnion(a, b);
+    const float h = std::max(p_k - fabsf(a - b), 0.f) / p_k;
+    return std::min(a, b) - h * h * p_k * 0.25f;
+}
+inline float SDFSmoothSubtract(float a, float b, float p_k) {
+    return -SDFSmoothUnion(-a, b, p_k);
+}
+inline float SDFSmoothIntersect(float a, float b, float p_k) {
+    return -SDFSmoothUnion(-a, -b, p_k);
+}
+
 } // namespace Math
 } // namespace Engine
\ No newline at end of file
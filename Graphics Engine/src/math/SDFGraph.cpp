@@ -0,0 +1,478 @@
+#include "SDFGraph.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "SDF.h"
+#include "SIMD.h"
+
+namespace Engine {
+namespace Math {
+using namespace SIMD;
+
+// RotateVector:
+// Rotates a vector by a unit quaternion, q * v * q^-1.
+static Vector3 RotateVector(const Quaternion& q, const Vector3& v) {
+    const Vector3& u = q.getIm();
+    const Vector3 t = u.cross(v) * 2.f;
+    return v + t * q.getR() + u.cross(t);
+}
+
+// --- SDFGraph ---
+SDFGraph::SDFGraph() = default;
+SDFGraph::~SDFGraph() = default;
+
+SDFGraph::Node SDFGraph::sphere(float radius) {
+    NodeData data;
+    data.op = Op::Sphere;
+    data.f0 = radius;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::box(const Vector3& half_extents) {
+    NodeData data;
+    data.op = Op::Box;
+    data.v0 = half_extents;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::capsule(const Vector3& a, const Vector3& b,
+                                 float radius) {
+    NodeData data;
+    data.op = Op::Capsule;
+    data.v0 = a;
+    data.v1 = b;
+    data.f0 = radius;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::torus(float major, float minor) {
+    NodeData data;
+    data.op = Op::Torus;
+    data.f0 = major;
+    data.f1 = minor;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::plane(const Vector3& normal, float offset) {
+    NodeData data;
+    data.op = Op::Plane;
+    data.v0 = normal.unit();
+    data.f0 = offset;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::cylinder(float radius, float half_height) {
+    NodeData data;
+    data.op = Op::Cylinder;
+    data.f0 = radius;
+    data.f1 = half_height;
+    return add(data);
+}
+
+SDFGraph::Node SDFGraph::unite(Node a, Node b) {
+    return smoothUnite(a, b, 0.f);
+}
+SDFGraph::Node SDFGraph::subtract(Node a, Node b) {
+    return smoothSubtract(a, b, 0.f);
+}
+SDFGraph::Node SDFGraph::intersect(Node a, Node b) {
+    return smoothIntersect(a, b, 0.f);
+}
+
+// Smooth CSG:
+// A blend distance of 0 is the same as the hard operator, and is stored as
+// one, so it compiles to the cheaper instruction.
+SDFGraph::Node SDFGraph::smoothUnite(Node a, Node b, float k) {
+    NodeData data;
+    data.op = k > 0 ? Op::SmoothUnion : Op::Union;
+    data.a = a;
+    data.b = b;
+    data.f0 = k;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::smoothSubtract(Node a, Node b, float k) {
+    NodeData data;
+    data.op = k > 0 ? Op::SmoothSubtract : Op::Subtract;
+    data.a = a;
+    data.b = b;
+    data.f0 = k;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::smoothIntersect(Node a, Node b, float k) {
+    NodeData data;
+    data.op = k > 0 ? Op::SmoothIntersect : Op::Intersect;
+    data.a = a;
+    data.b = b;
+    data.f0 = k;
+    return add(data);
+}
+
+SDFGraph::Node SDFGraph::translate(Node child, const Vector3& offset) {
+    NodeData data;
+    data.op = Op::Translate;
+    data.a = child;
+    data.v0 = offset;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::rotate(Node child, const Quaternion& rotation) {
+    NodeData data;
+    data.op = Op::Rotate;
+    data.a = child;
+    data.rotation = rotation;
+    return add(data);
+}
+SDFGraph::Node SDFGraph::scale(Node child, float scale) {
+    assert(scale > 0);
+    NodeData data;
+    data.op = Op::Scale;
+    data.a = child;
+    data.f0 = scale;
+    return add(data);
+}
+
+float SDFGraph::evaluate(Node root, const Vector3& point) const {
+    const NodeData& node = getNode(root);
+
+    switch (node.op) {
+    case Op::Sphere:
+        return SDFSphere(point, node.f0);
+    case Op::Box:
+        return SDFBox(point, node.v0);
+    case Op::Capsule:
+        return SDFCapsule(point, node.v0, node.v1, node.f0);
+    case Op::Torus:
+        return SDFTorus(point, node.f0, node.f1);
+    case Op::Plane:
+        return SDFPlane(point, node.v0, node.f0);
+    case Op::Cylinder:
+        return SDFCylinder(point, node.f0, node.f1);
+
+    case Op::Union:
+        return SDFUnion(evaluate(node.a, point), evaluate(node.b, point));
+    case Op::Subtract:
+        return SDFSubtract(evaluate(node.a, point), evaluate(node.b, point));
+    case Op::Intersect:
+        return SDFIntersect(evaluate(node.a, point),
+                            evaluate(node.b, point));
+    case Op::SmoothUnion:
+        return SDFSmoothUnion(evaluate(node.a, point),
+                              evaluate(node.b, point), node.f0);
+    case Op::SmoothSubtract:
+        return SDFSmoothSubtract(evaluate(node.a, point),
+                                 evaluate(node.b, point), node.f0);
+    case Op::SmoothIntersect:
+        return SDFSmoothIntersect(evaluate(node.a, point),
+                                  evaluate(node.b, point), node.f0);
+
+    case Op::Translate:
+        return evaluate(node.a, point - node.v0);
+    case Op::Rotate:
+        return evaluate(node.a,
+                        RotateVector(node.rotation.conjugate(), point));
+    case Op::Scale:
+        return evaluate(node.a, point / node.f0) * node.f0;
+
+    default:
+        assert(false);
+        return 0.f;
+    }
+}
+
+const SDFGraph::NodeData& SDFGraph::getNode(Node node) const {
+    assert(0 <= node && node < (Node)nodes.size());
+    return nodes[node];
+}
+size_t SDFGraph::size() const { return nodes.size(); }
+
+SDFGraph::Node SDFGraph::add(const NodeData& data) {
+    assert(data.a < (Node)nodes.size() && data.b < (Node)nodes.size());
+    nodes.push_back(data);
+    return (Node)nodes.size() - 1;
+}
+
+// --- SDFProgram ---
+SDFProgram::SDFProgram() : stack_size(0) {}
+SDFProgram::SDFProgram(const SDFGraph& graph, SDFGraph::Node root) {
+    Affine identity;
+    identity.columns[0] = Vector3::PositiveX();
+    identity.columns[1] = Vector3::PositiveY();
+    identity.columns[2] = Vector3::PositiveZ();
+    identity.translation = Vector3(0, 0, 0);
+    identity.scale = 1.f;
+
+    stack_size = compile(graph, root, identity, 0);
+}
+SDFProgram::~SDFProgram() = default;
+
+void SDFProgram::evaluate(const float* x, const float* y, const float* z,
+                          float* output, size_t count) const {
+    assert(!instructions.empty());
+    std::vector<float> stack((size_t)stack_size * BLOCK_SIZE);
+    // The last block is padded out to a whole block
+    float padded[4][BLOCK_SIZE];
+
+    for (size_t start = 0; start < count; start += BLOCK_SIZE) {
+        const size_t size = std::min(BLOCK_SIZE, count - start);
+        if (size == BLOCK_SIZE) {
+            evaluateBlock(x + start, y + start, z + start, stack.data(),
+                          output + start);
+            continue;
+        }
+
+        std::fill(&padded[0][0], &padded[0][0] + 3 * BLOCK_SIZE, 0.f);
+        std::copy(x + start, x + count, padded[0]);
+        std::copy(y + start, y + count, padded[1]);
+        std::copy(z + start, z + count, padded[2]);
+        evaluateBlock(padded[0], padded[1], padded[2], stack.data(),
+                      padded[3]);
+        std::copy(padded[3], padded[3] + size, output + start);
+    }
+}
+
+float SDFProgram::evaluate(const Vector3& point) const {
+    float output;
+    evaluate(&point.x, &point.y, &point.z, &output, 1);
+    return output;
+}
+
+size_t SDFProgram::getInstructionCount() const {
+    return instructions.size();
+}
+
+// Compile:
+// Emits the instructions for a node, which leave its distance in the slot
+// at depth. Transforms emit nothing, and instead change the map from the
+// point to the space of the primitives below them. Returns the number of
+// slots used.
+int SDFProgram::compile(const SDFGraph& graph, SDFGraph::Node node,
+                        const Affine& affine, int depth) {
+    const SDFGraph::NodeData& data = graph.getNode(node);
+
+    switch (data.op) {
+    case SDFGraph::Op::Translate: {
+        Affine moved = affine;
+        moved.translation = affine.translation - data.v0;
+        return compile(graph, data.a, moved, depth);
+    }
+    case SDFGraph::Op::Rotate: {
+        const Quaternion inverse = data.rotation.conjugate();
+        Affine rotated;
+        for (int i = 0; i < 3; i++)
+            rotated.columns[i] = RotateVector(inverse, affine.columns[i]);
+        rotated.translation = RotateVector(inverse, affine.translation);
+        rotated.scale = affine.scale;
+        return compile(graph, data.a, rotated, depth);
+    }
+    case SDFGraph::Op::Scale: {
+        Affine scaled;
+        for (int i = 0; i < 3; i++)
+            scaled.columns[i] = affine.columns[i] / data.f0;
+        scaled.translation = affine.translation / data.f0;
+        scaled.scale = affine.scale * data.f0;
+        return compile(graph, data.a, scaled, depth);
+    }
+
+    case SDFGraph::Op::Union:
+    case SDFGraph::Op::Subtract:
+    case SDFGraph::Op::Intersect:
+    case SDFGraph::Op::SmoothUnion:
+    case SDFGraph::Op::SmoothSubtract:
+    case SDFGraph::Op::SmoothIntersect: {
+        const int used_a = compile(graph, data.a, affine, depth);
+        const int used_b = compile(graph, data.b, affine, depth + 1);
+
+        // Blending happens in the node's space, so the blend distance is
+        // scaled like the distances are
+        Instruction instruction;
+        instruction.op = data.op;
+        instruction.slot = depth;
+        instruction.f0 = data.f0 * affine.scale;
+        instructions.push_back(instruction);
+        return std::max(used_a, used_b);
+    }
+
+    default: {
+        Instruction instruction;
+        instruction.op = data.op;
+        instruction.slot = depth;
+        for (int i = 0; i < 3; i++)
+            instruction.columns[i] = affine.columns[i];
+        instruction.translation = affine.translation;
+        instruction.scale = affine.scale;
+        instruction.v0 = data.v0;
+        instruction.v1 = data.v1;
+        instruction.f0 = data.f0;
+        instruction.f1 = data.f1;
+        instructions.push_back(instruction);
+        return depth + 1;
+    }
+    }
+}
+
+// EvaluateBlock:
+// Runs every instruction over BLOCK_SIZE points, with the same formulas as
+// SDF.h, 4 lanes at a time. The op is switched on once per instruction, and
+// the kernels are inlined into their own loops.
+void SDFProgram::evaluateBlock(const float* x, const float* y, const float* z,
+                               float* stack, float* output) const {
+    static_assert(BLOCK_SIZE % 4 == 0);
+    const float4 zero = Splat(0.f);
+    const float4 one = Splat(1.f);
+
+    for (const Instruction& instruction : instructions) {
+        float* result = stack + (size_t)instruction.slot * BLOCK_SIZE;
+        const float* other = result + BLOCK_SIZE;
+
+        // Combine: result = kernel(result, other)
+        auto combine = [&](auto&& kernel) {
+            for (size_t i = 0; i < BLOCK_SIZE; i += 4)
+                Store(result + i, kernel(Load(result + i), Load(other + i)));
+        };
+        const float4 blend = Splat(instruction.f0);
+        const float4 inverse_blend =
+            Splat(instruction.f0 > 0 ? 1.f / instruction.f0 : 0.f);
+        const float4 quarter_blend = Splat(instruction.f0 * 0.25f);
+        // Amount the smooth operators round off by, given how far apart the
+        // two distances are
+        auto rounding = [&](float4 difference) {
+            const float4 h = Mul(Max(Sub(blend, Abs(difference)), zero),
+                                 inverse_blend);
+            return Mul(Mul(h, h), quarter_blend);
+        };
+
+        // Primitive: result = kernel(point in the primitive's space) * scale
+        const Vector3* columns = instruction.columns;
+        const Vector3& t = instruction.translation;
+        const float4 scale = Splat(instruction.scale);
+        auto primitive = [&](auto&& kernel) {
+            for (size_t i = 0; i < BLOCK_SIZE; i += 4) {
+                const float4 wx = Load(x + i);
+                const float4 wy = Load(y + i);
+                const float4 wz = Load(z + i);
+                const float4 px = MulAdd(
+                    Splat(columns[0].x), wx,
+                    MulAdd(Splat(columns[1].x), wy,
+                           MulAdd(Splat(columns[2].x), wz, Splat(t.x))));
+                const float4 py = MulAdd(
+                    Splat(columns[0].y), wx,
+                    MulAdd(Splat(columns[1].y), wy,
+                           MulAdd(Splat(columns[2].y), wz, Splat(t.y))));
+                const float4 pz = MulAdd(
+                    Splat(columns[0].z), wx,
+                    MulAdd(Splat(columns[1].z), wy,
+                           MulAdd(Splat(columns[2].z), wz, Splat(t.z))));
+                Store(result + i, Mul(kernel(px, py, pz), scale));
+            }
+        };
+        const Vector3& v0 = instruction.v0;
+        const Vector3& v1 = instruction.v1;
+        const float4 f0 = Splat(instruction.f0);
+        const float4 f1 = Splat(instruction.f1);
+
+        switch (instruction.op) {
+        case SDFGraph::Op::Union:
+            combine([&](float4 a, float4 b) { return Min(a, b); });
+            break;
+        case SDFGraph::Op::Subtract:
+            combine([&](float4 a, float4 b) { return Max(a, Sub(zero, b)); });
+            break;
+        case SDFGraph::Op::Intersect:
+            combine([&](float4 a, float4 b) { return Max(a, b); });
+            break;
+        case SDFGraph::Op::SmoothUnion:
+            combine([&](float4 a, float4 b) {
+                return Sub(Min(a, b), rounding(Sub(a, b)));
+            });
+            break;
+        case SDFGraph::Op::SmoothSubtract:
+            // -SmoothUnion(-a, b)
+            combine([&](float4 a, float4 b) {
+                return Add(Max(a, Sub(zero, b)), rounding(Add(a, b)));
+            });
+            break;
+        case SDFGraph::Op::SmoothIntersect:
+            // -SmoothUnion(-a, -b)
+            combine([&](float4 a, float4 b) {
+                return Add(Max(a, b), rounding(Sub(a, b)));
+            });
+            break;
+
+        case SDFGraph::Op::Sphere:
+            primitive([&](float4 px, float4 py, float4 pz) {
+                return Sub(Sqrt(MulAdd(px, px, MulAdd(py, py, Mul(pz, pz)))),
+                           f0);
+            });
+            break;
+
+        case SDFGraph::Op::Box: {
+            const float4 hx = Splat(v0.x), hy = Splat(v0.y), hz = Splat(v0.z);
+            primitive([&](float4 px, float4 py, float4 pz) {
+                const float4 qx = Sub(Abs(px), hx);
+                const float4 qy = Sub(Abs(py), hy);
+                const float4 qz = Sub(Abs(pz), hz);
+                const float4 ox = Max(qx, zero);
+                const float4 oy = Max(qy, zero);
+                const float4 oz = Max(qz, zero);
+                const float4 inside = Min(Max(qx, Max(qy, qz)), zero);
+                return Add(Sqrt(MulAdd(ox, ox, MulAdd(oy, oy, Mul(oz, oz)))),
+                           inside);
+            });
+        } break;
+
+        case SDFGraph::Op::Capsule: {
+            const Vector3 ba = v1 - v0;
+            const float length = ba.dot(ba);
+            const float4 inverse_length =
+                Splat(length > 0 ? 1.f / length : 0.f);
+            const float4 ax = Splat(v0.x), ay = Splat(v0.y), az = Splat(v0.z);
+            const float4 bx = Splat(ba.x), by = Splat(ba.y), bz = Splat(ba.z);
+            primitive([&](float4 px, float4 py, float4 pz) {
+                const float4 pax = Sub(px, ax);
+                const float4 pay = Sub(py, ay);
+                const float4 paz = Sub(pz, az);
+                const float4 projection =
+                    MulAdd(pax, bx, MulAdd(pay, by, Mul(paz, bz)));
+                const float4 h =
+                    Min(Max(Mul(projection, inverse_length), zero), one);
+                const float4 dx = Sub(pax, Mul(bx, h));
+                const float4 dy = Sub(pay, Mul(by, h));
+                const float4 dz = Sub(paz, Mul(bz, h));
+                return Sub(Sqrt(MulAdd(dx, dx, MulAdd(dy, dy, Mul(dz, dz)))),
+                           f0);
+            });
+        } break;
+
+        case SDFGraph::Op::Torus:
+            primitive([&](float4 px, float4 py, float4 pz) {
+                const float4 ring = Sub(Sqrt(MulAdd(px, px, Mul(pz, pz))), f0);
+                return Sub(Sqrt(MulAdd(ring, ring, Mul(py, py))), f1);
+            });
+            break;
+
+        case SDFGraph::Op::Plane: {
+            const float4 nx = Splat(v0.x), ny = Splat(v0.y), nz = Splat(v0.z);
+            primitive([&](float4 px, float4 py, float4 pz) {
+                return Sub(MulAdd(px, nx, MulAdd(py, ny, Mul(pz, nz))), f0);
+            });
+        } break;
+
+        case SDFGraph::Op::Cylinder:
+            primitive([&](float4 px, float4 py, float4 pz) {
+                const float4 dx = Sub(Sqrt(MulAdd(px, px, Mul(pz, pz))), f0);
+                const float4 dy = Sub(Abs(py), f1);
+                const float4 ox = Max(dx, zero);
+                const float4 oy = Max(dy, zero);
+                return Add(Min(Max(dx, dy), zero),
+                           Sqrt(MulAdd(ox, ox, Mul(oy, oy))));
+            });
+            break;
+
+        default:
+            assert(false);
+            break;
+        }
+    }
+
+    std::copy(stack, stack + BLOCK_SIZE, output);
+}
+
+} // namespace Math
+} // namespace Engine
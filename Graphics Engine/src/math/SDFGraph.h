@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "Quaternion.h"
+#include "Vector3.h"
+
+namespace Engine {
+namespace Math {
+// SDFGraph Class:
+// An expression tree of SDFs (see SDF.h). Primitives are centered on the
+// origin, and are placed by transform nodes and combined by CSG nodes.
+// Nodes are added bottom-up, and refer to their children by the index the
+// graph returned for them. A node can be used by many parents.
+class SDFGraph {
+  public:
+    typedef int Node;
+
+    enum class Op {
+        Sphere,
+        Box,
+        Capsule,
+        Torus,
+        Plane,
+        Cylinder,
+        Union,
+        Subtract,
+        Intersect,
+        SmoothUnion,
+        SmoothSubtract,
+        SmoothIntersect,
+        Translate,
+        Rotate,
+        Scale
+    };
+
+    struct NodeData {
+        Op op;
+        Node a = -1;
+        Node b = -1;
+        // Parameters, which depend on the op
+        Vector3 v0;
+        Vector3 v1;
+        float f0 = 0.f;
+        float f1 = 0.f;
+        Quaternion rotation;
+    };
+
+  private:
+    std::vector<NodeData> nodes;
+
+  public:
+    SDFGraph();
+    ~SDFGraph();
+
+    // Primitives, with the parameters of their SDF.h functions
+    Node sphere(float radius);
+    Node box(const Vector3& half_extents);
+    Node capsule(const Vector3& a, const Vector3& b, float radius);
+    Node torus(float major, float minor);
+    Node plane(const Vector3& normal, float offset);
+    Node cylinder(float radius, float half_height);
+
+    // CSG. Subtract carves b out of a. k is the blend distance.
+    Node unite(Node a, Node b);
+    Node subtract(Node a, Node b);
+    Node intersect(Node a, Node b);
+    Node smoothUnite(Node a, Node b, float k);
+    Node smoothSubtract(Node a, Node b, float k);
+    Node smoothIntersect(Node a, Node b, float k);
+
+    // Transforms, which move (rotate, or uniformly scale) a node's shape
+    Node translate(Node child, const Vector3& offset);
+    Node rotate(Node child, const Quaternion& rotation);
+    Node scale(Node child, float scale);
+
+    // Evaluates a node at one point, by walking its tree
+    float evaluate(Node root, const Vector3& point) const;
+
+    const NodeData& getNode(Node node) const;
+    size_t size() const;
+
+  private:
+    Node add(const NodeData& data);
+};
+
+// SDFProgram Class:
+// An SDFGraph compiled for evaluating many points at once. Transforms are
+// folded into one affine map per primitive, and the tree is flattened into
+// instructions that run on a stack of distances. The points are evaluated
+// in blocks, with every instruction running over the whole block before the
+// next, 4 points at a time with SIMD.
+class SDFProgram {
+  public:
+    // Points per block
+    static constexpr size_t BLOCK_SIZE = 64;
+
+  private:
+    struct Instruction {
+        SDFGraph::Op op;
+        // Stack slot of the result. CSG instructions combine it with the
+        // slot above.
+        int slot;
+        // Primitives: the map from the point to the primitive's space,
+        // local = column_x * x + column_y * y + column_z * z + translation,
+        // and the factor its distance is scaled by
+        Vector3 columns[3];
+        Vector3 translation;
+        float scale = 1.f;
+        // Parameters, as in SDFGraph. CSG instructions only use f0.
+        Vector3 v0;
+        Vector3 v1;
+        float f0 = 0.f;
+        float f1 = 0.f;
+    };
+
+    std::vector<Instruction> instructions;
+    int stack_size;
+
+  public:
+    SDFProgram();
+    SDFProgram(const SDFGraph& graph, SDFGraph::Node root);
+    ~SDFProgram();
+
+    // Evaluates count points, given as separate coordinate arrays
+    void evaluate(const float* x, const float* y, const float* z,
+                  float* output, size_t count) const;
+    float evaluate(const Vector3& point) const;
+
+    size_t getInstructionCount() const;
+
+  private:
+    struct Affine {
+        Vector3 columns[3];
+        Vector3 translation;
+        float scale;
+    };
+
+    int compile(const SDFGraph& graph, SDFGraph::Node node,
+                const Affine& affine, int depth);
+    void evaluateBlock(const float* x, const float* y, const float* z,
+                       float* stack, float* output) const;
+};
+
+} // namespace Math
+} // namespace Engine
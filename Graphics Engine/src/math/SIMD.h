@@ -0,0 +1,326 @@
+#pragma once
+
+// SIMD Backend:
+// Thin wrapper over 4-wide float vectors, used by the math library for its
+// hot paths (matrix multiply, inverse, batched transforms). The backend is
+// selected at compile time:
+//   SSE    - x86 / x64. Uses FMA instructions if built with /arch:AVX2 (or
+//            -mfma), or if MATH_SIMD_FMA is defined. Likewise, uses SSE4.1
+//            rounding if built with /arch:AVX (or -msse4.1), or if
+//            MATH_SIMD_SSE4_1 is defined.
+//   NEON   - ARM64.
+//   Scalar - Portable fallback. Define MATH_FORCE_SCALAR in the project's
+//            preprocessor definitions to use it on any platform.
+// Code using this header should only use the functions below, so that it
+// works identically on every backend.
+#include <stddef.h>
+#include <string.h>
+
+#if !defined(MATH_FORCE_SCALAR) &&                                            \
+    (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__))
+#define MATH_SIMD_SSE
+#include <immintrin.h>
+// MSVC never defines __FMA__, but every CPU with AVX2 has FMA
+#if !defined(MATH_SIMD_FMA) &&                                                \
+    (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define MATH_SIMD_FMA
+#endif
+// MSVC never defines __SSE4_1__, but /arch:AVX and above include it
+#if !defined(MATH_SIMD_SSE4_1) && (defined(__SSE4_1__) || defined(__AVX__))
+#define MATH_SIMD_SSE4_1
+#endif
+#elif !defined(MATH_FORCE_SCALAR) &&                                          \
+    (defined(_M_ARM64) || defined(__ARM_NEON))
+#define MATH_SIMD_NEON
+#include <arm_neon.h>
+#else
+#define MATH_SIMD_SCALAR
+#include <math.h>
+#endif
+
+namespace Engine {
+namespace Math {
+namespace SIMD {
+#if defined(MATH_SIMD_SSE)
+typedef __m128 float4;
+#elif defined(MATH_SIMD_NEON)
+typedef float32x4_t float4;
+#else
+struct float4 {
+    float v[4];
+};
+#endif
+
+// BackendName:
+// Returns the name of the backend in use, for debug display.
+inline const char* BackendName() {
+#if defined(MATH_SIMD_SSE) && defined(MATH_SIMD_FMA)
+    return "SSE + FMA";
+#elif defined(MATH_SIMD_SSE)
+    return "SSE";
+#elif defined(MATH_SIMD_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+// Load / Store:
+// Move 4 floats between memory and a register. The memory does not need to
+// be aligned.
+inline float4 Load(const float* p) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_loadu_ps(p);
+#elif defined(MATH_SIMD_NEON)
+    return vld1q_f32(p);
+#else
+    return float4{{p[0], p[1], p[2], p[3]}};
+#endif
+}
+inline void Store(float* p, float4 a) {
+#if defined(MATH_SIMD_SSE)
+    _mm_storeu_ps(p, a);
+#elif defined(MATH_SIMD_NEON)
+    vst1q_f32(p, a);
+#else
+    p[0] = a.v[0];
+    p[1] = a.v[1];
+    p[2] = a.v[2];
+    p[3] = a.v[3];
+#endif
+}
+
+// Set / Splat:
+// Build a register from 4 values, or from one value in all lanes.
+inline float4 Set(float x, float y, float z, float w) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_setr_ps(x, y, z, w);
+#elif defined(MATH_SIMD_NEON)
+    const float values[4] = {x, y, z, w};
+    return vld1q_f32(values);
+#else
+    return float4{{x, y, z, w}};
+#endif
+}
+inline float4 Splat(float s) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_set1_ps(s);
+#elif defined(MATH_SIMD_NEON)
+    return vdupq_n_f32(s);
+#else
+    return float4{{s, s, s, s}};
+#endif
+}
+
+// Arithmetic:
+// Component-wise operations. MulAdd(a, b, c) returns a * b + c.
+inline float4 Add(float4 a, float4 b) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_add_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vaddq_f32(a, b);
+#else
+    return float4{{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2],
+                   a.v[3] + b.v[3]}};
+#endif
+}
+inline float4 Sub(float4 a, float4 b) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_sub_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vsubq_f32(a, b);
+#else
+    return float4{{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2],
+                   a.v[3] - b.v[3]}};
+#endif
+}
+inline float4 Mul(float4 a, float4 b) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_mul_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vmulq_f32(a, b);
+#else
+    return float4{{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2],
+                   a.v[3] * b.v[3]}};
+#endif
+}
+inline float4 Div(float4 a, float4 b) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_div_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vdivq_f32(a, b);
+#else
+    return float4{{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2],
+                   a.v[3] / b.v[3]}};
+#endif
+}
+inline float4 Min(float4 a, float4 b) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_min_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vminq_f32(a, b);
+#else
+    return float4{{a.v[0] < b.v[0] ? a.v[0] : b.v[0],
+                   a.v[1] < b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] < b.v[2] ? a.v[2] : b.v[2],
+                   a.v[3] < b.v[3] ? a.v[3] : b.v[3]}};
+#endif
+}
+inline float4 Max(float4 a, float4 b) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_max_ps(a, b);
+#elif defined(MATH_SIMD_NEON)
+    return vmaxq_f32(a, b);
+#else
+    return float4{{a.v[0] > b.v[0] ? a.v[0] : b.v[0],
+                   a.v[1] > b.v[1] ? a.v[1] : b.v[1],
+                   a.v[2] > b.v[2] ? a.v[2] : b.v[2],
+                   a.v[3] > b.v[3] ? a.v[3] : b.v[3]}};
+#endif
+}
+inline float4 MulAdd(float4 a, float4 b, float4 c) {
+#if defined(MATH_SIMD_SSE) && defined(MATH_SIMD_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#elif defined(MATH_SIMD_SSE)
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#elif defined(MATH_SIMD_NEON)
+    return vmlaq_f32(c, a, b);
+#else
+    return Add(Mul(a, b), c);
+#endif
+}
+
+// Abs / Sqrt:
+// Component-wise absolute value and square root.
+inline float4 Abs(float4 a) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_andnot_ps(_mm_set1_ps(-0.f), a);
+#elif defined(MATH_SIMD_NEON)
+    return vabsq_f32(a);
+#else
+    return float4{{fabsf(a.v[0]), fabsf(a.v[1]), fabsf(a.v[2]),
+                   fabsf(a.v[3])}};
+#endif
+}
+inline float4 Sqrt(float4 a) {
+#if defined(MATH_SIMD_SSE)
+    return _mm_sqrt_ps(a);
+#elif defined(MATH_SIMD_NEON)
+    return vsqrtq_f32(a);
+#else
+    return float4{{sqrtf(a.v[0]), sqrtf(a.v[1]), sqrtf(a.v[2]),
+                   sqrtf(a.v[3])}};
+#endif
+}
+
+// Floor:
+// Rounds each lane down to an integer. Lanes must be within the range of a
+// 32-bit integer.
+inline float4 Floor(float4 a) {
+#if defined(MATH_SIMD_SSE) && defined(MATH_SIMD_SSE4_1)
+    return _mm_floor_ps(a);
+#elif defined(MATH_SIMD_SSE)
+    // Truncate, then subtract 1 from lanes that were rounded up (negative
+    // non-integers)
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    const __m128 rounded_up = _mm_cmpgt_ps(truncated, a);
+    return _mm_sub_ps(truncated, _mm_and_ps(rounded_up, _mm_set1_ps(1.f)));
+#elif defined(MATH_SIMD_NEON)
+    return vrndmq_f32(a);
+#else
+    return float4{{floorf(a.v[0]), floorf(a.v[1]), floorf(a.v[2]),
+                   floorf(a.v[3])}};
+#endif
+}
+
+// LoadPartial / StorePartial:
+// Move up to 4 floats between memory and a register, so that the last
+// (count % 4) elements of an array can go through the same code as the rest.
+// Missing lanes are loaded as 0.
+inline float4 LoadPartial(const float* p, size_t count) {
+    if (count >= 4)
+        return Load(p);
+
+    float values[4] = {0.f, 0.f, 0.f, 0.f};
+    memcpy(values, p, count * sizeof(float));
+    return Load(values);
+}
+inline void StorePartial(float* p, float4 a, size_t count) {
+    if (count >= 4) {
+        Store(p, a);
+        return;
+    }
+
+    float values[4];
+    Store(values, a);
+    memcpy(p, values, count * sizeof(float));
+}
+
+// Lane:
+// Returns a single lane of a register.
+template <int i> inline float Lane(float4 a) {
+    static_assert(0 <= i && i < 4);
+#if defined(MATH_SIMD_SSE)
+    return _mm_cvtss_f32(_mm_shuffle_ps(a, a, _MM_SHUFFLE(i, i, i, i)));
+#elif defined(MATH_SIMD_NEON)
+    return vgetq_lane_f32(a, i);
+#else
+    return a.v[i];
+#endif
+}
+
+// Shuffle:
+// Returns (a[x], a[y], a[z], a[w]).
+template <int x, int y, int z, int w> inline float4 Shuffle(float4 a) {
+    static_assert(0 <= x && x < 4 && 0 <= y && y < 4 && 0 <= z && z < 4 &&
+                  0 <= w && w < 4);
+#if defined(MATH_SIMD_SSE)
+    return _mm_shuffle_ps(a, a, _MM_SHUFFLE(w, z, y, x));
+#elif defined(MATH_SIMD_NEON) && defined(__clang__)
+    return __builtin_shufflevector(a, a, x, y, z, w);
+#elif defined(MATH_SIMD_NEON)
+    return Set(vgetq_lane_f32(a, x), vgetq_lane_f32(a, y),
+               vgetq_lane_f32(a, z), vgetq_lane_f32(a, w));
+#else
+    return float4{{a.v[x], a.v[y], a.v[z], a.v[w]}};
+#endif
+}
+
+// Dot3:
+// Dot product of the first 3 lanes, broadcast to all lanes.
+inline float4 Dot3(float4 a, float4 b) {
+    const float4 m = Mul(a, b);
+    return Add(Add(Shuffle<0, 0, 0, 0>(m), Shuffle<1, 1, 1, 1>(m)),
+               Shuffle<2, 2, 2, 2>(m));
+}
+
+// Cross3:
+// Cross product of the first 3 lanes. The last lane is 0.
+inline float4 Cross3(float4 a, float4 b) {
+    const float4 a_yzx = Shuffle<1, 2, 0, 3>(a);
+    const float4 b_yzx = Shuffle<1, 2, 0, 3>(b);
+    const float4 c = Sub(Mul(a, b_yzx), Mul(a_yzx, b));
+    return Shuffle<1, 2, 0, 3>(c);
+}
+
+// Transpose:
+// Transposes the 4x4 matrix whose rows (or columns) are r0, ..., r3.
+inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3) {
+#if defined(MATH_SIMD_SSE)
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+#else
+    float m[4][4];
+    Store(m[0], r0);
+    Store(m[1], r1);
+    Store(m[2], r2);
+    Store(m[3], r3);
+    r0 = Set(m[0][0], m[1][0], m[2][0], m[3][0]);
+    r1 = Set(m[0][1], m[1][1], m[2][1], m[3][1]);
+    r2 = Set(m[0][2], m[1][2], m[2][2], m[3][2]);
+    r3 = Set(m[0][3], m[1][3], m[2][3], m[3][3]);
+#endif
+}
+
+} // namespace SIMD
+} // namespace Math
+} // namespace Engine
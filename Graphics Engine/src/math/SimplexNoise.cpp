@@ -0,0 +1,347 @@
+#include "SimplexNoise.h"
+
+#include <math.h>
+
+#include "Compute.h"
+#include "SIMD.h"
+
+namespace Engine {
+namespace Math {
+// Gradients:
+// The 12 vectors from the center of a cube to its edges. 2D noise uses the
+// x and y components.
+static constexpr float GRADIENTS[12][3] = {
+    {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0}, {1, 0, 1},  {-1, 0, 1},
+    {1, 0, -1}, {-1, 0, -1}, {0, 1, 1}, {0, -1, 1}, {0, 1, -1}, {0, -1, -1}};
+
+// Skewing factors, which map between the simplex grid and the square grid.
+// F skews a point onto the square grid, and G unskews it back.
+static constexpr float F2 = 0.36602540378f; // (sqrt(3) - 1) / 2
+static constexpr float G2 = 0.21132486540f; // (3 - sqrt(3)) / 6
+static constexpr float F3 = 1.f / 3.f;
+static constexpr float G3 = 1.f / 6.f;
+
+// Corner2D / Corner3D:
+// The contribution of a corner with the given gradient index, to a point at
+// (x,y,z) relative to it. Falls off to 0 at a radius of sqrt(0.5) in 2D and
+// sqrt(0.6) in 3D, so a corner only affects the simplices around it.
+static float Corner2D(int gradient, float x, float y) {
+    float t = 0.5f - x * x - y * y;
+    if (t < 0)
+        return 0;
+
+    t *= t;
+    const float* g = GRADIENTS[gradient];
+    return t * t * (g[0] * x + g[1] * y);
+}
+
+static float Corner3D(int gradient, float x, float y, float z) {
+    float t = 0.6f - x * x - y * y - z * z;
+    if (t < 0)
+        return 0;
+
+    t *= t;
+    const float* g = GRADIENTS[gradient];
+    return t * t * (g[0] * x + g[1] * y + g[2] * z);
+}
+
+SimplexNoise::SimplexNoise() { seed(0); }
+SimplexNoise::SimplexNoise(unsigned int seed) { this->seed(seed); }
+
+NoiseType SimplexNoise::type() const { return NoiseType::Simplex; }
+
+void SimplexNoise::seed(unsigned int seed) {
+    GeneratePermutationTable(seed, permutation_table);
+}
+
+// Noise2D:
+// Finds the triangle containing (x,y), and sums the contributions of its 3
+// corners.
+float SimplexNoise::noise2D(float x, float y) const {
+    const unsigned char* perm = permutation_table;
+
+    // Skew the point to find the square cell it is in
+    const float s = (x + y) * F2;
+    const float i = floorf(x + s);
+    const float j = floorf(y + s);
+
+    // Unskew the cell origin back, to get the point relative to it
+    const float t = (i + j) * G2;
+    const float x0 = x - (i - t);
+    const float y0 = y - (j - t);
+
+    // The square cell is split into 2 triangles. Find which one we are in,
+    // which determines the middle corner.
+    const int i1 = x0 > y0 ? 1 : 0;
+    const int j1 = 1 - i1;
+
+    const float x1 = x0 - i1 + G2;
+    const float y1 = y0 - j1 + G2;
+    const float x2 = x0 - 1.f + 2.f * G2;
+    const float y2 = y0 - 1.f + 2.f * G2;
+
+    // Hash the corners for their gradients
+    const int ii = ((int)i) & 0xFF;
+    const int jj = ((int)j) & 0xFF;
+    const int g0 = perm[ii + perm[jj]] % 12;
+    const int g1 = perm[ii + i1 + perm[jj + j1]] % 12;
+    const int g2 = perm[ii + 1 + perm[jj + 1]] % 12;
+
+    const float value =
+        Corner2D(g0, x0, y0) + Corner2D(g1, x1, y1) + Corner2D(g2, x2, y2);
+
+    // The sum is scaled to [-1,1], and then to [0,1]
+    return Clamp(value * 35.f + 0.5f, 0, 1);
+}
+
+// Noise3D:
+// Finds the tetrahedron containing (x,y,z), and sums the contributions of
+// its 4 corners.
+float SimplexNoise::noise3D(float x, float y, float z) const {
+    const unsigned char* perm = permutation_table;
+
+    const float s = (x + y + z) * F3;
+    const float i = floorf(x + s);
+    const float j = floorf(y + s);
+    const float k = floorf(z + s);
+
+    const float t = (i + j + k) * G3;
+    const float x0 = x - (i - t);
+    const float y0 = y - (j - t);
+    const float z0 = z - (k - t);
+
+    // The cube cell is split into 6 tetrahedra. The order of the point's
+    // coordinates determines which one we are in, and the 2 middle corners.
+    int i1, j1, k1;
+    int i2, j2, k2;
+    if (x0 >= y0) {
+        if (y0 >= z0) { // X Y Z
+            i1 = 1, j1 = 0, k1 = 0;
+            i2 = 1, j2 = 1, k2 = 0;
+        } else if (x0 >= z0) { // X Z Y
+            i1 = 1, j1 = 0, k1 = 0;
+            i2 = 1, j2 = 0, k2 = 1;
+        } else { // Z X Y
+            i1 = 0, j1 = 0, k1 = 1;
+            i2 = 1, j2 = 0, k2 = 1;
+        }
+    } else {
+        if (y0 < z0) { // Z Y X
+            i1 = 0, j1 = 0, k1 = 1;
+            i2 = 0, j2 = 1, k2 = 1;
+        } else if (x0 < z0) { // Y Z X
+            i1 = 0, j1 = 1, k1 = 0;
+            i2 = 0, j2 = 1, k2 = 1;
+        } else { // Y X Z
+            i1 = 0, j1 = 1, k1 = 0;
+            i2 = 1, j2 = 1, k2 = 0;
+        }
+    }
+
+    const float x1 = x0 - i1 + G3;
+    const float y1 = y0 - j1 + G3;
+    const float z1 = z0 - k1 + G3;
+    const float x2 = x0 - i2 + 2.f * G3;
+    const float y2 = y0 - j2 + 2.f * G3;
+    const float z2 = z0 - k2 + 2.f * G3;
+    const float x3 = x0 - 1.f + 3.f * G3;
+    const float y3 = y0 - 1.f + 3.f * G3;
+    const float z3 = z0 - 1.f + 3.f * G3;
+
+    const int ii = ((int)i) & 0xFF;
+    const int jj = ((int)j) & 0xFF;
+    const int kk = ((int)k) & 0xFF;
+    const int g0 = perm[ii + perm[jj + perm[kk]]] % 12;
+    const int g1 = perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]] % 12;
+    const int g2 = perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]] % 12;
+    const int g3 = perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] % 12;
+
+    const float value = Corner3D(g0, x0, y0, z0) + Corner3D(g1, x1, y1, z1) +
+                        Corner3D(g2, x2, y2, z2) + Corner3D(g3, x3, y3, z3);
+
+    return Clamp(value * 16.f + 0.5f, 0, 1);
+}
+
+// --- Batch Sampling ---
+// The batch functions evaluate 4 samples at a time. Finding the simplex and
+// hashing its corners is done per lane. The corner offsets, falloffs and
+// gradient dot products are done for all lanes at once.
+using namespace SIMD;
+
+// Corner4:
+// Corner2D / Corner3D for 4 lanes, given the gradient components by lane.
+static float4 Corner4(float4 radius_sq, const float* gx, const float* gy,
+                      float4 x, float4 y) {
+    float4 t = Sub(radius_sq, MulAdd(x, x, Mul(y, y)));
+    t = Max(t, Splat(0.f));
+    t = Mul(t, t);
+    return Mul(Mul(t, t), MulAdd(Load(gx), x, Mul(Load(gy), y)));
+}
+static float4 Corner4(float4 radius_sq, const float* gx, const float* gy,
+                      const float* gz, float4 x, float4 y, float4 z) {
+    float4 t = Sub(radius_sq, MulAdd(x, x, MulAdd(y, y, Mul(z, z))));
+    t = Max(t, Splat(0.f));
+    t = Mul(t, t);
+    const float4 dot =
+        MulAdd(Load(gx), x, MulAdd(Load(gy), y, Mul(Load(gz), z)));
+    return Mul(Mul(t, t), dot);
+}
+
+// Noise2D4:
+// Evaluates noise2D at 4 points.
+static float4 Noise2D4(const unsigned char* perm, float4 x, float4 y) {
+    const float4 s = Mul(Add(x, y), Splat(F2));
+    const float4 i = Floor(Add(x, s));
+    const float4 j = Floor(Add(y, s));
+
+    const float4 t = Mul(Add(i, j), Splat(G2));
+    const float4 x0 = Sub(x, Sub(i, t));
+    const float4 y0 = Sub(y, Sub(j, t));
+
+    float is[4], js[4], x0s[4], y0s[4];
+    Store(is, i);
+    Store(js, j);
+    Store(x0s, x0);
+    Store(y0s, y0);
+
+    // Middle corner offsets, and gradient components for each corner, by lane
+    float i1s[4], j1s[4];
+    float gx[3][4], gy[3][4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        const int i1 = x0s[lane] > y0s[lane] ? 1 : 0;
+        const int j1 = 1 - i1;
+        i1s[lane] = (float)i1;
+        j1s[lane] = (float)j1;
+
+        const int ii = ((int)is[lane]) & 0xFF;
+        const int jj = ((int)js[lane]) & 0xFF;
+        const int gradients[3] = {perm[ii + perm[jj]] % 12,
+                                  perm[ii + i1 + perm[jj + j1]] % 12,
+                                  perm[ii + 1 + perm[jj + 1]] % 12};
+
+        for (int corner = 0; corner < 3; corner++) {
+            gx[corner][lane] = GRADIENTS[gradients[corner]][0];
+            gy[corner][lane] = GRADIENTS[gradients[corner]][1];
+        }
+    }
+
+    const float4 x1 = Add(Sub(x0, Load(i1s)), Splat(G2));
+    const float4 y1 = Add(Sub(y0, Load(j1s)), Splat(G2));
+    const float4 x2 = Add(x0, Splat(-1.f + 2.f * G2));
+    const float4 y2 = Add(y0, Splat(-1.f + 2.f * G2));
+
+    const float4 radius_sq = Splat(0.5f);
+    const float4 value = Add(Add(Corner4(radius_sq, gx[0], gy[0], x0, y0),
+                                 Corner4(radius_sq, gx[1], gy[1], x1, y1)),
+                             Corner4(radius_sq, gx[2], gy[2], x2, y2));
+
+    const float4 normalized = MulAdd(value, Splat(35.f), Splat(0.5f));
+    return Min(Max(normalized, Splat(0.f)), Splat(1.f));
+}
+
+// Noise3D4:
+// Evaluates noise3D at 4 points.
+static float4 Noise3D4(const unsigned char* perm, float4 x, float4 y,
+                       float4 z) {
+    const float4 s = Mul(Add(Add(x, y), z), Splat(F3));
+    const float4 i = Floor(Add(x, s));
+    const float4 j = Floor(Add(y, s));
+    const float4 k = Floor(Add(z, s));
+
+    const float4 t = Mul(Add(Add(i, j), k), Splat(G3));
+    const float4 x0 = Sub(x, Sub(i, t));
+    const float4 y0 = Sub(y, Sub(j, t));
+    const float4 z0 = Sub(z, Sub(k, t));
+
+    float is[4], js[4], ks[4], x0s[4], y0s[4], z0s[4];
+    Store(is, i);
+    Store(js, j);
+    Store(ks, k);
+    Store(x0s, x0);
+    Store(y0s, y0);
+    Store(z0s, z0);
+
+    // Offsets of the 2 middle corners, and gradients for each corner, by lane
+    float offsets[2][3][4];
+    float gx[4][4], gy[4][4], gz[4][4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        const float xl = x0s[lane], yl = y0s[lane], zl = z0s[lane];
+
+        // The corners are reached by stepping along the axes in order of
+        // the point's coordinates, largest first.
+        const int rank_x = (xl >= yl) + (xl >= zl);
+        const int rank_y = (yl > xl) + (yl >= zl);
+        const int rank_z = (zl > xl) + (zl > yl);
+
+        const int i1 = rank_x >= 2, j1 = rank_y >= 2, k1 = rank_z >= 2;
+        const int i2 = rank_x >= 1, j2 = rank_y >= 1, k2 = rank_z >= 1;
+
+        offsets[0][0][lane] = (float)i1;
+        offsets[0][1][lane] = (float)j1;
+        offsets[0][2][lane] = (float)k1;
+        offsets[1][0][lane] = (float)i2;
+        offsets[1][1][lane] = (float)j2;
+        offsets[1][2][lane] = (float)k2;
+
+        const int ii = ((int)is[lane]) & 0xFF;
+        const int jj = ((int)js[lane]) & 0xFF;
+        const int kk = ((int)ks[lane]) & 0xFF;
+        const int gradients[4] = {
+            perm[ii + perm[jj + perm[kk]]] % 12,
+            perm[ii + i1 + perm[jj + j1 + perm[kk + k1]]] % 12,
+            perm[ii + i2 + perm[jj + j2 + perm[kk + k2]]] % 12,
+            perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] % 12};
+
+        for (int corner = 0; corner < 4; corner++) {
+            gx[corner][lane] = GRADIENTS[gradients[corner]][0];
+            gy[corner][lane] = GRADIENTS[gradients[corner]][1];
+            gz[corner][lane] = GRADIENTS[gradients[corner]][2];
+        }
+    }
+
+    const float4 x1 = Add(Sub(x0, Load(offsets[0][0])), Splat(G3));
+    const float4 y1 = Add(Sub(y0, Load(offsets[0][1])), Splat(G3));
+    const float4 z1 = Add(Sub(z0, Load(offsets[0][2])), Splat(G3));
+    const float4 x2 = Add(Sub(x0, Load(offsets[1][0])), Splat(2.f * G3));
+    const float4 y2 = Add(Sub(y0, Load(offsets[1][1])), Splat(2.f * G3));
+    const float4 z2 = Add(Sub(z0, Load(offsets[1][2])), Splat(2.f * G3));
+    const float4 x3 = Add(x0, Splat(-1.f + 3.f * G3));
+    const float4 y3 = Add(y0, Splat(-1.f + 3.f * G3));
+    const float4 z3 = Add(z0, Splat(-1.f + 3.f * G3));
+
+    const float4 radius_sq = Splat(0.6f);
+    const float4 value =
+        Add(Add(Corner4(radius_sq, gx[0], gy[0], gz[0], x0, y0, z0),
+                Corner4(radius_sq, gx[1], gy[1], gz[1], x1, y1, z1)),
+            Add(Corner4(radius_sq, gx[2], gy[2], gz[2], x2, y2, z2),
+                Corner4(radius_sq, gx[3], gy[3], gz[3], x3, y3, z3)));
+
+    const float4 normalized = MulAdd(value, Splat(16.f), Splat(0.5f));
+    return Min(Max(normalized, Splat(0.f)), Splat(1.f));
+}
+
+void SimplexNoise::noise2D(const float* x, const float* y, float* output,
+                           size_t count) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 value = Noise2D4(permutation_table, LoadPartial(x + i, n),
+                                      LoadPartial(y + i, n));
+        StorePartial(output + i, value, n);
+    }
+}
+
+void SimplexNoise::noise3D(const float* x, const float* y, const float* z,
+                           float* output, size_t count) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 value =
+            Noise3D4(permutation_table, LoadPartial(x + i, n),
+                     LoadPartial(y + i, n), LoadPartial(z + i, n));
+        StorePartial(output + i, value, n);
+    }
+}
+
+} // namespace Math
+} // namespace Engine
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Noise.h"
+
+namespace Engine {
+namespace Math {
+// SimplexNoise Class:
+// Gradient noise sampled on a simplex grid (triangles in 2D, tetrahedra in
+// 3D) instead of a square grid. Each sample only needs 3 gradients in 2D and
+// 4 in 3D (Perlin needs 4 and 8), and the noise has fewer axis-aligned
+// artifacts.
+// Adapted from Stefan Gustavson's "Simplex noise demystified".
+class SimplexNoise final : public Noise {
+  private:
+    // Permutation table, stored twice so lookups never need to wrap
+    unsigned char permutation_table[512];
+
+  public:
+    SimplexNoise();
+    SimplexNoise(unsigned int seed);
+
+    NoiseType type() const override;
+    void seed(unsigned int seed) override;
+
+    float noise2D(float x, float y) const override;
+    float noise3D(float x, float y, float z) const override;
+
+    void noise2D(const float* x, const float* y, float* output,
+                 size_t count) const override;
+    void noise3D(const float* x, const float* y, const float* z,
+                 float* output, size_t count) const override;
+};
+
+} // namespace Math
+} // namespace Engine
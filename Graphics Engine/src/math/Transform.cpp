@@ -11,9 +11,57 @@ namespace Math {
 // Default Constructor:
 // Initializes transform with all properties set to 0
 Transform::Transform() {
+    listener = nullptr;
+    listener_id = 0;
+    listener_notified = false;
+
     position_local = Vector3(0, 0, 0);
     rotation = Quaternion::Identity();
     scale = Vector3(1, 1, 1);
+
+    markDirty();
+}
+
+Transform::Transform(const Transform& transform) {
+    listener = nullptr;
+    listener_id = 0;
+    listener_notified = false;
+
+    position_local = transform.position_local;
+    rotation = transform.rotation;
+    scale = transform.scale;
+
+    markDirty();
+}
+
+Transform& Transform::operator=(const Transform& transform) {
+    position_local = transform.position_local;
+    rotation = transform.rotation;
+    scale = transform.scale;
+
+    markDirty();
+    return *this;
+}
+
+// MarkDirty:
+// Flags the cached matrices for regeneration
+void Transform::markDirty() {
+    matrix_dirty = true;
+    inverse_dirty = true;
+
+    if (listener != nullptr && !listener_notified) {
+        listener_notified = true;
+        listener->onTransformChanged(listener_id);
+    }
+}
+
+// SetListener:
+// Sets the listener notified on the next change. Pass nullptr to stop
+// listening.
+void Transform::setListener(TransformListener* _listener, uint32_t id) {
+    listener = _listener;
+    listener_id = id;
+    listener_notified = false;
 }
 
 // GetPosition:
@@ -26,6 +74,8 @@ void Transform::setPosition(float x, float y, float z) {
     position_local.x = x;
     position_local.y = y;
     position_local.z = z;
+
+    markDirty();
 }
 
 void Transform::setPosition(const Vector3& pos) {
@@ -38,6 +88,8 @@ void Transform::offsetPosition(float x, float y, float z) {
     position_local.x = position_local.x + x;
     position_local.y = position_local.y + y;
     position_local.z = position_local.z + z;
+
+    markDirty();
 }
 
 void Transform::offsetPosition(const Vector3& offset) {
@@ -69,6 +121,7 @@ void Transform::setViewDirection(const Vector3& direc) {
         Quaternion::RotationAroundAxis(Vector3::PositiveZ(), phi);
 
     rotation = z_rotate * y_rotate;
+    markDirty();
 }
 
 // LookAt:
@@ -80,11 +133,13 @@ void Transform::lookAt(const Vector3& target) {
 // SetRotation:
 void Transform::setRotation(const Quaternion& quaternion) {
     rotation = quaternion;
+    markDirty();
 }
 
 // Changes the transform's rotation to theta degrees around some axis in space
 void Transform::setRotation(const Vector3& axis, float theta) {
     rotation = Quaternion::RotationAroundAxis(axis, theta);
+    markDirty();
 }
 
 // OffsetRotation
@@ -92,6 +147,7 @@ void Transform::setRotation(const Vector3& axis, float theta) {
 void Transform::offsetRotation(const Vector3& axis, float theta) {
     const Quaternion newRotation = Quaternion::RotationAroundAxis(axis, theta);
     rotation *= newRotation;
+    markDirty();
 }
 
 // GetScale:
@@ -104,6 +160,8 @@ void Transform::setScale(float x, float y, float z) {
     scale.x = x;
     scale.y = y;
     scale.z = z;
+
+    markDirty();
 }
 
 void Transform::setScale(const Vector3& scale) {
@@ -157,19 +215,36 @@ Vector3 Transform::down(void) const { return -up(); }
 
 // TransformMatrix:
 // Returns the 4x4 matrix representing the scale, rotation,
-// and translations for a given transform
-Matrix4 Transform::transformMatrix(void) const {
-    // Generate the transformation matrices
-    const Matrix4 m_scale =
-        Matrix4::T_Scale(scale.x, scale.y, scale.z);       // Scale
-    const Matrix4 m_rotation = rotation.rotationMatrix4(); // Rotation
-    const Matrix4 m_translation =
-        Matrix4::T_Translate(position_local); // Translation
-
-    // Build final matrix
-    // Left matrix gets precedence, as we are performing row-major
-    // multiplication
-    return m_translation * m_rotation * m_scale;
+// and translations for a given transform (Translate * Rotate * Scale).
+// The matrix is only rebuilt if the transform changed since the last call.
+const Matrix4& Transform::transformMatrix(void) const {
+    if (matrix_dirty) {
+        m_affine = Matrix3x4::FromTRS(position_local, rotation, scale);
+        m_transform = m_affine.toMatrix4();
+        matrix_dirty = false;
+    }
+
+    return m_transform;
+}
+
+// InverseTransformMatrix:
+// Returns the inverse of the transform matrix. The basis of the matrix is a
+// rotation with a per-axis scale, so we can invert it without a general 4x4
+// inverse.
+const Matrix4& Transform::inverseTransformMatrix(void) const {
+    if (inverse_dirty) {
+        m_inverse = affineMatrix().inverseRigidScale().toMatrix4();
+        inverse_dirty = false;
+    }
+
+    return m_inverse;
+}
+
+// AffineMatrix:
+// Returns the transform matrix in compact 3x4 form
+const Matrix3x4& Transform::affineMatrix(void) const {
+    transformMatrix();
+    return m_affine;
 }
 
 // ScaleMatrix:
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <stdint.h>
+
+#include "math/Matrix3x4.h"
 #include "math/Matrix4.h"
 #include "math/Quaternion.h"
 #include "math/Vector3.h"
 
 namespace Engine {
 namespace Math {
+// TransformListener Interface:
+// Notified when a transform changes. A listener is only notified once, until
+// it is set on the transform again.
+class TransformListener {
+  public:
+    virtual void onTransformChanged(uint32_t id) = 0;
+};
+
 // Class Transform:
 // Contains the data and methods regarding
 // an object's transform
@@ -15,10 +26,33 @@ class Transform {
     Quaternion rotation;    // Quaternion Rotation
     Vector3 scale;          // ScaleX, ScaleY, ScaleZ
 
+    // Cached matrices. These are rebuilt lazily the next time they are
+    // requested after the position, rotation or scale changes.
+    mutable Matrix3x4 m_affine;
+    mutable Matrix4 m_transform;
+    mutable Matrix4 m_inverse;
+    mutable bool matrix_dirty;
+    mutable bool inverse_dirty;
+
+    // Lets copies of the matrices (such as the datamodel's TransformStore)
+    // find out when they are stale, without polling every transform.
+    TransformListener* listener;
+    uint32_t listener_id;
+    bool listener_notified;
+
+    void markDirty();
+
   public:
     // Constructor
     Transform();
-    
+    // Copies and assignment copy the properties, but not the listener. An
+    // assignment counts as a change to this transform.
+    Transform(const Transform& transform);
+    Transform& operator=(const Transform& transform);
+
+    // Notifies the listener, with the given id, on the next change
+    void setListener(TransformListener* listener, uint32_t id);
+
     // Get and set the transform properties
     const Vector3& getPosition() const;
 
@@ -47,8 +81,11 @@ class Transform {
     Vector3 up(void) const;
     Vector3 down(void) const;
 
-    // Generates transformation matrices based off transform
-    Matrix4 transformMatrix(void) const;
+    // Generates transformation matrices based off transform. The local ->
+    // parent matrix and its inverse are cached.
+    const Matrix4& transformMatrix(void) const;
+    const Matrix4& inverseTransformMatrix(void) const;
+    const Matrix3x4& affineMatrix(void) const;
 
     Matrix4 scaleMatrix(void) const;
     Matrix4 rotationMatrix(void) const;
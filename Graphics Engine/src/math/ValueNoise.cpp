@@ -0,0 +1,196 @@
+#include "ValueNoise.h"
+
+#include <math.h>
+
+#include "Compute.h"
+#include "SIMD.h"
+
+namespace Engine {
+namespace Math {
+// Primes used to hash lattice coordinates
+static constexpr uint32_t PRIME_X = 501125321u;
+static constexpr uint32_t PRIME_Y = 1136930381u;
+static constexpr uint32_t PRIME_Z = 1720413743u;
+
+// Fade Function:
+// 6t^5 - 15t^4 + 10t^3, which smooths the interpolation between corners.
+// Results are clamped by the caller, as rounding can push them past 1.
+static float fade(float t) { return (t * t * t) * (10 + t * (6 * t - 15)); }
+
+// CornerValue:
+// Hashes the (pre-multiplied) corner coordinates into a value in [0,1].
+static float CornerValue(uint32_t seed, uint32_t x, uint32_t y, uint32_t z) {
+    uint32_t hash = (seed ^ x ^ y ^ z) * 0x27d4eb2du;
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return (hash >> 8) * (1.f / 16777215.f);
+}
+
+ValueNoise::ValueNoise() { seed(0); }
+ValueNoise::ValueNoise(unsigned int seed) { this->seed(seed); }
+
+NoiseType ValueNoise::type() const { return NoiseType::Value; }
+
+void ValueNoise::seed(unsigned int seed) { mSeed = seed; }
+
+float ValueNoise::noise2D(float x, float y) const {
+    const float x_floor = floorf(x);
+    const float y_floor = floorf(y);
+
+    const uint32_t x0 = (uint32_t)(int)x_floor * PRIME_X;
+    const uint32_t y0 = (uint32_t)(int)y_floor * PRIME_Y;
+    const uint32_t x1 = x0 + PRIME_X;
+    const uint32_t y1 = y0 + PRIME_Y;
+
+    const float u = Clamp(fade(x - x_floor), 0, 1);
+    const float v = Clamp(fade(y - y_floor), 0, 1);
+
+    const float bottom = Lerp(CornerValue(mSeed, x0, y0, 0),
+                              CornerValue(mSeed, x1, y0, 0), u);
+    const float top = Lerp(CornerValue(mSeed, x0, y1, 0),
+                           CornerValue(mSeed, x1, y1, 0), u);
+    return Lerp(bottom, top, v);
+}
+
+float ValueNoise::noise3D(float x, float y, float z) const {
+    const float x_floor = floorf(x);
+    const float y_floor = floorf(y);
+    const float z_floor = floorf(z);
+
+    const uint32_t x0 = (uint32_t)(int)x_floor * PRIME_X;
+    const uint32_t y0 = (uint32_t)(int)y_floor * PRIME_Y;
+    const uint32_t z0 = (uint32_t)(int)z_floor * PRIME_Z;
+    const uint32_t x1 = x0 + PRIME_X;
+    const uint32_t y1 = y0 + PRIME_Y;
+    const uint32_t z1 = z0 + PRIME_Z;
+
+    const float u = Clamp(fade(x - x_floor), 0, 1);
+    const float v = Clamp(fade(y - y_floor), 0, 1);
+    const float w = Clamp(fade(z - z_floor), 0, 1);
+
+    const float front = Lerp(Lerp(CornerValue(mSeed, x0, y0, z0),
+                                 CornerValue(mSeed, x1, y0, z0), u),
+                            Lerp(CornerValue(mSeed, x0, y1, z0),
+                                 CornerValue(mSeed, x1, y1, z0), u),
+                            v);
+    const float back = Lerp(Lerp(CornerValue(mSeed, x0, y0, z1),
+                                CornerValue(mSeed, x1, y0, z1), u),
+                           Lerp(CornerValue(mSeed, x0, y1, z1),
+                                CornerValue(mSeed, x1, y1, z1), u),
+                           v);
+    return Lerp(front, back, w);
+}
+
+// --- Batch Sampling ---
+// The batch functions evaluate 4 samples at a time. The corners are hashed
+// per lane, and the fade and interpolation are done for all lanes at once.
+using namespace SIMD;
+
+static float4 Fade4(float4 t) {
+    const float4 t3 = Mul(Mul(t, t), t);
+    const float4 inner =
+        MulAdd(t, MulAdd(Splat(6.f), t, Splat(-15.f)), Splat(10.f));
+    return Min(Max(Mul(t3, inner), Splat(0.f)), Splat(1.f));
+}
+
+static float4 Lerp4(float4 a, float4 b, float4 t) {
+    return MulAdd(Sub(b, a), t, a);
+}
+
+// Noise2D4:
+// Evaluates noise2D at 4 points.
+static float4 Noise2D4(uint32_t seed, float4 x, float4 y) {
+    const float4 x_floor = Floor(x);
+    const float4 y_floor = Floor(y);
+
+    float xs[4], ys[4];
+    Store(xs, x_floor);
+    Store(ys, y_floor);
+
+    // Corner values (00, 10, 01, 11), by lane
+    float values[4][4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        const uint32_t x0 = (uint32_t)(int)xs[lane] * PRIME_X;
+        const uint32_t y0 = (uint32_t)(int)ys[lane] * PRIME_Y;
+
+        values[0][lane] = CornerValue(seed, x0, y0, 0);
+        values[1][lane] = CornerValue(seed, x0 + PRIME_X, y0, 0);
+        values[2][lane] = CornerValue(seed, x0, y0 + PRIME_Y, 0);
+        values[3][lane] = CornerValue(seed, x0 + PRIME_X, y0 + PRIME_Y, 0);
+    }
+
+    const float4 u = Fade4(Sub(x, x_floor));
+    const float4 v = Fade4(Sub(y, y_floor));
+
+    const float4 bottom = Lerp4(Load(values[0]), Load(values[1]), u);
+    const float4 top = Lerp4(Load(values[2]), Load(values[3]), u);
+    return Lerp4(bottom, top, v);
+}
+
+// Noise3D4:
+// Evaluates noise3D at 4 points.
+static float4 Noise3D4(uint32_t seed, float4 x, float4 y, float4 z) {
+    const float4 x_floor = Floor(x);
+    const float4 y_floor = Floor(y);
+    const float4 z_floor = Floor(z);
+
+    float xs[4], ys[4], zs[4];
+    Store(xs, x_floor);
+    Store(ys, y_floor);
+    Store(zs, z_floor);
+
+    // Corner values, by lane. Corner c is offset by (c & 1, c & 2, c & 4)
+    // from the cell's origin.
+    float values[8][4];
+
+    for (int lane = 0; lane < 4; lane++) {
+        const uint32_t x0 = (uint32_t)(int)xs[lane] * PRIME_X;
+        const uint32_t y0 = (uint32_t)(int)ys[lane] * PRIME_Y;
+        const uint32_t z0 = (uint32_t)(int)zs[lane] * PRIME_Z;
+
+        for (int corner = 0; corner < 8; corner++) {
+            const uint32_t xc = (corner & 1) ? x0 + PRIME_X : x0;
+            const uint32_t yc = (corner & 2) ? y0 + PRIME_Y : y0;
+            const uint32_t zc = (corner & 4) ? z0 + PRIME_Z : z0;
+            values[corner][lane] = CornerValue(seed, xc, yc, zc);
+        }
+    }
+
+    const float4 u = Fade4(Sub(x, x_floor));
+    const float4 v = Fade4(Sub(y, y_floor));
+    const float4 w = Fade4(Sub(z, z_floor));
+
+    const float4 front =
+        Lerp4(Lerp4(Load(values[0]), Load(values[1]), u),
+              Lerp4(Load(values[2]), Load(values[3]), u), v);
+    const float4 back =
+        Lerp4(Lerp4(Load(values[4]), Load(values[5]), u),
+              Lerp4(Load(values[6]), Load(values[7]), u), v);
+    return Lerp4(front, back, w);
+}
+
+void ValueNoise::noise2D(const float* x, const float* y, float* output,
+                         size_t count) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 value =
+            Noise2D4(mSeed, LoadPartial(x + i, n), LoadPartial(y + i, n));
+        StorePartial(output + i, value, n);
+    }
+}
+
+void ValueNoise::noise3D(const float* x, const float* y, const float* z,
+                         float* output, size_t count) const {
+    for (size_t i = 0; i < count; i += 4) {
+        const size_t n = count - i;
+        const float4 value = Noise3D4(mSeed, LoadPartial(x + i, n),
+                                      LoadPartial(y + i, n),
+                                      LoadPartial(z + i, n));
+        StorePartial(output + i, value, n);
+    }
+}
+
+} // namespace Math
+} // namespace Engine
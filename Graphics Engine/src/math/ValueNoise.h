@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Noise.h"
+
+namespace Engine {
+namespace Math {
+// ValueNoise Class:
+// The cheapest coherent noise. Each grid corner is given a random value
+// (instead of a gradient), and the values are smoothly interpolated. It is
+// blockier than gradient noise, with visible axis-aligned features, but
+// needs no dot products.
+class ValueNoise final : public Noise {
+  private:
+    uint32_t mSeed;
+
+  public:
+    ValueNoise();
+    ValueNoise(unsigned int seed);
+
+    NoiseType type() const override;
+    void seed(unsigned int seed) override;
+
+    float noise2D(float x, float y) const override;
+    float noise3D(float x, float y, float z) const override;
+
+    void noise2D(const float* x, const float* y, float* output,
+                 size_t count) const override;
+    void noise3D(const float* x, const float* y, const float* z,
+                 float* output, size_t count) const override;
+};
+
+} // namespace Math
+} // namespace Engine
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stdint.h>
+
+#include <bit>
 #include <functional>
 
 #include "Vector2.h"
@@ -93,9 +96,10 @@ class Vector3 {
 template <> struct std::hash<Engine::Math::Vector3> {
     std::size_t operator()(const Engine::Math::Vector3& k) const {
         // https://stackoverflow.com/questions/5928725/hashing-2d-3d-and-nd-vectors
-        uint32_t hash = std::_Bit_cast<uint32_t, float>(k.x) * 73856093 ^
-                        std::_Bit_cast<uint32_t, float>(k.y) * 19349663 ^
-                        std::_Bit_cast<uint32_t, float>(k.z) * 83492791;
+        // Adding 0 maps -0 to +0, as they compare equal.
+        uint32_t hash = std::bit_cast<uint32_t>(k.x + 0.f) * 73856093 ^
+                        std::bit_cast<uint32_t>(k.y + 0.f) * 19349663 ^
+                        std::bit_cast<uint32_t>(k.z + 0.f) * 83492791;
 
         return hash % SIZE_MAX;
     }
@@ -0,0 +1,31 @@
+#include "PhysicsInput.h"
+
+#include "input/InputState.h"
+
+namespace Engine {
+namespace Physics {
+PhysicsInput::PhysicsInput() {
+    symbols = 0;
+    device_x = device_y = 0.f;
+}
+
+bool PhysicsInput::isSymbolActive(InputSymbol symbol) const {
+    return (symbols >> symbol) & 1;
+}
+
+PhysicsInput PhysicsInput::Capture() {
+    PhysicsInput input;
+
+    for (int i = 0; i < SymbolCount; i++) {
+        if (InputState::IsSymbolActive((InputSymbol)i))
+            input.symbols |= uint64_t(1) << i;
+    }
+
+    input.device_x = InputState::DeviceXCoordinate();
+    input.device_y = InputState::DeviceYCoordinate();
+
+    return input;
+}
+
+} // namespace Physics
+} // namespace Engine
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "input/SymbolData.h"
+
+namespace Engine {
+using namespace Input;
+
+namespace Physics {
+// PhysicsInput Struct:
+// Snapshot of the input the physics system consumes in a frame. Physics
+// objects read input from this instead of the live InputState, so that
+// recorded input can be fed back in during a replay.
+struct PhysicsInput {
+    uint64_t symbols; // Bit i is set if InputSymbol i is active
+    float device_x, device_y;
+
+    PhysicsInput();
+
+    bool isSymbolActive(InputSymbol symbol) const;
+
+    // Capture the current state of the InputState
+    static PhysicsInput Capture();
+};
+static_assert(SymbolCount <= 64);
+
+} // namespace Physics
+} // namespace Engine
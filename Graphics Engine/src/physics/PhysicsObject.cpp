@@ -1,42 +1,86 @@
 #include "PhysicsObject.h"
 
-#include "input/InputState.h"
-
 namespace Engine {
-using namespace Input;
 namespace Physics {
 PhysicsObject::PhysicsObject(Object* _object) : DMBinding(_object) {
     acceleration = Vector3(0, 0, 0);
     velocity = Vector3(0, 0, 0);
 
     collider = nullptr;
+    input_enabled = true;
+    ccd_enabled = false;
+
+    prev_x = prev_y = 0.f;
 }
 PhysicsObject::~PhysicsObject() = default;
 
+static bool TransformsEqual(const Transform& a, const Transform& b) {
+    const Quaternion& rot_a = a.getRotation();
+    const Quaternion& rot_b = b.getRotation();
+
+    return a.getPosition() == b.getPosition() &&
+           rot_a.getIm() == rot_b.getIm() && rot_a.getR() == rot_b.getR() &&
+           a.getScale() == b.getScale();
+}
+
+// PullDatamodelDataImpl:
+// The datamodel holds the interpolated transform we last pushed, so the
+// physics state is only overwritten if the object was moved by something other
+// than the physics system. The collider file is only pulled here; the system
+// rebinds the collider when it changes. Flags are pulled as they are.
 void PhysicsObject::pullDatamodelDataImpl(Object* _object) {
-    transform = _object->getTransform();
+    const Transform& dm_transform = _object->getTransform();
+
+    if (!TransformsEqual(dm_transform, pushed_transform)) {
+        transform = dm_transform;
+        prev_transform = dm_transform;
+    }
+
+    DMPhysics* dm_physics = static_cast<DMPhysics*>(_object);
+    dm_collider_file = dm_physics->getColliderFile();
+    input_enabled = dm_physics->isInputEnabled();
+    ccd_enabled = dm_physics->isContinuousCollision();
+
     object = _object;
 }
-void PhysicsObject::push() { object->getTransform() = transform; }
 
-void PhysicsObject::pollInput() {
-    // Poll the input system for the status of the WASDQE keys.
+// Push:
+// Pushes the transform to the datamodel, interpolated between the previous
+// and current physics step.
+void PhysicsObject::push(float alpha) {
+    Transform& dm_transform = object->getTransform();
+
+    dm_transform = transform;
+    dm_transform.setPosition(Vector3::Lerp(prev_transform.getPosition(),
+                                           transform.getPosition(), alpha));
+    dm_transform.setRotation(Quaternion::Slerp(
+        prev_transform.getRotation(), transform.getRotation(), alpha));
+
+    pushed_transform = dm_transform;
+}
+
+void PhysicsObject::storePreviousState() { prev_transform = transform; }
+
+void PhysicsObject::pollInput(const PhysicsInput& input) {
+    // Check the input for the status of the WASDQE keys.
     // Use this to form a movement vector indicating the direction
     // to move in.
     Vector3 movementVector = Vector3(0, 0, 0);
 
-    if (InputState::IsSymbolActive(KEY_W))
-        movementVector += transform.forward();
-    if (InputState::IsSymbolActive(KEY_S))
-        movementVector += transform.backward();
-    if (InputState::IsSymbolActive(KEY_A))
-        movementVector += transform.left();
-    if (InputState::IsSymbolActive(KEY_D))
-        movementVector += transform.right();
-    if (InputState::IsSymbolActive(KEY_Q))
-        movementVector += transform.down();
-    if (InputState::IsSymbolActive(KEY_E))
-        movementVector += transform.up();
+    if (input_enabled) {
+        if (input.isSymbolActive(KEY_W))
+            movementVector += transform.forward();
+        if (input.isSymbolActive(KEY_S))
+            movementVector += transform.backward();
+        if (input.isSymbolActive(KEY_A))
+            movementVector += transform.left();
+        if (input.isSymbolActive(KEY_D))
+            movementVector += transform.right();
+        if (input.isSymbolActive(KEY_Q))
+            movementVector += transform.down();
+        if (input.isSymbolActive(KEY_E))
+            movementVector += transform.up();
+    }
 
     // This movement vector determines our acceleration.
     constexpr float ACCELERATION = 20.0f;
@@ -52,10 +96,10 @@ void PhysicsObject::pollInput() {
     }
 
     // Then, handle camera rotation movement.
-    const float new_pos_x = InputState::DeviceXCoordinate();
-    const float new_pos_y = InputState::DeviceYCoordinate();
+    const float new_pos_x = input.device_x;
+    const float new_pos_y = input.device_y;
 
-    if (InputState::IsSymbolActive(DEVICE_ALT_INTERACT)) {
+    if (input_enabled && input.isSymbolActive(DEVICE_ALT_INTERACT)) {
         const float x_delta = new_pos_x - prev_x;
         const float y_delta = prev_y - new_pos_y;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "datamodel/objects/DMPhysics.h"
 #include "datamodel/DMBinding.h"
 
@@ -9,6 +11,8 @@
 #include "collisions/GJKSupport.h"
 #include "math/Vector3.h"
 
+#include "PhysicsInput.h"
+
 namespace Engine {
 using namespace Datamodel;
 using namespace Math;
@@ -23,12 +27,29 @@ class PhysicsObject : public DMBinding {
   protected:
     Object* object; // HACKY
 
+    // Transform at the current and previous physics step. The transform
+    // pushed to the datamodel is interpolated between the two.
     Transform transform;
+    Transform prev_transform;
+    // Last transform pushed, used to detect changes made to the
+    // object outside of the physics system.
+    Transform pushed_transform;
 
     Vector3 acceleration;
     Vector3 velocity;
 
     CollisionObject* collider;
+    // Mesh file the collider was decomposed from, and the file last pulled
+    // from the datamodel. The system rebinds the collider when they differ.
+    std::string collider_file;
+    std::string dm_collider_file;
+
+    // If disabled, the object ignores input, but its velocity still decays
+    bool input_enabled;
+
+    // If enabled, the object uses continuous collision detection, so that it
+    // does not tunnel through thin colliders when moving quickly.
+    bool ccd_enabled;
 
     Quaternion xRotation; // Left-Right Rotation (Z-Axis)
     Quaternion yRotation; // Up-Down Rotation (Y-Axis)
@@ -42,9 +63,12 @@ class PhysicsObject : public DMBinding {
 
     // Pull and push data from this component
     // and the datamodel.
-    void push();
+    // Alpha in [0,1] interpolates between the previous and current step.
+    void push(float alpha);
+
+    void storePreviousState();
 
-    void pollInput();
+    void pollInput(const PhysicsInput& input);
     void applyVelocity(float delta_time);
     void applyAcceleration(float delta_time);
 };
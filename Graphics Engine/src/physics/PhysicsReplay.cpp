@@ -0,0 +1,314 @@
+#include "PhysicsReplay.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "utility/Stopwatch.h"
+
+namespace Engine {
+using namespace Utility;
+
+namespace Physics {
+constexpr uint32_t kLogMagic = 0x53594850; // "PHYS"
+constexpr uint32_t kLogVersion = 4;
+
+// Binary Serialization:
+// Values are written in the host's byte order, one field at a time.
+template <typename T> static void Write(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+template <typename T> static bool Read(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return bool(in);
+}
+
+// BytesLeft:
+// Returns the number of bytes between the read position and the end of the
+// stream. Counts read from a file are checked against it before anything is
+// allocated for them, so that a corrupt file can't request huge buffers.
+static size_t BytesLeft(std::istream& in) {
+    const std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(position);
+    return size_t(end - position);
+}
+
+static void WriteVector3(std::ostream& out, const Vector3& v) {
+    Write(out, v.x);
+    Write(out, v.y);
+    Write(out, v.z);
+}
+static bool ReadVector3(std::istream& in, Vector3& v) {
+    return Read(in, v.x) && Read(in, v.y) && Read(in, v.z);
+}
+
+static void WriteQuaternion(std::ostream& out, const Quaternion& q) {
+    WriteVector3(out, q.getIm());
+    Write(out, q.getR());
+}
+static bool ReadQuaternion(std::istream& in, Quaternion& q) {
+    Vector3 im;
+    float r;
+    if (!ReadVector3(in, im) || !Read(in, r))
+        return false;
+    q = Quaternion(im, r);
+    return true;
+}
+
+static void WriteBody(std::ostream& out, const PhysicsBodyState& body) {
+    WriteVector3(out, body.position);
+    WriteQuaternion(out, body.rotation);
+    WriteVector3(out, body.scale);
+    WriteVector3(out, body.velocity);
+    WriteVector3(out, body.acceleration);
+    WriteQuaternion(out, body.x_rotation);
+    WriteQuaternion(out, body.y_rotation);
+    Write(out, body.prev_x);
+    Write(out, body.prev_y);
+    Write(out, uint8_t(body.input_enabled));
+    Write(out, uint8_t(body.ccd_enabled));
+
+    Write(out, uint32_t(body.hulls.size()));
+    for (const std::vector<Vector3>& hull : body.hulls) {
+        Write(out, uint32_t(hull.size()));
+        for (const Vector3& point : hull)
+            WriteVector3(out, point);
+    }
+}
+// Bytes written for a body with no hulls: 4 vectors, 3 quaternions, the
+// previous mouse position, 2 flags and the hull count
+constexpr size_t kBodyBytes = 4 * 3 * sizeof(float) + 3 * 4 * sizeof(float) +
+                              2 * sizeof(float) + 2 * sizeof(uint8_t) +
+                              sizeof(uint32_t);
+
+static bool ReadBody(std::istream& in, PhysicsBodyState& body) {
+    uint8_t input_enabled, ccd_enabled;
+    uint32_t num_hulls;
+
+    const bool success =
+        ReadVector3(in, body.position) && ReadQuaternion(in, body.rotation) &&
+        ReadVector3(in, body.scale) && ReadVector3(in, body.velocity) &&
+        ReadVector3(in, body.acceleration) &&
+        ReadQuaternion(in, body.x_rotation) &&
+        ReadQuaternion(in, body.y_rotation) && Read(in, body.prev_x) &&
+        Read(in, body.prev_y) && Read(in, input_enabled) &&
+        Read(in, ccd_enabled) && Read(in, num_hulls);
+    if (!success)
+        return false;
+
+    body.input_enabled = input_enabled != 0;
+    body.ccd_enabled = ccd_enabled != 0;
+
+    if (num_hulls > BytesLeft(in) / sizeof(uint32_t))
+        return false;
+
+    body.hulls.resize(num_hulls);
+    for (std::vector<Vector3>& hull : body.hulls) {
+        uint32_t hull_size;
+        if (!Read(in, hull_size) ||
+            hull_size > BytesLeft(in) / (3 * sizeof(float)))
+            return false;
+
+        hull.resize(hull_size);
+        for (Vector3& point : hull) {
+            if (!ReadVector3(in, point))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Read:
+// Loads a log from a file. Returns false if the file could not be opened, is
+// not a physics log, or is cut off before its first frame.
+bool PhysicsLog::read(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    uint32_t magic, version, num_bodies;
+    uint8_t terrain;
+    const bool success =
+        Read(file, magic) && magic == kLogMagic && Read(file, version) &&
+        version == kLogVersion && Read(file, step_size) &&
+        Read(file, max_substeps) && Read(file, accumulator) &&
+        Read(file, seed) && Read(file, terrain) &&
+        Read(file, terrain_origin.x) && Read(file, terrain_origin.y) &&
+        Read(file, terrain_extents.x) && Read(file, terrain_extents.y) &&
+        Read(file, terrain_samples);
+    if (!success)
+        return false;
+
+    has_terrain = terrain != 0;
+
+    terrain_heights.clear();
+    if (terrain_samples < 0)
+        return false;
+
+    if (terrain_samples > 0) {
+        const size_t num_heights = (size_t)terrain_samples * terrain_samples;
+        if (num_heights > BytesLeft(file) / sizeof(float))
+            return false;
+
+        terrain_heights.resize(num_heights);
+        file.read(reinterpret_cast<char*>(terrain_heights.data()),
+                  terrain_heights.size() * sizeof(float));
+        if (!file)
+            return false;
+    }
+
+    if (!Read(file, num_bodies) || num_bodies > BytesLeft(file) / kBodyBytes)
+        return false;
+
+    bodies.resize(num_bodies);
+    for (PhysicsBodyState& body : bodies) {
+        if (!ReadBody(file, body))
+            return false;
+    }
+
+    // Frames run until the end of the file. A partially written frame (if the
+    // recording was cut off) is dropped.
+    frames.clear();
+
+    Frame frame;
+    while (Read(file, frame.delta_time) && Read(file, frame.input.symbols) &&
+           Read(file, frame.input.device_x) &&
+           Read(file, frame.input.device_y) &&
+           Read(file, frame.terrain_origin.x) &&
+           Read(file, frame.terrain_origin.y)) {
+        frames.push_back(frame);
+    }
+
+    return true;
+}
+
+PhysicsRecorder::PhysicsRecorder() = default;
+PhysicsRecorder::~PhysicsRecorder() = default;
+
+// Open:
+// Opens the file and writes the log header and initial bodies to it.
+bool PhysicsRecorder::open(const std::string& path, const PhysicsLog& header) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    Write(file, kLogMagic);
+    Write(file, kLogVersion);
+    Write(file, header.step_size);
+    Write(file, header.max_substeps);
+    Write(file, header.accumulator);
+    Write(file, header.seed);
+    Write(file, uint8_t(header.has_terrain));
+    Write(file, header.terrain_origin.x);
+    Write(file, header.terrain_origin.y);
+    Write(file, header.terrain_extents.x);
+    Write(file, header.terrain_extents.y);
+    Write(file, header.terrain_samples);
+    file.write(reinterpret_cast<const char*>(header.terrain_heights.data()),
+               header.terrain_heights.size() * sizeof(float));
+
+    Write(file, uint32_t(header.bodies.size()));
+    for (const PhysicsBodyState& body : header.bodies)
+        WriteBody(file, body);
+
+    return bool(file);
+}
+
+void PhysicsRecorder::recordFrame(float delta_time, const PhysicsInput& input,
+                                  const Vector2& terrain_origin) {
+    Write(file, delta_time);
+    Write(file, input.symbols);
+    Write(file, input.device_x);
+    Write(file, input.device_y);
+    Write(file, terrain_origin.x);
+    Write(file, terrain_origin.y);
+}
+
+void PhysicsReplayResult::print(FILE* out) const {
+    const unsigned int steps = timings.num_steps > 0 ? timings.num_steps : 1;
+    auto printPhase = [out, steps](const char* name, double seconds) {
+        fprintf(out, "  %-12s %10.3f ms total %10.3f us / step\n", name,
+                seconds * 1000.0, seconds * 1000000.0 / steps);
+    };
+
+    fprintf(out, "Physics Replay: %zu bodies, %zu frames, %u steps\n",
+            num_bodies, num_frames, timings.num_steps);
+    printPhase("Broadphase", timings.broadphase);
+    printPhase("Narrowphase", timings.narrowphase);
+    printPhase("Solve", timings.solve);
+    printPhase("Integrate", timings.integrate);
+    fprintf(out, "  %-12s %10.3f ms\n", "Total", total_seconds * 1000.0);
+    fprintf(out, "  Final State: %08x%08x%08x%08x\n", final_state[0],
+            final_state[1], final_state[2], final_state[3]);
+}
+
+PhysicsReplay::PhysicsReplay() = default;
+PhysicsReplay::~PhysicsReplay() = default;
+
+bool PhysicsReplay::load(const std::string& path) { return log.read(path); }
+const PhysicsLog& PhysicsReplay::getLog() const { return log; }
+
+// Run:
+// Re-executes the log. The recorded seed is restored, and each frame is
+// simulated with its recorded time and input, so the run is deterministic.
+// The random generator's state is put back afterwards, so a replay run in
+// the engine does not change the game's random sequence.
+PhysicsReplayResult PhysicsReplay::run(const HeightSampler& terrain_sampler) {
+    const std::mt19937 random_state = GetRandomState();
+    SeedRandom(log.seed);
+
+    PhysicsSystem system(true);
+    HeightfieldCollider* terrain = nullptr;
+    system.step_size = log.step_size;
+    system.setMaxSubsteps(log.max_substeps);
+    system.accumulator = log.accumulator;
+
+    if (log.has_terrain) {
+        assert(terrain_sampler != nullptr);
+
+        terrain = system.bindTerrain(terrain_sampler);
+        if (log.terrain_samples > 0)
+            terrain->loadGrid(log.terrain_origin, log.terrain_extents,
+                              log.terrain_samples, log.terrain_heights.data());
+    }
+
+    system.restoreBodies(log.bodies);
+
+    Stopwatch stopwatch;
+    stopwatch.Reset();
+    for (const PhysicsLog::Frame& frame : log.frames) {
+        if (terrain != nullptr && log.terrain_samples > 0)
+            terrain->updateGrid(frame.terrain_origin, log.terrain_extents,
+                                log.terrain_samples, 0);
+        system.simulate(frame.delta_time, frame.input);
+    }
+
+    PhysicsReplayResult result;
+    result.total_seconds = stopwatch.Duration();
+    result.timings = system.getTimings();
+    result.num_frames = log.frames.size();
+    result.num_bodies = log.bodies.size();
+
+    // Hash the final state of all bodies
+    std::vector<float> state;
+    for (const PhysicsBodyState& body : system.captureBodies()) {
+        const Vector3 vectors[] = {body.position, body.rotation.getIm(),
+                                   body.velocity};
+        for (const Vector3& v : vectors) {
+            state.push_back(v.x);
+            state.push_back(v.y);
+            state.push_back(v.z);
+        }
+        state.push_back(body.rotation.getR());
+    }
+    result.final_state = hashMD5(state.data(), state.size() * sizeof(float));
+
+    SetRandomState(random_state);
+
+    return result;
+}
+
+} // namespace Physics
+} // namespace Engine
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "math/Compute.h"
+#include "math/Quaternion.h"
+#include "math/Vector3.h"
+
+#include "collisions/HeightfieldCollider.h"
+
+#include "PhysicsInput.h"
+#include "PhysicsSystem.h"
+
+namespace Engine {
+using namespace Math;
+
+namespace Physics {
+// PhysicsBodyState Struct:
+// State of a physics body at the start of a recording.
+struct PhysicsBodyState {
+    Vector3 position;
+    Quaternion rotation;
+    Vector3 scale;
+
+    Vector3 velocity;
+    Vector3 acceleration;
+
+    Quaternion x_rotation;
+    Quaternion y_rotation;
+    float prev_x, prev_y;
+
+    bool input_enabled;
+    bool ccd_enabled;
+
+    // Points of each hull of the body's collider. Empty if the body has no
+    // collider.
+    std::vector<std::vector<Vector3>> hulls;
+};
+
+// PhysicsLog Struct:
+// A recorded physics workload. Stored as a compact binary file of
+//   Header: magic, version, step size, max substeps, accumulator, seed,
+//           terrain region and heights
+//   Bodies: count, then one PhysicsBodyState each
+//   Frames: (delta time, input, terrain origin) for every frame until the
+//           end of the file
+struct PhysicsLog {
+    float step_size = 0.f;
+    uint32_t max_substeps = 0;
+    // Time left in the accumulator when the recording began
+    float accumulator = 0.f;
+    uint32_t seed = 0;
+
+    // Terrain. If the terrain grid was cached, its heights are saved, and
+    // the replay starts from the same grid.
+    bool has_terrain = false;
+    Vector2 terrain_origin;
+    Vector2 terrain_extents;
+    int terrain_samples = 0;
+    std::vector<float> terrain_heights;
+
+    std::vector<PhysicsBodyState> bodies;
+
+    struct Frame {
+        float delta_time;
+        PhysicsInput input;
+        // The terrain grid follows the camera. The replay moves its grid to
+        // the same origin before each frame.
+        Vector2 terrain_origin;
+    };
+    std::vector<Frame> frames;
+
+    bool read(const std::string& path);
+};
+
+// PhysicsRecorder Class:
+// Streams a PhysicsLog to a file as the simulation runs.
+class PhysicsRecorder {
+  private:
+    std::ofstream file;
+
+  public:
+    PhysicsRecorder();
+    ~PhysicsRecorder();
+
+    // Writes the log header and bodies. Returns false if the file could not
+    // be opened.
+    bool open(const std::string& path, const PhysicsLog& header);
+    void recordFrame(float delta_time, const PhysicsInput& input,
+                     const Vector2& terrain_origin);
+};
+
+// PhysicsReplayResult Struct:
+// Timings of a replay, and a hash of the final state of all bodies. Two runs of
+// the same log should always produce the same hash.
+struct PhysicsReplayResult {
+    PhysicsTimings timings;
+    double total_seconds = 0.0;
+    size_t num_frames = 0;
+    size_t num_bodies = 0;
+    MD5Hash final_state;
+
+    void print(FILE* out) const;
+};
+
+// PhysicsReplay Class:
+// Headless replay runner. Re-executes a recorded log with a physics system
+// that is not connected to the datamodel, feeding it the recorded frame times
+// and input.
+class PhysicsReplay {
+  private:
+    PhysicsLog log;
+
+  public:
+    PhysicsReplay();
+    ~PhysicsReplay();
+
+    bool load(const std::string& path);
+    const PhysicsLog& getLog() const;
+
+    // Run the replay. If the log was recorded with terrain, a height sampler
+    // must be given for it.
+    PhysicsReplayResult run(const HeightSampler& terrain_sampler = nullptr);
+};
+
+} // namespace Physics
+} // namespace Engine
@@ -1,7 +1,21 @@
 #include "PhysicsSystem.h"
 
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+#include "GlobalConfig.h"
+#include "PhysicsReplay.h"
 #include "collisions/GJK.h"
+#include "collisions/TimeOfImpact.h"
+#include "core/DataFilePath.h"
+#include "math/Compute.h"
+#include "rendering/ImGui.h"
 #include "rendering/VisualDebug.h"
+#include "rendering/resources/files/GLTFFile.h"
 
 namespace Engine {
 using namespace Utility;
@@ -9,24 +23,176 @@ using namespace Utility;
 namespace Physics {
 // Constructor:
 // Initializes relevant fields
-PhysicsSystem::PhysicsSystem() : broadphase_tree(0.2f), stopwatch() {
+PhysicsSystem::PhysicsSystem() : PhysicsSystem(false) {}
+PhysicsSystem::PhysicsSystem(bool headless)
+    : broadphase_tree(0.2f), stopwatch() {
     stopwatch.Reset();
+    delta_time = 0.f;
+
+    accumulator = 0.f;
+    setTickRate(PHYSICS_TICKS_PER_SECOND);
+    setMaxSubsteps(PHYSICS_MAX_SUBSTEPS);
 
-    DMPhysics::ConnectToCreation([this](Object* obj) { onObjectCreate(obj); });
+    terrain = nullptr;
+    recorder = nullptr;
 
-    // terrain = nullptr;
+    if (!headless) {
+        DMPhysics::ConnectToCreation(
+            [this](Object* obj) { onObjectCreate(obj); });
+
+        ImGuiHelper::registerImGuiCallback("Physics/Terrain",
+                                           [this]() { imGuiTerrain(); });
+        ImGuiHelper::registerImGuiCallback("Physics/Replay",
+                                           [this]() { imGuiReplay(); });
+        ImGuiHelper::registerImGuiCallback("Physics/Hulls",
+                                           [this]() { imGuiHulls(); });
+        ImGuiHelper::registerImGuiCallback(
+            "Physics/Decomposition", [this]() { imGuiDecomposition(); });
+    }
+}
+
+// Destructor:
+// Frees all colliders, objects and hulls owned by the system.
+PhysicsSystem::~PhysicsSystem() {
+    endRecording();
+
+    for (PhysicsObject* obj : objects) {
+        if (obj->collider != nullptr) {
+            broadphase_tree.remove(&obj->collider->broadphase_aabb);
+            delete obj->collider;
+        }
+        delete obj;
+    }
+    objects.clear();
+
+    for (const auto& [name, shape] : collision_shapes)
+        delete shape;
+    collision_shapes.clear();
+
+    if (terrain != nullptr)
+        delete terrain;
 }
 
 // AddCollisionHull:
-// Adds a collision hull to the physics engine with a name
+// Adds a collision hull to the physics engine with a name. Points that can't
+// form a hull (too few, or all on one plane) are kept as given, as are points
+// whose hull fails the builder's convexity check.
 void PhysicsSystem::addCollisionHull(const std::string& name,
-                                     const std::vector<Vector3>& points) {
-    CollisionHull* new_hull = new CollisionHull(points);
+                                     const std::vector<Vector3>& points,
+                                     int max_vertices) {
+    QuickHullBuilder::Config config;
+    config.max_vertices = max_vertices;
+
+    if (max_vertices > 0 && hull_builder.build(points, config))
+        addCollisionShape(name, CollisionShape{hull_builder.getVertices()});
+    else
+        addCollisionShape(name, CollisionShape{points});
+}
+
+// DecompositionHash:
+// Key of a mesh's decomposition in the cache, from the mesh and the config
+// it is decomposed with.
+static MD5Hash DecompositionHash(const std::vector<Vector3>& vertices,
+                                 const std::vector<UINT>& indices,
+                                 const ConvexDecomposer::Config& config) {
+    const void* data_arr[3] = {vertices.data(), indices.data(), &config};
+    const size_t byte_size_arr[3] = {vertices.size() * sizeof(Vector3),
+                                     indices.size() * sizeof(UINT),
+                                     sizeof(ConvexDecomposer::Config)};
+    return hashMD5(data_arr, byte_size_arr, 3);
+}
+
+// AddCollisionMesh:
+// Adds a collision shape for a mesh, decomposing it if it isn't cached. If
+// the mesh can't be decomposed (it has no volume), its vertices are used as
+// a single hull.
+int PhysicsSystem::addCollisionMesh(const std::string& name,
+                                    const std::vector<Vector3>& vertices,
+                                    const std::vector<UINT>& indices,
+                                    const ConvexDecomposer::Config& config) {
+    const MD5Hash hash = DecompositionHash(vertices, indices, config);
+
+    auto iter = decomposition_cache.find(hash);
+    if (iter == decomposition_cache.end()) {
+        CollisionShape shape;
+        if (decomposer.decompose(vertices, indices, config)) {
+            for (const std::vector<Vector3>& hull : decomposer.getHulls())
+                shape.push_back(hull);
+        } else
+            shape.push_back(vertices);
+
+        iter = decomposition_cache.emplace(hash, std::move(shape)).first;
+    }
+
+    addCollisionShape(name, iter->second);
+    return int(iter->second.size());
+}
+
+void PhysicsSystem::addCollisionShape(const std::string& name,
+                                      const CollisionShape& shape) {
+    CollisionShape* new_shape = new CollisionShape(shape);
+
+    if (collision_shapes.contains(name))
+        delete collision_shapes[name];
+
+    collision_shapes[name] = new_shape;
+}
+
+// BindTerrain:
+// Bind a heightfield collider for the terrain, which queries heights from the
+// sampler given. Replaces the existing terrain collider, if there is one.
+HeightfieldCollider* PhysicsSystem::bindTerrain(const HeightSampler& sampler) {
+    if (terrain != nullptr)
+        delete terrain;
+    terrain = new HeightfieldCollider(sampler);
+    return terrain;
+}
 
-    if (collision_hulls.contains(name))
-        delete collision_hulls[name];
+// SetTickRate / SetMaxSubsteps:
+// Configure the fixed timestep. The tick rate is the number of physics steps
+// taken per second of simulated time (e.g. 30, 60, 120).
+void PhysicsSystem::setTickRate(unsigned int ticks_per_second) {
+    assert(ticks_per_second > 0);
+    step_size = 1.f / ticks_per_second;
+}
+void PhysicsSystem::setMaxSubsteps(unsigned int _max_substeps) {
+    assert(_max_substeps > 0);
+    max_substeps = _max_substeps;
+}
+
+// BindCollider:
+// Binds a collider to an object, decomposed from a mesh file in data/. Each
+// file is read and decomposed once, and its shape is shared by every object
+// using it. An empty file, or one that can't be read, leaves the object
+// without a collider.
+void PhysicsSystem::bindCollider(PhysicsObject* obj,
+                                 const std::string& mesh_file) {
+    if (obj->collider != nullptr) {
+        broadphase_tree.remove(&obj->collider->broadphase_aabb);
+        delete obj->collider;
+        obj->collider = nullptr;
+    }
+    obj->collider_file = mesh_file;
+
+    if (mesh_file.empty())
+        return;
+
+    const std::string shape_name = "mesh/" + mesh_file;
+    if (!collision_shapes.contains(shape_name)) {
+        std::vector<Vector3> vertices;
+        std::vector<UINT> indices;
+        if (!Graphics::GLTFFile::ReadGLTFPositions(
+                DataFilePath(mesh_file).getFullPath(), vertices, &indices))
+            return;
+
+        addCollisionMesh(shape_name, vertices, indices,
+                         ConvexDecomposer::Config());
+    }
 
-    collision_hulls[name] = new_hull;
+    obj->collider = new CollisionObject(obj, &obj->transform,
+                                        collision_shapes[shape_name]);
+    obj->collider->updateBroadphaseAABB();
+    broadphase_tree.add(&obj->collider->broadphase_aabb);
 }
 
 // Datamodel Handling
@@ -47,7 +213,7 @@ PhysicsSystem::bindCollisionObject(PhysicsObject* phys_obj,
     // Create my collider
     const Transform* obj_transform = &phys_obj->getObject()->getTransform();
     CollisionObject* collider =
-        new CollisionObject(phys_obj, obj_transform, collision_hulls[hull_id]);
+        new CollisionObject(phys_obj, obj_transform, collision_shapes[hull_id]);
 
     // Free previous collider, if it exists
     if (phys_obj->collider != nullptr) {
@@ -78,10 +244,14 @@ void PhysicsSystem::pullDatamodelData() {
     // Remove all PhysicsObjects marked for destruction, and free their memory.
     // objects.cleanAndUpdate();
 
-    // Pull datamodel data
-    for (PhysicsObject* obj : objects)
+    // Pull datamodel data, and rebind colliders whose mesh file changed
+    for (PhysicsObject* obj : objects) {
         obj->pullDatamodelData();
 
+        if (obj->dm_collider_file != obj->collider_file)
+            bindCollider(obj, obj->dm_collider_file);
+    }
+
     // if (terrain != nullptr)
       //  terrain->pullTerrainBVHs();
 
@@ -92,70 +262,861 @@ void PhysicsSystem::pullDatamodelData() {
 }
 
 // Update:
-// Updates the physics for a scene.
+// Updates the physics for a scene. Input is captured once per frame, and
+// recorded if a recording is in progress.
 void PhysicsSystem::update() {
+    const PhysicsInput input = PhysicsInput::Capture();
+
+    if (recorder != nullptr) {
+        Vector2 terrain_origin, terrain_extents;
+        int terrain_samples;
+        if (terrain != nullptr)
+            terrain->getCachedRegion(&terrain_origin, &terrain_extents,
+                                     &terrain_samples);
+        recorder->recordFrame(delta_time, input, terrain_origin);
+    }
+
+    simulate(delta_time, input);
+
+    // DEBUG:
+#if defined(_DEBUG)
+    for (PhysicsObject* obj : objects) {
+        if (obj->collider != nullptr)
+            obj->collider->debugDrawCollider();
+    }
+    broadphase_tree.debugDrawTree();
+#endif
+}
+
+// Simulate:
+// Runs a frame of the simulation. Input is polled once, and the simulation is
+// then advanced in fixed steps for however much time has accumulated.
+// Everything the simulation reads is passed in, so that a replay given the
+// same frame times and input reproduces the same result.
+void PhysicsSystem::simulate(float dt, const PhysicsInput& input) {
     // Poll Input
     for (PhysicsObject* obj : objects)
-        obj->pollInput();
+        obj->pollInput(input);
+
+    accumulator += dt;
+
+    unsigned int num_steps = 0;
+    while (accumulator >= step_size && num_steps < max_substeps) {
+        step(step_size);
+        accumulator -= step_size;
+        num_steps++;
+    }
+
+    // If we hit the substep cap, drop the time we could not simulate so that
+    // a long hitch does not force us to keep catching up on later frames.
+    if (accumulator >= step_size)
+        accumulator = fmodf(accumulator, step_size);
+}
+
+// Step:
+// Advances the simulation by a fixed amount of time. The step is split into
+// phases, each of which is timed.
+void PhysicsSystem::step(float dt) {
+    Stopwatch phase_timer;
+    // Returns the time since the last lap, and starts the next
+    auto lap = [&phase_timer]() {
+        const double duration = phase_timer.Duration();
+        phase_timer.Reset();
+        return duration;
+    };
+    phase_timer.Reset();
+
+    // Integrate (Acceleration):
+    // Save the state at the start of the step, so that the transform pushed
+    // to the datamodel can be interpolated between steps. Then apply
+    // acceleration to all objects. This is done before the broadphase, so
+    // that swept AABBs cover the motion the objects make this step.
+    for (PhysicsObject* obj : objects)
+        obj->storePreviousState();
 
-    // Update all AABBs
+    for (PhysicsObject* object : objects)
+        object->applyAcceleration(dt);
+
+    timings.integrate += lap();
+
+    // Broadphase:
+    // Update all AABBs. Objects using continuous collision sweep their AABB
+    // over the entire step. Then use the dynamic AABB tree to find colliders
+    // whose AABB is colliding.
     for (PhysicsObject* obj : objects) {
-        if (obj->collider != nullptr) {
+        if (obj->collider == nullptr)
+            continue;
+
+        if (obj->ccd_enabled)
+            obj->collider->updateBroadphaseAABB(obj->velocity * dt);
+        else
             obj->collider->updateBroadphaseAABB();
-#if defined(_DEBUG)
-            obj->collider->debugDrawCollider();
-#endif
-        }
     }
 
-    // Collision Broadphase:
-    // Use the dynamic AABB tree to find colliders whose AABB is colliding.
     broadphase_tree.update();
     const std::vector<ColliderPair>& collision_pairs =
         broadphase_tree.computeColliderPairs();
 
-    // DEBUG:
-#if defined(_DEBUG)
-    broadphase_tree.debugDrawTree();
-#endif
+    timings.broadphase += lap();
 
-    // Collision Test:
+    // Narrowphase:
     // For each pair, check that their colliders are actually intersecting.
-    // If they are, then resolve the collision.
+    // Objects are also tested against the terrain.
+    contacts.clear();
+
     for (const ColliderPair& pair : collision_pairs) {
         CollisionObject* c1 = pair.aabb_1->collider;
-        CollisionObject* c2 = pair.aabb_1->collider;
+        CollisionObject* c2 = pair.aabb_2->collider;
+
+        Vector3 penetration;
+        if (c1->computePenetration(c2, &penetration)) {
+            PhysicsContact contact;
+            contact.object_1 = c1->phys_object;
+            contact.object_2 = c2->phys_object;
+            contact.penetration = penetration;
+            contacts.push_back(contact);
+        }
+    }
+
+    if (terrain != nullptr) {
+        for (PhysicsObject* obj : objects) {
+            if (obj->collider == nullptr)
+                continue;
 
-        GJKSolver gjk_solver = GJKSolver(c1, c2);
+            const CollisionAABB& aabb = obj->collider->broadphase_aabb;
+            if (!terrain->overlapsAABB(aabb.getMin(), aabb.getMax()))
+                continue;
 
-        if (gjk_solver.checkIntersection()) {
-            const Vector3 penetration = gjk_solver.penetrationVector();
-            c1->phys_object->velocity += -penetration;
-            c2->phys_object->velocity += penetration;
+            // Each part is tested on its own, as the hull around a concave
+            // shape can touch the terrain where the shape doesn't
+            bool hit = false;
+            HeightfieldContact deepest;
+            deepest.depth = 0.f;
+
+            for (const CollisionPart& part : obj->collider->getParts()) {
+                if (!terrain->overlapsAABB(part.getMin(), part.getMax()))
+                    continue;
+
+                HeightfieldContact terrain_contact;
+                if (terrain->computeContact(&part, &terrain_contact) &&
+                    terrain_contact.depth > deepest.depth) {
+                    deepest = terrain_contact;
+                    hit = true;
+                }
+            }
+
+            if (hit) {
+                PhysicsContact contact;
+                contact.object_1 = obj;
+                contact.object_2 = nullptr;
+                contact.penetration = deepest.normal * deepest.depth;
+                contacts.push_back(contact);
+            }
         }
     }
 
-    // Iterate through and clear
-    // Apply acceleration and velocity to all objects
+    timings.narrowphase += lap();
+
+    // Solve:
+    // Push colliding objects apart. Objects penetrating the terrain are moved
+    // out along the terrain normal, and their velocity into the terrain is
+    // removed.
+    for (const PhysicsContact& contact : contacts) {
+        if (contact.object_2 != nullptr) {
+            contact.object_1->velocity += -contact.penetration;
+            contact.object_2->velocity += contact.penetration;
+        } else {
+            PhysicsObject* obj = contact.object_1;
+            obj->transform.offsetPosition(contact.penetration);
+
+            const Vector3 normal = contact.penetration.unit();
+            const float into_surface = obj->velocity.dot(normal);
+            if (into_surface < 0.f)
+                obj->velocity -= normal * into_surface;
+        }
+    }
+
+    timings.solve += lap();
+
+    // Integrate (Velocity):
+    // Apply velocity to all objects. Objects using continuous collision are
+    // integrated last, against the end-of-step positions of everything else.
     for (PhysicsObject* object : objects) {
-        object->applyAcceleration(delta_time);
-        object->applyVelocity(delta_time);
+        if (!object->ccd_enabled || object->collider == nullptr)
+            object->applyVelocity(dt);
     }
+
+    for (PhysicsObject* object : objects) {
+        if (object->ccd_enabled && object->collider != nullptr)
+            integrateContinuous(object, collision_pairs, dt);
+    }
+
+    timings.integrate += lap();
+    timings.num_steps++;
+}
+
+// IntegrateContinuous:
+// Moves an object by its velocity with continuous collision detection. We
+// find the earliest time of impact against every collider its swept AABB
+// overlaps, advance the object to that time, and remove the velocity into
+// the surface hit. The remainder of the step is then sub-stepped the same way,
+// so only objects using CCD pay for the extra steps.
+void PhysicsSystem::integrateContinuous(
+    PhysicsObject* object, const std::vector<ColliderPair>& collision_pairs,
+    float dt) {
+    constexpr int MAX_CCD_SUBSTEPS = 4;
+
+    CollisionObject* collider = object->collider;
+    float remaining = dt;
+
+    for (int i = 0; i < MAX_CCD_SUBSTEPS && remaining > 0.f; i++) {
+        const Vector3 displacement = object->velocity * remaining;
+
+        bool hit = false;
+        TimeOfImpact earliest;
+        earliest.time = 1.f;
+
+        for (const ColliderPair& pair : collision_pairs) {
+            CollisionObject* other = nullptr;
+            if (pair.aabb_1->collider == collider)
+                other = pair.aabb_2->collider;
+            else if (pair.aabb_2->collider == collider)
+                other = pair.aabb_1->collider;
+            else
+                continue;
+
+            TimeOfImpact toi;
+            if (collider->computeTimeOfImpact(other, displacement, &toi) &&
+                toi.time < earliest.time) {
+                earliest = toi;
+                hit = true;
+            }
+        }
+
+        if (!hit)
+            break;
+
+        object->applyVelocity(remaining * earliest.time);
+        remaining *= 1.f - earliest.time;
+
+        const float into_surface = object->velocity.dot(earliest.normal);
+        if (into_surface < 0.f)
+            object->velocity -= earliest.normal * into_surface;
+    }
+
+    // The time left, if nothing was hit or the substeps ran out, is spent
+    // moving with the velocity left after the hits
+    object->applyVelocity(remaining);
 }
 
 // PushDatamodelData:
-// Pushes data to the datamodel.
+// Pushes data to the datamodel. Because the simulation runs on a fixed
+// timestep, we are generally partway between two steps. The pushed transforms
+// are interpolated by how far into the next step we are.
 void PhysicsSystem::pushDatamodelData() {
+    const float alpha = accumulator / step_size;
+
     for (PhysicsObject* obj : objects)
-        obj->push();
+        obj->push(alpha);
 }
 
-/*
-BVHRayCast PhysicsSystem::raycast(const Vector3& origin,
-                                  const Vector3& direction) {
-    // return terrain->getTerrainTLS().raycast(origin, direction);
+// Raycast:
+// Raycast into the scene. Currently only tests against the terrain.
+HeightfieldRayCast PhysicsSystem::raycast(const Vector3& origin,
+                                          const Vector3& direction,
+                                          float max_distance) {
+    if (terrain == nullptr) {
+        HeightfieldRayCast result;
+        result.hit = false;
+        return result;
+    }
+
+    return terrain->raycast(origin, direction, max_distance);
+}
+
+// CaptureBodies:
+// Captures the state of all bodies, so that it can be recorded.
+std::vector<PhysicsBodyState> PhysicsSystem::captureBodies() const {
+    std::vector<PhysicsBodyState> bodies;
+    bodies.reserve(objects.size());
+
+    for (const PhysicsObject* obj : objects) {
+        PhysicsBodyState body;
+        body.position = obj->transform.getPosition();
+        body.rotation = obj->transform.getRotation();
+        body.scale = obj->transform.getScale();
+        body.velocity = obj->velocity;
+        body.acceleration = obj->acceleration;
+        body.x_rotation = obj->xRotation;
+        body.y_rotation = obj->yRotation;
+        body.prev_x = obj->prev_x;
+        body.prev_y = obj->prev_y;
+        body.input_enabled = obj->input_enabled;
+        body.ccd_enabled = obj->ccd_enabled;
+
+        if (obj->collider != nullptr)
+            body.hulls = *obj->collider->collision_shape;
+
+        bodies.push_back(body);
+    }
+
+    return bodies;
+}
+
+// RestoreBodies:
+// Creates a body for each state given. The bodies are not bound to the
+// datamodel, so this should only be used on headless systems.
+void PhysicsSystem::restoreBodies(const std::vector<PhysicsBodyState>& bodies) {
+    for (size_t i = 0; i < bodies.size(); i++) {
+        const PhysicsBodyState& body = bodies[i];
+
+        PhysicsObject* obj = new PhysicsObject(nullptr);
+        obj->transform.setPosition(body.position);
+        obj->transform.setRotation(body.rotation);
+        obj->transform.setScale(body.scale);
+        obj->prev_transform = obj->transform;
+        obj->pushed_transform = obj->transform;
+
+        obj->velocity = body.velocity;
+        obj->acceleration = body.acceleration;
+        obj->xRotation = body.x_rotation;
+        obj->yRotation = body.y_rotation;
+        obj->prev_x = body.prev_x;
+        obj->prev_y = body.prev_y;
+        obj->input_enabled = body.input_enabled;
+        obj->ccd_enabled = body.ccd_enabled;
+
+        if (!body.hulls.empty()) {
+            const std::string shape_name = "replay/" + std::to_string(i);
+            addCollisionShape(shape_name, body.hulls);
+
+            obj->collider = new CollisionObject(obj, &obj->transform,
+                                                collision_shapes[shape_name]);
+            obj->collider->updateBroadphaseAABB();
+            broadphase_tree.add(&obj->collider->broadphase_aabb);
+        }
+
+        objects.push_back(obj);
+    }
+}
+
+// BeginRecording:
+// Starts recording the simulation to a file. The random generator is seeded
+// so that the replay sees the same random values.
+bool PhysicsSystem::beginRecording(const std::string& path, uint32_t seed) {
+    endRecording();
+
+    PhysicsLog header;
+    header.step_size = step_size;
+    header.max_substeps = max_substeps;
+    header.accumulator = accumulator;
+    header.seed = seed;
+
+    header.has_terrain = terrain != nullptr;
+    if (terrain != nullptr &&
+        terrain->getCachedRegion(&header.terrain_origin,
+                                 &header.terrain_extents,
+                                 &header.terrain_samples))
+        header.terrain_heights = terrain->getCachedHeights();
+
+    header.bodies = captureBodies();
+
+    recorder = new PhysicsRecorder();
+    if (!recorder->open(path, header)) {
+        delete recorder;
+        recorder = nullptr;
+        return false;
+    }
+
+    SeedRandom(seed);
+    return true;
+}
+
+void PhysicsSystem::endRecording() {
+    if (recorder != nullptr) {
+        delete recorder;
+        recorder = nullptr;
+    }
+}
+
+bool PhysicsSystem::isRecording() const { return recorder != nullptr; }
+
+const PhysicsTimings& PhysicsSystem::getTimings() const { return timings; }
+void PhysicsSystem::resetTimings() { timings = PhysicsTimings(); }
+
+#if defined(IMGUI_ENABLED)
+// TerrainBenchmark:
+// Compares the heightfield collider against the previous terrain collision
+// design, which triangulated the terrain into a BVH. Both are built over the
+// same grid of heights, and the same set of rays is cast against both.
+struct TerrainBenchmark {
+    int num_samples = 0;
+    int num_rays = 0;
+
+    size_t heightfield_bytes = 0;
+    size_t bvh_bytes = 0;
+
+    double heightfield_build_ms = 0.0;
+    double bvh_build_ms = 0.0;
+
+    double heightfield_ray_us = 0.0;
+    double bvh_ray_us = 0.0;
+
+    int heightfield_hits = 0;
+    int bvh_hits = 0;
+};
+
+static TerrainBenchmark RunTerrainBenchmark(const HeightSampler& sampler) {
+    constexpr int NUM_SAMPLES = 257;
+    constexpr int NUM_RAYS = 1000;
+    constexpr float EXTENTS = 1000.f;
+    constexpr float RAY_HEIGHT = 1000.f;
+
+    TerrainBenchmark results;
+    results.num_samples = NUM_SAMPLES;
+    results.num_rays = NUM_RAYS;
+
+    const Vector2 origin = Vector2(-EXTENTS / 2, -EXTENTS / 2);
+    const float spacing = EXTENTS / (NUM_SAMPLES - 1);
+
+    Stopwatch stopwatch;
+
+    // Build the heightfield
+    stopwatch.Reset();
+    HeightfieldCollider heightfield = HeightfieldCollider(sampler);
+    heightfield.cacheGrid(origin, Vector2(EXTENTS, EXTENTS), NUM_SAMPLES);
+    results.heightfield_build_ms = stopwatch.Duration() * 1000.0;
+    results.heightfield_bytes = heightfield.memoryUsage();
+
+    // Build the BVH, using the heightfield's samples so that both represent
+    // the same surface.
+    stopwatch.Reset();
+    Datamodel::BVH bvh;
+    for (int x = 0; x < NUM_SAMPLES - 1; x++) {
+        for (int z = 0; z < NUM_SAMPLES - 1; z++) {
+            const float x0 = origin.x + x * spacing;
+            const float z0 = origin.y + z * spacing;
+            const float x1 = x0 + spacing;
+            const float z1 = z0 + spacing;
+
+            const Vector3 a = Vector3(x0, heightfield.sampleHeight(x0, z0), z0);
+            const Vector3 b = Vector3(x1, heightfield.sampleHeight(x1, z0), z0);
+            const Vector3 c = Vector3(x1, heightfield.sampleHeight(x1, z1), z1);
+            const Vector3 d = Vector3(x0, heightfield.sampleHeight(x0, z1), z1);
+
+            bvh.addBVHTriangle(Triangle(a, d, b), nullptr);
+            bvh.addBVHTriangle(Triangle(c, b, d), nullptr);
+        }
+    }
+    bvh.build();
+    results.bvh_build_ms = stopwatch.Duration() * 1000.0;
+
+    const size_t num_triangles = 2 * (NUM_SAMPLES - 1) * (NUM_SAMPLES - 1);
+    results.bvh_bytes =
+        sizeof(Datamodel::BVH) + bvh.size() * sizeof(Datamodel::BVHNode) +
+        num_triangles * (sizeof(Datamodel::BVHTriangle) + sizeof(UINT));
+
+    // Generate rays pointing down onto the terrain
+    std::mt19937 generator = std::mt19937(0);
+    std::uniform_real_distribution<float> position_dist(-EXTENTS / 4,
+                                                        EXTENTS / 4);
+    std::uniform_real_distribution<float> tilt_dist(-0.5f, 0.5f);
+
+    std::vector<Vector3> origins, directions;
+    for (int i = 0; i < NUM_RAYS; i++) {
+        const float x = position_dist(generator);
+        const float z = position_dist(generator);
+        origins.push_back(Vector3(x, RAY_HEIGHT, z));
+        directions.push_back(
+            Vector3(tilt_dist(generator), -1.f, tilt_dist(generator)).unit());
+    }
+
+    // Time the ray casts
+    stopwatch.Reset();
+    for (int i = 0; i < NUM_RAYS; i++) {
+        if (heightfield.raycast(origins[i], directions[i], 2 * RAY_HEIGHT).hit)
+            results.heightfield_hits++;
+    }
+    results.heightfield_ray_us = stopwatch.Duration() * 1000000.0 / NUM_RAYS;
+
+    stopwatch.Reset();
+    for (int i = 0; i < NUM_RAYS; i++) {
+        if (bvh.raycast(origins[i], directions[i]).hit)
+            results.bvh_hits++;
+    }
+    results.bvh_ray_us = stopwatch.Duration() * 1000000.0 / NUM_RAYS;
+
+    return results;
+}
+#endif
+
+void PhysicsSystem::imGuiTerrain() {
+#if defined(IMGUI_ENABLED)
+    if (terrain == nullptr) {
+        ImGui::Text("No terrain bound");
+        return;
+    }
+
+    ImGui::Text("Heightfield Memory: %zu KB", terrain->memoryUsage() / 1024);
+
+    static TerrainBenchmark benchmark;
+    if (ImGui::Button("Benchmark Heightfield vs BVH"))
+        benchmark = RunTerrainBenchmark(
+            [this](float x, float z) { return terrain->sampleHeight(x, z); });
+
+    if (benchmark.num_rays > 0) {
+        ImGui::SeparatorText("Benchmark");
+        ImGui::Text("%i x %i samples, %i rays", benchmark.num_samples,
+                    benchmark.num_samples, benchmark.num_rays);
+        ImGui::Text("Heightfield: %zu KB, build %.2f ms, %.2f us / ray, "
+                    "%i hits",
+                    benchmark.heightfield_bytes / 1024,
+                    benchmark.heightfield_build_ms,
+                    benchmark.heightfield_ray_us, benchmark.heightfield_hits);
+        ImGui::Text("BVH: %zu KB, build %.2f ms, %.2f us / ray, %i hits",
+                    benchmark.bvh_bytes / 1024, benchmark.bvh_build_ms,
+                    benchmark.bvh_ray_us, benchmark.bvh_hits);
+    }
+#endif
+}
+
+#if defined(IMGUI_ENABLED)
+static void ImGuiTimings(const PhysicsTimings& timings) {
+    const unsigned int steps = timings.num_steps > 0 ? timings.num_steps : 1;
+
+    ImGui::Text("%u steps", timings.num_steps);
+    ImGui::Text("Broadphase: %.2f ms (%.2f us / step)",
+                timings.broadphase * 1000.0,
+                timings.broadphase * 1000000.0 / steps);
+    ImGui::Text("Narrowphase: %.2f ms (%.2f us / step)",
+                timings.narrowphase * 1000.0,
+                timings.narrowphase * 1000000.0 / steps);
+    ImGui::Text("Solve: %.2f ms (%.2f us / step)", timings.solve * 1000.0,
+                timings.solve * 1000000.0 / steps);
+    ImGui::Text("Integrate: %.2f ms (%.2f us / step)",
+                timings.integrate * 1000.0,
+                timings.integrate * 1000000.0 / steps);
+}
+#endif
+
+void PhysicsSystem::imGuiReplay() {
+#if defined(IMGUI_ENABLED)
+    constexpr const char* RECORDING_PATH = "physics_recording.bin";
+
+    ImGui::SeparatorText("Live");
+    ImGuiTimings(timings);
+    if (ImGui::Button("Reset Timings"))
+        resetTimings();
+
+    ImGui::SeparatorText("Recording");
+    if (!isRecording()) {
+        if (ImGui::Button("Start Recording"))
+            beginRecording(RECORDING_PATH, 0);
+    } else {
+        ImGui::Text("Recording to %s", RECORDING_PATH);
+        if (ImGui::Button("Stop Recording"))
+            endRecording();
+    }
+
+    static bool has_result = false;
+    static PhysicsReplayResult result;
+
+    if (!isRecording() && ImGui::Button("Replay Recording")) {
+        PhysicsReplay replay;
+        has_result = replay.load(RECORDING_PATH);
+
+        if (has_result) {
+            // The replay caches its own grid from the live terrain's sampler
+            HeightSampler sampler = nullptr;
+            if (terrain != nullptr)
+                sampler = terrain->getSampler();
+            result = replay.run(sampler);
+        }
+    }
+
+    if (has_result) {
+        ImGui::SeparatorText("Replay");
+        ImGui::Text("%zu bodies, %zu frames, %.2f ms total", result.num_bodies,
+                    result.num_frames, result.total_seconds * 1000.0);
+        ImGuiTimings(result.timings);
+        ImGui::Text("Final State: %08x%08x%08x%08x", result.final_state[0],
+                    result.final_state[1], result.final_state[2],
+                    result.final_state[3]);
+    }
+#endif
+}
+
+#if defined(IMGUI_ENABLED)
+// HullBenchmark:
+// Times the QuickHullBuilder on every mesh in data/, building the full hull
+// and a simplified hull for physics. Builds are timed both with a new
+// builder, which has to allocate its storage, and with one that is reused.
+// A large random point set also compares the serial and parallel partition
+// of the points into the initial hull.
+struct HullBenchmarkMesh {
+    std::string name;
+    size_t num_points = 0;
+
+    int vertices = 0;
+    int triangles = 0;
+    int simplified_vertices = 0;
+
+    double new_builder_ms = 0.0;
+    double reused_builder_ms = 0.0;
+    double simplified_ms = 0.0;
+};
+
+struct HullBenchmark {
+    int max_vertices = 0;
+    std::vector<HullBenchmarkMesh> meshes;
+
+    size_t large_points = 0;
+    double serial_ms = 0.0;
+    double parallel_ms = 0.0;
+};
+
+static HullBenchmark RunHullBenchmark(int max_vertices) {
+    constexpr int NUM_RUNS = 20;
+    constexpr size_t LARGE_POINTS = 500000;
+    constexpr float LARGE_RADIUS = 100.f;
+
+    HullBenchmark results;
+    results.max_vertices = max_vertices;
+
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator("data")) {
+        const std::filesystem::path extension = entry.path().extension();
+        if (extension == ".glb" || extension == ".gltf")
+            paths.push_back(entry.path());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    QuickHullBuilder builder;
+    QuickHullBuilder::Config full_config;
+    QuickHullBuilder::Config simplified_config;
+    simplified_config.max_vertices = max_vertices;
+
+    Stopwatch stopwatch;
+    std::vector<Vector3> points;
+
+    for (const std::filesystem::path& path : paths) {
+        if (!Graphics::GLTFFile::ReadGLTFPositions(path.string(), points))
+            continue;
+
+        HullBenchmarkMesh mesh;
+        mesh.name = path.filename().string();
+        mesh.num_points = points.size();
+
+        stopwatch.Reset();
+        for (int i = 0; i < NUM_RUNS; i++) {
+            QuickHullBuilder new_builder;
+            new_builder.build(points, full_config);
+        }
+        mesh.new_builder_ms = stopwatch.Duration() * 1000.0 / NUM_RUNS;
+
+        stopwatch.Reset();
+        for (int i = 0; i < NUM_RUNS; i++)
+            builder.build(points, full_config);
+        mesh.reused_builder_ms = stopwatch.Duration() * 1000.0 / NUM_RUNS;
+        mesh.vertices = int(builder.getVertices().size());
+        mesh.triangles = int(builder.getIndices().size() / 3);
+
+        stopwatch.Reset();
+        for (int i = 0; i < NUM_RUNS; i++)
+            builder.build(points, simplified_config);
+        mesh.simplified_ms = stopwatch.Duration() * 1000.0 / NUM_RUNS;
+        mesh.simplified_vertices = int(builder.getVertices().size());
+
+        results.meshes.push_back(mesh);
+    }
+
+    // Points spread through a ball, so that most are inside the hull and
+    // the partition is most of the work
+    std::mt19937 generator = std::mt19937(0);
+    std::uniform_real_distribution<float> dist(-LARGE_RADIUS, LARGE_RADIUS);
+
+    points.clear();
+    while (points.size() < LARGE_POINTS) {
+        const Vector3 point =
+            Vector3(dist(generator), dist(generator), dist(generator));
+        if (point.magnitude() <= LARGE_RADIUS)
+            points.push_back(point);
+    }
+    results.large_points = points.size();
+
+    QuickHullBuilder::Config serial_config;
+    serial_config.parallel_threshold = SIZE_MAX;
+
+    stopwatch.Reset();
+    builder.build(points, serial_config);
+    results.serial_ms = stopwatch.Duration() * 1000.0;
+
+    stopwatch.Reset();
+    builder.build(points, full_config);
+    results.parallel_ms = stopwatch.Duration() * 1000.0;
+
+    return results;
+}
+#endif
+
+void PhysicsSystem::imGuiHulls() {
+#if defined(IMGUI_ENABLED)
+    static int max_vertices = 32;
+    static HullBenchmark benchmark;
+
+    ImGui::SliderInt("Simplified Vertices", &max_vertices, 4, 256);
+    if (ImGui::Button("Benchmark QuickHull"))
+        benchmark = RunHullBenchmark(max_vertices);
+
+    if (benchmark.meshes.empty())
+        return;
+
+    ImGui::SeparatorText("Meshes");
+    if (ImGui::BeginTable("Hull Benchmark", 6)) {
+        ImGui::TableSetupColumn("Mesh");
+        ImGui::TableSetupColumn("Points");
+        ImGui::TableSetupColumn("Hull");
+        ImGui::TableSetupColumn("New Builder");
+        ImGui::TableSetupColumn("Reused Builder");
+        ImGui::TableSetupColumn("Simplified");
+        ImGui::TableHeadersRow();
+
+        for (const HullBenchmarkMesh& mesh : benchmark.meshes) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", mesh.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%zu", mesh.num_points);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%i verts, %i tris", mesh.vertices, mesh.triangles);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.3f ms", mesh.new_builder_ms);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.3f ms", mesh.reused_builder_ms);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%.3f ms (%i verts)", mesh.simplified_ms,
+                        mesh.simplified_vertices);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::SeparatorText("Partition");
+    ImGui::Text("%zu points: serial %.2f ms, parallel %.2f ms",
+                benchmark.large_points, benchmark.serial_ms,
+                benchmark.parallel_ms);
+#endif
+}
+
+#if defined(IMGUI_ENABLED)
+// DecompositionResult:
+// Result of decomposing a mesh in data/ into a collision shape. The mesh is
+// added twice, where the second add should be served by the cache.
+struct DecompositionResult {
+    std::string name;
+    size_t num_triangles = 0;
+    size_t num_vertices = 0;
+
+    int num_hulls = 0;
+    size_t hull_vertices = 0;
+
+    double decompose_ms = 0.0;
+    double cached_ms = 0.0;
+};
+#endif
+
+void PhysicsSystem::imGuiDecomposition() {
+#if defined(IMGUI_ENABLED)
+    static ConvexDecomposer::Config config;
+    static std::vector<DecompositionResult> results;
+
+    ImGui::SliderInt("Resolution", &config.resolution, 8, 64);
+    ImGui::SliderFloat("Concavity", &config.concavity, 0.001f, 0.2f, "%.3f");
+    ImGui::SliderInt("Max Depth", &config.max_depth, 1, 8);
+    ImGui::SliderInt("Max Hulls", &config.max_hulls, 1, 64);
+    ImGui::SliderInt("Max Vertices", &config.max_vertices, 0, 128);
+
+    if (ImGui::Button("Decompose Meshes")) {
+        results.clear();
+
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry :
+             std::filesystem::directory_iterator("data")) {
+            const std::filesystem::path extension = entry.path().extension();
+            if (extension == ".glb" || extension == ".gltf")
+                paths.push_back(entry.path());
+        }
+        std::sort(paths.begin(), paths.end());
+
+        Stopwatch stopwatch;
+        std::vector<Vector3> vertices;
+        std::vector<UINT> indices;
+
+        for (const std::filesystem::path& path : paths) {
+            if (!Graphics::GLTFFile::ReadGLTFPositions(path.string(),
+                                                       vertices, &indices))
+                continue;
+
+            DecompositionResult result;
+            result.name = path.filename().string();
+            result.num_triangles = indices.size() / 3;
+            result.num_vertices = vertices.size();
+
+            const std::string shape_name = "decomposition/" + result.name;
+
+            // Drop any cached decomposition, so the first add decomposes
+            decomposition_cache.erase(
+                DecompositionHash(vertices, indices, config));
+
+            stopwatch.Reset();
+            result.num_hulls =
+                addCollisionMesh(shape_name, vertices, indices, config);
+            result.decompose_ms = stopwatch.Duration() * 1000.0;
+
+            stopwatch.Reset();
+            addCollisionMesh(shape_name, vertices, indices, config);
+            result.cached_ms = stopwatch.Duration() * 1000.0;
+
+            for (const CollisionHull& hull : *collision_shapes[shape_name])
+                result.hull_vertices += hull.size();
+
+            results.push_back(result);
+        }
+    }
+
+    if (results.empty())
+        return;
+
+    if (ImGui::BeginTable("Decomposition", 6)) {
+        ImGui::TableSetupColumn("Mesh");
+        ImGui::TableSetupColumn("Triangles");
+        ImGui::TableSetupColumn("Hulls");
+        ImGui::TableSetupColumn("Hull Vertices");
+        ImGui::TableSetupColumn("Decompose");
+        ImGui::TableSetupColumn("Cached");
+        ImGui::TableHeadersRow();
+
+        for (const DecompositionResult& result : results) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", result.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%zu", result.num_triangles);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%i", result.num_hulls);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%zu (mesh %zu)", result.hull_vertices,
+                        result.num_vertices);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.2f ms", result.decompose_ms);
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%.3f ms", result.cached_ms);
+        }
+
+        ImGui::EndTable();
+    }
+#endif
 }
-*/
 
 } // namespace Physics
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -1,42 +1,110 @@
 #pragma once
 
+#include <map>
 #include <unordered_map>
 #include <vector>
 
 #include "collisions/AABBTree.h"
+#include "collisions/HeightfieldCollider.h"
 
+#include "PhysicsInput.h"
 #include "PhysicsObject.h"
 #include "PhysicsTerrain.h"
 
+#include "math/Compute.h"
+#include "math/ConvexDecomposition.h"
+#include "math/QuickHull.h"
 #include "utility/Stopwatch.h"
 
 namespace Engine {
 namespace Physics {
+class PhysicsRecorder;
+struct PhysicsBodyState;
+
+// PhysicsTimings Struct:
+// Time (in seconds) spent in each phase of the physics step, accumulated
+// over num_steps steps.
+struct PhysicsTimings {
+    double broadphase = 0.0;
+    double narrowphase = 0.0;
+    double solve = 0.0;
+    double integrate = 0.0;
+    unsigned int num_steps = 0;
+};
+
+// PhysicsContact Struct:
+// A collision found in the narrowphase, to be resolved in the solve phase.
+// If object_2 is null, the collision is against the terrain.
+struct PhysicsContact {
+    PhysicsObject* object_1;
+    PhysicsObject* object_2;
+    Vector3 penetration;
+};
+
 // PhysicsSystem Class
 // Manages physics behaviors in the game engine.
 class PhysicsSystem {
+    friend class PhysicsReplay;
+
   private:
     // Track delta time
     Utility::Stopwatch stopwatch;
     float delta_time;
 
+    // Fixed timestep. Frame time is added to the accumulator, and the
+    // simulation is advanced in steps of step_size until the accumulator
+    // runs dry (or max_substeps is reached).
+    float step_size;
+    float accumulator;
+    unsigned int max_substeps;
+
     // Dynamic AABB tree for the collision broad-phase
     AABBTree broadphase_tree;
 
-    std::unordered_map<std::string, CollisionHull*> collision_hulls;
+    std::unordered_map<std::string, CollisionShape*> collision_shapes;
+    // Kept so that their storage is reused between shapes
+    QuickHullBuilder hull_builder;
+    ConvexDecomposer decomposer;
+    // Decompositions of meshes, by the hash of the mesh and the config used
+    std::map<MD5Hash, CollisionShape> decomposition_cache;
 
     // All physics object the engine is in control of
     std::vector<PhysicsObject*> objects;
-    // PhysicsTerrain* terrain;
+    // Terrain collider, if one is bound
+    HeightfieldCollider* terrain;
+
+    // Contacts found in the current step
+    std::vector<PhysicsContact> contacts;
+
+    // Profiling and recording
+    PhysicsTimings timings;
+    PhysicsRecorder* recorder;
 
   public:
     PhysicsSystem();
+    ~PhysicsSystem();
 
+    // Adds a collision hull with a name. If max_vertices is above 0, the
+    // points are replaced by the vertices of their convex hull, simplified
+    // to at most max_vertices, which makes support queries cheaper.
     void addCollisionHull(const std::string& name,
-                          const std::vector<Vector3>& points);
+                          const std::vector<Vector3>& points,
+                          int max_vertices = 0);
+    // Adds a collision shape for a triangle mesh, which can be concave, by
+    // decomposing it into convex hulls. Decompositions are cached, so
+    // adding the same mesh again is cheap. Returns the number of hulls.
+    int addCollisionMesh(const std::string& name,
+                         const std::vector<Vector3>& vertices,
+                         const std::vector<UINT>& indices,
+                         const ConvexDecomposer::Config& config);
+    void addCollisionShape(const std::string& name,
+                           const CollisionShape& shape);
 
     // Datamodel Handling
     void onObjectCreate(Object* object);
+    // Bind a collider decomposed from a mesh file, replacing the object's
+    // collider
+    void bindCollider(PhysicsObject* object, const std::string& mesh_file);
 
     // Bind a PhysicsObject to an object and return it for configuration
     /*
@@ -45,6 +113,13 @@ class PhysicsSystem {
     PhysicsTerrain* bindTerrain(Terrain* terrain);
     */
 
+    // Bind a heightfield for the terrain and return it for configuration
+    HeightfieldCollider* bindTerrain(const HeightSampler& sampler);
+
+    // Configure the fixed timestep
+    void setTickRate(unsigned int ticks_per_second);
+    void setMaxSubsteps(unsigned int max_substeps);
+
     // (SYNC) Pull data from the datamodel
     void pullDatamodelData();
     // Updates the physics for a scene
@@ -53,7 +128,42 @@ class PhysicsSystem {
     void pushDatamodelData();
 
     // Raycast into the scene
-    BVHRayCast raycast(const Vector3& origin, const Vector3& direction);
+    HeightfieldRayCast raycast(const Vector3& origin, const Vector3& direction,
+                               float max_distance);
+
+    // Recording:
+    // Records the initial state of all bodies, and the input of every frame
+    // after, to a log that can be re-executed with PhysicsReplay.
+    bool beginRecording(const std::string& path, uint32_t seed);
+    void endRecording();
+    bool isRecording() const;
+
+    // Per-phase timings, accumulated over all steps since the last reset
+    const PhysicsTimings& getTimings() const;
+    void resetTimings();
+
+    // Debug Display
+    void imGuiTerrain();
+    void imGuiReplay();
+    void imGuiHulls();
+    void imGuiDecomposition();
+
+  private:
+    // Headless systems do not connect to the datamodel or debug display, and
+    // are used for replays.
+    PhysicsSystem(bool headless);
+
+    // Capture and restore the state of all bodies for recordings
+    std::vector<PhysicsBodyState> captureBodies() const;
+    void restoreBodies(const std::vector<PhysicsBodyState>& bodies);
+
+    // Runs a frame of the simulation with the given time and input
+    void simulate(float dt, const PhysicsInput& input);
+    // Advances the simulation by a single fixed step
+    void step(float dt);
+    void integrateContinuous(PhysicsObject* object,
+                             const std::vector<ColliderPair>& collision_pairs,
+                             float dt);
 };
 } // namespace Physics
 } // namespace Engine
\ No newline at end of file
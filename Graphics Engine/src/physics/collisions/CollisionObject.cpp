@@ -1,17 +1,79 @@
 #include "CollisionObject.h"
 
+#include <float.h>
+
+#include "GJK.h"
+#include "math/BatchMath.h"
+
 #if defined(_DEBUG)
 #include "math/QuickHull.h"
 #endif
 
 namespace Engine {
 namespace Physics {
+CollisionPart::CollisionPart(const CollisionHull* _hull,
+                             const Transform* _transform)
+    : hull(_hull), transform(_transform) {}
+CollisionPart::~CollisionPart() = default;
+
+// GJKSupport Methods:
+// Lets us query the part as a support function, so that it can be used in
+// the GJK algorithm for collision detection.
+const Vector3 CollisionPart::center(void) const {
+    Vector3 center = Vector3(0, 0, 0);
+
+    for (const Vector3& point : *hull)
+        center += point;
+    center /= hull->size();
+
+    center += transform->getPosition();
+
+    return center;
+}
+
+const Vector3 CollisionPart::furthestPoint(const Vector3& direction) const {
+    if (hull->size() == 0) {
+        return Vector3(0, 0, 0);
+    }
+
+    // The furthest point along the direction in world space is the furthest
+    // point along the transposed direction in local space, so we only need
+    // to transform the point we pick.
+    const Matrix3x4& m_transform = transform->affineMatrix();
+    const Vector3 direc = m_transform.transposeTransformVector(direction);
+
+    const Vector3* furthest = &(*hull)[0];
+    float furthest_dot = furthest->dot(direc);
+
+    for (const Vector3& point : *hull) {
+        const float point_dot = point.dot(direc);
+        if (point_dot >= furthest_dot) {
+            furthest = &point;
+            furthest_dot = point_dot;
+        }
+    }
+
+    return m_transform.transformPoint(*furthest);
+}
+
+const Vector3& CollisionPart::getMin() const { return minimum; }
+const Vector3& CollisionPart::getMax() const { return maximum; }
+
+bool CollisionPart::overlaps(const CollisionPart& other) const {
+    return minimum.x <= other.maximum.x && other.minimum.x <= maximum.x &&
+           minimum.y <= other.maximum.y && other.minimum.y <= maximum.y &&
+           minimum.z <= other.maximum.z && other.minimum.z <= maximum.z;
+}
+
 CollisionObject::CollisionObject(PhysicsObject* phys_obj,
                                  const Transform* _transform,
-                                 const CollisionHull* hull)
-    : collision_hull(hull), transform(_transform) {
+                                 const CollisionShape* shape)
+    : collision_shape(shape), transform(_transform) {
     phys_object = phys_obj;
 
+    for (const CollisionHull& hull : *collision_shape)
+        parts.push_back(CollisionPart(&hull, transform));
+
     broadphase_aabb = CollisionAABB();
     broadphase_aabb.collider = this;
 }
@@ -19,13 +81,18 @@ CollisionObject::~CollisionObject() = default;
 
 // GJKSupport Methods:
 // Lets us query the CollisionObject as a support function, so that it can be
-// used in the GJK algorithm for collision detection.
+// used in the GJK algorithm for collision detection. With many parts, this
+// is the support function of the hull around all of them.
 const Vector3 CollisionObject::center(void) const {
     Vector3 center = Vector3(0, 0, 0);
+    size_t num_points = 0;
 
-    for (const Vector3& point : *collision_hull)
-        center += point;
-    center /= collision_hull->size();
+    for (const CollisionHull& hull : *collision_shape) {
+        for (const Vector3& point : hull)
+            center += point;
+        num_points += hull.size();
+    }
+    center /= num_points;
 
     center += transform->getPosition();
 
@@ -33,20 +100,21 @@ const Vector3 CollisionObject::center(void) const {
 }
 
 const Vector3 CollisionObject::furthestPoint(const Vector3& direction) const {
-    if (collision_hull->size() == 0) {
-        return Vector3(0, 0, 0);
-    }
+    if (parts.size() == 1)
+        return parts[0].furthestPoint(direction);
 
-    const Vector3 direc = direction.unit();
-    const Matrix4 m_transform = transform->transformMatrix();
+    Vector3 furthest = Vector3(0, 0, 0);
+    float furthest_dot = -FLT_MAX;
 
-    Vector3 furthest =
-        (m_transform * Vector4((*collision_hull)[0], 1.0f)).xyz();
+    for (const CollisionPart& part : parts) {
+        if (part.hull->empty())
+            continue;
 
-    for (const Vector3& point : *collision_hull) {
-        const Vector3 transformed = (m_transform * Vector4(point, 1.0f)).xyz();
-        if (transformed.dot(direc) >= furthest.dot(direc)) {
-            furthest = transformed;
+        const Vector3 point = part.furthestPoint(direction);
+        const float point_dot = point.dot(direction);
+        if (point_dot >= furthest_dot) {
+            furthest = point;
+            furthest_dot = point_dot;
         }
     }
 
@@ -57,24 +125,107 @@ const Vector3 CollisionObject::furthestPoint(const Vector3& direction) const {
 // Updates the AABB extents to encompass the translated convex hull,
 // so that it can be used in the broadphase collision pass.
 void CollisionObject::updateBroadphaseAABB(void) {
-    broadphase_aabb = CollisionAABB();
+    updateBroadphaseAABB(Vector3(0, 0, 0));
+}
+
+// The swept AABB is the union of the AABBs at the start and end of the sweep.
+// Used for continuous collision, so that the broadphase will pair the collider
+// with anything it passes through. The parts' bounds are not swept.
+void CollisionObject::updateBroadphaseAABB(const Vector3& sweep) {
+    // Only reset the extents, so that the AABB keeps its links to the tree
+    // and collider
+    broadphase_aabb.reset();
+
+    const Matrix4& m_transform = transform->transformMatrix();
+
+    for (CollisionPart& part : parts) {
+        BatchBoundsOfTransformedPoints(m_transform, part.hull->data(),
+                                       part.hull->size(), &part.minimum,
+                                       &part.maximum);
+
+        // The bounds are empty (min > max) if there are no points, or none
+        // of them are valid. Expanding by them would then cover all of
+        // space.
+        if (part.minimum.x <= part.maximum.x) {
+            broadphase_aabb.expandToContain(part.minimum);
+            broadphase_aabb.expandToContain(part.maximum);
+        }
+    }
+
+    broadphase_aabb.expandToContain(broadphase_aabb.getMin() + sweep);
+    broadphase_aabb.expandToContain(broadphase_aabb.getMax() + sweep);
+}
+
+const std::vector<CollisionPart>& CollisionObject::getParts() const {
+    return parts;
+}
+
+// ComputePenetration:
+// Runs GJK on every pair of parts whose bounds overlap. The deepest
+// penetration is kept, as it is the one that most needs resolving.
+bool CollisionObject::computePenetration(CollisionObject* other,
+                                         Vector3* penetration) {
+    bool hit = false;
+    float deepest = -1.f;
+
+    for (CollisionPart& part : parts) {
+        for (CollisionPart& other_part : other->parts) {
+            if (!part.overlaps(other_part))
+                continue;
+
+            GJKSolver gjk_solver = GJKSolver(&part, &other_part);
+            if (!gjk_solver.checkIntersection())
+                continue;
+
+            const Vector3 part_penetration = gjk_solver.penetrationVector();
+            const float depth = part_penetration.magnitude();
+            if (depth > deepest) {
+                *penetration = part_penetration;
+                deepest = depth;
+                hit = true;
+            }
+        }
+    }
 
-    const Matrix4 m_transform = transform->transformMatrix();
+    return hit;
+}
 
-    for (const Vector3& point : *collision_hull) {
-        const Vector3 transformed = (m_transform * Vector4(point, 1.0f)).xyz();
-        broadphase_aabb.expandToContain(transformed);
+// ComputeTimeOfImpact:
+// Finds the earliest time of impact over every pair of parts. Bounds aren't
+// checked, as objects have moved since they were last updated.
+bool CollisionObject::computeTimeOfImpact(CollisionObject* other,
+                                          const Vector3& displacement,
+                                          TimeOfImpact* result) {
+    bool hit = false;
+    result->time = 1.f;
+
+    for (CollisionPart& part : parts) {
+        for (CollisionPart& other_part : other->parts) {
+            TimeOfImpact toi;
+            if (ComputeTimeOfImpact(&part, &other_part, displacement, &toi) &&
+                toi.time < result->time) {
+                *result = toi;
+                hit = true;
+            }
+        }
     }
+
+    return hit;
 }
 
 #if (_DEBUG)
 void CollisionObject::debugDrawCollider(void) {
-    QuickHullSolver solver;
-    solver.computeConvexHull(*collision_hull);
-    ConvexHull* hull = solver.getHull();
-    hull->transformPoints(transform);
-    hull->debugDrawConvexHull();
-    delete hull;
+    QuickHullBuilder builder;
+
+    for (const CollisionHull& hull : *collision_shape) {
+        if (!builder.build(hull, QuickHullBuilder::Config()))
+            continue;
+
+        ConvexHull* convex_hull = builder.getHull();
+        convex_hull->transformPoints(transform);
+        convex_hull->debugDrawConvexHull();
+        delete convex_hull;
+    }
 }
 #endif
 
@@ -4,6 +4,7 @@
 
 #include "CollisionAABB.h"
 #include "GJKSupport.h"
+#include "TimeOfImpact.h"
 #include "math/Transform.h"
 #include "math/Vector3.h"
 
@@ -18,27 +19,59 @@ class PhysicsObject;
 // collision hulls
 typedef std::vector<Vector3> CollisionHull;
 
+// CollisionShape Struct:
+// The convex hulls that together make up the shape of a collider. Concave
+// meshes are approximated by several hulls (see ConvexDecomposer), so that
+// collisions with them can still use GJK.
+typedef std::vector<CollisionHull> CollisionShape;
+
+// CollisionPart Class:
+// One convex hull of a collider, which can be used as a GJK support
+// function on its own. Keeps its bounds in world space, so that pairs of
+// parts that can't touch are skipped.
+class CollisionPart : public GJKSupportFunc {
+    friend class CollisionObject;
+
+    const CollisionHull* hull;
+    const Transform* transform;
+
+    Vector3 minimum;
+    Vector3 maximum;
+
+  public:
+    CollisionPart(const CollisionHull* hull, const Transform* transform);
+    ~CollisionPart();
+
+    const Vector3 center(void) const;
+    const Vector3 furthestPoint(const Vector3& direction) const;
+
+    const Vector3& getMin() const;
+    const Vector3& getMax() const;
+    bool overlaps(const CollisionPart& other) const;
+};
+
 // CollisionObject Class:
 // Stores the information for an object that can collide with other
 // objects in the physics system.
-// Internally, stores a point-set representing a convex collision hull,
-// and an AABB of this collision hull.
+// Internally, stores a shape of one or more convex collision hulls,
+// and an AABB of the whole shape.
 class CollisionObject : public GJKSupportFunc {
     friend class PhysicsSystem;
 
     PhysicsObject* phys_object;
 
-    // Point-sets representing the hull of the collider.
+    // The hulls of the collider's shape, and a part for each.
     // These points will not change on initialization.
-    const CollisionHull* collision_hull;
+    const CollisionShape* collision_shape;
+    std::vector<CollisionPart> parts;
     const Transform* transform;
 
-    // An AABB of the collision hull, after being transformed.
+    // An AABB of the collision shape, after being transformed.
     CollisionAABB broadphase_aabb;
 
   private:
     CollisionObject(PhysicsObject* phys_obj, const Transform* transform,
-                    const CollisionHull* hull);
+                    const CollisionShape* shape);
 
   public:
     ~CollisionObject();
@@ -46,12 +79,27 @@ class CollisionObject : public GJKSupportFunc {
     // Physics / Collision Methods: Used in the physics engine.
     // Center, FurthestPoint: Lets us query the collision object to see if it's
     // collision hull
-    //       collides with another.
-    // UpdateBroadphaseAABB: Updates the AABB for use in the AABB tree.
+    //       collides with another. For shapes of many hulls, these
+    //       describe the hull of the whole shape.
+    // UpdateBroadphaseAABB: Updates the AABB for use in the AABB tree. If a
+    //       sweep is given, the AABB contains the hull over the entire sweep.
+    //       The bounds of each part are updated as well.
     const Vector3 center(void) const;
     const Vector3 furthestPoint(const Vector3& direction) const;
 
     void updateBroadphaseAABB(void);
+    void updateBroadphaseAABB(const Vector3& sweep);
+
+    // Part Queries: Test the parts of two colliders against each other.
+    // ComputePenetration: Returns true if any parts intersect, and the
+    //       deepest of their penetration vectors.
+    // ComputeTimeOfImpact: Returns true if any parts touch as this collider
+    //       moves by displacement, and the earliest time they do.
+    const std::vector<CollisionPart>& getParts() const;
+    bool computePenetration(CollisionObject* other, Vector3* penetration);
+    bool computeTimeOfImpact(CollisionObject* other,
+                             const Vector3& displacement,
+                             TimeOfImpact* result);
 
 #if (_DEBUG)
     void debugDrawCollider(void);
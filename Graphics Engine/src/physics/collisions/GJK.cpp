@@ -1,6 +1,7 @@
 #include "GJK.h"
 
 #include <assert.h>
+#include <float.h>
 #include <math.h>
 
 #include "GJKSupport.h"
@@ -52,6 +53,14 @@ struct GJKSimplex {
     const Vector3& p4() const { return points[num_points - 4]; }
 };
 
+// Destructor:
+// Defined after GJKSimplex, as deleting an incomplete type skips its
+// destructor.
+GJKSolver::~GJKSolver() {
+    if (simplex != nullptr)
+        delete simplex;
+}
+
 // CheckIntersection:
 // Returns whether or not the shapes intersect.
 // True on intersection, false if none.
@@ -226,6 +235,215 @@ Vector3 GJKSolver::penetrationVector() {
     return penetration;
 }
 
+// Distance:
+// Computes the distance between the two shapes with the GJK distance
+// algorithm. Rather than checking if the Minkowski Difference contains the
+// origin, we search for the point in the difference closest to the origin.
+// Each iteration adds the support point in the direction of the origin to the
+// simplex, and reduces the simplex to the smallest feature containing its
+// closest point to the origin.
+// Based on Real-Time Collision Detection (Ericson), Ch. 9.5.
+static Vector3 ClosestPointOnSimplex(Vector3* points, int& num_points);
+
+float GJKSolver::distance(Vector3* separation) {
+    constexpr int MAX_ITERATIONS = 32;
+    constexpr float TOLERANCE = 0.0001f;
+
+    Vector3 points[4];
+    int num_points = 0;
+
+    // Start from an arbitrary point in the Minkowski Difference
+    Vector3 initial_direction = shape_1->center() - shape_2->center();
+    if (initial_direction.magnitude() < TOLERANCE)
+        initial_direction = Vector3::PositiveX();
+
+    Vector3 closest = querySupports(initial_direction);
+    points[num_points++] = closest;
+
+    for (int i = 0; i < MAX_ITERATIONS; i++) {
+        const float closest_sqr = closest.dot(closest);
+
+        // Origin is (nearly) contained in the difference.
+        if (closest_sqr < TOLERANCE * TOLERANCE) {
+            closest = Vector3(0, 0, 0);
+            break;
+        }
+
+        // Find the support point in the direction of the origin. If it does
+        // not bring us any closer, then we have converged.
+        const Vector3 support = querySupports(-closest);
+        if (closest_sqr - closest.dot(support) <= TOLERANCE * closest_sqr)
+            break;
+
+        points[num_points++] = support;
+        closest = ClosestPointOnSimplex(points, num_points);
+
+        // A full tetrahedron is only kept if it contains the origin
+        if (num_points == 4) {
+            closest = Vector3(0, 0, 0);
+            break;
+        }
+    }
+
+    if (separation != nullptr)
+        *separation = closest;
+
+    return closest.magnitude();
+}
+
+// ClosestPointOnSimplex:
+// Returns the point on the simplex closest to the origin, and reduces the
+// simplex to the vertices of the feature that point lies on.
+static Vector3 ClosestPointOnSegment(Vector3* points, int& num_points) {
+    const Vector3 A = points[0];
+    const Vector3 B = points[1];
+    const Vector3 AB = B - A;
+
+    const float length_sqr = AB.dot(AB);
+    const float t = length_sqr > 0.f ? -A.dot(AB) / length_sqr : 0.f;
+
+    if (t <= 0.f) {
+        num_points = 1;
+        return A;
+    } else if (t >= 1.f) {
+        points[0] = B;
+        num_points = 1;
+        return B;
+    } else
+        return A + AB * t;
+}
+
+static Vector3 ClosestPointOnTriangle(Vector3* points, int& num_points) {
+    const Vector3 A = points[0];
+    const Vector3 B = points[1];
+    const Vector3 C = points[2];
+
+    const Vector3 AB = B - A;
+    const Vector3 AC = C - A;
+
+    // Vertex region A
+    const float d1 = AB.dot(-A);
+    const float d2 = AC.dot(-A);
+    if (d1 <= 0.f && d2 <= 0.f) {
+        num_points = 1;
+        return A;
+    }
+
+    // Vertex region B
+    const float d3 = AB.dot(-B);
+    const float d4 = AC.dot(-B);
+    if (d3 >= 0.f && d4 <= d3) {
+        points[0] = B;
+        num_points = 1;
+        return B;
+    }
+
+    // Edge region AB
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+        num_points = 2;
+        return A + AB * (d1 / (d1 - d3));
+    }
+
+    // Vertex region C
+    const float d5 = AB.dot(-C);
+    const float d6 = AC.dot(-C);
+    if (d6 >= 0.f && d5 <= d6) {
+        points[0] = C;
+        num_points = 1;
+        return C;
+    }
+
+    // Edge region AC
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+        points[1] = C;
+        num_points = 2;
+        return A + AC * (d2 / (d2 - d6));
+    }
+
+    // Edge region BC
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+        points[0] = B;
+        points[1] = C;
+        num_points = 2;
+        return B + (C - B) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    // Face region
+    const float denom = 1.f / (va + vb + vc);
+    return A + AB * (vb * denom) + AC * (vc * denom);
+}
+
+static Vector3 ClosestPointOnTetrahedron(Vector3* points, int& num_points) {
+    constexpr int FACES[4][4] = {
+        {0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+
+    Vector3 closest = Vector3(0, 0, 0);
+    float closest_sqr = FLT_MAX;
+    Vector3 best_points[3];
+    int best_num_points = 4;
+
+    for (const int* face : FACES) {
+        const Vector3& A = points[face[0]];
+        const Vector3& B = points[face[1]];
+        const Vector3& C = points[face[2]];
+        const Vector3& D = points[face[3]];
+
+        // Only faces with the origin on their outside (the side opposite
+        // the 4th vertex) can contain the closest point. For a degenerate
+        // (flat) tetrahedron, every face is tested.
+        const Vector3 normal = (B - A).cross(C - A);
+        const float sign_origin = (-A).dot(normal);
+        const float sign_d = (D - A).dot(normal);
+
+        const bool degenerate = sign_d * sign_d < 1e-12f;
+        if (!degenerate && sign_origin * sign_d >= 0.f)
+            continue;
+
+        Vector3 face_points[3] = {A, B, C};
+        int face_num_points = 3;
+        const Vector3 point =
+            ClosestPointOnTriangle(face_points, face_num_points);
+
+        if (point.dot(point) < closest_sqr) {
+            closest = point;
+            closest_sqr = point.dot(point);
+
+            for (int i = 0; i < face_num_points; i++)
+                best_points[i] = face_points[i];
+            best_num_points = face_num_points;
+        }
+    }
+
+    // If the origin was inside every face, it is contained in the
+    // tetrahedron.
+    if (best_num_points < 4) {
+        for (int i = 0; i < best_num_points; i++)
+            points[i] = best_points[i];
+        num_points = best_num_points;
+    }
+
+    return closest;
+}
+
+Vector3 ClosestPointOnSimplex(Vector3* points, int& num_points) {
+    switch (num_points) {
+    case 1:
+        return points[0];
+    case 2:
+        return ClosestPointOnSegment(points, num_points);
+    case 3:
+        return ClosestPointOnTriangle(points, num_points);
+    case 4:
+        return ClosestPointOnTetrahedron(points, num_points);
+    default:
+        assert(false);
+        return Vector3(0, 0, 0);
+    }
+}
+
 // QuerySupports:
 // Given a direction, queries the suport functions to find the corresponding
 // support point in the Minkowski Difference
@@ -30,6 +30,7 @@ class GJKSolver {
 
   public:
     GJKSolver(GJKSupportFunc* shape_1, GJKSupportFunc* shape_2);
+    ~GJKSolver();
 
     // Returns if the two shapes are intersecting or not
     bool checkIntersection();
@@ -37,6 +38,11 @@ class GJKSolver {
     // If the two shapes are intersecting, returns the penetration vector
     Vector3 penetrationVector();
 
+    // Returns the distance between the two shapes, or 0 if they intersect.
+    // If separation is given, it is set to the vector from the closest point
+    // on shape 2 to the closest point on shape 1.
+    float distance(Vector3* separation = nullptr);
+
   private:
     // Performs 1 iteration of the GJK algorithm
     SolverStatus iterate(); 
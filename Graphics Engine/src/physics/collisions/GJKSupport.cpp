@@ -50,19 +50,41 @@ GJKSupportPointSet::furthestPoint(const Vector3& direction) const {
         return Vector3(0, 0, 0);
     }
 
-    const Vector3 direc = direction.unit();
-    const Matrix4 m_transform = transform->transformMatrix();
+    // Search in local space, and only transform the winning point
+    const Matrix3x4& m_transform = transform->affineMatrix();
+    const Vector3 direc = m_transform.transposeTransformVector(direction);
 
-    Vector3 furthest = (m_transform * Vector4(points[0], 1.0f)).xyz();
+    const Vector3* furthest = &points[0];
+    float furthest_dot = furthest->dot(direc);
 
     for (const Vector3& point : points) {
-        const Vector3 transformed = (m_transform * Vector4(point, 1.0f)).xyz();
-        if (transformed.dot(direc) >= furthest.dot(direc)) {
-            furthest = transformed;
+        const float point_dot = point.dot(direc);
+        if (point_dot >= furthest_dot) {
+            furthest = &point;
+            furthest_dot = point_dot;
         }
     }
 
-    return furthest;
+    return m_transform.transformPoint(*furthest);
+}
+
+GJKSupportTranslated::GJKSupportTranslated(const GJKSupportFunc* _shape,
+                                           const Vector3& _offset)
+    : offset(_offset) {
+    shape = _shape;
+}
+GJKSupportTranslated::~GJKSupportTranslated() = default;
+
+void GJKSupportTranslated::setOffset(const Vector3& _offset) {
+    offset = _offset;
+}
+
+const Vector3 GJKSupportTranslated::center(void) const {
+    return shape->center() + offset;
+}
+const Vector3
+GJKSupportTranslated::furthestPoint(const Vector3& direction) const {
+    return shape->furthestPoint(direction) + offset;
 }
 
 } // namespace Physics
@@ -43,5 +43,24 @@ class GJKSupportPointSet : public GJKSupportFunc {
     const Vector3 furthestPoint(const Vector3& direction) const;
 };
 
+// GJKSupportTranslated Class:
+// Support function that offsets another support function by a translation.
+// Lets us query a shape at a different position without modifying its
+// transform, e.g. when sweeping a shape along its path of motion.
+class GJKSupportTranslated : public GJKSupportFunc {
+  private:
+    const GJKSupportFunc* shape;
+    Vector3 offset;
+
+  public:
+    GJKSupportTranslated(const GJKSupportFunc* shape, const Vector3& offset);
+    ~GJKSupportTranslated();
+
+    void setOffset(const Vector3& offset);
+
+    const Vector3 center(void) const;
+    const Vector3 furthestPoint(const Vector3& direction) const;
+};
+
 } // namespace Math
 } // namespace Engine
\ No newline at end of file
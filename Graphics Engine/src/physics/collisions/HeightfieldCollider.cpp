@@ -0,0 +1,334 @@
+#include "HeightfieldCollider.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "GJKSupport.h"
+
+namespace Engine {
+namespace Physics {
+// Spacing between samples when querying the sampler directly
+constexpr float kDirectSampleSpacing = 1.f;
+
+HeightfieldCollider::HeightfieldCollider(const HeightSampler& _sampler)
+    : sampler(_sampler), grid(), grid_origin(), grid_extents() {
+    grid_samples = 0;
+    grid_version = 0;
+}
+HeightfieldCollider::~HeightfieldCollider() = default;
+
+const HeightSampler& HeightfieldCollider::getSampler() const {
+    return sampler;
+}
+
+// CacheGrid:
+// Samples the heights of a region into a grid. Queries inside the region
+// read from the grid instead of the sampler.
+void HeightfieldCollider::cacheGrid(const Vector2& origin,
+                                    const Vector2& extents, int num_samples,
+                                    uint32_t version) {
+    assert(num_samples >= 2);
+
+    grid_origin = origin;
+    grid_extents = extents;
+    grid_samples = num_samples;
+    grid_version = version;
+    grid.resize(num_samples * num_samples);
+
+    const float dist_between_samples_inv = 1 / float(num_samples - 1);
+    for (int x = 0; x < num_samples; x++) {
+        for (int z = 0; z < num_samples; z++) {
+            const float world_x =
+                origin.x + x * dist_between_samples_inv * extents.x;
+            const float world_z =
+                origin.y + z * dist_between_samples_inv * extents.y;
+            grid[x * num_samples + z] = sampler(world_x, world_z);
+        }
+    }
+}
+
+void HeightfieldCollider::loadGrid(const Vector2& origin,
+                                   const Vector2& extents, int num_samples,
+                                   const float* heights, uint32_t version) {
+    assert(num_samples >= 2);
+
+    grid_origin = origin;
+    grid_extents = extents;
+    grid_samples = num_samples;
+    grid_version = version;
+    grid.assign(heights, heights + num_samples * num_samples);
+}
+
+// UpdateGrid:
+// Moves the cached grid to a new region. Samples are shifted over when the
+// region moves by a whole number of samples, so a window that follows the
+// camera only samples the rows and columns it exposes.
+void HeightfieldCollider::updateGrid(const Vector2& origin,
+                                     const Vector2& extents, int num_samples,
+                                     uint32_t version) {
+    if (grid_samples != num_samples || version != grid_version ||
+        grid_extents.x != extents.x || grid_extents.y != extents.y) {
+        cacheGrid(origin, extents, num_samples, version);
+        return;
+    }
+
+    const Vector2 spacing = extents / float(num_samples - 1);
+    const float shift_x = (origin.x - grid_origin.x) / spacing.x;
+    const float shift_z = (origin.y - grid_origin.y) / spacing.y;
+    const int dx = int(roundf(shift_x));
+    const int dz = int(roundf(shift_z));
+
+    if (fabsf(shift_x - dx) > 0.001f || fabsf(shift_z - dz) > 0.001f) {
+        cacheGrid(origin, extents, num_samples, version);
+        return;
+    }
+    if (dx == 0 && dz == 0)
+        return;
+
+    grid_scratch.resize(grid.size());
+    for (int x = 0; x < num_samples; x++) {
+        const int old_x = x + dx;
+        const bool old_x_valid = 0 <= old_x && old_x < num_samples;
+
+        for (int z = 0; z < num_samples; z++) {
+            const int old_z = z + dz;
+            if (old_x_valid && 0 <= old_z && old_z < num_samples) {
+                grid_scratch[x * num_samples + z] =
+                    grid[old_x * num_samples + old_z];
+            } else {
+                grid_scratch[x * num_samples + z] =
+                    sampler(origin.x + x * spacing.x, origin.y + z * spacing.y);
+            }
+        }
+    }
+
+    grid.swap(grid_scratch);
+    grid_origin = origin;
+}
+
+void HeightfieldCollider::clearCache() {
+    grid.clear();
+    grid.shrink_to_fit();
+    grid_samples = 0;
+}
+
+bool HeightfieldCollider::getCachedRegion(Vector2* origin, Vector2* extents,
+                                          int* num_samples) const {
+    if (grid_samples == 0)
+        return false;
+
+    *origin = grid_origin;
+    *extents = grid_extents;
+    *num_samples = grid_samples;
+    return true;
+}
+
+const std::vector<float>& HeightfieldCollider::getCachedHeights() const {
+    return grid;
+}
+
+size_t HeightfieldCollider::memoryUsage() const {
+    return sizeof(HeightfieldCollider) +
+           (grid.capacity() + grid_scratch.capacity()) * sizeof(float);
+}
+
+bool HeightfieldCollider::insideGrid(float x, float z) const {
+    if (grid_samples == 0)
+        return false;
+
+    const float u = (x - grid_origin.x) / grid_extents.x;
+    const float v = (z - grid_origin.y) / grid_extents.y;
+    return 0.f <= u && u <= 1.f && 0.f <= v && v <= 1.f;
+}
+
+// SampleSpacing:
+// Distance between height samples. Queries step at this resolution.
+float HeightfieldCollider::sampleSpacing() const {
+    if (grid_samples == 0)
+        return kDirectSampleSpacing;
+    return std::min(grid_extents.x, grid_extents.y) / (grid_samples - 1);
+}
+
+// SampleHeight:
+// Returns the height at a world (x,z) coordinate. Inside the cached grid, the
+// height is bilinearly interpolated between the 4 nearest samples.
+float HeightfieldCollider::sampleHeight(float x, float z) const {
+    if (!insideGrid(x, z))
+        return sampler(x, z);
+
+    const float grid_x =
+        (x - grid_origin.x) / grid_extents.x * (grid_samples - 1);
+    const float grid_z =
+        (z - grid_origin.y) / grid_extents.y * (grid_samples - 1);
+
+    const int x0 = std::min(int(grid_x), grid_samples - 2);
+    const int z0 = std::min(int(grid_z), grid_samples - 2);
+    const float tx = grid_x - x0;
+    const float tz = grid_z - z0;
+
+    const float h00 = grid[x0 * grid_samples + z0];
+    const float h10 = grid[(x0 + 1) * grid_samples + z0];
+    const float h01 = grid[x0 * grid_samples + z0 + 1];
+    const float h11 = grid[(x0 + 1) * grid_samples + z0 + 1];
+
+    const float h0 = h00 + (h10 - h00) * tx;
+    const float h1 = h01 + (h11 - h01) * tx;
+    return h0 + (h1 - h0) * tz;
+}
+
+// SampleNormal:
+// Returns the surface normal at a world (x,z) coordinate, using central
+// differences.
+Vector3 HeightfieldCollider::sampleNormal(float x, float z) const {
+    const float h = sampleSpacing();
+
+    const float dx = sampleHeight(x + h, z) - sampleHeight(x - h, z);
+    const float dz = sampleHeight(x, z + h) - sampleHeight(x, z - h);
+
+    return Vector3(-dx, 2 * h, -dz).unit();
+}
+
+// Raycast:
+// Marches the ray across the heightfield, one sample spacing (in the xz plane)
+// at a time, until the ray passes below the surface. The crossing is then
+// refined by bisection.
+HeightfieldRayCast HeightfieldCollider::raycast(const Vector3& origin,
+                                                const Vector3& direction,
+                                                float max_distance) const {
+    constexpr int MAX_REFINE_ITERATIONS = 32;
+    constexpr float REFINE_TOLERANCE = 0.001f;
+
+    HeightfieldRayCast result;
+    result.hit = false;
+
+    const Vector3 direc = direction.unit();
+    auto heightAbove = [this, &origin, &direc](float t) {
+        const Vector3 point = origin + direc * t;
+        return point.y - sampleHeight(point.x, point.z);
+    };
+
+    // Heights only change as we move in the xz plane, so we step by the sample
+    // spacing over the horizontal length of the ray.
+    const float horizontal = sqrtf(direc.x * direc.x + direc.z * direc.z);
+    const float step = horizontal > 0.0001f
+                           ? sampleSpacing() / horizontal
+                           : max_distance;
+
+    float t_prev = 0.f;
+    float t_hit = heightAbove(0.f) <= 0.f ? 0.f : -1.f;
+
+    while (t_hit < 0.f && t_prev < max_distance) {
+        const float t_next = std::min(t_prev + step, max_distance);
+        const float above_next = heightAbove(t_next);
+
+        if (above_next <= 0.f) {
+            // Crossing is in [t_prev, t_next]
+            float t_low = t_prev;
+            float t_high = t_next;
+            for (int i = 0; i < MAX_REFINE_ITERATIONS &&
+                            t_high - t_low > REFINE_TOLERANCE;
+                 i++) {
+                const float t_mid = (t_low + t_high) * 0.5f;
+                if (heightAbove(t_mid) > 0.f)
+                    t_low = t_mid;
+                else
+                    t_high = t_mid;
+            }
+            t_hit = t_high;
+        }
+
+        t_prev = t_next;
+    }
+
+    if (t_hit >= 0.f) {
+        result.hit = true;
+        result.t = t_hit;
+        result.position = origin + direc * t_hit;
+        result.normal = sampleNormal(result.position.x, result.position.z);
+    }
+
+    return result;
+}
+
+// OverlapsAABB:
+// The AABB overlaps the terrain if its bottom is below the highest point of
+// the terrain within its xz footprint. As the surface is bilinear between
+// samples, its maximum over the footprint lies on the lattice formed by the
+// footprint edges and the sample lines within it, so we only test there.
+bool HeightfieldCollider::overlapsAABB(const Vector3& aabb_min,
+                                       const Vector3& aabb_max) const {
+    const float spacing = sampleSpacing();
+
+    // Sample lines are aligned to the grid origin (or world origin, if there is
+    // no grid).
+    const Vector2 lattice_origin =
+        grid_samples > 0 ? grid_origin : Vector2(0.f, 0.f);
+
+    lattice_x.clear();
+    lattice_z.clear();
+    auto buildLattice = [spacing](std::vector<float>& out, float min, float max,
+                                  float origin) {
+        out.push_back(min);
+        for (float v = origin + ceilf((min - origin) / spacing) * spacing;
+             v < max; v += spacing)
+            out.push_back(v);
+        out.push_back(max);
+    };
+    buildLattice(lattice_x, aabb_min.x, aabb_max.x, lattice_origin.x);
+    buildLattice(lattice_z, aabb_min.z, aabb_max.z, lattice_origin.y);
+
+    for (const float x : lattice_x) {
+        for (const float z : lattice_z) {
+            if (aabb_min.y <= sampleHeight(x, z))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// ComputeContact:
+// Finds the deepest point of a convex shape below the heightfield. For a set
+// of downward directions, we take the shape's support point and measure its
+// depth below the tangent plane of the terrain beneath it. The support is then
+// re-queried against that plane's normal, which converges on the deepest
+// point for smooth terrain.
+bool HeightfieldCollider::computeContact(const GJKSupportFunc* shape,
+                                         HeightfieldContact* contact) const {
+    constexpr int REFINE_ITERATIONS = 2;
+    const Vector3 DIRECTIONS[] = {
+        Vector3(0, -1, 0),        Vector3(1, -1, 0).unit(),
+        Vector3(-1, -1, 0).unit(), Vector3(0, -1, 1).unit(),
+        Vector3(0, -1, -1).unit()};
+
+    bool hit = false;
+    contact->depth = 0.f;
+
+    for (const Vector3& initial_direction : DIRECTIONS) {
+        Vector3 point = shape->furthestPoint(initial_direction);
+        Vector3 normal = sampleNormal(point.x, point.z);
+
+        for (int i = 0; i < REFINE_ITERATIONS; i++) {
+            point = shape->furthestPoint(-normal);
+            normal = sampleNormal(point.x, point.z);
+        }
+
+        // Depth below the terrain's tangent plane at the point
+        const float height = sampleHeight(point.x, point.z);
+        const float depth = (height - point.y) * normal.y;
+
+        if (depth > contact->depth) {
+            contact->point = point;
+            contact->normal = normal;
+            contact->depth = depth;
+            hit = true;
+        }
+    }
+
+    return hit;
+}
+
+} // namespace Physics
+} // namespace Engine
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "math/Vector2.h"
+#include "math/Vector3.h"
+
+namespace Engine {
+using namespace Math;
+
+namespace Physics {
+class GJKSupportFunc;
+
+// HeightSampler:
+// Returns the height of the terrain at a world-space (x,z) coordinate.
+typedef std::function<float(float x, float z)> HeightSampler;
+
+// HeightfieldRayCast:
+// Result of a ray cast against the heightfield. t is the distance along
+// the (normalized) ray direction.
+struct HeightfieldRayCast {
+    bool hit;
+    float t;
+    Vector3 position;
+    Vector3 normal;
+};
+
+// HeightfieldContact:
+// Contact between a convex shape and the heightfield. The shape must be
+// moved by normal * depth to resolve the penetration.
+struct HeightfieldContact {
+    Vector3 point;
+    Vector3 normal;
+    float depth;
+};
+
+// HeightfieldCollider Class:
+// Collision shape for heightmap-based terrain. The terrain is solid below the
+// height surface. Heights are either queried directly from a height sampler,
+// or read from a cached grid of samples over a region (bilinearly
+// interpolated). No triangle meshes are ever built.
+class HeightfieldCollider {
+  private:
+    HeightSampler sampler;
+
+    // Cached Grid:
+    // Samples covering [grid_origin, grid_origin + grid_extents], where
+    // sample (x,z) is stored at index x * grid_samples + z. Queries outside of
+    // the grid fall back to the sampler.
+    std::vector<float> grid;
+    Vector2 grid_origin;
+    Vector2 grid_extents;
+    int grid_samples;
+    // Version of the heights the grid was sampled from
+    uint32_t grid_version;
+
+    // Scratch for rebuilding the grid and for overlap tests
+    std::vector<float> grid_scratch;
+    mutable std::vector<float> lattice_x;
+    mutable std::vector<float> lattice_z;
+
+  public:
+    HeightfieldCollider(const HeightSampler& sampler);
+    ~HeightfieldCollider();
+
+    // Cache the heights of a region in a grid
+    void cacheGrid(const Vector2& origin, const Vector2& extents,
+                   int num_samples, uint32_t version = 0);
+    // Cache a grid of heights that were sampled before, such as the grid
+    // saved in a physics recording
+    void loadGrid(const Vector2& origin, const Vector2& extents,
+                  int num_samples, const float* heights,
+                  uint32_t version = 0);
+    // Keeps the grid on a region that moves, such as a window around the
+    // camera. If only the origin moved, by whole samples, the samples still
+    // in the region are kept and only the new ones are sampled. The grid is
+    // rebuilt if the version of the heights changed.
+    void updateGrid(const Vector2& origin, const Vector2& extents,
+                    int num_samples, uint32_t version);
+    void clearCache();
+    // Returns false if no grid is cached
+    bool getCachedRegion(Vector2* origin, Vector2* extents,
+                         int* num_samples) const;
+    const std::vector<float>& getCachedHeights() const;
+
+    // Memory used by the collider, in bytes
+    size_t memoryUsage() const;
+
+    // The sampler the heights come from, without the cached grid
+    const HeightSampler& getSampler() const;
+
+    // Height queries
+    float sampleHeight(float x, float z) const;
+    Vector3 sampleNormal(float x, float z) const;
+
+    // Collision queries
+    HeightfieldRayCast raycast(const Vector3& origin, const Vector3& direction,
+                               float max_distance) const;
+    bool overlapsAABB(const Vector3& aabb_min, const Vector3& aabb_max) const;
+    bool computeContact(const GJKSupportFunc* shape,
+                        HeightfieldContact* contact) const;
+
+  private:
+    bool insideGrid(float x, float z) const;
+    float sampleSpacing() const;
+};
+
+} // namespace Physics
+} // namespace Engine
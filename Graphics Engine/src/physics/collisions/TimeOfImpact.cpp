@@ -0,0 +1,69 @@
+#include "TimeOfImpact.h"
+
+#include "GJK.h"
+#include "GJKSupport.h"
+
+namespace Engine {
+namespace Physics {
+// ComputeTimeOfImpact:
+// Conservative advancement. At each iteration, we find the distance d between
+// the shapes and the speed at which the moving shape is closing that distance.
+// The shapes cannot touch in less than d / speed time, so we can safely
+// advance by that amount. This repeats until the shapes are within contact
+// distance, or are moving apart. Shapes in contact that aren't closing in
+// have no impact.
+// As the moving shape only translates, it must cover the full distance along
+// the separating direction before touching, so we never advance past the
+// first contact.
+bool ComputeTimeOfImpact(GJKSupportFunc* moving, GJKSupportFunc* target,
+                         const Vector3& displacement, TimeOfImpact* result) {
+    constexpr int MAX_ITERATIONS = 32;
+    constexpr float CONTACT_DISTANCE = 0.01f;
+
+    // A shape that isn't moving can't hit anything
+    if (displacement.magnitude() == 0.f)
+        return false;
+
+    GJKSupportTranslated swept = GJKSupportTranslated(moving, Vector3(0, 0, 0));
+
+    float time = 0.f;
+    Vector3 normal = -displacement.unit();
+
+    for (int i = 0; i < MAX_ITERATIONS; i++) {
+        swept.setOffset(displacement * time);
+
+        GJKSolver solver = GJKSolver(&swept, target);
+
+        Vector3 separation;
+        const float distance = solver.distance(&separation);
+
+        if (distance > 0.f)
+            normal = separation / distance;
+        else if (i == 0) {
+            // Shapes already overlap, which the contact solver resolves
+            return false;
+        }
+
+        // Shapes are moving apart, or parallel to one another. This is
+        // checked before contact, so that shapes resting on, sliding along
+        // or leaving each other aren't stopped.
+        const float closing_speed = -displacement.dot(normal);
+        if (closing_speed <= 0.f)
+            return false;
+
+        // Shapes are touching
+        if (distance <= CONTACT_DISTANCE)
+            break;
+
+        time += (distance - CONTACT_DISTANCE * 0.5f) / closing_speed;
+        if (time > 1.f)
+            return false;
+    }
+
+    result->time = time;
+    result->normal = normal;
+    return true;
+}
+
+} // namespace Physics
+} // namespace Engine
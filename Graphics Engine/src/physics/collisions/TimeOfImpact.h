@@ -0,0 +1,28 @@
+#pragma once
+
+#include "math/Vector3.h"
+
+namespace Engine {
+using namespace Math;
+
+namespace Physics {
+class GJKSupportFunc;
+
+// TimeOfImpact Struct:
+// Result of a time of impact query. Time is the fraction of the motion at
+// which the shapes first touch, and normal points from the target shape
+// towards the moving shape at the point of contact.
+struct TimeOfImpact {
+    float time;
+    Vector3 normal;
+};
+
+// ComputeTimeOfImpact:
+// Finds when a shape moving linearly by displacement first touches a
+// stationary target, using conservative advancement on top of GJK distance
+// queries. Returns false if the shapes do not touch during the motion.
+bool ComputeTimeOfImpact(GJKSupportFunc* moving, GJKSupportFunc* target,
+                         const Vector3& displacement, TimeOfImpact* result);
+
+} // namespace Physics
+} // namespace Engine
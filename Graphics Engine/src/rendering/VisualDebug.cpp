@@ -2,6 +2,8 @@
 
 #include <assert.h>
 
+#include "math/BatchMath.h"
+
 namespace Engine {
 namespace Graphics {
 #if defined(ENABLE_DEBUG_DRAWING)
@@ -100,33 +102,30 @@ void VisualDebug::DrawFrustum(const Matrix4& frustumMatrix, const Color& rgb) {
 #if defined(ENABLE_DEBUG_DRAWING)
     // Box from (-1, -1, 0) to (1, 1, 1). Represents Direct3D's
     // render space in normalized device coordinates.
-    Vector4 cube[8] = {
-        Vector4(-1, -1, 0, 1), Vector4(1, -1, 0, 1),  Vector4(1, 1, 0, 1),
-        Vector4(-1, 1, 0, 1),  Vector4(-1, -1, 1, 1), Vector4(1, -1, 1, 1),
-        Vector4(1, 1, 1, 1),   Vector4(-1, 1, 1, 1),
+    Vector3 cube[8] = {
+        Vector3(-1, -1, 0), Vector3(1, -1, 0), Vector3(1, 1, 0),
+        Vector3(-1, 1, 0),  Vector3(-1, -1, 1), Vector3(1, -1, 1),
+        Vector3(1, 1, 1),   Vector3(-1, 1, 1),
     };
 
     // Project the cube back into world coordinates.
-    for (int i = 0; i < 8; i++) {
-        cube[i] = frustumMatrix * cube[i];
-        cube[i] = cube[i] / cube[i].w;
-    }
+    BatchProjectPoints(frustumMatrix, cube, cube, 8);
 
     // Render cube
-    DrawLine(cube[0].xyz(), cube[1].xyz(), rgb);
-    DrawLine(cube[1].xyz(), cube[2].xyz(), rgb);
-    DrawLine(cube[2].xyz(), cube[3].xyz(), rgb);
-    DrawLine(cube[3].xyz(), cube[0].xyz(), rgb);
-
-    DrawLine(cube[0].xyz(), cube[4].xyz(), rgb);
-    DrawLine(cube[1].xyz(), cube[5].xyz(), rgb);
-    DrawLine(cube[2].xyz(), cube[6].xyz(), rgb);
-    DrawLine(cube[3].xyz(), cube[7].xyz(), rgb);
-
-    DrawLine(cube[4].xyz(), cube[5].xyz(), rgb);
-    DrawLine(cube[5].xyz(), cube[6].xyz(), rgb);
-    DrawLine(cube[6].xyz(), cube[7].xyz(), rgb);
-    DrawLine(cube[7].xyz(), cube[4].xyz(), rgb);
+    DrawLine(cube[0], cube[1], rgb);
+    DrawLine(cube[1], cube[2], rgb);
+    DrawLine(cube[2], cube[3], rgb);
+    DrawLine(cube[3], cube[0], rgb);
+
+    DrawLine(cube[0], cube[4], rgb);
+    DrawLine(cube[1], cube[5], rgb);
+    DrawLine(cube[2], cube[6], rgb);
+    DrawLine(cube[3], cube[7], rgb);
+
+    DrawLine(cube[4], cube[5], rgb);
+    DrawLine(cube[5], cube[6], rgb);
+    DrawLine(cube[6], cube[7], rgb);
+    DrawLine(cube[7], cube[4], rgb);
 #endif
 }
 
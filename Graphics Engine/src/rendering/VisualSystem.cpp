@@ -32,6 +32,7 @@ VisualSystem::VisualSystem(HWND window) {
 
     light_manager = new LightManager(device, 4096);
     terrain2D = Terrain2DManager::create(this);
+    terrain3D = std::make_unique<Terrain3DManager>(this);
 }
 
 // Render:
@@ -72,7 +73,9 @@ void VisualSystem::renderPrepare() {
     scene_manager->update();
 
     light_manager->pullDatamodelData();
-    terrain2D->update(scene_manager->getMainCamera()->getPosition());
+    terrain2D->update(scene_manager->getMainCamera()->getPosition(),
+                      scene_manager->getMainCamera()->frustum());
+    terrain3D->update(scene_manager->getMainCamera()->getPosition());
 
     // Prepare managers for data
     light_manager->updateSunDirection(Vector3(0, -1, 0));
@@ -115,6 +118,12 @@ RenderManager* VisualSystem::getRenderManager() const {
     return render_manager.get();
 }
 LightManager* VisualSystem::getLightManager() const { return light_manager; }
+Terrain2DManager* VisualSystem::getTerrain2DManager() const {
+    return terrain2D.get();
+}
+Terrain3DManager* VisualSystem::getTerrain3DManager() const {
+    return terrain3D.get();
+}
 
 Pipeline* VisualSystem::getPipeline() const { return pipeline.get(); }
 
@@ -11,6 +11,7 @@
 #include "scene/SceneListener.h"
 #include "scene/SceneManager.h"
 #include "terrain2D/Terrain2DManager.h"
+#include "terrain3D/Terrain3DManager.h"
 
 namespace Engine {
 using namespace Datamodel;
@@ -41,6 +42,7 @@ class VisualSystem {
     std::unique_ptr<SceneListener> scene_listener;
     std::unique_ptr<SceneManager> scene_manager;
     std::unique_ptr<Terrain2DManager> terrain2D;
+    std::unique_ptr<Terrain3DManager> terrain3D;
     LightManager* light_manager;
 
   public:
@@ -56,6 +58,8 @@ class VisualSystem {
     SceneManager* getSceneManager() const;
     RenderManager* getRenderManager() const;
     LightManager* getLightManager() const;
+    Terrain2DManager* getTerrain2DManager() const;
+    Terrain3DManager* getTerrain3DManager() const;
     Pipeline* getPipeline() const;
 };
 } // namespace Graphics
@@ -71,13 +71,13 @@ const Vector3& Camera::getPosition() const {
 // Returns an object which can be used to query the camera frustum.
 Frustum Camera::frustum() const {
     const Matrix4 m_world_to_frustum =
-        frustum_matrix * local_to_world_matrix.inverse();
+        frustum_matrix * local_to_world_matrix.inverseAffine();
     return Frustum(m_world_to_frustum);
 }
 
 // Camera -> World Matrix
 const Matrix4 Camera::getWorldToCameraMatrix(void) const {
-    return local_to_world_matrix.inverse();
+    return local_to_world_matrix.inverseAffine();
 }
 
 // Camera -> Projected Space Matrix
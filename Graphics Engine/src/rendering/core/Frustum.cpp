@@ -4,11 +4,31 @@
 #include <float.h>
 #include <math.h>
 
+#include "math/BatchMath.h"
+
 namespace Engine {
 namespace Graphics {
 Frustum::Frustum(const Matrix4& _m_world_to_frustum) {
     m_world_to_frustum = _m_world_to_frustum;
     m_frustum_to_world = m_world_to_frustum.inverse();
+
+    // Extract the planes from the rows of the matrix (Gribb / Hartmann). A
+    // point p is in the frustum if -w <= x <= w, -w <= y <= w, 0 <= z <= w
+    // for (x, y, z, w) = M * p, and each inequality is a plane.
+    Vector4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = Vector4(m_world_to_frustum.entry(i, 0),
+                          m_world_to_frustum.entry(i, 1),
+                          m_world_to_frustum.entry(i, 2),
+                          m_world_to_frustum.entry(i, 3));
+    }
+
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[2];
+    planes[5] = rows[3] - rows[2];
 }
 
 Vector3 Frustum::toWorldSpace(const Vector3& frustum_coords) const {
@@ -45,10 +65,7 @@ void Frustum::fillArrWithWorldPoints(Vector3* point_arr) const {
     fillArrWithFrustumPoints(point_arr);
 
     // Transform to world space
-    for (int i = 0; i < 8; i++) {
-        const Vector3 point = point_arr[i];
-        point_arr[i] = toWorldSpace(point);
-    }
+    BatchProjectPoints(m_frustum_to_world, point_arr, point_arr, 8);
 }
 
 // IntersectsAABB:
@@ -130,6 +147,46 @@ bool Frustum::intersectsOBB(const OBB& obb) const {
     return true;
 }
 
+// IntersectsAABB:
+// For each plane, finds the corner of the box furthest along the plane's
+// normal. If that corner is outside, the whole box is. Otherwise, if the
+// nearest corner is also inside, the box is entirely on the plane's inside
+// and children don't need to test it.
+bool Frustum::intersectsAABB(const AABB& aabb, uint8_t& plane_mask) const {
+    const Vector3& minimum = aabb.getMin();
+    const Vector3& maximum = aabb.getMax();
+
+    for (int i = 0; i < 6; i++) {
+        const uint8_t bit = 1 << i;
+        if (!(plane_mask & bit))
+            continue;
+
+        const Vector4& plane = planes[i];
+        const Vector3 far_corner =
+            Vector3(plane.x >= 0 ? maximum.x : minimum.x,
+                    plane.y >= 0 ? maximum.y : minimum.y,
+                    plane.z >= 0 ? maximum.z : minimum.z);
+        const Vector3 near_corner =
+            Vector3(plane.x >= 0 ? minimum.x : maximum.x,
+                    plane.y >= 0 ? minimum.y : maximum.y,
+                    plane.z >= 0 ? minimum.z : maximum.z);
+
+        const float far_distance = plane.x * far_corner.x +
+                                   plane.y * far_corner.y +
+                                   plane.z * far_corner.z + plane.w;
+        if (far_distance < 0)
+            return false;
+
+        const float near_distance = plane.x * near_corner.x +
+                                    plane.y * near_corner.y +
+                                    plane.z * near_corner.z + plane.w;
+        if (near_distance >= 0)
+            plane_mask &= ~bit;
+    }
+
+    return true;
+}
+
 bool testSeparationAlongAxis(const Vector3& axis,
                              const Vector3* frustum_points,
                              const Vector3* obb_points) {
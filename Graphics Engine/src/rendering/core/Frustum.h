@@ -1,5 +1,8 @@
 #pragma once
 
+#include <stdint.h>
+
+#include "math/AABB.h"
 #include "math/Matrix4.h"
 #include "math/OBB.h"
 
@@ -22,7 +25,14 @@ class Frustum {
 
     Vector3 camera_pos;
 
+    // World space planes (a, b, c, d), where points with
+    // a * x + b * y + c * z + d >= 0 are on the inside.
+    // Left, Right, Bottom, Top, Near, Far
+    Vector4 planes[6];
+
   public:
+    static constexpr uint8_t kAllPlanes = 0x3F;
+
     Frustum(const Matrix4& m_world_to_frustum);
 
     Vector3 toWorldSpace(const Vector3& frustum_coords) const;
@@ -33,6 +43,14 @@ class Frustum {
     void fillArrWithWorldPoints(Vector3* point_arr) const;
 
     bool intersectsOBB(const OBB& obb) const;
+    // Tests the AABB against the frustum's planes. This is much cheaper than
+    // intersectsOBB, but conservative: boxes just outside of the frustum's
+    // corners can pass.
+    // plane_mask has the planes to test (bit i for plane i). It is updated to
+    // the planes the box crosses, so that boxes contained by this one (such
+    // as the children in a tree) only need to test those. If it becomes 0,
+    // the box is entirely inside.
+    bool intersectsAABB(const AABB& aabb, uint8_t& plane_mask) const;
 
     // Return frustum to world coordinates
     const Matrix4& getFrustumToWorldMatrix() const;
@@ -13,6 +13,8 @@
 
 namespace Engine {
 namespace Graphics {
+class StructuredBuffer;
+
 // A technique determines all shader bindings, including:
 // - Vertex Shader + Resources
 // - Pixel Shader + Resources
@@ -28,6 +30,9 @@ struct Technique {
     
     std::array<BoundTexture, kVertexResourceMax> vResources;
     std::bitset<kVertexResourceMax> vResourcesFlag;
+    // Structured buffers share the resource slots with textures
+    std::array<std::shared_ptr<StructuredBuffer>, kVertexResourceMax>
+        vBuffers;
 
     std::array<std::vector<uint8_t>, kVertexConstantBufferMax> vertexCBuffers;
     std::bitset<kVertexResourceMax> vertexResourcesFlag;
@@ -42,9 +47,12 @@ struct Technique {
     void bindVertexShaderResource(uint8_t slot,
                                   std::shared_ptr<Texture> texture,
                                   SamplerType sampleState);
+    void bindVertexStructuredBuffer(uint8_t slot,
+                                    std::shared_ptr<StructuredBuffer> buffer);
     
     bool hasVertexResource(uint8_t slot) const;
     const BoundTexture& getVertexResource(uint8_t slot) const;
+    StructuredBuffer* getVertexStructuredBuffer(uint8_t slot) const;
 
     bool ready() const;
 };
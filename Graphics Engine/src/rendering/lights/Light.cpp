@@ -44,7 +44,8 @@ void ShadowLight::uploadGPUData(LightDataGPU& gpuData) {
     gpuData.color = Vector3(color.r, color.g, color.b);
     gpuData.pad1 = 0.f;
 
-    gpuData.m_local_to_projection = getFrustumMatrix() * getWorldMatrix().inverse();
+    gpuData.m_local_to_projection =
+        getFrustumMatrix() * getWorldMatrix().inverseAffine();
 
     // Needs to be normalized outside
     gpuData.tex_x = shadow_viewport.x;
@@ -74,7 +75,7 @@ Vector3 ShadowLight::getPosition(void) const { return m_world.column(3).xyz(); }
 
 Frustum ShadowLight::frustum() const {
     const Matrix4 m_world_to_frustum =
-        getFrustumMatrix() * getWorldMatrix().inverse();
+        getFrustumMatrix() * getWorldMatrix().inverseAffine();
     return Frustum(m_world_to_frustum);
 }
 
@@ -5,6 +5,7 @@
 #include "../VisualDebug.h"
 #include "../core/Camera.h"
 #include "../core/Frustum.h"
+#include "math/BatchMath.h"
 #include "math/Compute.h"
 
 namespace Engine {
@@ -68,10 +69,8 @@ void SunLight::updateCascade(int index, float min_z, float max_z,
     };
 
     // Transform from Viewing Cube -> World Space
-    for (int i = 0; i < 8; i++) {
-        const Vector3 point = frustum_points[i];
-        frustum_points[i] = cam_frustum.toWorldSpace(point);
-    }
+    BatchProjectPoints(cam_frustum.getFrustumToWorldMatrix(), frustum_points,
+                       frustum_points, 8);
 
     // For each near / far point pair, find the direction from one to the other,
     // and translate them so that they are z_min, z_max distance from the
@@ -23,6 +23,8 @@ Pipeline::Pipeline(HWND window) {
     shader_manager = new ShaderManager(device);
     shader_manager->initializeShaders();
 
+    buffer_backend = new D3D11StructuredBufferBackend(device, context);
+
     // Initialize my vertex buffers / offsets / strides
     active_pool_addr = NULL;
     memset(vb_buffers, 0, sizeof(ID3D11Buffer*) * BINDABLE_STREAM_COUNT);
@@ -94,6 +96,7 @@ Pipeline::~Pipeline() {
     }
 
     delete shader_manager;
+    delete buffer_backend;
 }
 
 void Pipeline::initializeTargets(HWND _window) {
@@ -325,12 +328,16 @@ ID3D11DeviceContext* Pipeline::getContext() const { return context; }
 Texture* Pipeline::getRenderTargetDest() const { return render_target_dest; }
 Texture* Pipeline::getRenderTargetSrc() const { return render_target_src; }
 Texture* Pipeline::getDepthStencil() const { return depth_stencil; }
+StructuredBufferBackend& Pipeline::getBufferBackend() const {
+    return *buffer_backend;
+}
 
 // Prepare
 void Pipeline::beginFrame(const uint64_t frame) {
     // Clear the the target destination color
     GPUTimer::BeginFrame(frame);
     stats = Pipeline::Stats();
+    buffer_backend->resetStats();
 
     const float baseColor[4] = {0.f, 0.f, 0.f, 1.f};
     context->ClearRenderTargetView(render_target_dest->target_view, baseColor);
@@ -651,6 +658,9 @@ void Pipeline::imGuiShutdown() {
 void Pipeline::imGui() {
 #if defined(IMGUI_ENABLED)
     ImGui::Text("Draw Call Count: %zu", stats.numDraws);
+    ImGui::Text("Structured Buffer Uploads: %zu (%zu bytes)",
+                buffer_backend->getNumUploads(),
+                buffer_backend->getBytesUploaded());
 #endif
 }
 
@@ -117,6 +117,8 @@ class Pipeline {
     // Post Processing
     ID3D11Buffer* postprocess_quad;
 
+    StructuredBufferBackend* buffer_backend;
+
     void initializeTargets(HWND window);
     void initializeSamplers();
 
@@ -129,6 +131,7 @@ class Pipeline {
     Texture* getRenderTargetDest() const;
     Texture* getRenderTargetSrc() const;
     Texture* getDepthStencil() const;
+    StructuredBufferBackend& getBufferBackend() const;
 
     // Prepare
     void beginFrame(const uint64_t frame);
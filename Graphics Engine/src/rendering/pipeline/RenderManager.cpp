@@ -466,6 +466,14 @@ void RenderManagerImpl::executeRenderPass(RenderPass pass,
                 pipeline->bindVertexTexture(slot, *boundTex.texture,
                                             boundTex.sampleState);
             }
+
+            // Changes to the buffer are uploaded before its first use
+            StructuredBuffer* buffer =
+                technique->getVertexStructuredBuffer(slot);
+            if (buffer != nullptr) {
+                buffer->flush(pipeline->getBufferBackend());
+                pipeline->bindVertexSB(*buffer, slot);
+            }
         }
 
         pipeline->bindPixelShader(technique->pixelShader);
@@ -1,14 +1,95 @@
 #include "StructuredBuffer.h"
 
+#include <string.h>
+
+#include <algorithm>
+
 #include "../Direct3D11.h"
 
 namespace Engine {
 namespace Graphics {
+// Clean elements between two changed ranges closer than this are uploaded
+// with them, as one upload
+static constexpr size_t kMergeGap = 8;
+// Smallest GPU storage, in elements
+static constexpr size_t kMinimumCapacity = 64;
+
+StructuredBufferBackend::~StructuredBufferBackend() = default;
+
+size_t StructuredBufferBackend::getBytesUploaded() const {
+    return bytesUploaded;
+}
+size_t StructuredBufferBackend::getNumUploads() const { return numUploads; }
+void StructuredBufferBackend::resetStats() {
+    bytesUploaded = 0;
+    numUploads = 0;
+}
+
+D3D11StructuredBufferBackend::D3D11StructuredBufferBackend(
+    ID3D11Device* _device, ID3D11DeviceContext* _context)
+    : device(_device), context(_context) {}
+
+void D3D11StructuredBufferBackend::allocate(StructuredBuffer& sb) {
+    if (sb.buffer)
+        sb.buffer->Release();
+    if (sb.srv)
+        sb.srv->Release();
+    sb.buffer = NULL;
+    sb.srv = NULL;
+
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = UINT(sb.elementSize * sb.capacity);
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+    desc.StructureByteStride = UINT(sb.elementSize);
+
+    device->CreateBuffer(&desc, NULL, &sb.buffer);
+    assert(sb.buffer != NULL);
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+    srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+    srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+    srv_desc.Buffer.ElementOffset = 0;
+    srv_desc.Buffer.NumElements = UINT(sb.capacity);
+
+    device->CreateShaderResourceView(sb.buffer, &srv_desc, &sb.srv);
+    assert(sb.srv != NULL);
+}
+
+void D3D11StructuredBufferBackend::upload(StructuredBuffer& sb, size_t first,
+                                          size_t count) {
+    D3D11_BOX box = {};
+    box.left = UINT(first * sb.elementSize);
+    box.right = UINT((first + count) * sb.elementSize);
+    box.top = 0;
+    box.bottom = 1;
+    box.front = 0;
+    box.back = 1;
+
+    context->UpdateSubresource(sb.buffer, 0, &box,
+                               sb.data.data() + first * sb.elementSize, 0, 0);
+
+    bytesUploaded += count * sb.elementSize;
+    numUploads++;
+}
+
+void NullStructuredBufferBackend::allocate(StructuredBuffer& sb) {}
+void NullStructuredBufferBackend::upload(StructuredBuffer& sb, size_t first,
+                                         size_t count) {
+    bytesUploaded += count * sb.getElementSize();
+    numUploads++;
+}
+
 StructuredBuffer::StructuredBuffer() {
-    elementSize = 0;
-    numElements = 0;
     buffer = NULL;
     srv = NULL;
+
+    elementSize = 0;
+    numElements = 0;
+    capacity = 0;
+    numDirty = 0;
+    lastFlushBytes = 0;
 };
 StructuredBuffer::~StructuredBuffer() {
     if (buffer)
@@ -17,45 +98,101 @@ StructuredBuffer::~StructuredBuffer() {
         srv->Release();
 }
 
-void StructuredBuffer::initialize(ID3D11Device* device, size_t elementSize,
-                                  size_t numElements) {
-    this->elementSize = elementSize;
-    this->numElements = numElements;
+void StructuredBuffer::initialize(size_t _elementSize, size_t _numElements) {
+    assert(_elementSize > 0);
+    elementSize = _elementSize;
 
-    // Create my buffer
-    D3D11_BUFFER_DESC desc = {};
-    desc.ByteWidth = elementSize * numElements;
-    desc.Usage = D3D11_USAGE_DYNAMIC;
-    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-    desc.StructureByteStride = elementSize;
+    numElements = 0;
+    capacity = 0;
+    data.clear();
+    dirty.clear();
+    numDirty = 0;
 
-    device->CreateBuffer(&desc, NULL, &buffer);
-    assert(buffer != NULL);
+    resize(_numElements);
+}
 
-    // Create my shader resource view
-    D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
-    srv_desc.Format = DXGI_FORMAT_UNKNOWN;
-    srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
-    srv_desc.Buffer.ElementOffset = 0;
-    srv_desc.Buffer.NumElements = numElements;
+void StructuredBuffer::resize(size_t _numElements) {
+    const size_t oldSize = numElements;
+    numElements = _numElements;
+
+    data.resize(numElements * elementSize, 0);
+    dirty.resize(numElements, false);
+
+    if (numElements > oldSize)
+        markDirty(oldSize, numElements - oldSize);
+    numDirty = std::count(dirty.begin(), dirty.end(), true);
+}
+
+void StructuredBuffer::write(size_t first, const void* elements,
+                             size_t count) {
+    assert(first + count <= numElements);
+    const uint8_t* src = static_cast<const uint8_t*>(elements);
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t* dest = &data[(first + i) * elementSize];
+        const uint8_t* element = src + i * elementSize;
+
+        if (memcmp(dest, element, elementSize) != 0) {
+            memcpy(dest, element, elementSize);
+            markDirty(first + i, 1);
+        }
+    }
+}
+
+// Flush:
+// If the GPU storage is too small, it's reallocated and every element is
+// uploaded. Otherwise, runs of changed elements are uploaded.
+void StructuredBuffer::flush(StructuredBufferBackend& backend) {
+    lastFlushBytes = 0;
+
+    if (numElements > capacity) {
+        capacity = std::max({numElements, capacity * 2, kMinimumCapacity});
+        backend.allocate(*this);
+        markDirty(0, numElements);
+    }
+    if (numDirty == 0)
+        return;
+
+    size_t index = 0;
+    while (index < numElements) {
+        if (!dirty[index]) {
+            index++;
+            continue;
+        }
+
+        // Extend the run past clean gaps shorter than kMergeGap
+        size_t end = index + 1;
+        size_t gap = 0;
+        for (size_t i = end; i < numElements && gap < kMergeGap; i++) {
+            if (dirty[i]) {
+                end = i + 1;
+                gap = 0;
+            } else
+                gap++;
+        }
+
+        backend.upload(*this, index, end - index);
+        lastFlushBytes += (end - index) * elementSize;
+        index = end;
+    }
 
-    device->CreateShaderResourceView(buffer, &srv_desc, &srv);
-    assert(srv != NULL);
+    std::fill(dirty.begin(), dirty.end(), false);
+    numDirty = 0;
 }
 
-// UploadData:
-// Given a vector of data elements, uploads the data to the structured
-// buffer. Takes the minimum of the two sizes to upload.
-void StructuredBuffer::uploadData(ID3D11DeviceContext* context,
-                                  const void* addr, unsigned int array_size) {
-    const unsigned int num_elements = min(numElements, array_size);
+size_t StructuredBuffer::getElementSize() const { return elementSize; }
+size_t StructuredBuffer::getNumElements() const { return numElements; }
+size_t StructuredBuffer::getCapacity() const { return capacity; }
+const uint8_t* StructuredBuffer::getData() const { return data.data(); }
+size_t StructuredBuffer::getLastFlushBytes() const { return lastFlushBytes; }
 
-    D3D11_MAPPED_SUBRESOURCE sr = {};
-    context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &sr);
-    memcpy(sr.pData, addr, elementSize * num_elements);
-    context->Unmap(buffer, 0);
+void StructuredBuffer::markDirty(size_t first, size_t count) {
+    for (size_t i = first; i < first + count; i++) {
+        if (!dirty[i]) {
+            dirty[i] = true;
+            numDirty++;
+        }
+    }
 }
 } // namespace Graphics
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
 
 struct ID3D11Device;
 struct ID3D11DeviceContext;
@@ -9,31 +13,110 @@ struct ID3D11ShaderResourceView;
 
 namespace Engine {
 namespace Graphics {
+class StructuredBuffer;
+
+// StructuredBufferBackend Interface:
+// Creates and updates the GPU copies of structured buffers, and counts the
+// bytes it uploads.
+class StructuredBufferBackend {
+  protected:
+    size_t bytesUploaded = 0;
+    size_t numUploads = 0;
+
+  public:
+    virtual ~StructuredBufferBackend();
+
+    // (Re)creates the buffer's GPU storage, with room for its capacity.
+    // The old contents are discarded.
+    virtual void allocate(StructuredBuffer& buffer) = 0;
+    // Copies elements [first, first + count) of the buffer to the GPU
+    virtual void upload(StructuredBuffer& buffer, size_t first,
+                        size_t count) = 0;
+
+    size_t getBytesUploaded() const;
+    size_t getNumUploads() const;
+    void resetStats();
+};
+
+// D3D11StructuredBufferBackend Class:
+// Stores structured buffers in default usage D3D11 buffers, so that ranges
+// of elements can be updated without rewriting the whole buffer.
+class D3D11StructuredBufferBackend : public StructuredBufferBackend {
+  private:
+    ID3D11Device* device;
+    ID3D11DeviceContext* context;
+
+  public:
+    D3D11StructuredBufferBackend(ID3D11Device* device,
+                                 ID3D11DeviceContext* context);
+
+    void allocate(StructuredBuffer& buffer) override;
+    void upload(StructuredBuffer& buffer, size_t first, size_t count) override;
+};
+
+// NullStructuredBufferBackend Class:
+// Creates no GPU resources, and only counts what would be uploaded. Lets
+// buffer updates be measured without a device.
+class NullStructuredBufferBackend : public StructuredBufferBackend {
+  public:
+    void allocate(StructuredBuffer& buffer) override;
+    void upload(StructuredBuffer& buffer, size_t first, size_t count) override;
+};
+
 // StructuredBuffer Class:
-// An interface for working with structured buffers in this engine.
+// A structured buffer, with a CPU copy of its elements. Writes compare
+// against the CPU copy and mark the elements that changed, and flushing
+// uploads only those. The GPU storage persists between frames, and grows
+// by doubling.
 class StructuredBuffer {
   private:
     friend class Pipeline;
+    friend class D3D11StructuredBufferBackend;
 
     ID3D11Buffer* buffer;
     ID3D11ShaderResourceView* srv;
 
     size_t elementSize;
     size_t numElements;
+    // Elements the GPU storage has room for, 0 if it isn't allocated
+    size_t capacity;
+
+    std::vector<uint8_t> data;
+    std::vector<bool> dirty;
+    size_t numDirty;
+
+    size_t lastFlushBytes;
 
   public:
     StructuredBuffer();
     ~StructuredBuffer();
+    // Owns its GPU resources, so it can't be copied
+    StructuredBuffer(const StructuredBuffer&) = delete;
+    StructuredBuffer& operator=(const StructuredBuffer&) = delete;
+
+    void initialize(size_t elementSize, size_t numElements = 0);
+
+    // Resizes the buffer. New elements are zeroed.
+    void resize(size_t numElements);
 
-    void initialize(ID3D11Device* device, size_t elementSize,
-                    size_t numElements);
+    // Writes count elements starting at index first. Only elements that
+    // differ from the current contents are uploaded.
+    void write(size_t first, const void* elements, size_t count = 1);
 
-    // UploadData:
-    // Given a vector of data elements, uploads the data to the structured
-    // buffer. Takes the minimum of the two sizes to upload.
-    void uploadData(ID3D11DeviceContext* context, const void* addr,
-                    unsigned int array_size);
+    // Uploads the changed elements. Nearby ranges are merged, so that an
+    // upload isn't issued for every element.
+    void flush(StructuredBufferBackend& backend);
+
+    size_t getElementSize() const;
+    size_t getNumElements() const;
+    size_t getCapacity() const;
+    const uint8_t* getData() const;
+    // Bytes uploaded by the last flush
+    size_t getLastFlushBytes() const;
+
+  private:
+    void markDirty(size_t first, size_t count);
 };
 
 } // namespace Graphics
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
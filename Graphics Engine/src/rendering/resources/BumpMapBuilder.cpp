@@ -39,18 +39,21 @@ void BumpMapBuilder::setHeight(int x, int y, float val) {
 
     heightmap[index(x, y)] = val;
 }
+// SampleNoise:
+// Sets the builder's height with a noise function
+void BumpMapBuilder::sampleNoise(const Noise& noise, float freq,
+                                 float amplitude) {
+    // The grid is laid out the same way as the heightmap
+    noise.octaveNoiseGrid2D(0.f, 0.f, freq, freq, heightmap_width,
+                            heightmap_height, 5, 0.75f, heightmap.data());
+    for (float& height : heightmap)
+        height *= amplitude;
+}
 // SamplePerlinNoise:
 // Sets the builder's height with the Perlin Noise function
 void BumpMapBuilder::samplePerlinNoise(unsigned int seed, float freq,
                                        float amplitude) {
-    PerlinNoise noise = PerlinNoise(seed);
-
-    for (int i = 0; i < heightmap_width; i++) {
-        for (int j = 0; j < heightmap_height; j++) {
-            const float val = noise.octaveNoise2D(freq * i, freq * j, 5, 0.75f);
-            setHeight(i, j, amplitude * val);
-        }
-    }
+    sampleNoise(PerlinNoise(seed), freq, amplitude);
 }
 
 // ComputeNormals:
@@ -2,6 +2,8 @@
 
 #include "TextureBuilder.h"
 
+#include "math/Noise.h"
+
 namespace Engine {
 namespace Graphics {
 // BumpMapBuilder Class:
@@ -29,6 +31,8 @@ class BumpMapBuilder : private TextureBuilder {
 
     // Encode a height value in the heightmap
     void setHeight(int x, int y, float height);
+    // Create bump map with fBm noise from the given generator
+    void sampleNoise(const Math::Noise& noise, float freq, float amplitude);
     // Create bump map with Perlin Noise
     void samplePerlinNoise(unsigned int seed, float freq, float amplitude);
 
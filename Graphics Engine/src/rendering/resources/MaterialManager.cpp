@@ -29,11 +29,16 @@ void Technique::uploadPixelCBData(uint8_t slot, const void* src,
 void Technique::bindVertexShaderResource(uint8_t slot,
                                          std::shared_ptr<Texture> texture,
                                          SamplerType sampleState) {
-    assert(slot <= kVertexResourceMax);
+    assert(slot <= kVertexResourceMax && vBuffers[slot] == nullptr);
     vResources[slot].texture = texture;
     vResources[slot].sampleState = sampleState;
     vResourcesFlag.set(slot);
 }
+void Technique::bindVertexStructuredBuffer(
+    uint8_t slot, std::shared_ptr<StructuredBuffer> buffer) {
+    assert(slot <= kVertexResourceMax && !vResourcesFlag.test(slot));
+    vBuffers[slot] = buffer;
+}
 bool Technique::hasVertexResource(uint8_t slot) const {
     assert(slot <= kVertexResourceMax);
     return vResourcesFlag.test(slot);
@@ -43,6 +48,10 @@ Technique::getVertexResource(uint8_t slot) const {
     assert(slot <= kVertexResourceMax && vResourcesFlag.test(slot));
     return vResources[slot];
 }
+StructuredBuffer* Technique::getVertexStructuredBuffer(uint8_t slot) const {
+    assert(slot <= kVertexResourceMax);
+    return vBuffers[slot].get();
+}
 
 bool Technique::ready() const {
     bool ready = true;
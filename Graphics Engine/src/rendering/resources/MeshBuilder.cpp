@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <functional>
 
+#include "math/BatchMath.h"
 #include "math/Compute.h"
 
 namespace Engine {
@@ -193,11 +194,10 @@ void MeshBuilder::addCube(const Vector3& center, const Quaternion& rotation,
                            3, 7, 6, 2};
 
     // Transform my vertices.
-    const Matrix3 m_rotation = rotation.rotationMatrix3();
-
-    for (int i = 0; i < 8; i++) {
-        vertices[i] = center + m_rotation * (vertices[i] * size);
-    }
+    const Matrix4 m_transform = Matrix4::T_Translate(center) *
+                                rotation.rotationMatrix4() *
+                                Matrix4::T_Scale(size, size, size);
+    BatchTransformPoints(m_transform, vertices, vertices, 8);
 
     // Add the faces of the cube. We need to add repeat vertices so that the
     // normals for each face are sharp.
@@ -267,6 +267,39 @@ void MeshBuilder::addTube(const Vector3& start, const Vector3& end,
     }
 }
 
+// BakeTransform:
+// Applies a transform to every vertex in the builder. Positions are
+// transformed as points, and normals by the inverse transpose of the matrix
+// so that they stay perpendicular to the surface under non-uniform scales.
+void MeshBuilder::bakeTransform(const Matrix4& m_transform) {
+    const size_t count = vertex_buffer.size();
+
+    // The vertices are interleaved, so gather each stream into SoA form
+    // before running the batch kernels on it.
+    Vector3SoA stream;
+    stream.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+        stream.set(i, vertex_buffer[i].position);
+    BatchTransformPoints(m_transform, stream, stream);
+    for (size_t i = 0; i < count; i++)
+        vertex_buffer[i].position = stream.get(i);
+
+    if (layout.hasVertexStream(NORMAL)) {
+        const Matrix4 m_normal = m_transform.inverseAffine().transpose();
+
+        for (size_t i = 0; i < count; i++)
+            stream.set(i, vertex_buffer[i].normal);
+        BatchTransformVectors(m_normal, stream, stream);
+        for (size_t i = 0; i < count; i++) {
+            // Leave degenerate normals for regenerateNormals() to fill in
+            const Vector3 normal = stream.get(i);
+            if (normal.magnitude() != 0)
+                vertex_buffer[i].normal = normal.unit();
+        }
+    }
+}
+
 // RegenerateNormals:
 // Discard the current normals for the mesh and regenerate them
 void MeshBuilder::regenerateNormals() {
@@ -95,6 +95,9 @@ class MeshBuilder {
     void addTube(const Vector3& start, const Vector3& end, float radius,
                  int num_vertices);
 
+    // Transform every vertex in the builder by a matrix
+    void bakeTransform(const Matrix4& m_transform);
+
     // Discard the current normals for the mesh and regenerate them
     void regenerateNormals();
 
@@ -51,6 +51,12 @@ class ResourceManagerImpl {
 
         bool newTexture = true;
         std::shared_ptr<Texture> texture = nullptr;
+
+        // If true, data is written to the texture's region starting at
+        // (regionX, regionY)
+        bool region = false;
+        unsigned int regionX = 0;
+        unsigned int regionY = 0;
     };
 
   private:
@@ -94,6 +100,9 @@ class ResourceManagerImpl {
     std::shared_ptr<Texture>
     requestTexture(const TextureBuilder& tex_builder, bool editable,
                    const std::shared_ptr<Texture>& target);
+    void requestTextureRegion(const TextureBuilder& tex_builder,
+                              const std::shared_ptr<Texture>& target, UINT x,
+                              UINT y);
 
     void clearDepthStencil(const Texture& texture);
 
@@ -156,6 +165,11 @@ ResourceManager::requestTexture(const TextureBuilder& texture_builder,
                                 const std::shared_ptr<Texture>& target) {
     return mImpl->requestTexture(texture_builder, editable, target);
 }
+void ResourceManager::requestTextureRegion(
+    const TextureBuilder& texture_builder,
+    const std::shared_ptr<Texture>& target, UINT x, UINT y) {
+    mImpl->requestTextureRegion(texture_builder, target, x, y);
+}
 
 void ResourceManager::clearDepthStencil(const Texture& texture) {
     mImpl->clearDepthStencil(texture);
@@ -365,7 +379,8 @@ ResourceManagerImpl::requestTexture(const TextureBuilder& tex_builder,
         job.texture = std::make_shared<Texture>();
 
         job.texture->width = job.width;
-        job.texture->height = job.width;
+        job.texture->height = job.height;
+        job.texture->layout = job.layout;
         job.texture->editable = editable;
 
         job.texture->ready = false;
@@ -380,6 +395,27 @@ ResourceManagerImpl::requestTexture(const TextureBuilder& tex_builder,
     return job.texture;
 }
 
+void ResourceManagerImpl::requestTextureRegion(
+    const TextureBuilder& tex_builder, const std::shared_ptr<Texture>& target,
+    UINT x, UINT y) {
+    assert(target != nullptr);
+    std::scoped_lock<std::mutex> lock(texture_job_mutex);
+
+    TextureBuildingJob& job = texture_jobs.emplace_back();
+    job.data = tex_builder.data;
+    job.width = tex_builder.width;
+    job.height = tex_builder.height;
+    job.layout = tex_builder.layout;
+
+    job.newTexture = false;
+    job.texture = target;
+    job.texture->ready = false;
+
+    job.region = true;
+    job.regionX = x;
+    job.regionY = y;
+}
+
 void ResourceManagerImpl::clearDepthStencil(const Texture& texture) {
     assert(texture.depth_view != nullptr);
     context->ClearDepthStencilView(texture.depth_view, D3D11_CLEAR_DEPTH, 1.0f,
@@ -588,6 +624,25 @@ void ResourceManagerImpl::processTextureJob(const TextureBuildingJob& job) {
         result = device->CreateShaderResourceView(
             job.texture->texture, &tex_view, &(job.texture->shader_view));
         assert(SUCCEEDED(result));
+    } else if (job.region) {
+        // Dynamic textures can only be written to as a whole, so regions are
+        // copied in with UpdateSubresource instead.
+        assert(!texture->editable);
+        assert(job.regionX + job.width <= texture->width);
+        assert(job.regionY + job.height <= texture->height);
+        assert(job.layout == texture->layout);
+
+        D3D11_BOX box;
+        box.left = job.regionX;
+        box.right = job.regionX + job.width;
+        box.top = job.regionY;
+        box.bottom = job.regionY + job.height;
+        box.front = 0;
+        box.back = 1;
+
+        const size_t byteSize = TextureLayoutByteSize(job.layout);
+        context->UpdateSubresource(texture->texture, 0, &box,
+                                   job.data.data(), job.width * byteSize, 0);
     } else {
         assert(texture->editable);
         assert(job.width == texture->width);
@@ -64,6 +64,12 @@ class ResourceManager {
     std::shared_ptr<Texture>
     requestTexture(const TextureBuilder& texture_builder, bool editable = false,
                    const std::shared_ptr<Texture>& target = nullptr);
+    // Uploads the builder's data into a region of an existing texture, with
+    // the region's top-left texel at (x, y). Only the region is sent to the
+    // GPU. The target cannot be editable.
+    void requestTextureRegion(const TextureBuilder& texture_builder,
+                              const std::shared_ptr<Texture>& target, UINT x,
+                              UINT y);
 
     // Not-Thread Safe Creation / Modification of Resources.
     // Must be done on main thread if called.
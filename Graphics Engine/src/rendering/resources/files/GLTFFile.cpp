@@ -1,12 +1,15 @@
 #include "GLTFFile.h"
 
 #include <assert.h>
+#include <string.h>
 #include <functional>
 #include <unordered_map>
 #include <vector>
 
 #include <string>
 
+#include "math/BatchMath.h"
+
 // The GLTFFile uses the cgltf library to read GLTF files.
 // See https://github.com/jkuhlmann/cgltf
 #include "cgltf/cgltf.h"
@@ -332,6 +335,25 @@ Asset* GLTFFile::readFromFile(MeshBuilder& mesh_builder,
     */
 }
 
+// FindMeshTransform:
+// Finds the world transform of the first node that instances the mesh.
+// Returns false if no node does, or if its transform is the identity, in
+// which case the mesh can be used as is.
+static bool FindMeshTransform(const cgltf_data* data, const cgltf_mesh* mesh,
+                              Matrix4& m_transform) {
+    for (int i = 0; i < data->nodes_count; i++) {
+        if (data->nodes[i].mesh != mesh)
+            continue;
+
+        // Both cgltf and Matrix4 store matrices by column
+        cgltf_node_transform_world(&data->nodes[i], m_transform[0]);
+
+        const Matrix4 m_identity = Matrix4::Identity();
+        return memcmp(&m_transform, &m_identity, sizeof(Matrix4)) != 0;
+    }
+    return false;
+}
+
 void GLTFFile::ReadGLTFMesh(const std::string& path, MeshBuilder& builder) {
     builder.reset();
 
@@ -432,10 +454,88 @@ void GLTFFile::ReadGLTFMesh(const std::string& path, MeshBuilder& builder) {
                       memcpy(dest + index, data, size);
                   });
 
+    // Bake the transform of the mesh's node into its vertices, so that the
+    // mesh matches how it was placed in the file
+    Matrix4 m_transform;
+    if (FindMeshTransform(data, &mesh, m_transform))
+        builder.bakeTransform(m_transform);
+
     // Finally, free any used memory
     cgltf_free(data);
 }
 
+// ReadGLTFPositions:
+// Reads the vertex positions of every primitive of every mesh in the file,
+// transformed by the mesh's node, and optionally their triangles. Unlike
+// ReadGLTFMesh, files can have any number of meshes, which makes this
+// suitable for collision shapes.
+bool GLTFFile::ReadGLTFPositions(const std::string& path,
+                                 std::vector<Vector3>& positions,
+                                 std::vector<UINT>* indices) {
+    positions.clear();
+    if (indices != nullptr)
+        indices->clear();
+
+    cgltf_options options = {};
+    cgltf_data* data = NULL;
+
+    if (cgltf_parse_file(&options, path.c_str(), &data) !=
+        cgltf_result_success)
+        return false;
+
+    if (cgltf_load_buffers(&options, data, path.c_str()) !=
+        cgltf_result_success) {
+        cgltf_free(data);
+        return false;
+    }
+
+    for (int i_mesh = 0; i_mesh < data->meshes_count; i_mesh++) {
+        const cgltf_mesh& mesh = data->meshes[i_mesh];
+        const size_t mesh_first = positions.size();
+
+        for (int i_prim = 0; i_prim < mesh.primitives_count; i_prim++) {
+            const cgltf_primitive& prim = mesh.primitives[i_prim];
+
+            for (int i_attr = 0; i_attr < prim.attributes_count; i_attr++) {
+                const cgltf_attribute& attr = prim.attributes[i_attr];
+                if (attr.type != cgltf_attribute_type_position)
+                    continue;
+
+                // Unpacking handles the accessor's offset and stride
+                const size_t first = positions.size();
+                positions.resize(first + attr.data->count);
+                cgltf_accessor_unpack_floats(attr.data, &positions[first].x,
+                                             attr.data->count * 3);
+
+                if (indices == nullptr ||
+                    prim.type != cgltf_primitive_type_triangles)
+                    continue;
+
+                // Primitives without indices list their vertices in order
+                if (prim.indices != nullptr) {
+                    for (int i = 0; i < prim.indices->count; i++)
+                        indices->push_back(
+                            first + cgltf_accessor_read_index(prim.indices, i));
+                } else {
+                    for (int i = 0; i < attr.data->count; i++)
+                        indices->push_back(first + i);
+                }
+            }
+        }
+
+        // Match the transform ReadGLTFMesh bakes into the rendered mesh
+        Matrix4 m_transform;
+        if (FindMeshTransform(data, &mesh, m_transform)) {
+            BatchTransformPoints(m_transform, positions.data() + mesh_first,
+                                 positions.data() + mesh_first,
+                                 positions.size() - mesh_first);
+        }
+    }
+
+    cgltf_free(data);
+    return true;
+}
+
 // --- Parsing ---
 /*
 void GLTFFile::parseMaterial(const cgltf_material* mat_data,
@@ -25,6 +25,9 @@ class GLTFFile {
                         ID3D11Device* device, ID3D11DeviceContext* context);
 
     static void ReadGLTFMesh(const std::string& path, MeshBuilder& builder);
+    static bool ReadGLTFPositions(const std::string& path,
+                                  std::vector<Vector3>& positions,
+                                  std::vector<UINT>* indices = nullptr);
 
   private:
     //// Material Parsing
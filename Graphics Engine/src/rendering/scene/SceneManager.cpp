@@ -3,6 +3,8 @@
 #include <mutex>
 #include <unordered_set>
 
+#include "math/SIMD.h"
+#include "rendering/ImGui.h"
 #include "rendering/VisualSystem.h"
 #include "rendering/resources/MaterialManager.h"
 #include "rendering/resources/ResourceManager.h"
@@ -43,6 +45,8 @@ class SceneManagerImpl {
 
     Camera* getMainCamera();
 
+    void imGui();
+
   private:
     void processDirtyMeshes();
     void processUpdatePackets();
@@ -70,7 +74,9 @@ std::unique_ptr<SceneManager> SceneManager::create(VisualSystem* visualSystem) {
 }
 
 SceneManagerImpl::SceneManagerImpl(VisualSystem* _visualSystem)
-    : mVisualSystem(_visualSystem) {}
+    : mVisualSystem(_visualSystem) {
+    ImGuiHelper::registerImGuiCallback("Render/Scene", [this]() { imGui(); });
+}
 SceneManagerImpl::~SceneManagerImpl() = default;
 
 void SceneManagerImpl::submitUpdatePacket(const UpdatePacket& packet) {
@@ -198,7 +204,7 @@ void SceneManagerImpl::processMeshPacket(const UpdatePacket& packet) {
         case RenderableMeshUpdatePacket::Property::LocalMatrix: {
             mesh.instanceData.mLocalToWorld = std::get<Matrix4>(data.data);
             mesh.instanceData.mNormalTransform =
-                mesh.instanceData.mLocalToWorld.inverse().transpose();
+                mesh.instanceData.mLocalToWorld.inverseAffine().transpose();
             if (mesh.blockKey != kInvalidDrawBlockKey) {
                 renderManager->updateInstanceData(mesh.blockKey,
                                                   mesh.instanceData);
@@ -239,5 +245,14 @@ void SceneManagerImpl::processMeshPacket(const UpdatePacket& packet) {
 
 Camera* SceneManagerImpl::getMainCamera() { return activeCamera; }
 
+void SceneManagerImpl::imGui() {
+#if defined(IMGUI_ENABLED)
+    ImGui::Text("Cameras: %zu, Meshes: %zu", cameras.size(), meshes.size());
+
+    ImGui::SeparatorText("Transform Math");
+    ImGui::Text("SIMD Backend: %s", SIMD::BackendName());
+#endif
+}
+
 } // namespace Graphics
 } // namespace Engine
\ No newline at end of file
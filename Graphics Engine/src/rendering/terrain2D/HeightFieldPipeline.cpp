@@ -0,0 +1,443 @@
+#include "HeightFieldPipeline.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "core/ThreadPool.h"
+#include "utility/Stopwatch.h"
+
+#include "rendering/ImGui.h"
+
+namespace Engine {
+namespace Graphics {
+// Grids are split into tiles of at most this many samples on a side
+static constexpr int kGridTileSize = 128;
+// Largest apron a tile is padded by, so erosion settings can't make tiles
+// arbitrarily expensive
+static constexpr int kMaxApron = 32;
+
+// MixSeed:
+// Combines a seed with a value, so that seeds for different tiles and
+// stages are unrelated.
+static uint32_t MixSeed(uint32_t seed, uint32_t value) {
+    uint32_t hash = seed ^ (value * 0x9e3779b9u);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// FloorDiv:
+// Divides, rounding towards negative infinity
+static int FloorDiv(int value, int divisor) {
+    return value / divisor - (value % divisor < 0 ? 1 : 0);
+}
+
+bool HeightTileKey::operator==(const HeightTileKey& other) const {
+    return seed == other.seed && x == other.x && z == other.z &&
+           lod == other.lod;
+}
+
+size_t HeightTileKeyHash::operator()(const HeightTileKey& key) const {
+    uint32_t hash = MixSeed(key.seed, (uint32_t)key.x);
+    hash = MixSeed(hash, (uint32_t)key.z);
+    return MixSeed(hash, (uint32_t)key.lod);
+}
+
+HeightFieldPipeline::HeightFieldPipeline() : HeightFieldPipeline(Config()) {}
+HeightFieldPipeline::HeightFieldPipeline(const Config& config)
+    : mConfig(config) {}
+HeightFieldPipeline::~HeightFieldPipeline() = default;
+
+const HeightFieldPipeline::Config& HeightFieldPipeline::getConfig() const {
+    return mConfig;
+}
+
+HeightStage* HeightFieldPipeline::addStage(std::unique_ptr<HeightStage> stage) {
+    stage->setNoise(mNoiseType, MixSeed(mSeed, (uint32_t)mStages.size()));
+    mStages.push_back(std::move(stage));
+    invalidate();
+    return mStages.back().get();
+}
+
+size_t HeightFieldPipeline::getStageCount() const { return mStages.size(); }
+HeightStage* HeightFieldPipeline::getStage(size_t index) {
+    return mStages[index].get();
+}
+
+void HeightFieldPipeline::setNoise(NoiseType type, uint32_t seed) {
+    mNoiseType = type;
+    mSeed = seed;
+
+    for (size_t i = 0; i < mStages.size(); i++)
+        mStages[i]->setNoise(mNoiseType, MixSeed(mSeed, (uint32_t)i));
+
+    invalidate();
+}
+NoiseType HeightFieldPipeline::getNoiseType() const { return mNoiseType; }
+uint32_t HeightFieldPipeline::getSeed() const { return mSeed; }
+
+uint32_t HeightFieldPipeline::getVersion() const { return mVersion; }
+
+void HeightFieldPipeline::invalidate() {
+    mVersion++;
+
+    std::unique_lock<std::mutex> lock(mCacheMutex);
+    mCache.clear();
+    mLRU.clear();
+}
+
+// ComputeApron:
+// Pads by the largest apron of the enabled stages
+int HeightFieldPipeline::computeApron() const {
+    int apron = 0;
+    for (const auto& stage : mStages) {
+        if (stage->enabled)
+            apron = std::max(apron, stage->apron());
+    }
+    return std::min(apron, kMaxApron);
+}
+
+// IsPointwise:
+// True if every enabled stage is pointwise, so that heights do not depend on
+// how a grid is split into tiles
+bool HeightFieldPipeline::isPointwise() const {
+    for (const auto& stage : mStages) {
+        if (stage->enabled && !stage->isPointwise())
+            return false;
+    }
+    return true;
+}
+
+void HeightFieldPipeline::runStages(HeightSamples& samples) const {
+    for (const auto& stage : mStages) {
+        if (!stage->enabled)
+            continue;
+        if (!samples.grid && !stage->isPointwise())
+            continue;
+
+        stage->apply(samples);
+    }
+}
+
+// SamplePoint:
+// Runs the pointwise stages on the one sample directly, so that point
+// queries (used by physics and placement) do not allocate.
+float HeightFieldPipeline::samplePoint(float x, float z) const {
+    float height = 0.f;
+    for (const auto& stage : mStages) {
+        if (stage->enabled && stage->isPointwise())
+            stage->applyPoint(x, z, height);
+    }
+    return height;
+}
+
+void HeightFieldPipeline::samplePoints(const float* x, const float* z,
+                                       float* output, size_t count) const {
+    HeightSamples samples;
+    samples.countX = (int)count;
+    samples.countZ = 1;
+    samples.grid = false;
+    samples.x.assign(x, x + count);
+    samples.z.assign(z, z + count);
+    samples.heights.assign(count, 0.f);
+
+    runStages(samples);
+
+    std::copy(samples.heights.begin(), samples.heights.end(), output);
+}
+
+// GenerateBlock:
+// Generates a grid of count_x by count_z samples, padded by the apron, and
+// writes the unpadded samples to output[i * output_stride + j].
+void HeightFieldPipeline::generateBlock(const Vector2& origin,
+                                        const Vector2& spacing, int count_x,
+                                        int count_z, uint32_t seed,
+                                        float* output,
+                                        int output_stride) const {
+    const int apron = computeApron();
+
+    HeightSamples samples;
+    samples.countX = count_x + 2 * apron;
+    samples.countZ = count_z + 2 * apron;
+    samples.grid = true;
+    samples.spacing = std::max(spacing.x, spacing.y);
+    samples.seed = seed;
+
+    const size_t size = (size_t)samples.countX * samples.countZ;
+    samples.x.resize(size);
+    samples.z.resize(size);
+    samples.heights.assign(size, 0.f);
+
+    for (int i = 0; i < samples.countX; i++) {
+        for (int j = 0; j < samples.countZ; j++) {
+            const size_t index = (size_t)i * samples.countZ + j;
+            samples.x[index] = origin.x + (i - apron) * spacing.x;
+            samples.z[index] = origin.y + (j - apron) * spacing.y;
+        }
+    }
+
+    runStages(samples);
+
+    for (int i = 0; i < count_x; i++) {
+        const float* row = &samples.at(i + apron, apron);
+        std::copy(row, row + count_z, output + (size_t)i * output_stride);
+    }
+}
+
+// SampleGrid:
+// Splits the grid along a lattice of tiles fixed in the world, so that each
+// sample is always generated by the same tile, with the same seed and
+// surroundings, however the grid was requested. Otherwise erosion would give
+// different heights where differently placed grids meet. Tiles are generated
+// in parallel, and each writes the part of the grid it covers.
+void HeightFieldPipeline::sampleGrid(const Vector2& origin,
+                                     const Vector2& spacing, int count_x,
+                                     int count_z, float* output) const {
+    // Index of the first sample on the world's sample lattice, and the offset
+    // of the grid from the lattice (zero for grids that start on a sample)
+    const int first_x = (int)floorf(origin.x / spacing.x + 0.5f);
+    const int first_z = (int)floorf(origin.y / spacing.y + 0.5f);
+    const Vector2 offset = Vector2(origin.x - first_x * spacing.x,
+                                   origin.y - first_z * spacing.y);
+
+    const int first_tile_x = FloorDiv(first_x, kGridTileSize);
+    const int first_tile_z = FloorDiv(first_z, kGridTileSize);
+    const int tiles_x =
+        FloorDiv(first_x + count_x - 1, kGridTileSize) - first_tile_x + 1;
+    const int tiles_z =
+        FloorDiv(first_z + count_z - 1, kGridTileSize) - first_tile_z + 1;
+
+    // Pointwise stages give the same heights however the grid is split, so
+    // only the part of each tile in the grid needs generating
+    const bool whole_tiles = !isPointwise();
+
+    ParallelFor((size_t)tiles_x * tiles_z, [&](size_t index) {
+        const int tile_x = first_tile_x + int(index / tiles_z);
+        const int tile_z = first_tile_z + int(index % tiles_z);
+        const int tile_start_x = tile_x * kGridTileSize;
+        const int tile_start_z = tile_z * kGridTileSize;
+
+        // Lattice samples of the tile that are in the grid
+        const int start_x = std::max(tile_start_x, first_x);
+        const int start_z = std::max(tile_start_z, first_z);
+        const int end_x =
+            std::min(tile_start_x + kGridTileSize, first_x + count_x);
+        const int end_z =
+            std::min(tile_start_z + kGridTileSize, first_z + count_z);
+        float* tile_output = output + (size_t)(start_x - first_x) * count_z +
+                             (start_z - first_z);
+
+        if (!whole_tiles) {
+            const Vector2 block_origin =
+                Vector2(start_x * spacing.x + offset.x,
+                        start_z * spacing.y + offset.y);
+            generateBlock(block_origin, spacing, end_x - start_x,
+                          end_z - start_z, mSeed, tile_output, count_z);
+            return;
+        }
+
+        const Vector2 tile_origin =
+            Vector2(tile_start_x * spacing.x + offset.x,
+                    tile_start_z * spacing.y + offset.y);
+        uint32_t seed = MixSeed(mSeed, (uint32_t)tile_x);
+        seed = MixSeed(seed, (uint32_t)tile_z);
+
+        std::vector<float> heights((size_t)kGridTileSize * kGridTileSize);
+        generateBlock(tile_origin, spacing, kGridTileSize, kGridTileSize, seed,
+                      heights.data(), kGridTileSize);
+
+        for (int i = start_x; i < end_x; i++) {
+            const float* row =
+                &heights[(size_t)(i - tile_start_x) * kGridTileSize +
+                         (start_z - tile_start_z)];
+            std::copy(row, row + (end_z - start_z),
+                      tile_output + (size_t)(i - start_x) * count_z);
+        }
+    });
+}
+
+HeightTileKey HeightFieldPipeline::tileKey(int x, int z, int lod) const {
+    HeightTileKey key;
+    key.seed = mSeed;
+    key.x = x;
+    key.z = z;
+    key.lod = lod;
+    return key;
+}
+
+std::shared_ptr<HeightTile>
+HeightFieldPipeline::generateTile(const HeightTileKey& key) const {
+    const float tile_width = mConfig.tileSize * float(1 << key.lod);
+
+    std::shared_ptr<HeightTile> tile = std::make_shared<HeightTile>();
+    tile->key = key;
+    tile->origin = Vector2(key.x * tile_width, key.z * tile_width);
+    tile->resolution = mConfig.tileResolution;
+    tile->spacing = tile_width / (tile->resolution - 1);
+    tile->heights.resize((size_t)tile->resolution * tile->resolution);
+
+    HeightTileKeyHash hash;
+    generateBlock(tile->origin, Vector2(tile->spacing, tile->spacing),
+                  tile->resolution, tile->resolution, (uint32_t)hash(key),
+                  tile->heights.data(), tile->resolution);
+
+    return tile;
+}
+
+std::shared_ptr<const HeightTile>
+HeightFieldPipeline::getTile(const HeightTileKey& key) {
+    std::shared_ptr<const HeightTile> tile;
+    getTiles(&key, 1, &tile);
+    return tile;
+}
+
+// GetTiles:
+// Finds the cached tiles, and generates the rest in parallel. The cache is
+// not locked while tiles generate.
+void HeightFieldPipeline::getTiles(const HeightTileKey* keys, size_t count,
+                                   std::shared_ptr<const HeightTile>* output) {
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < count; i++) {
+        output[i] = findCachedTile(keys[i]);
+        if (output[i] == nullptr)
+            missing.push_back(i);
+    }
+
+    ParallelFor(missing.size(), [&](size_t index) {
+        const size_t i = missing[index];
+        output[i] = generateTile(keys[i]);
+    });
+
+    for (size_t i : missing)
+        insertCachedTile(output[i]);
+}
+
+std::shared_ptr<const HeightTile>
+HeightFieldPipeline::findCachedTile(const HeightTileKey& key) {
+    std::unique_lock<std::mutex> lock(mCacheMutex);
+
+    const auto it = mCache.find(key);
+    if (it == mCache.end()) {
+        mCacheMisses++;
+        return nullptr;
+    }
+
+    // Move to the front, as the most recently used
+    mLRU.splice(mLRU.begin(), mLRU, it->second.lruPosition);
+    mCacheHits++;
+    return it->second.tile;
+}
+
+void HeightFieldPipeline::insertCachedTile(
+    const std::shared_ptr<const HeightTile>& tile) {
+    std::unique_lock<std::mutex> lock(mCacheMutex);
+
+    if (mCache.find(tile->key) != mCache.end())
+        return;
+
+    while (!mLRU.empty() && mCache.size() >= mConfig.cacheCapacity) {
+        mCache.erase(mLRU.back());
+        mLRU.pop_back();
+    }
+
+    mLRU.push_front(tile->key);
+    mCache[tile->key] = CacheEntry{tile, mLRU.begin()};
+}
+
+#if defined(IMGUI_ENABLED)
+// TileBenchmark:
+// Times generating a square of tiles one at a time on this thread, in
+// parallel on the thread pool with an empty cache, and again from the
+// cache. Times are in milliseconds.
+struct TileBenchmark {
+    int tiles = 0;
+
+    double serial = 0.0;
+    double parallel = 0.0;
+    double cached = 0.0;
+};
+
+static TileBenchmark RunTileBenchmark(HeightFieldPipeline& pipeline) {
+    constexpr int NUM_TILES = 8;
+
+    TileBenchmark results;
+    results.tiles = NUM_TILES * NUM_TILES;
+
+    std::vector<HeightTileKey> keys;
+    for (int x = 0; x < NUM_TILES; x++) {
+        for (int z = 0; z < NUM_TILES; z++)
+            keys.push_back(pipeline.tileKey(x - NUM_TILES / 2,
+                                            z - NUM_TILES / 2, 0));
+    }
+    std::vector<std::shared_ptr<const HeightTile>> tiles(keys.size());
+
+    Utility::Stopwatch stopwatch;
+
+    stopwatch.Reset();
+    for (const HeightTileKey& key : keys)
+        pipeline.generateTile(key);
+    results.serial = stopwatch.Duration() * 1000.0;
+
+    pipeline.invalidate();
+    stopwatch.Reset();
+    pipeline.getTiles(keys.data(), keys.size(), tiles.data());
+    results.parallel = stopwatch.Duration() * 1000.0;
+
+    stopwatch.Reset();
+    pipeline.getTiles(keys.data(), keys.size(), tiles.data());
+    results.cached = stopwatch.Duration() * 1000.0;
+
+    return results;
+}
+#endif
+
+bool HeightFieldPipeline::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+
+    for (size_t i = 0; i < mStages.size(); i++) {
+        HeightStage* stage = mStages[i].get();
+
+        ImGui::PushID((int)i);
+        changed |= EditCheckbox("##Enabled", stage->enabled, before_edit);
+        ImGui::SameLine();
+        if (ImGui::TreeNode(stage->name())) {
+            changed |= stage->imGui(before_edit);
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+
+    if (changed)
+        invalidate();
+
+    {
+        std::unique_lock<std::mutex> lock(mCacheMutex);
+        ImGui::Text("Cached Tiles: %zu / %zu", mCache.size(),
+                    mConfig.cacheCapacity);
+        ImGui::Text("Cache Hits: %zu, Misses: %zu", mCacheHits, mCacheMisses);
+    }
+
+    static TileBenchmark benchmark;
+    if (ImGui::Button("Benchmark Tiles"))
+        benchmark = RunTileBenchmark(*this);
+
+    if (benchmark.tiles > 0) {
+        ImGui::Text("%i Tiles (ms) Serial: %.1f, Parallel: %.1f, Cached: %.2f",
+                    benchmark.tiles, benchmark.serial, benchmark.parallel,
+                    benchmark.cached);
+    }
+
+    return changed;
+#else
+    return false;
+#endif
+}
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vector2.h"
+
+#include "HeightStages.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+// HeightTileKey:
+// Identifies a tile of the world's height field. Tiles at a given LOD are
+// tileSize * 2^lod world units wide, and tile (x, z) starts at
+// (x, z) * that width.
+struct HeightTileKey {
+    uint32_t seed = 0;
+    int x = 0;
+    int z = 0;
+    int lod = 0;
+
+    bool operator==(const HeightTileKey& other) const;
+};
+struct HeightTileKeyHash {
+    size_t operator()(const HeightTileKey& key) const;
+};
+
+// HeightTile:
+// A finished tile. Heights are stored as resolution x resolution samples,
+// with heights[i * resolution + j] at origin + (i, j) * spacing. Adjacent
+// tiles share their edge samples.
+struct HeightTile {
+    HeightTileKey key;
+
+    Vector2 origin;
+    float spacing;
+    int resolution;
+
+    std::vector<float> heights;
+};
+
+// HeightFieldPipeline Class:
+// Generates heights by running samples through a list of stages (noise,
+// shaping, erosion). Grids are split into tiles, which are generated in
+// parallel on the thread pool. Tiles are padded by the apron the stages
+// need, so that erosion near a tile's edge sees its surroundings, and are
+// cropped afterwards.
+// World tiles (by tile coordinate and LOD) are cached, so that each tile is
+// only generated once until the settings change.
+class HeightFieldPipeline {
+  public:
+    struct Config {
+        float tileSize = 256.f;
+        int tileResolution = 129;
+        size_t cacheCapacity = 256;
+    };
+
+  private:
+    Config mConfig;
+
+    std::vector<std::unique_ptr<HeightStage>> mStages;
+    NoiseType mNoiseType = NoiseType::Perlin;
+    uint32_t mSeed = 0;
+    uint32_t mVersion = 0;
+
+    // Tile Cache
+    // Least recently used tiles are at the back of the list, and are evicted
+    // first when the cache is full.
+    struct CacheEntry {
+        std::shared_ptr<const HeightTile> tile;
+        std::list<HeightTileKey>::iterator lruPosition;
+    };
+    std::unordered_map<HeightTileKey, CacheEntry, HeightTileKeyHash> mCache;
+    std::list<HeightTileKey> mLRU;
+    mutable std::mutex mCacheMutex;
+
+    size_t mCacheHits = 0;
+    size_t mCacheMisses = 0;
+
+  public:
+    HeightFieldPipeline();
+    HeightFieldPipeline(const Config& config);
+    ~HeightFieldPipeline();
+
+    const Config& getConfig() const;
+
+    // Stages
+    // Adds a stage to the end of the pipeline. The pipeline owns the stage.
+    HeightStage* addStage(std::unique_ptr<HeightStage> stage);
+    template <typename T> T* addStage() {
+        return static_cast<T*>(addStage(std::make_unique<T>()));
+    }
+    size_t getStageCount() const;
+    HeightStage* getStage(size_t index);
+
+    // Reseeds the noise of every stage. Each stage gets a different seed, so
+    // that their noise is not correlated.
+    void setNoise(NoiseType type, uint32_t seed);
+    NoiseType getNoiseType() const;
+    uint32_t getSeed() const;
+
+    // Must be called after changing any stage setting. Clears the cache, and
+    // bumps the version so that users holding on to heights know to
+    // regenerate them.
+    void invalidate();
+    uint32_t getVersion() const;
+
+    // Sampling
+    // Point samples only run the pointwise stages, so they match generated
+    // grids unless an erosion stage is enabled.
+    float samplePoint(float x, float z) const;
+    void samplePoints(const float* x, const float* z, float* output,
+                      size_t count) const;
+    // Samples a count_x by count_z grid, with output[i * count_z + j] at
+    // origin + (i, j) * spacing. The grid is generated in parallel, in tiles
+    // aligned to multiples of spacing in the world, so that overlapping grids
+    // agree. Not cached.
+    void sampleGrid(const Vector2& origin, const Vector2& spacing, int count_x,
+                    int count_z, float* output) const;
+
+    // World Tiles
+    HeightTileKey tileKey(int x, int z, int lod) const;
+    // Returns the tile, generating it if it is not cached.
+    std::shared_ptr<const HeightTile> getTile(const HeightTileKey& key);
+    // Returns the tiles, generating the ones that are not cached in
+    // parallel.
+    void getTiles(const HeightTileKey* keys, size_t count,
+                  std::shared_ptr<const HeightTile>* output);
+    // Generates a tile without using the cache
+    std::shared_ptr<HeightTile> generateTile(const HeightTileKey& key) const;
+
+    // Returns true if a setting was changed. The pipeline is invalidated.
+    bool imGui(const HeightEditCallback& before_edit);
+
+  private:
+    int computeApron() const;
+    bool isPointwise() const;
+    void runStages(HeightSamples& samples) const;
+    void generateBlock(const Vector2& origin, const Vector2& spacing,
+                       int count_x, int count_z, uint32_t seed, float* output,
+                       int output_stride) const;
+
+    std::shared_ptr<const HeightTile> findCachedTile(const HeightTileKey& key);
+    void insertCachedTile(const std::shared_ptr<const HeightTile>& tile);
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -1,36 +1,51 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
-#include "math/PerlinNoise.h"
+#include <memory>
+
+#include "math/Noise.h"
 #include "math/Vector2.h"
 
+#include "HeightFieldPipeline.h"
+
 namespace Engine {
 using namespace Math;
 namespace Graphics {
+// HeightMapGenerator Class:
+// Generates the terrain's heights with a height field pipeline. By default
+// the pipeline is fBm noise, shaped by an exponent and scaled into a height
+// range. Domain warping, ridges, terraces and erosion can be enabled on top.
 class HeightMapGenerator {
   private:
-    PerlinNoise mNoise;
-
-    float frequency = 0.005f;
-    int octaves = 1;
-    float persistence = 0.75f;
-
-    float exponential = 3.5f;
-
-    float heightMin = -30.f;
-    float heightMax = 500.f;
+    std::unique_ptr<HeightFieldPipeline> mPipeline;
 
   public:
     HeightMapGenerator();
     ~HeightMapGenerator();
 
-    void imGui();
+    // Returns true if a setting was changed. before_edit is called before
+    // any setting is written.
+    bool imGui(const HeightEditCallback& before_edit);
 
     void seed(uint32_t seed);
+    // Switches the noise generator, keeping the current seed
+    void setNoiseType(NoiseType type);
 
     float sampleHeight(const Vector2& xz) const;
     float sampleHeight(float x, float z) const;
+
+    // Batch versions of sampleHeight, using the batch noise functions.
+    // The grid has count_x by count_z samples starting at origin, and
+    // output[i * count_z + j] is the height at origin + (i, j) * spacing.
+    // Grids are generated in parallel, and include erosion.
+    void sampleHeights(const float* x, const float* z, float* output,
+                       size_t count) const;
+    void sampleHeightGrid(const Vector2& origin, const Vector2& spacing,
+                          int count_x, int count_z, float* output) const;
+
+    HeightFieldPipeline* getPipeline();
 };
 
 } // namespace Graphics
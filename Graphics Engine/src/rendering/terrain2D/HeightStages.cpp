@@ -0,0 +1,548 @@
+#include "HeightStages.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+#include <random>
+
+#include "rendering/ImGui.h"
+
+namespace Engine {
+namespace Graphics {
+HeightStage::~HeightStage() = default;
+
+bool HeightStage::isPointwise() const { return true; }
+int HeightStage::apron() const { return 0; }
+void HeightStage::setNoise(NoiseType type, uint32_t seed) {}
+void HeightStage::applyPoint(float& x, float& z, float& height) const {}
+
+bool EditSlider(const char* label, float& setting, float min, float max,
+                const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    float value = setting;
+    if (!ImGui::SliderFloat(label, &value, min, max))
+        return false;
+
+    before_edit();
+    setting = value;
+    return true;
+#else
+    return false;
+#endif
+}
+bool EditSlider(const char* label, int& setting, int min, int max,
+                const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    int value = setting;
+    if (!ImGui::SliderInt(label, &value, min, max))
+        return false;
+
+    before_edit();
+    setting = value;
+    return true;
+#else
+    return false;
+#endif
+}
+bool EditCheckbox(const char* label, bool& setting,
+                  const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool value = setting;
+    if (!ImGui::Checkbox(label, &value))
+        return false;
+
+    before_edit();
+    setting = value;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// --- FBmStage ---
+FBmStage::FBmStage() { mNoise = Noise::Create(NoiseType::Perlin, 0); }
+FBmStage::~FBmStage() = default;
+
+const char* FBmStage::name() const { return "fBm"; }
+
+void FBmStage::setNoise(NoiseType type, uint32_t seed) {
+    mNoise = Noise::Create(type, seed);
+}
+
+void FBmStage::apply(HeightSamples& samples) const {
+    const size_t count = samples.size();
+
+    std::vector<float> x(count), z(count), noise(count);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = frequency * samples.x[i];
+        z[i] = frequency * samples.z[i];
+    }
+
+    mNoise->octaveNoise2D(x.data(), z.data(), noise.data(), count, octaves,
+                          persistence);
+    for (size_t i = 0; i < count; i++)
+        samples.heights[i] += weight * noise[i];
+}
+void FBmStage::applyPoint(float& x, float& z, float& height) const {
+    height += weight * mNoise->octaveNoise2D(frequency * x, frequency * z,
+                                             octaves, persistence);
+}
+
+bool FBmStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |=
+        EditSlider("Noise Frequency", frequency, 0.0f, 0.1f, before_edit);
+    changed |= EditSlider("Noise Octaves", octaves, 0, 10, before_edit);
+    changed |=
+        EditSlider("Noise Persistence", persistence, 0.0f, 2.f, before_edit);
+    changed |= EditSlider("Weight", weight, 0.f, 2.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+// --- RidgedStage ---
+RidgedStage::RidgedStage() { mNoise = Noise::Create(NoiseType::Perlin, 0); }
+RidgedStage::~RidgedStage() = default;
+
+const char* RidgedStage::name() const { return "Ridged"; }
+
+void RidgedStage::setNoise(NoiseType type, uint32_t seed) {
+    mNoise = Noise::Create(type, seed);
+}
+
+// Apply:
+// Each octave's noise n is folded into 1 - |2n - 1|, which peaks where the
+// noise crosses its middle, and squared to sharpen the peaks.
+void RidgedStage::apply(HeightSamples& samples) const {
+    const size_t count = samples.size();
+
+    std::vector<float> x(count), z(count), noise(count);
+    std::vector<float> total(count, 0.f);
+    float maxValue = 0.f;
+
+    float octave_frequency = frequency;
+    float amplitude = 1.f;
+
+    for (int octave = 0; octave < octaves; octave++) {
+        for (size_t i = 0; i < count; i++) {
+            x[i] = octave_frequency * samples.x[i];
+            z[i] = octave_frequency * samples.z[i];
+        }
+        mNoise->noise2D(x.data(), z.data(), noise.data(), count);
+
+        for (size_t i = 0; i < count; i++) {
+            const float ridge = 1.f - fabsf(2.f * noise[i] - 1.f);
+            total[i] += ridge * ridge * amplitude;
+        }
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        octave_frequency *= 2.f;
+    }
+
+    if (maxValue <= 0.f)
+        return;
+
+    for (size_t i = 0; i < count; i++)
+        samples.heights[i] += weight * total[i] / maxValue;
+}
+void RidgedStage::applyPoint(float& x, float& z, float& height) const {
+    float total = 0.f;
+    float maxValue = 0.f;
+
+    float octave_frequency = frequency;
+    float amplitude = 1.f;
+
+    for (int octave = 0; octave < octaves; octave++) {
+        const float noise =
+            mNoise->noise2D(octave_frequency * x, octave_frequency * z);
+        const float ridge = 1.f - fabsf(2.f * noise - 1.f);
+        total += ridge * ridge * amplitude;
+        maxValue += amplitude;
+
+        amplitude *= persistence;
+        octave_frequency *= 2.f;
+    }
+
+    if (maxValue > 0.f)
+        height += weight * total / maxValue;
+}
+
+bool RidgedStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |= EditSlider("Frequency", frequency, 0.0f, 0.05f, before_edit);
+    changed |= EditSlider("Octaves", octaves, 1, 10, before_edit);
+    changed |= EditSlider("Persistence", persistence, 0.0f, 1.f, before_edit);
+    changed |= EditSlider("Weight", weight, 0.f, 2.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+// --- DomainWarpStage ---
+DomainWarpStage::DomainWarpStage() {
+    mNoise = Noise::Create(NoiseType::Perlin, 0);
+}
+DomainWarpStage::~DomainWarpStage() = default;
+
+const char* DomainWarpStage::name() const { return "Domain Warp"; }
+
+void DomainWarpStage::setNoise(NoiseType type, uint32_t seed) {
+    mNoise = Noise::Create(type, seed);
+}
+
+// The x and z offsets are sampled from the same noise, at positions this
+// far apart, so that they are unrelated.
+static constexpr float kWarpZOffset = 71.3f;
+
+void DomainWarpStage::apply(HeightSamples& samples) const {
+    const size_t count = samples.size();
+
+    std::vector<float> x(count), z(count), z_shifted(count);
+    std::vector<float> warp_x(count), warp_z(count);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = frequency * samples.x[i];
+        z[i] = frequency * samples.z[i];
+        z_shifted[i] = z[i] + kWarpZOffset;
+    }
+
+    mNoise->octaveNoise2D(x.data(), z.data(), warp_x.data(), count, octaves,
+                          0.5f);
+    mNoise->octaveNoise2D(x.data(), z_shifted.data(), warp_z.data(), count,
+                          octaves, 0.5f);
+
+    for (size_t i = 0; i < count; i++) {
+        samples.x[i] += strength * (2.f * warp_x[i] - 1.f);
+        samples.z[i] += strength * (2.f * warp_z[i] - 1.f);
+    }
+}
+void DomainWarpStage::applyPoint(float& x, float& z, float& height) const {
+    const float noise_x = frequency * x;
+    const float noise_z = frequency * z;
+
+    const float warp_x = mNoise->octaveNoise2D(noise_x, noise_z, octaves, 0.5f);
+    const float warp_z = mNoise->octaveNoise2D(noise_x, noise_z + kWarpZOffset,
+                                               octaves, 0.5f);
+
+    x += strength * (2.f * warp_x - 1.f);
+    z += strength * (2.f * warp_z - 1.f);
+}
+
+bool DomainWarpStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |= EditSlider("Frequency", frequency, 0.0f, 0.02f, before_edit);
+    changed |= EditSlider("Octaves", octaves, 1, 8, before_edit);
+    changed |= EditSlider("Strength", strength, 0.f, 500.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+// --- RemapStage ---
+const char* RemapStage::name() const { return "Remap"; }
+
+void RemapStage::apply(HeightSamples& samples) const {
+    for (float& height : samples.heights) {
+        const float shaped = pow(std::max(height, 0.f), exponential);
+        height = shaped * (heightMax - heightMin) + heightMin;
+    }
+}
+void RemapStage::applyPoint(float& x, float& z, float& height) const {
+    const float shaped = pow(std::max(height, 0.f), exponential);
+    height = shaped * (heightMax - heightMin) + heightMin;
+}
+
+bool RemapStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |= EditSlider("Exponential", exponential, 0.5f, 5.f, before_edit);
+    changed |=
+        EditSlider("Heigh Minimum", heightMin, -100.f, 25.f, before_edit);
+    changed |=
+        EditSlider("Height Maximum", heightMax, -25.f, 500.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+// --- TerraceStage ---
+const char* TerraceStage::name() const { return "Terrace"; }
+
+void TerraceStage::apply(HeightSamples& samples) const {
+    if (stepHeight <= 0.f)
+        return;
+
+    for (float& height : samples.heights) {
+        const float steps = height / stepHeight;
+        const float step = floorf(steps);
+        const float t = steps - step;
+        height = (step + powf(t, sharpness)) * stepHeight;
+    }
+}
+void TerraceStage::applyPoint(float& x, float& z, float& height) const {
+    if (stepHeight <= 0.f)
+        return;
+
+    const float steps = height / stepHeight;
+    const float step = floorf(steps);
+    const float t = steps - step;
+    height = (step + powf(t, sharpness)) * stepHeight;
+}
+
+bool TerraceStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |= EditSlider("Step Height", stepHeight, 1.f, 100.f, before_edit);
+    changed |= EditSlider("Sharpness", sharpness, 1.f, 16.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+// --- ThermalErosionStage ---
+const char* ThermalErosionStage::name() const { return "Thermal Erosion"; }
+bool ThermalErosionStage::isPointwise() const { return false; }
+// Material moves at most one sample per iteration
+int ThermalErosionStage::apron() const { return iterations; }
+
+// Apply:
+// Each iteration, every sample sheds material to its lower neighbors (of
+// the 4 adjacent) whose slope is above the talus slope. The amount moved is
+// proportional to the steepest excess slope, and is split between the
+// neighbors by their excess. Changes are accumulated in a separate buffer,
+// so the result does not depend on the order samples are visited in.
+void ThermalErosionStage::apply(HeightSamples& samples) const {
+    assert(samples.grid);
+
+    constexpr int OFFSETS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    const float talus = talusSlope * samples.spacing;
+
+    std::vector<float> delta(samples.size());
+
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        std::fill(delta.begin(), delta.end(), 0.f);
+
+        for (int i = 0; i < samples.countX; i++) {
+            for (int j = 0; j < samples.countZ; j++) {
+                const float height = samples.at(i, j);
+
+                float excess[4] = {0.f, 0.f, 0.f, 0.f};
+                float total_excess = 0.f;
+                float max_excess = 0.f;
+
+                for (int n = 0; n < 4; n++) {
+                    const int ni = i + OFFSETS[n][0];
+                    const int nj = j + OFFSETS[n][1];
+                    if (ni < 0 || ni >= samples.countX || nj < 0 ||
+                        nj >= samples.countZ)
+                        continue;
+
+                    const float drop = height - samples.at(ni, nj) - talus;
+                    if (drop > 0.f) {
+                        excess[n] = drop;
+                        total_excess += drop;
+                        max_excess = std::max(max_excess, drop);
+                    }
+                }
+
+                if (total_excess <= 0.f)
+                    continue;
+
+                // Moving half of the excess would level the steepest pair
+                const float moved = rate * max_excess * 0.5f;
+                for (int n = 0; n < 4; n++) {
+                    if (excess[n] <= 0.f)
+                        continue;
+
+                    const float amount = moved * excess[n] / total_excess;
+                    const int ni = i + OFFSETS[n][0];
+                    const int nj = j + OFFSETS[n][1];
+                    delta[(size_t)ni * samples.countZ + nj] += amount;
+                    delta[(size_t)i * samples.countZ + j] -= amount;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < samples.size(); i++)
+            samples.heights[i] += delta[i];
+    }
+}
+
+bool ThermalErosionStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |= EditSlider("Iterations", iterations, 1, 32, before_edit);
+    changed |= EditSlider("Talus Slope", talusSlope, 0.1f, 4.f, before_edit);
+    changed |= EditSlider("Rate", rate, 0.f, 1.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+// --- HydraulicErosionStage ---
+const char* HydraulicErosionStage::name() const { return "Hydraulic Erosion"; }
+bool HydraulicErosionStage::isPointwise() const { return false; }
+// A droplet moves at most one sample per step
+int HydraulicErosionStage::apron() const { return lifetime; }
+
+// Apply:
+// Droplets move one sample per step in their direction, which follows the
+// downhill gradient with some inertia. A droplet can carry sediment up to a
+// capacity given by its speed, water and the drop in height. Below the
+// capacity it erodes the ground under it, and above it (or when going
+// uphill) it deposits. Sediment is added and removed from the 4 samples
+// around the droplet, weighted by its position between them.
+// Based on Hans Theobald Beyer's "Implementation of a method for hydraulic
+// erosion".
+void HydraulicErosionStage::apply(HeightSamples& samples) const {
+    assert(samples.grid);
+
+    constexpr float MIN_CAPACITY = 0.01f;
+
+    const int count_x = samples.countX;
+    const int count_z = samples.countZ;
+    if (count_x < 2 || count_z < 2)
+        return;
+
+    // Height and gradient at a position between samples, by bilinear
+    // interpolation
+    auto sample = [&samples](float px, float pz, float& gradient_x,
+                             float& gradient_z) {
+        const int i = (int)px;
+        const int j = (int)pz;
+        const float u = px - i;
+        const float v = pz - j;
+
+        const float h00 = samples.at(i, j);
+        const float h10 = samples.at(i + 1, j);
+        const float h01 = samples.at(i, j + 1);
+        const float h11 = samples.at(i + 1, j + 1);
+
+        gradient_x = (h10 - h00) * (1 - v) + (h11 - h01) * v;
+        gradient_z = (h01 - h00) * (1 - u) + (h11 - h10) * u;
+        return h00 * (1 - u) * (1 - v) + h10 * u * (1 - v) +
+               h01 * (1 - u) * v + h11 * u * v;
+    };
+    // Adds an amount of height around a position, split between the 4
+    // samples around it.
+    auto deposit = [&samples](float px, float pz, float amount) {
+        const int i = (int)px;
+        const int j = (int)pz;
+        const float u = px - i;
+        const float v = pz - j;
+
+        samples.at(i, j) += amount * (1 - u) * (1 - v);
+        samples.at(i + 1, j) += amount * u * (1 - v);
+        samples.at(i, j + 1) += amount * (1 - u) * v;
+        samples.at(i + 1, j + 1) += amount * u * v;
+    };
+
+    std::mt19937 generator = std::mt19937(samples.seed);
+    // Droplets start strictly inside the grid, so every sample they read has
+    // a neighbor at +1
+    std::uniform_real_distribution<float> dist_x(0.f, count_x - 1.001f);
+    std::uniform_real_distribution<float> dist_z(0.f, count_z - 1.001f);
+
+    const int num_droplets = int(dropletsPerSample * samples.size());
+
+    for (int droplet = 0; droplet < num_droplets; droplet++) {
+        float px = dist_x(generator);
+        float pz = dist_z(generator);
+        float direction_x = 0.f;
+        float direction_z = 0.f;
+
+        float speed = 1.f;
+        float water = 1.f;
+        float sediment = 0.f;
+
+        for (int step = 0; step < lifetime; step++) {
+            float gradient_x, gradient_z;
+            const float height = sample(px, pz, gradient_x, gradient_z);
+
+            // Blend the previous direction with the downhill direction
+            direction_x =
+                direction_x * inertia - gradient_x * (1.f - inertia);
+            direction_z =
+                direction_z * inertia - gradient_z * (1.f - inertia);
+
+            const float length =
+                sqrtf(direction_x * direction_x + direction_z * direction_z);
+            if (length <= 0.f)
+                break;
+            direction_x /= length;
+            direction_z /= length;
+
+            const float old_x = px;
+            const float old_z = pz;
+            px += direction_x;
+            pz += direction_z;
+
+            // Stop droplets that leave the grid
+            if (px < 0.f || px >= count_x - 1 || pz < 0.f ||
+                pz >= count_z - 1)
+                break;
+
+            float unused_x, unused_z;
+            const float height_change =
+                sample(px, pz, unused_x, unused_z) - height;
+
+            const float max_sediment = std::max(
+                -height_change * speed * water * capacity, MIN_CAPACITY);
+
+            if (height_change > 0.f || sediment > max_sediment) {
+                // Going uphill, fill the pit behind the droplet. Otherwise,
+                // drop some of the excess sediment.
+                const float amount =
+                    height_change > 0.f
+                        ? std::min(height_change, sediment)
+                        : (sediment - max_sediment) * depositionRate;
+                sediment -= amount;
+                deposit(old_x, old_z, amount);
+            } else {
+                // Never erode more than the drop in height, so the droplet
+                // doesn't dig a pit behind it.
+                const float amount = std::min(
+                    (max_sediment - sediment) * erosionRate, -height_change);
+                sediment += amount;
+                deposit(old_x, old_z, -amount);
+            }
+
+            speed = sqrtf(
+                std::max(speed * speed - height_change * gravity, 0.f));
+            water *= 1.f - evaporation;
+        }
+    }
+}
+
+bool HydraulicErosionStage::imGui(const HeightEditCallback& before_edit) {
+#if defined(IMGUI_ENABLED)
+    bool changed = false;
+    changed |= EditSlider("Droplets / Sample", dropletsPerSample, 0.f, 2.f,
+                          before_edit);
+    changed |= EditSlider("Lifetime", lifetime, 1, 64, before_edit);
+    changed |= EditSlider("Inertia", inertia, 0.f, 1.f, before_edit);
+    changed |= EditSlider("Capacity", capacity, 0.f, 16.f, before_edit);
+    changed |= EditSlider("Erosion Rate", erosionRate, 0.f, 1.f, before_edit);
+    changed |=
+        EditSlider("Deposition Rate", depositionRate, 0.f, 1.f, before_edit);
+    changed |= EditSlider("Evaporation", evaporation, 0.f, 0.5f, before_edit);
+    changed |= EditSlider("Gravity", gravity, 0.f, 16.f, before_edit);
+    return changed;
+#else
+    return false;
+#endif
+}
+
+} // namespace Graphics
+} // namespace Engine
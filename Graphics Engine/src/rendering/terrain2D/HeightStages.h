@@ -0,0 +1,222 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "math/Noise.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+// HeightSamples Struct:
+// The working data of the height field pipeline. Holds the (x,z) position
+// and the height of each sample. For a grid, sample (i, j) is at index
+// i * countZ + j, and is spaced from its neighbors by spacing world units.
+// A list of points (not a grid) has countZ = 1, and can only be run through
+// pointwise stages.
+struct HeightSamples {
+    int countX = 0;
+    int countZ = 0;
+    bool grid = false;
+    float spacing = 1.f;
+
+    // Seed for stages that use random numbers, unique to the tile
+    uint32_t seed = 0;
+
+    // Positions that noise is sampled at. Domain warping moves these.
+    std::vector<float> x;
+    std::vector<float> z;
+    std::vector<float> heights;
+
+    size_t size() const { return heights.size(); }
+    float& at(int i, int j) { return heights[(size_t)i * countZ + j]; }
+    float at(int i, int j) const { return heights[(size_t)i * countZ + j]; }
+};
+
+// HeightEditCallback:
+// Called by the editor before it changes a setting. Heights may be generated
+// from the settings in the background, and the callback waits for them.
+typedef std::function<void()> HeightEditCallback;
+
+// Editor Widgets:
+// Draw a widget for a copy of the setting. If the widget changes it, call
+// before_edit and then write the new value. Return true if it changed.
+bool EditSlider(const char* label, float& setting, float min, float max,
+                const HeightEditCallback& before_edit);
+bool EditSlider(const char* label, int& setting, int min, int max,
+                const HeightEditCallback& before_edit);
+bool EditCheckbox(const char* label, bool& setting,
+                  const HeightEditCallback& before_edit);
+
+// HeightStage Class:
+// A step in the height field pipeline, which reads and modifies the height
+// samples. Stages are run in order, so they can be composed.
+class HeightStage {
+  public:
+    bool enabled = true;
+
+    virtual ~HeightStage();
+
+    virtual const char* name() const = 0;
+
+    // Pointwise stages only use each sample's own position and height, so
+    // they can be run for single points. Other stages (erosion) need the
+    // whole grid.
+    virtual bool isPointwise() const;
+    // Number of samples of padding the stage needs around a tile, so that
+    // its results near the tile's edges are close to its neighbors'.
+    virtual int apron() const;
+
+    // Recreates any noise the stage uses with the given type and seed
+    virtual void setNoise(NoiseType type, uint32_t seed);
+
+    virtual void apply(HeightSamples& samples) const = 0;
+    // Same as apply, for a single sample at (x, z). Used by point queries,
+    // which should not allocate. Only called for pointwise stages.
+    virtual void applyPoint(float& x, float& z, float& height) const;
+
+    // Returns true if a setting was changed. Settings are edited with the
+    // editor widgets above.
+    virtual bool imGui(const HeightEditCallback& before_edit) = 0;
+};
+
+// FBmStage:
+// Adds fractal noise, scaled by weight. The noise is in [0, weight].
+class FBmStage : public HeightStage {
+  private:
+    std::unique_ptr<Noise> mNoise;
+
+  public:
+    float frequency = 0.005f;
+    int octaves = 1;
+    float persistence = 0.75f;
+    float weight = 1.f;
+
+    FBmStage();
+    ~FBmStage();
+
+    const char* name() const override;
+    void setNoise(NoiseType type, uint32_t seed) override;
+    void apply(HeightSamples& samples) const override;
+    void applyPoint(float& x, float& z, float& height) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+// RidgedStage:
+// Adds ridged fractal noise, which folds the noise about its middle to
+// create sharp crests. The noise is in [0, weight].
+class RidgedStage : public HeightStage {
+  private:
+    std::unique_ptr<Noise> mNoise;
+
+  public:
+    float frequency = 0.003f;
+    int octaves = 4;
+    float persistence = 0.5f;
+    float weight = 0.5f;
+
+    RidgedStage();
+    ~RidgedStage();
+
+    const char* name() const override;
+    void setNoise(NoiseType type, uint32_t seed) override;
+    void apply(HeightSamples& samples) const override;
+    void applyPoint(float& x, float& z, float& height) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+// DomainWarpStage:
+// Offsets the positions that later stages sample noise at by up to
+// strength world units, which bends and swirls their features.
+class DomainWarpStage : public HeightStage {
+  private:
+    std::unique_ptr<Noise> mNoise;
+
+  public:
+    float frequency = 0.002f;
+    int octaves = 3;
+    float strength = 150.f;
+
+    DomainWarpStage();
+    ~DomainWarpStage();
+
+    const char* name() const override;
+    void setNoise(NoiseType type, uint32_t seed) override;
+    void apply(HeightSamples& samples) const override;
+    void applyPoint(float& x, float& z, float& height) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+// RemapStage:
+// Shapes heights in [0,1] with an exponent, and scales them into world
+// heights between heightMin and heightMax.
+class RemapStage : public HeightStage {
+  public:
+    float exponential = 3.5f;
+    float heightMin = -30.f;
+    float heightMax = 500.f;
+
+    const char* name() const override;
+    void apply(HeightSamples& samples) const override;
+    void applyPoint(float& x, float& z, float& height) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+// TerraceStage:
+// Quantizes heights into steps of stepHeight world units. With a sharpness
+// of 1 heights are unchanged, and larger values flatten the steps.
+class TerraceStage : public HeightStage {
+  public:
+    float stepHeight = 20.f;
+    float sharpness = 4.f;
+
+    const char* name() const override;
+    void apply(HeightSamples& samples) const override;
+    void applyPoint(float& x, float& z, float& height) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+// ThermalErosionStage:
+// Material slides down slopes steeper than the talus slope (height change
+// per world unit), which crumbles cliffs into scree.
+class ThermalErosionStage : public HeightStage {
+  public:
+    int iterations = 8;
+    float talusSlope = 1.f;
+    float rate = 0.5f;
+
+    const char* name() const override;
+    bool isPointwise() const override;
+    int apron() const override;
+    void apply(HeightSamples& samples) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+// HydraulicErosionStage:
+// Simulates rain droplets flowing downhill, which pick up sediment when
+// they speed up, and deposit it when they slow down. Carves valleys and
+// gullies. Droplets start at random samples, chosen by the tile's seed.
+class HydraulicErosionStage : public HeightStage {
+  public:
+    float dropletsPerSample = 0.25f;
+    int lifetime = 24;
+    float inertia = 0.05f;
+    float capacity = 4.f;
+    float erosionRate = 0.3f;
+    float depositionRate = 0.3f;
+    float evaporation = 0.02f;
+    float gravity = 4.f;
+
+    const char* name() const override;
+    bool isPointwise() const override;
+    int apron() const override;
+    void apply(HeightSamples& samples) const override;
+    bool imGui(const HeightEditCallback& before_edit) override;
+};
+
+} // namespace Graphics
+} // namespace Engine
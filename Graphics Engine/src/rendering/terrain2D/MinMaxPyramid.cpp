@@ -0,0 +1,103 @@
+#include "MinMaxPyramid.h"
+
+#include <assert.h>
+#include <float.h>
+
+#include <algorithm>
+
+namespace Engine {
+namespace Graphics {
+// Queries read at most this many cells along each axis
+static constexpr int kMaxQueryCells = 4;
+
+MinMaxPyramid::MinMaxPyramid() = default;
+MinMaxPyramid::~MinMaxPyramid() = default;
+
+void MinMaxPyramid::build(const float* heights, int count_x, int count_z) {
+    assert(count_x > 0 && count_z > 0);
+    mLevels.clear();
+
+    Level& base = mLevels.emplace_back();
+    base.countX = count_x;
+    base.countZ = count_z;
+    base.minimum.assign(heights, heights + (size_t)count_x * count_z);
+    base.maximum = base.minimum;
+
+    // Each level halves the previous one, rounding up, until a single cell
+    // covers the whole grid.
+    while (mLevels.back().countX > 1 || mLevels.back().countZ > 1) {
+        const Level& below = mLevels.back();
+        Level level;
+        level.countX = (below.countX + 1) / 2;
+        level.countZ = (below.countZ + 1) / 2;
+        level.minimum.resize((size_t)level.countX * level.countZ);
+        level.maximum.resize((size_t)level.countX * level.countZ);
+
+        for (int z = 0; z < level.countZ; z++) {
+            const int z0 = 2 * z;
+            const int z1 = std::min(z0 + 1, below.countZ - 1);
+
+            for (int x = 0; x < level.countX; x++) {
+                const int x0 = 2 * x;
+                const int x1 = std::min(x0 + 1, below.countX - 1);
+
+                const size_t i00 = (size_t)z0 * below.countX + x0;
+                const size_t i01 = (size_t)z0 * below.countX + x1;
+                const size_t i10 = (size_t)z1 * below.countX + x0;
+                const size_t i11 = (size_t)z1 * below.countX + x1;
+
+                const size_t index = (size_t)z * level.countX + x;
+                level.minimum[index] =
+                    std::min(std::min(below.minimum[i00], below.minimum[i01]),
+                             std::min(below.minimum[i10], below.minimum[i11]));
+                level.maximum[index] =
+                    std::max(std::max(below.maximum[i00], below.maximum[i01]),
+                             std::max(below.maximum[i10], below.maximum[i11]));
+            }
+        }
+
+        mLevels.push_back(std::move(level));
+    }
+}
+
+// Query:
+// Picks the finest level where the rectangle covers at most kMaxQueryCells
+// cells along each axis, and combines those cells.
+bool MinMaxPyramid::query(int x0, int z0, int x1, int z1, float& minimum,
+                          float& maximum) const {
+    if (mLevels.empty())
+        return false;
+
+    const Level& base = mLevels.front();
+    x0 = std::clamp(x0, 0, base.countX - 1);
+    x1 = std::clamp(x1, 0, base.countX - 1);
+    z0 = std::clamp(z0, 0, base.countZ - 1);
+    z1 = std::clamp(z1, 0, base.countZ - 1);
+    if (x1 < x0)
+        std::swap(x0, x1);
+    if (z1 < z0)
+        std::swap(z0, z1);
+
+    int shift = 0;
+    while (shift + 1 < (int)mLevels.size() &&
+           ((x1 >> shift) - (x0 >> shift) >= kMaxQueryCells ||
+            (z1 >> shift) - (z0 >> shift) >= kMaxQueryCells))
+        shift++;
+
+    const Level& level = mLevels[shift];
+    minimum = FLT_MAX;
+    maximum = -FLT_MAX;
+
+    for (int z = z0 >> shift; z <= (z1 >> shift); z++) {
+        for (int x = x0 >> shift; x <= (x1 >> shift); x++) {
+            const size_t index = (size_t)z * level.countX + x;
+            minimum = std::min(minimum, level.minimum[index]);
+            maximum = std::max(maximum, level.maximum[index]);
+        }
+    }
+
+    return true;
+}
+
+} // namespace Graphics
+} // namespace Engine
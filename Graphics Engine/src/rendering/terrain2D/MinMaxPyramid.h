@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+namespace Engine {
+namespace Graphics {
+// MinMaxPyramid Class:
+// A mip pyramid of a grid of heights, where each cell of level k holds the
+// minimum and maximum of the 2^k x 2^k heights below it. Finds the height
+// range of any rectangle of the grid by reading a handful of cells, which
+// gives terrain chunks their vertical bounds.
+class MinMaxPyramid {
+  private:
+    struct Level {
+        int countX;
+        int countZ;
+
+        std::vector<float> minimum;
+        std::vector<float> maximum;
+    };
+    std::vector<Level> mLevels;
+
+  public:
+    MinMaxPyramid();
+    ~MinMaxPyramid();
+
+    // Builds the pyramid from a count_x by count_z grid, with the height of
+    // sample (x, z) at heights[z * count_x + x].
+    void build(const float* heights, int count_x, int count_z);
+
+    // Finds the range of heights of the samples in [x0, x1] x [z0, z1]
+    // (inclusive, clamped to the grid). The range is conservative, and can
+    // include samples just outside of the rectangle.
+    // Returns false if the pyramid is empty.
+    bool query(int x0, int z0, int x1, int z1, float& minimum,
+               float& maximum) const;
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -1,39 +1,196 @@
 #include "Terrain2DManager.h"
 
 #include <assert.h>
+#include <math.h>
 #include <vector>
 
-#include "core/PoolAllocator.h"
 #include "math/Vector2.h"
+#include "utility/Stopwatch.h"
 
 #include "rendering/VisualSystem.h"
+#include "rendering/core/Frustum.h"
 #include "rendering/pipeline/RenderManager.h"
+#include "rendering/pipeline/StructuredBuffer.h"
 #include "rendering/resources/MaterialManager.h"
 #include "rendering/resources/ResourceManager.h"
 
 #include "rendering/ImGui.h"
 
 #include "HeightMapGenerator.h"
+#include "TerrainHeightQuery.h"
+#include "TerrainQuadTree.h"
+#include "ToroidalHeightmap.h"
 
 namespace Engine {
 namespace Graphics {
 static constexpr uint8_t kTerrainChunkSlot = 5;
-struct TerrainChunk {
-    Vector2 position; // Bottom-Left (x,z) Coordinates
-    Vector2 extents;
+// Vertex resource slots of the chunk buffers
+static constexpr uint8_t kChunkDataSlot = 1;
+static constexpr uint8_t kVisibleChunksSlot = 2;
+
+// WriteChunkBuffers:
+// Chunk data is stored by quadtree node, so it only changes when a node is
+// created. Each instance reads its node's index from the visible chunks.
+static void WriteChunkBuffers(const std::vector<TerrainChunk>& chunks,
+                              const std::vector<uint32_t>& slots,
+                              StructuredBuffer& chunkData,
+                              StructuredBuffer& visibleChunks) {
+    static_assert(sizeof(TerrainChunk) == sizeof(float) * 4);
+
+    for (size_t i = 0; i < chunks.size(); i++)
+        chunkData.write(slots[i], &chunks[i]);
+
+    visibleChunks.resize(slots.size());
+    if (!slots.empty())
+        visibleChunks.write(0, slots.data(), slots.size());
+}
+
+// LODBenchmark:
+// Flies a camera path through fresh quadtrees, and compares visiting every
+// node each frame against the incremental update, with and without
+// hysteresis.
+struct LODBenchmark {
+    struct Result {
+        const char* name;
+        double totalMs = 0;
+        size_t nodesVisited = 0;
+        size_t changes = 0;
+        size_t leaves = 0;
+    };
+
+    int frames = 0;
+    Result results[3];
 };
 
-struct QuadTreeNode {
-    TerrainChunk data;
-    QuadTreeNode* children[4] = {nullptr};
+// GenerateBenchmarkPath:
+// A flight that sweeps across the terrain while weaving side to side, at
+// up to ~40 units a frame.
+static std::vector<Vector2> GenerateBenchmarkPath() {
+    constexpr int kFrames = 4000;
+    constexpr float kPi = 3.14159265f;
+
+    std::vector<Vector2> path(kFrames);
+    for (int i = 0; i < kFrames; i++) {
+        const float t = float(i) / kFrames;
+        path[i] = Vector2(8000.f * sinf(2 * kPi * t),
+                          3000.f * sinf(6 * kPi * t) + 50.f * sinf(80 * t));
+    }
+    return path;
+}
+
+static LODBenchmark RunLODBenchmark(const std::vector<Vector2>& path,
+                                    const TerrainQuadTree::Config& config) {
+    LODBenchmark benchmark;
+    benchmark.frames = (int)path.size();
+
+    TerrainQuadTree::Config noHysteresis = config;
+    noHysteresis.hysteresis = 0.f;
+
+    struct Case {
+        const char* name;
+        TerrainQuadTree::Config config;
+        bool full;
+    };
+    const Case cases[3] = {{"Full Traversal", config, true},
+                           {"Incremental", config, false},
+                           {"Incremental, No Hysteresis", noHysteresis, false}};
+
+    Utility::Stopwatch stopwatch;
+    for (int i = 0; i < 3; i++) {
+        LODBenchmark::Result& result = benchmark.results[i];
+        result.name = cases[i].name;
+
+        std::unique_ptr<TerrainQuadTree> tree =
+            std::make_unique<TerrainQuadTree>(cases[i].config);
+
+        for (const Vector2& camera : path) {
+            stopwatch.Reset();
+            if (cases[i].full)
+                tree->updateLODFull(camera);
+            else
+                tree->updateLOD(camera);
+            result.totalMs += stopwatch.Duration() * 1000.0;
+
+            const TerrainQuadTree::Stats& stats = tree->getStats();
+            result.nodesVisited += stats.nodesVisited;
+            result.changes += stats.divides + stats.merges;
+        }
+
+        result.leaves = tree->getLeafCount();
+    }
+
+    return benchmark;
+}
 
-    bool isLeaf() const { return children[0] == nullptr; }
+// UploadBenchmark:
+// Flies a camera path, and compares the bytes uploaded per frame by
+// sending every chunk through the constant buffer against the chunk
+// buffers, which are flushed to a null backend. Chunks are not culled.
+struct UploadBenchmark {
+    int frames = 0;
+    size_t maxChunks = 0;
+
+    double constantBufferBytes = 0;
+    double structuredBufferBytes = 0;
+    double structuredBufferUploads = 0;
 };
 
+static UploadBenchmark
+RunUploadBenchmark(const std::vector<Vector2>& path,
+                   const TerrainQuadTree::Config& config) {
+    UploadBenchmark benchmark;
+    benchmark.frames = (int)path.size();
+
+    std::unique_ptr<TerrainQuadTree> tree =
+        std::make_unique<TerrainQuadTree>(config);
+
+    StructuredBuffer chunkData, visibleChunks;
+    chunkData.initialize(sizeof(TerrainChunk),
+                         TerrainQuadTree::kMaximumNodes);
+    visibleChunks.initialize(sizeof(uint32_t));
+    NullStructuredBufferBackend backend;
+
+    // Without height bounds, nothing is culled
+    const Frustum frustum = Frustum(Matrix4::Identity());
+    auto noBounds = [](const Vector2&, const Vector2&, float&, float&) {
+        return false;
+    };
+
+    std::vector<TerrainChunk> chunks;
+    std::vector<uint32_t> slots;
+    size_t constantBufferBytes = 0;
+
+    for (const Vector2& camera : path) {
+        tree->updateLOD(camera);
+
+        chunks.clear();
+        slots.clear();
+        tree->collectChunks(frustum, noBounds, chunks, slots);
+
+        WriteChunkBuffers(chunks, slots, chunkData, visibleChunks);
+        chunkData.flush(backend);
+        visibleChunks.flush(backend);
+
+        constantBufferBytes += sizeof(ToroidalHeightmap::ShaderData) +
+                               chunks.size() * sizeof(TerrainChunk);
+        benchmark.maxChunks = std::max(benchmark.maxChunks, chunks.size());
+    }
+
+    if (benchmark.frames > 0) {
+        benchmark.constantBufferBytes =
+            double(constantBufferBytes) / benchmark.frames;
+        benchmark.structuredBufferBytes =
+            double(backend.getBytesUploaded()) / benchmark.frames;
+        benchmark.structuredBufferUploads =
+            double(backend.getNumUploads()) / benchmark.frames;
+    }
+    return benchmark;
+}
+
 class Terrain2DManagerImpl {
   private:
     struct Config {
-        float lodAttenuation = 1000.f;
+        TerrainQuadTree::Config lod;
 
         // Mesh Generation Settings
         int terrainMeshSampleCount = 15;
@@ -41,54 +198,54 @@ class Terrain2DManagerImpl {
         float skirtDepth = 25.f;
 
         // Heightmap Generation Settings
-        Vector2 heightMapOrigin = Vector2(0, 0);
-        Vector2 heightMapExtents = Vector2(2500, 2500);
-        int heightmapNumSamples = 450;
+        ToroidalHeightmap::Config heightmap;
     } config;
 
-    // Settings
-    static constexpr int kMaximumNodes = 5000;
-    static constexpr int kMaxQuadTreeDepth = 10;
-    static constexpr float kTerrainNodeSize = 25.f;
-
     VisualSystem* mVisualSystem;
     RenderManager* mRenderManager;
 
     std::unique_ptr<HeightMapGenerator> mHeightMap;
+    // Heightmap texture around the camera, which the terrain mesh reads from
+    std::unique_ptr<ToroidalHeightmap> mHeightmapWindow;
+    // CPU height queries, kept coherent with the heightmap window
+    std::unique_ptr<TerrainHeightQuery> mHeightQuery;
 
     std::shared_ptr<Mesh> mTerrainMesh;
     std::shared_ptr<Material> mTerrainMaterial;
     Technique* mTerrainTechnique;
 
-    // QuadTree
-    QuadTreeNode* root = nullptr;
-    PoolAllocator<QuadTreeNode, kMaximumNodes> mQuadTreeAllocator;
+    std::unique_ptr<TerrainQuadTree> mQuadTree;
 
     DrawBlockKey terrainDrawKey = kInvalidDrawBlockKey;
     std::vector<TerrainChunk> chunksToRender;
+    std::vector<uint32_t> chunkSlots;
+    // Chunk data by quadtree node, and the node of each instance
+    std::shared_ptr<StructuredBuffer> mChunkData;
+    std::shared_ptr<StructuredBuffer> mVisibleChunks;
+    int numCulledNodes = 0;
+
+    // Camera path, recorded for the LOD benchmark
+    bool mRecordCameraPath = false;
+    std::vector<Vector2> mCameraPath;
 
   public:
     Terrain2DManagerImpl(VisualSystem* visualSystem);
     ~Terrain2DManagerImpl();
 
-    void update(const Vector3& cameraPosition);
+    void update(const Vector3& cameraPosition, const Frustum& frustum);
     void imGui();
     void reset();
 
+    const HeightMapGenerator* getHeightMap() const;
+    TerrainHeightQuery* getHeightQuery() const;
+    bool getHeightmapRegion(Vector2& origin, Vector2& extents, int& samples,
+                            uint32_t& version) const;
+
   private:
     void regenerateMesh();
-    void regenerateHeightmapTexture();
 
-    void updateQuadTreeRecursive(QuadTreeNode* node,
-                                 const Vector3& cameraPosition, int depth);
-
-    uint8_t computeIdealLOD(QuadTreeNode* node, const Vector3& cameraPosition);
-
-    // QuadTree Management
-    QuadTreeNode* allocateNode(const Vector2& position, const Vector2& extents);
-    void destroyNode(QuadTreeNode* node);
-    void divideNode(QuadTreeNode& node);
-    void mergeNode(QuadTreeNode& node);
+    bool computeHeightBounds(const Vector2& minimum, const Vector2& maximum,
+                             float& minHeight, float& maxHeight) const;
 };
 
 std::unique_ptr<Terrain2DManager>
@@ -102,38 +259,116 @@ Terrain2DManager::create(VisualSystem* visualSystem) {
 Terrain2DManager::Terrain2DManager() = default;
 Terrain2DManager::~Terrain2DManager() = default;
 
-void Terrain2DManager::update(const Vector3& cameraPosition) {
-    mImpl->update(cameraPosition);
+void Terrain2DManager::update(const Vector3& cameraPosition,
+                              const Frustum& frustum) {
+    mImpl->update(cameraPosition, frustum);
 }
 
 void Terrain2DManager::imGui() { mImpl->imGui(); }
 
+const HeightMapGenerator* Terrain2DManager::getHeightMap() const {
+    return mImpl->getHeightMap();
+}
+TerrainHeightQuery* Terrain2DManager::getHeightQuery() const {
+    return mImpl->getHeightQuery();
+}
+bool Terrain2DManager::getHeightmapRegion(Vector2& origin, Vector2& extents,
+                                          int& samples,
+                                          uint32_t& version) const {
+    return mImpl->getHeightmapRegion(origin, extents, samples, version);
+}
+
 Terrain2DManagerImpl::Terrain2DManagerImpl(VisualSystem* visualSystem)
     : mVisualSystem(visualSystem) {
     mRenderManager = mVisualSystem->getRenderManager();
     mHeightMap = std::make_unique<HeightMapGenerator>();
+    mQuadTree = std::make_unique<TerrainQuadTree>(config.lod);
 
     // Because our terrain is heightmap based, we can use a single mesh and
     // instance draw it for each chunk, reading from heightmap texture for the
     // height.
     mTerrainMaterial = visualSystem->getMaterialManager()->createMaterial(
         MaterialManager::TerrainMaterialParams());
+    mTerrainTechnique = mTerrainMaterial->getTechnique(RenderPass::kOpaque);
     regenerateMesh();
-    regenerateHeightmapTexture();
+
+    // The chunk buffers are persistent, and only their changes are uploaded
+    mChunkData = std::make_shared<StructuredBuffer>();
+    mChunkData->initialize(sizeof(TerrainChunk),
+                           TerrainQuadTree::kMaximumNodes);
+    mVisibleChunks = std::make_shared<StructuredBuffer>();
+    mVisibleChunks->initialize(sizeof(uint32_t));
+    mTerrainTechnique->bindVertexStructuredBuffer(kChunkDataSlot, mChunkData);
+    mTerrainTechnique->bindVertexStructuredBuffer(kVisibleChunksSlot,
+                                                  mVisibleChunks);
+
+    // Heights are generated in the background, and the terrain is not drawn
+    // until the first window is ready.
+    mHeightmapWindow = std::make_unique<ToroidalHeightmap>(
+        mVisualSystem->getResourceManager(), mHeightMap.get(),
+        config.heightmap);
+    mHeightQuery =
+        std::make_unique<TerrainHeightQuery>(mHeightMap->getPipeline());
 
     reset();
 
     ImGuiHelper::registerImGuiCallback("Render/Terrain2D",
                                        [this]() { imGui(); });
 }
-Terrain2DManagerImpl::~Terrain2DManagerImpl() = default;
+Terrain2DManagerImpl::~Terrain2DManagerImpl() {
+    // Wait for any generation in flight, which uses the height map
+    mHeightmapWindow.reset();
+    mHeightQuery.reset();
+}
+
+const HeightMapGenerator* Terrain2DManagerImpl::getHeightMap() const {
+    return mHeightMap.get();
+}
+TerrainHeightQuery* Terrain2DManagerImpl::getHeightQuery() const {
+    return mHeightQuery.get();
+}
+bool Terrain2DManagerImpl::getHeightmapRegion(Vector2& origin,
+                                              Vector2& extents, int& samples,
+                                              uint32_t& version) const {
+    if (!mHeightmapWindow->getSampleRegion(origin, extents))
+        return false;
+
+    samples = mHeightmapWindow->getConfig().resolution;
+    version = mHeightMap->getPipeline()->getVersion();
+    return true;
+}
+
+void Terrain2DManagerImpl::update(const Vector3& cameraPosition,
+                                  const Frustum& frustum) {
+    // The heightmap is updated first, as the node bounds come from it
+    mHeightmapWindow->update(cameraPosition.xz());
+
+    const Vector2 halfExtents = config.heightmap.extents / 2;
+    mHeightQuery->update(cameraPosition.xz() - halfExtents,
+                         cameraPosition.xz() + halfExtents);
+
+    if (mRecordCameraPath)
+        mCameraPath.push_back(cameraPosition.xz());
+
+    mQuadTree->updateLOD(cameraPosition.xz());
 
-void Terrain2DManagerImpl::update(const Vector3& cameraPosition) {
     chunksToRender.clear();
-    updateQuadTreeRecursive(root, cameraPosition, 0);
+    chunkSlots.clear();
+    numCulledNodes = mQuadTree->collectChunks(
+        frustum,
+        [this](const Vector2& minimum, const Vector2& maximum,
+               float& minHeight, float& maxHeight) {
+            return computeHeightBounds(minimum, maximum, minHeight, maxHeight);
+        },
+        chunksToRender, chunkSlots);
+
+    if (mHeightmapWindow->ready()) {
+        mTerrainTechnique->bindVertexShaderResource(
+            0, mHeightmapWindow->getTexture(), SamplerType::Sampler_Point);
+    }
 
     const bool render = !chunksToRender.empty() && mTerrainMesh->ready &&
-                        mTerrainMaterial->ready();
+                        mHeightmapWindow->ready() && mTerrainMaterial->ready();
     if (render) {
         if (terrainDrawKey == kInvalidDrawBlockKey) {
             DrawBlock block;
@@ -148,17 +383,15 @@ void Terrain2DManagerImpl::update(const Vector3& cameraPosition) {
 
         mTerrainTechnique->clearVertexCB(kTerrainChunkSlot);
 
-        const Vector2 heightMapPosition =
-            config.heightMapOrigin - config.heightMapExtents / 2;
-        mTerrainTechnique->uploadVertexCBData(
-            kTerrainChunkSlot, &heightMapPosition, sizeof(Vector2));
+        const ToroidalHeightmap::ShaderData heightmapData =
+            mHeightmapWindow->getShaderData();
         mTerrainTechnique->uploadVertexCBData(
-            kTerrainChunkSlot, &config.heightMapExtents, sizeof(Vector2));
+            kTerrainChunkSlot, &heightmapData, sizeof(heightmapData));
+        static_assert(sizeof(ToroidalHeightmap::ShaderData) ==
+                      sizeof(float) * 8);
 
-        mTerrainTechnique->uploadVertexCBData(
-            kTerrainChunkSlot, chunksToRender.data(),
-            chunksToRender.size() * sizeof(TerrainChunk));
-        static_assert(sizeof(TerrainChunk) == sizeof(float) * 4);
+        WriteChunkBuffers(chunksToRender, chunkSlots, *mChunkData,
+                          *mVisibleChunks);
     } else {
         if (terrainDrawKey != kInvalidDrawBlockKey) {
             mRenderManager->removeDrawBlock(terrainDrawKey);
@@ -169,10 +402,81 @@ void Terrain2DManagerImpl::update(const Vector3& cameraPosition) {
 
 void Terrain2DManagerImpl::imGui() {
 #if defined(IMGUI_ENABLED)
-    ImGui::Text("# Chunks: %zu", mQuadTreeAllocator.getNumAllocations());
+    ImGui::Text("# Chunks: %zu", mQuadTree->getNodeCount());
     ImGui::Text("# Leaves: %i", chunksToRender.size());
+    ImGui::Text("# Culled Nodes: %i", numCulledNodes);
+    ImGui::Text("Chunk Upload: %zu + %zu bytes",
+                mChunkData->getLastFlushBytes(),
+                mVisibleChunks->getLastFlushBytes());
+
+    const TerrainQuadTree::Stats& lodStats = mQuadTree->getStats();
+    ImGui::Text("LOD Update: %i visited, %i divides, %i merges",
+                lodStats.nodesVisited, lodStats.divides, lodStats.merges);
+
+    bool lodChanged = false;
+    lodChanged |= ImGui::SliderFloat(
+        "LOD Attenuation", &config.lod.lodAttenuation, 0.0, 10000.f);
+    lodChanged |= ImGui::SliderFloat("LOD Hysteresis", &config.lod.hysteresis,
+                                     0.f, 1.f);
+    if (lodChanged)
+        mQuadTree->setConfig(config.lod);
+
+    if (ImGui::CollapsingHeader("LOD Benchmark")) {
+        ImGui::Checkbox("Record Camera Path", &mRecordCameraPath);
+        ImGui::SameLine();
+        if (ImGui::Button("Clear Path"))
+            mCameraPath.clear();
+        ImGui::Text("Recorded Frames: %zu", mCameraPath.size());
+
+        // Without a recorded path, flies a built-in one
+        static LODBenchmark benchmark;
+        if (ImGui::Button("Benchmark LOD")) {
+            benchmark = RunLODBenchmark(
+                mCameraPath.empty() ? GenerateBenchmarkPath() : mCameraPath,
+                config.lod);
+        }
+
+        if (benchmark.frames > 0 && ImGui::BeginTable("LOD Benchmark", 5)) {
+            ImGui::TableSetupColumn("Update");
+            ImGui::TableSetupColumn("ms / Frame");
+            ImGui::TableSetupColumn("Visited / Frame");
+            ImGui::TableSetupColumn("Divides + Merges");
+            ImGui::TableSetupColumn("Final Leaves");
+            ImGui::TableHeadersRow();
+
+            for (const LODBenchmark::Result& result : benchmark.results) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", result.name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.4f", result.totalMs / benchmark.frames);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.1f",
+                            double(result.nodesVisited) / benchmark.frames);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%zu", result.changes);
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%zu", result.leaves);
+            }
 
-    ImGui::SliderFloat("LOD Attenuation", &config.lodAttenuation, 0.0, 10000.f);
+            ImGui::EndTable();
+        }
+
+        static UploadBenchmark uploads;
+        if (ImGui::Button("Benchmark Chunk Uploads")) {
+            uploads = RunUploadBenchmark(
+                mCameraPath.empty() ? GenerateBenchmarkPath() : mCameraPath,
+                config.lod);
+        }
+
+        if (uploads.frames > 0) {
+            ImGui::Text("Up to %zu chunks. Bytes / Frame:", uploads.maxChunks);
+            ImGui::Text("Constant Buffer: %.0f", uploads.constantBufferBytes);
+            ImGui::Text("Structured Buffers: %.0f (%.1f uploads)",
+                        uploads.structuredBufferBytes,
+                        uploads.structuredBufferUploads);
+        }
+    }
 
     if (ImGui::CollapsingHeader("Terrain Mesh")) {
         ImGui::SliderInt("# Terrain Mesh Samples: %i",
@@ -189,20 +493,32 @@ void Terrain2DManagerImpl::imGui() {
     }
 
     if (ImGui::CollapsingHeader("Height Map Settings")) {
-        ImGui::SliderFloat2("Heightmap Origin:", &config.heightMapOrigin.x,
-                            -500, 500);
-        ImGui::SliderFloat2("Heightmap Extents:", &config.heightMapExtents.x,
+        mHeightmapWindow->imGui();
+
+        ImGui::SliderFloat2("Heightmap Extents:", &config.heightmap.extents.x,
                             10, 5000);
-        ImGui::SliderInt("Heightmap Samples:", &config.heightmapNumSamples, 10,
+        ImGui::SliderInt("Heightmap Samples:", &config.heightmap.resolution, 10,
                          2500);
+        ImGui::SliderInt("Recenter Threshold:",
+                         &config.heightmap.recenterThreshold, 1, 128);
 
         if (ImGui::Button("Reset Heightmap")) {
-            regenerateHeightmapTexture();
+            mHeightmapWindow->reset(config.heightmap);
         }
     }
 
+    if (ImGui::CollapsingHeader("Height Queries")) {
+        mHeightQuery->imGui();
+    }
+
     if (ImGui::CollapsingHeader("Noise Settings")) {
-        mHeightMap->imGui();
+        // Settings can't change while heights are being generated, so the
+        // jobs are finished before a setting is written. Changes bump the
+        // pipeline's version, which regenerates the heightmap.
+        mHeightMap->imGui([this]() {
+            mHeightmapWindow->finish();
+            mHeightQuery->finish();
+        });
 
         if (ImGui::Button("Reset")) {
             reset();
@@ -211,16 +527,7 @@ void Terrain2DManagerImpl::imGui() {
 #endif
 }
 
-void Terrain2DManagerImpl::reset() {
-    if (root) {
-        destroyNode(root);
-        root = nullptr;
-    }
-
-    const float rootSize = kTerrainNodeSize * (1 << kMaxQuadTreeDepth);
-    root = allocateNode(Vector2(-rootSize / 2, -rootSize / 2),
-                        Vector2(rootSize, rootSize));
-}
+void Terrain2DManagerImpl::reset() { mQuadTree->reset(); }
 
 void Terrain2DManagerImpl::regenerateMesh() {
     const int numSamples = config.terrainMeshSampleCount;
@@ -315,133 +622,19 @@ void Terrain2DManagerImpl::regenerateMesh() {
     mTerrainMesh = mVisualSystem->getResourceManager()->requestMesh(builder);
 }
 
-void Terrain2DManagerImpl::regenerateHeightmapTexture() {
-    const int numSamples = config.heightmapNumSamples;
-
-    TextureBuilder builder(numSamples, numSamples, TextureLayout::R32_FLOAT);
-
-    TextureColor texel;
-    auto& height = texel.asType<TextureColor::FloatR32>();
-
-    const Vector2 heightMapPosition =
-        config.heightMapOrigin - config.heightMapExtents / 2;
-    const float distBetweenSamplesInv = 1 / float(numSamples - 1);
-    for (int x = 0; x < numSamples; x++) {
-        for (int z = 0; z < numSamples; z++) {
-            const float worldX =
-                heightMapPosition.x +
-                x * distBetweenSamplesInv * config.heightMapExtents.x;
-            const float worldZ =
-                heightMapPosition.y +
-                z * distBetweenSamplesInv * config.heightMapExtents.y;
-
-            height.r = mHeightMap->sampleHeight(worldX, worldZ);
-            builder.setColor(x, z, texel);
-        }
-    }
-
-    std::shared_ptr<Texture> texture =
-        mVisualSystem->getResourceManager()->requestTexture(builder, true);
-    mTerrainTechnique = mTerrainMaterial->getTechnique(RenderPass::kOpaque);
-    mTerrainTechnique->bindVertexShaderResource(0, texture,
-                                                SamplerType::Sampler_Point);
-}
-
-uint8_t Terrain2DManagerImpl::computeIdealLOD(QuadTreeNode* node,
-                                              const Vector3& cameraPosition) {
-    // Find distance from node to camera. If node is in the camera, distance is
-    // 0.
-    const Vector2 halfExtents = node->data.extents / 2;
-    const Vector2 center = node->data.position + halfExtents;
-
-    Vector2 relPos = cameraPosition.xz() - center;
-    relPos.x = abs(relPos.x);
-    relPos.y = abs(relPos.y);
-
-    relPos.x = max(relPos.x - halfExtents.x, 0.f);
-    relPos.y = max(relPos.y - halfExtents.y, 0.f);
-
-    const float distance = relPos.magnitude();
-
-    const uint8_t lod =
-        kMaxQuadTreeDepth / (1 + distance / config.lodAttenuation);
-    if (lod > kMaxQuadTreeDepth)
-        return kMaxQuadTreeDepth;
-    else
-        return lod;
-}
-
-void Terrain2DManagerImpl::updateQuadTreeRecursive(
-    QuadTreeNode* node, const Vector3& cameraPosition, int depth) {
-    const uint8_t idealLOD = computeIdealLOD(node, cameraPosition);
-    if (node->isLeaf()) {
-        if (idealLOD > depth) {
-            divideNode(*node);
-
-            for (int i = 0; i < 4; i++) {
-                updateQuadTreeRecursive(node->children[i], cameraPosition,
-                                        depth + 1);
-            }
-        }
-    } else {
-        if (idealLOD < depth) {
-            mergeNode(*node);
-        } else {
-            for (int i = 0; i < 4; i++) {
-                updateQuadTreeRecursive(node->children[i], cameraPosition,
-                                        depth + 1);
-            }
-        }
-    }
-
-    if (node->isLeaf()) {
-        chunksToRender.push_back(node->data);
-    }
-}
-
-QuadTreeNode* Terrain2DManagerImpl::allocateNode(const Vector2& position,
-                                                 const Vector2& extents) {
-    QuadTreeNode* node = mQuadTreeAllocator.allocate();
-    node->data.position = position;
-    node->data.extents = extents;
-
-    return node;
-}
-void Terrain2DManagerImpl::destroyNode(QuadTreeNode* node) {
-    const size_t index = mQuadTreeAllocator.getIndex(node);
-
-    if (!node->isLeaf()) {
-        for (int i = 0; i < 4; i++) {
-            destroyNode(node->children[i]);
-        }
-    }
-    mQuadTreeAllocator.free(node);
-}
-
-void Terrain2DManagerImpl::divideNode(QuadTreeNode& node) {
-    assert(node.isLeaf());
-    const auto& data = node.data;
-    const Vector2 halfExtents = data.extents / 2;
-
-    // Allocated in this order (bottom-left is parent position (x,z))
-    // C D
-    // A B
-    node.children[0] = allocateNode(data.position, halfExtents);
-    node.children[1] =
-        allocateNode(data.position + Vector2(halfExtents.x, 0), halfExtents);
-    node.children[2] =
-        allocateNode(data.position + Vector2(0, halfExtents.y), halfExtents);
-    node.children[3] = allocateNode(data.position + halfExtents, halfExtents);
-}
-
-void Terrain2DManagerImpl::mergeNode(QuadTreeNode& node) {
-    assert(!node.isLeaf());
-
-    for (int i = 0; i < 4; i++) {
-        QuadTreeNode* child = node.children[i];
-        destroyNode(child);
-        node.children[i] = nullptr;
-    }
+// ComputeHeightBounds:
+// Finds the range of heights a chunk is drawn with, including its skirt.
+bool Terrain2DManagerImpl::computeHeightBounds(const Vector2& minimum,
+                                               const Vector2& maximum,
+                                               float& minHeight,
+                                               float& maxHeight) const {
+    if (!mHeightmapWindow->getHeightBounds(minimum, maximum, minHeight,
+                                           maxHeight))
+        return false;
+
+    if (config.generateSkirt)
+        minHeight -= config.skirtDepth;
+    return true;
 }
 
 } // namespace Graphics
@@ -1,22 +1,39 @@
 #pragma once
 
+#include <stdint.h>
+
 #include <memory>
 
+#include "math/Vector2.h"
 #include "math/Vector3.h"
 
 namespace Engine {
 using namespace Math;
 namespace Graphics {
 class VisualSystem;
+class Frustum;
+class HeightMapGenerator;
+class TerrainHeightQuery;
 class Terrain2DManagerImpl;
 class Terrain2DManager {
   public:
     static std::unique_ptr<Terrain2DManager> create(VisualSystem* visualSystem);
     ~Terrain2DManager();
 
-    void update(const Vector3& cameraPosition);
+    // Chunks are selected by their distance to the camera, and culled against
+    // the camera's frustum.
+    void update(const Vector3& cameraPosition, const Frustum& frustum);
     void imGui();
 
+    const HeightMapGenerator* getHeightMap() const;
+    // Height and normal queries on the CPU, for gameplay and physics
+    TerrainHeightQuery* getHeightQuery() const;
+    // Region covered by the heightmap window, and the version of the height
+    // settings, so that physics can cache heights under the same window.
+    // Returns false until the first window is ready.
+    bool getHeightmapRegion(Vector2& origin, Vector2& extents, int& samples,
+                            uint32_t& version) const;
+
   private:
     std::unique_ptr<Terrain2DManagerImpl> mImpl;
     Terrain2DManager();
@@ -0,0 +1,507 @@
+#include "TerrainHeightQuery.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <unordered_set>
+
+#include "core/ThreadPool.h"
+#include "utility/Stopwatch.h"
+
+#include "rendering/ImGui.h"
+
+namespace Engine {
+namespace Graphics {
+// Divides, rounding towards negative infinity
+static int FloorDiv(int value, int divisor) {
+    const int quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+// CatmullRomWeights:
+// Weights of the 4 samples around t, and of their derivatives
+static void CatmullRomWeights(float t, float weights[4],
+                              float derivatives[4]) {
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+
+    weights[0] = 0.5f * (-t3 + 2 * t2 - t);
+    weights[1] = 0.5f * (3 * t3 - 5 * t2 + 2);
+    weights[2] = 0.5f * (-3 * t3 + 4 * t2 + t);
+    weights[3] = 0.5f * (t3 - t2);
+
+    derivatives[0] = 0.5f * (-3 * t2 + 4 * t - 1);
+    derivatives[1] = 0.5f * (9 * t2 - 10 * t);
+    derivatives[2] = 0.5f * (-9 * t2 + 8 * t + 1);
+    derivatives[3] = 0.5f * (3 * t2 - 2 * t);
+}
+
+bool TerrainHeightQuery::TileCoord::operator==(const TileCoord& other) const {
+    return x == other.x && z == other.z;
+}
+size_t
+TerrainHeightQuery::TileCoordHash::operator()(const TileCoord& coord) const {
+    return (size_t)((uint32_t)coord.x * 73856093u ^
+                    (uint32_t)coord.z * 19349663u);
+}
+
+TerrainHeightQuery::TerrainHeightQuery(HeightFieldPipeline* pipeline)
+    : TerrainHeightQuery(pipeline, Config()) {}
+TerrainHeightQuery::TerrainHeightQuery(HeightFieldPipeline* pipeline,
+                                       const Config& config)
+    : mPipeline(pipeline), mConfig(config) {
+    mConfig.cacheCapacity = std::max(mConfig.cacheCapacity, (size_t)1);
+    reset();
+}
+TerrainHeightQuery::~TerrainHeightQuery() { finish(); }
+
+void TerrainHeightQuery::reset() {
+    const HeightFieldPipeline::Config& config = mPipeline->getConfig();
+    mResolution = config.tileResolution;
+    mCellsPerTile = mResolution - 1;
+    mSpacing = config.tileSize * float(1 << mConfig.lod) / mCellsPerTile;
+    mVersion = mPipeline->getVersion();
+
+    mCache.clear();
+    mLRU.clear();
+    mLastTile = nullptr;
+}
+
+// CheckVersion:
+// Drops every tile if the pipeline's settings changed since they were
+// generated.
+void TerrainHeightQuery::checkVersion() {
+    if (mPipeline->getVersion() == mVersion)
+        return;
+
+    finish();
+    reset();
+}
+
+void TerrainHeightQuery::update(const Vector2& minimum,
+                                const Vector2& maximum) {
+    checkVersion();
+
+    if (mJob.valid() &&
+        mJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        completeJob();
+
+    mWindowCenter =
+        Vector2((minimum.x + maximum.x) / 2, (minimum.y + maximum.y) / 2);
+    if (mJob.valid())
+        return;
+
+    const TileCoord low = tileOf((int)floorf(minimum.x / mSpacing),
+                                 (int)floorf(minimum.y / mSpacing));
+    const TileCoord high = tileOf((int)ceilf(maximum.x / mSpacing),
+                                  (int)ceilf(maximum.y / mSpacing));
+
+    // Tiles past the capacity would evict each other, so they are left to
+    // be generated on demand.
+    std::vector<HeightTileKey> keys;
+    for (int x = low.x; x <= high.x; x++) {
+        for (int z = low.z; z <= high.z; z++) {
+            if (mCache.find(TileCoord{x, z}) == mCache.end() &&
+                keys.size() < mConfig.cacheCapacity)
+                keys.push_back(mPipeline->tileKey(x, z, mConfig.lod));
+        }
+    }
+    if (keys.empty())
+        return;
+
+    mJobKeys = std::move(keys);
+    mJobTiles.assign(mJobKeys.size(), nullptr);
+    mJobVersion = mVersion;
+
+    auto generate = [this]() {
+        mPipeline->getTiles(mJobKeys.data(), mJobKeys.size(),
+                            mJobTiles.data());
+    };
+
+    ThreadPool* pool = ThreadPool::GetThreadPool();
+    if (pool != nullptr) {
+        mJob = pool->scheduleJob(generate);
+    } else {
+        std::promise<void> done;
+        generate();
+        done.set_value();
+        mJob = done.get_future();
+    }
+}
+
+void TerrainHeightQuery::finish() {
+    if (mJob.valid())
+        completeJob();
+}
+
+void TerrainHeightQuery::completeJob() {
+    mJob.get();
+
+    if (mJobVersion == mVersion) {
+        for (size_t i = 0; i < mJobKeys.size(); i++)
+            insertTile(TileCoord{mJobKeys[i].x, mJobKeys[i].z}, mJobTiles[i]);
+        mStats.tilesPrefetched += mJobKeys.size();
+    }
+
+    mJobKeys.clear();
+    mJobTiles.clear();
+}
+
+float TerrainHeightQuery::sampleHeight(float x, float z,
+                                       HeightInterpolation interpolation) {
+    checkVersion();
+
+    float height;
+    evaluate(x, z, interpolation, &height, nullptr);
+    return height;
+}
+
+Vector3 TerrainHeightQuery::sampleNormal(float x, float z,
+                                         HeightInterpolation interpolation) {
+    checkVersion();
+
+    Vector2 gradient;
+    evaluate(x, z, interpolation, nullptr, &gradient);
+    return Vector3(-gradient.x, 1.f, -gradient.y).unit();
+}
+
+void TerrainHeightQuery::sampleHeights(const float* x, const float* z,
+                                       float* output, size_t count,
+                                       HeightInterpolation interpolation) {
+    checkVersion();
+
+    const int border = interpolation == HeightInterpolation::Bicubic ? 1 : 0;
+    fetchTiles(x, z, count, border);
+
+    for (size_t i = 0; i < count; i++)
+        evaluate(x[i], z[i], interpolation, &output[i], nullptr);
+}
+
+void TerrainHeightQuery::sampleNormals(const float* x, const float* z,
+                                       Vector3* output, size_t count,
+                                       HeightInterpolation interpolation) {
+    checkVersion();
+
+    const int border = interpolation == HeightInterpolation::Bicubic ? 1 : 0;
+    fetchTiles(x, z, count, border);
+
+    Vector2 gradient;
+    for (size_t i = 0; i < count; i++) {
+        evaluate(x[i], z[i], interpolation, nullptr, &gradient);
+        output[i] = Vector3(-gradient.x, 1.f, -gradient.y).unit();
+    }
+}
+
+const TerrainHeightQuery::Stats& TerrainHeightQuery::getStats() const {
+    return mStats;
+}
+size_t TerrainHeightQuery::getCachedTileCount() const { return mCache.size(); }
+
+// Evaluate:
+// Interpolates the height, and its gradient along (x, z), from the samples
+// around a position. Bilinear interpolation reads the 2x2 samples of the
+// cell, which are always in the same tile. Bicubic (Catmull-Rom)
+// interpolation reads the 4x4 samples around the cell, which can span
+// several tiles at a tile's edge.
+void TerrainHeightQuery::evaluate(float x, float z,
+                                  HeightInterpolation interpolation,
+                                  float* height, Vector2* gradient) {
+    mStats.queries++;
+
+    const float grid_x = x / mSpacing;
+    const float grid_z = z / mSpacing;
+    const int ix = (int)floorf(grid_x);
+    const int iz = (int)floorf(grid_z);
+    const float tx = grid_x - ix;
+    const float tz = grid_z - iz;
+
+    const TileCoord coord = tileOf(ix, iz);
+    const HeightTile* tile = findTile(coord);
+    const int local_x = ix - coord.x * mCellsPerTile;
+    const int local_z = iz - coord.z * mCellsPerTile;
+
+    if (interpolation == HeightInterpolation::Bilinear) {
+        const float* cell =
+            &tile->heights[(size_t)local_x * mResolution + local_z];
+        const float h00 = cell[0];
+        const float h01 = cell[1];
+        const float h10 = cell[mResolution];
+        const float h11 = cell[mResolution + 1];
+
+        if (height) {
+            const float h0 = h00 + (h10 - h00) * tx;
+            const float h1 = h01 + (h11 - h01) * tx;
+            *height = h0 + (h1 - h0) * tz;
+        }
+        if (gradient) {
+            gradient->x =
+                ((h10 - h00) * (1 - tz) + (h11 - h01) * tz) / mSpacing;
+            gradient->y =
+                ((h01 - h00) * (1 - tx) + (h11 - h10) * tx) / mSpacing;
+        }
+        return;
+    }
+
+    float samples[4][4];
+    if (local_x >= 1 && local_x <= mCellsPerTile - 2 && local_z >= 1 &&
+        local_z <= mCellsPerTile - 2) {
+        const float* base =
+            &tile->heights[(size_t)(local_x - 1) * mResolution + local_z - 1];
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++)
+                samples[i][j] = base[i * mResolution + j];
+        }
+    } else {
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++)
+                samples[i][j] = sample(ix - 1 + i, iz - 1 + j);
+        }
+    }
+
+    float wx[4], dx[4], wz[4], dz[4];
+    CatmullRomWeights(tx, wx, dx);
+    CatmullRomWeights(tz, wz, dz);
+
+    float h = 0.f, gx = 0.f, gz = 0.f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            h += wx[i] * wz[j] * samples[i][j];
+            gx += dx[i] * wz[j] * samples[i][j];
+            gz += wx[i] * dz[j] * samples[i][j];
+        }
+    }
+
+    if (height)
+        *height = h;
+    if (gradient)
+        *gradient = Vector2(gx / mSpacing, gz / mSpacing);
+}
+
+// Sample:
+// Returns the height of a sample, by its global sample index
+float TerrainHeightQuery::sample(int x, int z) {
+    const TileCoord coord = tileOf(x, z);
+    const HeightTile* tile = findTile(coord);
+
+    const int local_x = x - coord.x * mCellsPerTile;
+    const int local_z = z - coord.z * mCellsPerTile;
+    return tile->heights[(size_t)local_x * mResolution + local_z];
+}
+
+TerrainHeightQuery::TileCoord TerrainHeightQuery::tileOf(int x, int z) const {
+    return TileCoord{FloorDiv(x, mCellsPerTile), FloorDiv(z, mCellsPerTile)};
+}
+
+// FindTile:
+// Returns the tile, generating it if it is not cached. The pointer is only
+// valid until the next tile is inserted.
+const HeightTile* TerrainHeightQuery::findTile(const TileCoord& coord) {
+    if (mLastTile != nullptr && coord == mLastCoord) {
+        mStats.tileHits++;
+        return mLastTile;
+    }
+
+    auto it = mCache.find(coord);
+    if (it != mCache.end()) {
+        mLRU.splice(mLRU.begin(), mLRU, it->second.lruPosition);
+        mStats.tileHits++;
+    } else {
+        mStats.tileMisses++;
+        insertTile(coord, mPipeline->getTile(
+                              mPipeline->tileKey(coord.x, coord.z,
+                                                 mConfig.lod)));
+        it = mCache.find(coord);
+    }
+
+    mLastCoord = coord;
+    mLastTile = it->second.tile.get();
+    return mLastTile;
+}
+
+void TerrainHeightQuery::insertTile(
+    const TileCoord& coord, const std::shared_ptr<const HeightTile>& tile) {
+    if (mCache.find(coord) != mCache.end())
+        return;
+
+    while (!mLRU.empty() && mCache.size() >= mConfig.cacheCapacity) {
+        if (mLastTile != nullptr && mLRU.back() == mLastCoord)
+            mLastTile = nullptr;
+
+        mCache.erase(mLRU.back());
+        mLRU.pop_back();
+    }
+
+    mLRU.push_front(coord);
+    mCache[coord] = CacheEntry{tile, mLRU.begin()};
+}
+
+// FetchTiles:
+// Finds the tiles a batch of queries reads, and generates the ones that are
+// not cached together. With a border, the queries read the samples from
+// border cells before to 2 * border cells after their own.
+void TerrainHeightQuery::fetchTiles(const float* x, const float* z,
+                                    size_t count, int border) {
+    std::unordered_set<TileCoord, TileCoordHash> missing;
+
+    for (size_t i = 0; i < count && missing.size() < mConfig.cacheCapacity;
+         i++) {
+        const int ix = (int)floorf(x[i] / mSpacing);
+        const int iz = (int)floorf(z[i] / mSpacing);
+        const TileCoord low = tileOf(ix - border, iz - border);
+        const TileCoord high = tileOf(ix + 2 * border, iz + 2 * border);
+
+        for (int tx = low.x; tx <= high.x; tx++) {
+            for (int tz = low.z; tz <= high.z; tz++) {
+                const TileCoord coord = TileCoord{tx, tz};
+                if (mCache.find(coord) == mCache.end())
+                    missing.insert(coord);
+            }
+        }
+    }
+    if (missing.empty())
+        return;
+
+    std::vector<TileCoord> coords(missing.begin(), missing.end());
+    std::vector<HeightTileKey> keys;
+    for (const TileCoord& coord : coords)
+        keys.push_back(mPipeline->tileKey(coord.x, coord.z, mConfig.lod));
+
+    std::vector<std::shared_ptr<const HeightTile>> tiles(keys.size());
+    mPipeline->getTiles(keys.data(), keys.size(), tiles.data());
+
+    for (size_t i = 0; i < coords.size(); i++)
+        insertTile(coords[i], tiles[i]);
+    mStats.tileMisses += coords.size();
+}
+
+#if defined(IMGUI_ENABLED)
+// QueryBenchmark:
+// Times height queries at random points around the heightmap window, in
+// millions of queries per second. Tile queries run on a warm cache. Error
+// is the mean absolute difference from the pipeline's point samples, which
+// is interpolation error (and erosion, if it is enabled).
+struct QueryBenchmark {
+    static constexpr int kNumMethods = 6;
+
+    int queries = 0;
+    struct Result {
+        const char* name;
+        double throughput = 0.0;
+        float error = 0.f;
+    } results[kNumMethods];
+
+    float checksum = 0.f;
+};
+
+static QueryBenchmark RunQueryBenchmark(TerrainHeightQuery& query,
+                                        const HeightFieldPipeline& pipeline,
+                                        const Vector2& center) {
+    constexpr int NUM_QUERIES = 1 << 16;
+    constexpr float EXTENTS = 1000.f;
+
+    QueryBenchmark benchmark;
+    benchmark.queries = NUM_QUERIES;
+
+    std::mt19937 generator = std::mt19937(0);
+    std::uniform_real_distribution<float> dist(-EXTENTS, EXTENTS);
+
+    std::vector<float> x(NUM_QUERIES), z(NUM_QUERIES);
+    for (int i = 0; i < NUM_QUERIES; i++) {
+        x[i] = center.x + dist(generator);
+        z[i] = center.y + dist(generator);
+    }
+
+    std::vector<float> reference(NUM_QUERIES), output(NUM_QUERIES);
+    std::vector<Vector3> normals(NUM_QUERIES);
+    pipeline.samplePoints(x.data(), z.data(), reference.data(), NUM_QUERIES);
+    query.sampleHeights(x.data(), z.data(), output.data(), NUM_QUERIES,
+                        HeightInterpolation::Bicubic);
+
+    Utility::Stopwatch stopwatch;
+    int method = 0;
+    // Runs the queries, and records their throughput and error
+    auto time = [&](const char* name, auto&& run) {
+        QueryBenchmark::Result& result = benchmark.results[method++];
+        result.name = name;
+
+        stopwatch.Reset();
+        run();
+        result.throughput = NUM_QUERIES / stopwatch.Duration() * 1e-6;
+
+        double error = 0.0;
+        for (int i = 0; i < NUM_QUERIES; i++)
+            error += fabsf(output[i] - reference[i]);
+        result.error = float(error / NUM_QUERIES);
+        benchmark.checksum += output[NUM_QUERIES / 2];
+    };
+
+    time("Noise (Point)", [&]() {
+        for (int i = 0; i < NUM_QUERIES; i++)
+            output[i] = pipeline.samplePoint(x[i], z[i]);
+    });
+    time("Noise (Batch)", [&]() {
+        pipeline.samplePoints(x.data(), z.data(), output.data(),
+                              NUM_QUERIES);
+    });
+    time("Bilinear", [&]() {
+        for (int i = 0; i < NUM_QUERIES; i++)
+            output[i] = query.sampleHeight(x[i], z[i]);
+    });
+    time("Bicubic", [&]() {
+        for (int i = 0; i < NUM_QUERIES; i++)
+            output[i] = query.sampleHeight(x[i], z[i],
+                                           HeightInterpolation::Bicubic);
+    });
+    time("Bilinear (Batch)", [&]() {
+        query.sampleHeights(x.data(), z.data(), output.data(), NUM_QUERIES);
+    });
+    // Normals have no reference, so their error is meaningless
+    time("Bilinear Normals", [&]() {
+        query.sampleNormals(x.data(), z.data(), normals.data(), NUM_QUERIES);
+    });
+    benchmark.results[method - 1].error = 0.f;
+
+    return benchmark;
+}
+#endif
+
+void TerrainHeightQuery::imGui() {
+#if defined(IMGUI_ENABLED)
+    ImGui::Text("Cached Tiles: %zu / %zu", mCache.size(),
+                mConfig.cacheCapacity);
+    ImGui::Text("Queries: %zu, Tile Hits: %zu, Misses: %zu", mStats.queries,
+                mStats.tileHits, mStats.tileMisses);
+    ImGui::Text("Tiles Prefetched: %zu", mStats.tilesPrefetched);
+
+    static QueryBenchmark benchmark;
+    if (ImGui::Button("Benchmark Queries")) {
+        finish();
+        benchmark = RunQueryBenchmark(*this, *mPipeline, mWindowCenter);
+    }
+
+    if (benchmark.queries > 0 && ImGui::BeginTable("Query Benchmark", 3)) {
+        ImGui::TableSetupColumn("Query");
+        ImGui::TableSetupColumn("M / s");
+        ImGui::TableSetupColumn("Mean Error");
+        ImGui::TableHeadersRow();
+
+        for (const QueryBenchmark::Result& result : benchmark.results) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", result.name);
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f", result.throughput);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.4f", result.error);
+        }
+
+        ImGui::EndTable();
+    }
+#endif
+}
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <future>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "math/Vector2.h"
+#include "math/Vector3.h"
+
+#include "HeightFieldPipeline.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+enum class HeightInterpolation { Bilinear, Bicubic };
+
+// TerrainHeightQuery Class:
+// Answers height and normal queries at world (x,z) positions on the CPU,
+// for gameplay and physics. Reads from world tiles of the height field
+// pipeline, so the heights include erosion, unlike point samples. Recently
+// used tiles are kept in an LRU cache, and the tiles under the terrain's
+// heightmap window are prefetched in the background as it moves.
+// Queries are made from one thread.
+class TerrainHeightQuery {
+  public:
+    struct Config {
+        // Tile LOD read from. LOD 1 tiles sample every 4 units, which is
+        // finer than the heightmap window.
+        int lod = 1;
+        size_t cacheCapacity = 64;
+    };
+
+    struct Stats {
+        size_t queries = 0;
+        size_t tileHits = 0;
+        size_t tileMisses = 0;
+        size_t tilesPrefetched = 0;
+    };
+
+  private:
+    struct TileCoord {
+        int x;
+        int z;
+
+        bool operator==(const TileCoord& other) const;
+    };
+    struct TileCoordHash {
+        size_t operator()(const TileCoord& coord) const;
+    };
+
+    HeightFieldPipeline* mPipeline;
+    Config mConfig;
+
+    // Sample layout of the tiles. Adjacent tiles share their edge samples,
+    // so a tile covers mCellsPerTile cells.
+    float mSpacing;
+    int mCellsPerTile;
+    int mResolution;
+    uint32_t mVersion;
+
+    // Tile Cache
+    // Least recently used tiles are at the back of the list, and are evicted
+    // first. The last tile read is checked before the cache.
+    struct CacheEntry {
+        std::shared_ptr<const HeightTile> tile;
+        std::list<TileCoord>::iterator lruPosition;
+    };
+    std::unordered_map<TileCoord, CacheEntry, TileCoordHash> mCache;
+    std::list<TileCoord> mLRU;
+
+    TileCoord mLastCoord;
+    const HeightTile* mLastTile = nullptr;
+
+    // Prefetch Job
+    std::future<void> mJob;
+    std::vector<HeightTileKey> mJobKeys;
+    std::vector<std::shared_ptr<const HeightTile>> mJobTiles;
+    uint32_t mJobVersion = 0;
+
+    Vector2 mWindowCenter;
+    Stats mStats;
+
+  public:
+    TerrainHeightQuery(HeightFieldPipeline* pipeline);
+    TerrainHeightQuery(HeightFieldPipeline* pipeline, const Config& config);
+    ~TerrainHeightQuery();
+
+    // Keeps the cache coherent with the terrain's heightmap window. Drops
+    // the cache if the pipeline's settings changed, and prefetches the
+    // tiles covering [minimum, maximum] in the background.
+    void update(const Vector2& minimum, const Vector2& maximum);
+    // Waits for the prefetch job, if any. Must be called before changing
+    // the pipeline's settings.
+    void finish();
+
+    // Point Queries
+    float sampleHeight(float x, float z,
+                       HeightInterpolation interpolation =
+                           HeightInterpolation::Bilinear);
+    Vector3 sampleNormal(float x, float z,
+                         HeightInterpolation interpolation =
+                             HeightInterpolation::Bilinear);
+
+    // Batch Queries
+    // The tiles the batch reads are fetched up front, and the ones that
+    // are not cached are generated in parallel.
+    void sampleHeights(const float* x, const float* z, float* output,
+                       size_t count,
+                       HeightInterpolation interpolation =
+                           HeightInterpolation::Bilinear);
+    void sampleNormals(const float* x, const float* z, Vector3* output,
+                       size_t count,
+                       HeightInterpolation interpolation =
+                           HeightInterpolation::Bilinear);
+
+    const Stats& getStats() const;
+    size_t getCachedTileCount() const;
+
+    void imGui();
+
+  private:
+    void reset();
+    void checkVersion();
+
+    void evaluate(float x, float z, HeightInterpolation interpolation,
+                  float* height, Vector2* gradient);
+    float sample(int x, int z);
+
+    TileCoord tileOf(int x, int z) const;
+    const HeightTile* findTile(const TileCoord& coord);
+    void insertTile(const TileCoord& coord,
+                    const std::shared_ptr<const HeightTile>& tile);
+    void fetchTiles(const float* x, const float* z, size_t count, int border);
+
+    void completeJob();
+};
+
+} // namespace Graphics
+} // namespace Engine
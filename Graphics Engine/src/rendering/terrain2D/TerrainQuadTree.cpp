@@ -0,0 +1,236 @@
+#include "TerrainQuadTree.h"
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include <algorithm>
+
+#include "math/AABB.h"
+#include "rendering/core/Frustum.h"
+
+namespace Engine {
+namespace Graphics {
+TerrainQuadTree::TerrainQuadTree() : TerrainQuadTree(Config()) {}
+TerrainQuadTree::TerrainQuadTree(const Config& config) : mConfig(config) {
+    reset();
+}
+TerrainQuadTree::~TerrainQuadTree() {
+    if (mRoot)
+        destroyNode(mRoot);
+}
+
+void TerrainQuadTree::reset() {
+    if (mRoot) {
+        destroyNode(mRoot);
+        mRoot = nullptr;
+    }
+
+    const float rootSize = kNodeSize * (1 << kMaxDepth);
+    mRoot = allocateNode(Vector2(-rootSize / 2, -rootSize / 2),
+                         Vector2(rootSize, rootSize));
+}
+
+void TerrainQuadTree::setConfig(const Config& config) {
+    mConfig = config;
+    mForceUpdate = true;
+}
+const TerrainQuadTree::Config& TerrainQuadTree::getConfig() const {
+    return mConfig;
+}
+
+void TerrainQuadTree::updateLOD(const Vector2& camera) {
+    mStats = Stats();
+    updateNodeLOD(mRoot, camera, 0, mForceUpdate);
+    mForceUpdate = false;
+}
+
+void TerrainQuadTree::updateLODFull(const Vector2& camera) {
+    mStats = Stats();
+    updateNodeLOD(mRoot, camera, 0, true);
+    mForceUpdate = false;
+}
+
+int TerrainQuadTree::collectChunks(const Frustum& frustum,
+                                   const BoundsFunction& bounds,
+                                   std::vector<TerrainChunk>& output,
+                                   std::vector<uint32_t>& slots) {
+    return collectChunksRecursive(mRoot, frustum, bounds, Frustum::kAllPlanes,
+                                  output, slots);
+}
+
+size_t TerrainQuadTree::getNodeCount() {
+    return mAllocator.getNumAllocations();
+}
+size_t TerrainQuadTree::getLeafCount() const { return countLeaves(mRoot); }
+const TerrainQuadTree::Stats& TerrainQuadTree::getStats() const {
+    return mStats;
+}
+
+// UpdateNodeLOD:
+// Divides or merges the node if the camera crossed its divide or merge
+// distance, and updates its children. Then, computes how far the camera can
+// move before the subtree needs another visit: the distance to the node's
+// own threshold, or the smallest remaining slack of its children.
+void TerrainQuadTree::updateNodeLOD(QuadTreeNode* node, const Vector2& camera,
+                                    int depth, bool force) {
+    if (!force && node->lodSlack >= 0 &&
+        (camera - node->lodCamera).magnitude() < node->lodSlack)
+        return;
+    mStats.nodesVisited++;
+
+    const float distance = distanceTo(*node, camera);
+
+    if (node->isLeaf()) {
+        if (depth < kMaxDepth && distance <= divideDistance(depth)) {
+            divideNode(*node);
+            mStats.divides++;
+        }
+    } else {
+        if (depth > 0 && distance > mergeDistance(depth, *node)) {
+            mergeNode(*node);
+            mStats.merges++;
+        }
+    }
+
+    float slack = FLT_MAX;
+    if (node->isLeaf()) {
+        if (depth < kMaxDepth)
+            slack = distance - divideDistance(depth);
+    } else {
+        if (depth > 0)
+            slack = mergeDistance(depth, *node) - distance;
+
+        for (QuadTreeNode* child : node->children) {
+            updateNodeLOD(child, camera, depth + 1, force);
+            const float childSlack =
+                child->lodSlack - (camera - child->lodCamera).magnitude();
+            slack = std::min(slack, childSlack);
+        }
+    }
+
+    node->lodCamera = camera;
+    node->lodSlack = std::max(slack, 0.f);
+}
+
+// CollectChunksRecursive:
+// planeMask holds the frustum planes the parent crosses. Once a node is
+// entirely inside the frustum, its subtree skips culling.
+int TerrainQuadTree::collectChunksRecursive(QuadTreeNode* node,
+                                            const Frustum& frustum,
+                                            const BoundsFunction& bounds,
+                                            uint8_t planeMask,
+                                            std::vector<TerrainChunk>& output,
+                                            std::vector<uint32_t>& slots) {
+    const TerrainChunk& data = node->data;
+
+    if (planeMask != 0 &&
+        bounds(data.position, data.position + data.extents, node->minHeight,
+               node->maxHeight)) {
+        AABB aabb;
+        aabb.expandToContain(
+            Vector3(data.position.x, node->minHeight, data.position.y));
+        aabb.expandToContain(Vector3(data.position.x + data.extents.x,
+                                     node->maxHeight,
+                                     data.position.y + data.extents.y));
+
+        if (!frustum.intersectsAABB(aabb, planeMask))
+            return 1;
+    }
+
+    if (node->isLeaf()) {
+        output.push_back(data);
+        slots.push_back(mAllocator.getIndex(node));
+        return 0;
+    }
+
+    int culled = 0;
+    for (QuadTreeNode* child : node->children)
+        culled += collectChunksRecursive(child, frustum, bounds, planeMask,
+                                         output, slots);
+    return culled;
+}
+
+size_t TerrainQuadTree::countLeaves(const QuadTreeNode* node) const {
+    if (node->isLeaf())
+        return 1;
+
+    size_t count = 0;
+    for (const QuadTreeNode* child : node->children)
+        count += countLeaves(child);
+    return count;
+}
+
+// DistanceTo:
+// Distance from the camera to the node's square. 0 if the camera is above it.
+float TerrainQuadTree::distanceTo(const QuadTreeNode& node,
+                                  const Vector2& camera) const {
+    const Vector2 halfExtents = node.data.extents / 2;
+    const Vector2 center = node.data.position + halfExtents;
+
+    Vector2 relPos = camera - center;
+    relPos.x = std::max(fabsf(relPos.x) - halfExtents.x, 0.f);
+    relPos.y = std::max(fabsf(relPos.y) - halfExtents.y, 0.f);
+
+    return relPos.magnitude();
+}
+
+// DivideDistance / MergeDistance:
+// A node's ideal depth is kMaxDepth / (1 + distance / lodAttenuation). A leaf
+// divides when its ideal depth is deeper than it, and a node merges when its
+// ideal depth is shallower than it, past the hysteresis margin.
+float TerrainQuadTree::divideDistance(int depth) const {
+    return mConfig.lodAttenuation * (float(kMaxDepth) / (depth + 1) - 1.f);
+}
+float TerrainQuadTree::mergeDistance(int depth,
+                                     const QuadTreeNode& node) const {
+    assert(depth > 0);
+    return mConfig.lodAttenuation * (float(kMaxDepth) / depth - 1.f) +
+           mConfig.hysteresis * node.data.extents.x;
+}
+
+QuadTreeNode* TerrainQuadTree::allocateNode(const Vector2& position,
+                                            const Vector2& extents) {
+    QuadTreeNode* node = mAllocator.allocate();
+    node->data.position = position;
+    node->data.extents = extents;
+
+    return node;
+}
+void TerrainQuadTree::destroyNode(QuadTreeNode* node) {
+    if (!node->isLeaf()) {
+        for (int i = 0; i < 4; i++) {
+            destroyNode(node->children[i]);
+        }
+    }
+    mAllocator.free(node);
+}
+
+void TerrainQuadTree::divideNode(QuadTreeNode& node) {
+    assert(node.isLeaf());
+    const auto& data = node.data;
+    const Vector2 halfExtents = data.extents / 2;
+
+    // Allocated in this order (bottom-left is parent position (x,z))
+    // C D
+    // A B
+    node.children[0] = allocateNode(data.position, halfExtents);
+    node.children[1] =
+        allocateNode(data.position + Vector2(halfExtents.x, 0), halfExtents);
+    node.children[2] =
+        allocateNode(data.position + Vector2(0, halfExtents.y), halfExtents);
+    node.children[3] = allocateNode(data.position + halfExtents, halfExtents);
+}
+
+void TerrainQuadTree::mergeNode(QuadTreeNode& node) {
+    assert(!node.isLeaf());
+
+    for (int i = 0; i < 4; i++) {
+        QuadTreeNode* child = node.children[i];
+        destroyNode(child);
+        node.children[i] = nullptr;
+    }
+}
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "core/PoolAllocator.h"
+#include "math/Vector2.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+class Frustum;
+
+struct TerrainChunk {
+    Vector2 position; // Bottom-Left (x,z) Coordinates
+    Vector2 extents;
+};
+
+struct QuadTreeNode {
+    TerrainChunk data;
+    QuadTreeNode* children[4] = {nullptr};
+
+    // Range of heights of the terrain in the node, for culling
+    float minHeight = 0.f;
+    float maxHeight = 0.f;
+
+    // Camera (x,z) position the subtree's LOD was last updated at, and how
+    // far the camera can move from it before any node in the subtree could
+    // need to divide or merge. Negative if the subtree must be updated.
+    Vector2 lodCamera;
+    float lodSlack = -1.f;
+
+    bool isLeaf() const { return children[0] == nullptr; }
+};
+
+// TerrainQuadTree Class:
+// Quadtree of terrain chunks, refined around the camera. A node's ideal
+// depth falls off with its distance to the camera. Leaves divide when the
+// camera comes within their divide distance, and nodes merge when it leaves
+// their merge distance (plus a hysteresis margin, so that nodes don't thrash
+// at the boundary).
+// The LOD update is incremental. A node's distance to the camera changes by
+// at most as much as the camera moves, so each subtree remembers how far
+// the camera can move before it could change, and is skipped until then.
+class TerrainQuadTree {
+  public:
+    struct Config {
+        float lodAttenuation = 1000.f;
+        // Merge margin, as a fraction of the node's size
+        float hysteresis = 0.25f;
+    };
+
+    // Work done by the last LOD update
+    struct Stats {
+        int nodesVisited = 0;
+        int divides = 0;
+        int merges = 0;
+    };
+
+    // Finds the height range of the terrain in [minimum, maximum]. Returns
+    // false if it isn't known.
+    using BoundsFunction = std::function<bool(
+        const Vector2& minimum, const Vector2& maximum, float& minHeight,
+        float& maxHeight)>;
+
+    static constexpr int kMaximumNodes = 5000;
+    static constexpr int kMaxDepth = 10;
+    static constexpr float kNodeSize = 25.f;
+
+  private:
+    Config mConfig;
+    Stats mStats;
+    bool mForceUpdate = true;
+
+    QuadTreeNode* mRoot = nullptr;
+    PoolAllocator<QuadTreeNode, kMaximumNodes> mAllocator;
+
+  public:
+    TerrainQuadTree();
+    TerrainQuadTree(const Config& config);
+    ~TerrainQuadTree();
+
+    // Rebuilds the tree from a single root node
+    void reset();
+
+    // Changing the config makes the next update revisit every node
+    void setConfig(const Config& config);
+    const Config& getConfig() const;
+
+    // Divides and merges nodes to match the camera's position, visiting only
+    // the subtrees that could have changed.
+    void updateLOD(const Vector2& camera);
+    // Same as updateLOD, but visits every node. Used for comparison.
+    void updateLODFull(const Vector2& camera);
+
+    // Adds the leaves that intersect the frustum to output. Nodes are
+    // culled hierarchically, and subtrees entirely inside of the frustum
+    // skip the test. Returns the number of nodes culled.
+    // slots gets each leaf's node index, which is below kMaximumNodes and
+    // doesn't change while the node exists.
+    int collectChunks(const Frustum& frustum, const BoundsFunction& bounds,
+                      std::vector<TerrainChunk>& output,
+                      std::vector<uint32_t>& slots);
+
+    size_t getNodeCount();
+    size_t getLeafCount() const;
+    const Stats& getStats() const;
+
+  private:
+    void updateNodeLOD(QuadTreeNode* node, const Vector2& camera, int depth,
+                       bool force);
+    int collectChunksRecursive(QuadTreeNode* node, const Frustum& frustum,
+                               const BoundsFunction& bounds,
+                               uint8_t planeMask,
+                               std::vector<TerrainChunk>& output,
+                               std::vector<uint32_t>& slots);
+    size_t countLeaves(const QuadTreeNode* node) const;
+
+    float distanceTo(const QuadTreeNode& node, const Vector2& camera) const;
+    float divideDistance(int depth) const;
+    float mergeDistance(int depth, const QuadTreeNode& node) const;
+
+    // QuadTree Management
+    QuadTreeNode* allocateNode(const Vector2& position, const Vector2& extents);
+    void destroyNode(QuadTreeNode* node);
+    void divideNode(QuadTreeNode& node);
+    void mergeNode(QuadTreeNode& node);
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,352 @@
+#include "ToroidalHeightmap.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "core/ThreadPool.h"
+#include "utility/Stopwatch.h"
+
+#include "rendering/core/Texture.h"
+#include "rendering/resources/ResourceManager.h"
+#include "rendering/resources/TextureBuilder.h"
+
+#include "rendering/ImGui.h"
+
+#include "HeightMapGenerator.h"
+
+namespace Engine {
+namespace Graphics {
+bool ToroidalHeightmap::Window::operator==(const Window& other) const {
+    return valid == other.valid && x == other.x && z == other.z;
+}
+
+ToroidalHeightmap::ToroidalHeightmap(ResourceManager* resourceManager,
+                                     HeightMapGenerator* heightMap,
+                                     const Config& config)
+    : mResourceManager(resourceManager), mHeightMap(heightMap) {
+    reset(config);
+}
+ToroidalHeightmap::~ToroidalHeightmap() { finish(); }
+
+void ToroidalHeightmap::update(const Vector2& center) {
+    if (mJob.valid() &&
+        mJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        completeJob();
+
+    // Once the back texture has its upload, it holds a newer window than the
+    // front, so swap them.
+    Buffer& back = mBuffers[1 - mFront];
+    if (back.uploading && back.texture->ready) {
+        back.uploading = false;
+        mFront = 1 - mFront;
+    }
+
+    // Bring the back texture up to date with the latest heights. The job
+    // writes to mHeights while it runs, so this must wait for it.
+    if (!mJob.valid() && mHeightsWindow.valid) {
+        Buffer& buffer = mBuffers[1 - mFront];
+        if (!buffer.uploading && buffer.texture->ready &&
+            !(buffer.window == mHeightsWindow &&
+              buffer.version == mHeightsVersion))
+            uploadChanges(buffer);
+    }
+
+    if (!mJob.valid()) {
+        const uint32_t version = mHeightMap->getPipeline()->getVersion();
+        const Window target = computeWindow(center);
+
+        const int threshold = mConfig.recenterThreshold;
+        if (!mHeightsWindow.valid || version != mHeightsVersion)
+            startJob(target, true);
+        else if (abs(target.x - mHeightsWindow.x) >= threshold ||
+                 abs(target.z - mHeightsWindow.z) >= threshold)
+            startJob(target, false);
+    }
+}
+
+void ToroidalHeightmap::finish() {
+    if (mJob.valid())
+        completeJob();
+}
+
+void ToroidalHeightmap::reset(const Config& config) {
+    finish();
+
+    mConfig = config;
+    assert(mConfig.resolution >= 2);
+    mConfig.recenterThreshold = std::max(mConfig.recenterThreshold, 1);
+
+    const int resolution = mConfig.resolution;
+    mSpacing = mConfig.extents / float(resolution - 1);
+
+    mHeights.assign((size_t)resolution * resolution, 0.f);
+    mHeightsWindow = Window();
+    mHeightsBounds = nullptr;
+
+    // The textures are updated a region at a time, so they are not editable
+    // (which would require rewriting the whole texture).
+    TextureBuilder builder(resolution, resolution, TextureLayout::R32_FLOAT);
+    for (Buffer& buffer : mBuffers) {
+        buffer.texture = mResourceManager->requestTexture(builder);
+        buffer.window = Window();
+        buffer.uploading = false;
+        buffer.bounds = nullptr;
+    }
+    mFront = 0;
+}
+
+bool ToroidalHeightmap::ready() const {
+    return mBuffers[mFront].window.valid;
+}
+
+const std::shared_ptr<Texture>& ToroidalHeightmap::getTexture() const {
+    return mBuffers[mFront].texture;
+}
+
+ToroidalHeightmap::ShaderData ToroidalHeightmap::getShaderData() const {
+    const Window& window = mBuffers[mFront].window;
+    const float resolution = float(mConfig.resolution);
+
+    ShaderData data;
+    data.worldPosition = Vector2(window.x * mSpacing.x, window.z * mSpacing.y);
+    data.worldExtents =
+        Vector2(mSpacing.x * resolution, mSpacing.y * resolution);
+    // Offset by half a texel, so that positions round to the nearest sample
+    data.uvOffset = Vector2((wrap(window.x) + 0.5f) / resolution,
+                            (wrap(window.z) + 0.5f) / resolution);
+    data.windowExtents = mConfig.extents;
+    return data;
+}
+
+bool ToroidalHeightmap::getSampleRegion(Vector2& origin,
+                                        Vector2& extents) const {
+    const Window& window = mBuffers[mFront].window;
+    if (!window.valid)
+        return false;
+
+    origin = Vector2(window.x * mSpacing.x, window.z * mSpacing.y);
+    extents = Vector2(mSpacing.x * (mConfig.resolution - 1),
+                      mSpacing.y * (mConfig.resolution - 1));
+    return true;
+}
+
+bool ToroidalHeightmap::getHeightBounds(const Vector2& minimum,
+                                        const Vector2& maximum,
+                                        float& minHeight,
+                                        float& maxHeight) const {
+    const Buffer& front = mBuffers[mFront];
+    if (!front.window.valid || front.bounds == nullptr)
+        return false;
+
+    // Positions round to the nearest sample in the shader, so this includes
+    // the samples on either side.
+    const int x0 = (int)floorf(minimum.x / mSpacing.x) - front.window.x;
+    const int z0 = (int)floorf(minimum.y / mSpacing.y) - front.window.z;
+    const int x1 = (int)ceilf(maximum.x / mSpacing.x) - front.window.x;
+    const int z1 = (int)ceilf(maximum.y / mSpacing.y) - front.window.z;
+    return front.bounds->query(x0, z0, x1, z1, minHeight, maxHeight);
+}
+
+const ToroidalHeightmap::Config& ToroidalHeightmap::getConfig() const {
+    return mConfig;
+}
+
+void ToroidalHeightmap::imGui() {
+#if defined(IMGUI_ENABLED)
+    const Window& window = mBuffers[mFront].window;
+    ImGui::Text("Window: (%i, %i)", window.x, window.z);
+    ImGui::Text("Window Moves: %zu", mWindowMoves);
+    ImGui::Text("Generation: %s", mJob.valid() ? "Running" : "Idle");
+    ImGui::Text("Last Move: %zu samples in %.2f ms", mLastSamplesGenerated,
+                mLastGenerationMs);
+    ImGui::Text("Last Upload: %zu bytes", mLastBytesUploaded);
+#endif
+}
+
+// ComputeWindow:
+// Finds the window centered on a world position
+ToroidalHeightmap::Window
+ToroidalHeightmap::computeWindow(const Vector2& center) const {
+    Window window;
+    window.x = (int)floorf(center.x / mSpacing.x) - mConfig.resolution / 2;
+    window.z = (int)floorf(center.y / mSpacing.y) - mConfig.resolution / 2;
+    window.valid = true;
+    return window;
+}
+
+int ToroidalHeightmap::wrap(int sample) const {
+    const int index = sample % mConfig.resolution;
+    return index < 0 ? index + mConfig.resolution : index;
+}
+
+// StartJob:
+// Generates the samples of the target window that are not in the current
+// window (or all of them, if full) on the thread pool, writing them into
+// mHeights. Then, rebuilds the bounds of the target window.
+void ToroidalHeightmap::startJob(const Window& target, bool full) {
+    assert(!mJob.valid());
+
+    std::vector<SampleRect> rects;
+    exposedRects(full ? Window() : mHeightsWindow, target, rects);
+
+    mJobWindow = target;
+    mJobVersion = mHeightMap->getPipeline()->getVersion();
+
+    auto generate = [this, rects, target]() {
+        Utility::Stopwatch stopwatch;
+        stopwatch.Reset();
+
+        const int resolution = mConfig.resolution;
+        std::vector<float> heights;
+        size_t samples = 0;
+
+        for (const SampleRect& rect : rects) {
+            heights.resize((size_t)rect.countX * rect.countZ);
+            const Vector2 origin =
+                Vector2(rect.x * mSpacing.x, rect.z * mSpacing.y);
+            mHeightMap->sampleHeightGrid(origin, mSpacing, rect.countX,
+                                         rect.countZ, heights.data());
+
+            for (int i = 0; i < rect.countX; i++) {
+                const int column = wrap(rect.x + i);
+                for (int j = 0; j < rect.countZ; j++) {
+                    const int row = wrap(rect.z + j);
+                    mHeights[(size_t)row * resolution + column] =
+                        heights[(size_t)i * rect.countZ + j];
+                }
+            }
+            samples += heights.size();
+        }
+
+        // Unwrap the window so that it starts at (0,0) for the pyramid
+        heights.resize((size_t)resolution * resolution);
+        for (int z = 0; z < resolution; z++) {
+            const float* row =
+                &mHeights[(size_t)wrap(target.z + z) * resolution];
+            for (int x = 0; x < resolution; x++)
+                heights[(size_t)z * resolution + x] = row[wrap(target.x + x)];
+        }
+        std::shared_ptr<MinMaxPyramid> bounds =
+            std::make_shared<MinMaxPyramid>();
+        bounds->build(heights.data(), resolution, resolution);
+        mJobBounds = bounds;
+
+        mJobSamples = samples;
+        mJobMs = float(stopwatch.Duration() * 1000.0);
+    };
+
+    ThreadPool* pool = ThreadPool::GetThreadPool();
+    if (pool != nullptr) {
+        mJob = pool->scheduleJob(generate);
+    } else {
+        std::promise<void> done;
+        generate();
+        done.set_value();
+        mJob = done.get_future();
+    }
+}
+
+void ToroidalHeightmap::completeJob() {
+    mJob.get();
+
+    mHeightsWindow = mJobWindow;
+    mHeightsVersion = mJobVersion;
+    mHeightsBounds = mJobBounds;
+    mJobBounds = nullptr;
+
+    mLastSamplesGenerated = mJobSamples;
+    mLastGenerationMs = mJobMs;
+    mWindowMoves++;
+}
+
+// UploadChanges:
+// Uploads the samples that differ between the buffer's window and the
+// latest window. A rectangle of samples can wrap around the texture's
+// edges, so it's split into up to 4 texel regions.
+void ToroidalHeightmap::uploadChanges(Buffer& buffer) {
+    const bool current =
+        buffer.window.valid && buffer.version == mHeightsVersion;
+
+    std::vector<SampleRect> rects;
+    exposedRects(current ? buffer.window : Window(), mHeightsWindow, rects);
+
+    const int resolution = mConfig.resolution;
+    size_t bytes = 0;
+
+    for (const SampleRect& rect : rects) {
+        const int startX = wrap(rect.x);
+        const int startZ = wrap(rect.z);
+
+        const int spansX[2][2] = {
+            {startX, std::min(rect.countX, resolution - startX)},
+            {0, rect.countX - std::min(rect.countX, resolution - startX)}};
+        const int spansZ[2][2] = {
+            {startZ, std::min(rect.countZ, resolution - startZ)},
+            {0, rect.countZ - std::min(rect.countZ, resolution - startZ)}};
+
+        for (const auto& spanX : spansX) {
+            for (const auto& spanZ : spansZ) {
+                const int width = spanX[1];
+                const int height = spanZ[1];
+                if (width <= 0 || height <= 0)
+                    continue;
+
+                TextureBuilder builder(width, height,
+                                       TextureLayout::R32_FLOAT);
+                for (int z = 0; z < height; z++) {
+                    const float* row = &mHeights[(size_t)(spanZ[0] + z) *
+                                                     resolution +
+                                                 spanX[0]];
+                    for (int x = 0; x < width; x++)
+                        builder.setColor(x, z, TextureColor(row[x]));
+                }
+
+                mResourceManager->requestTextureRegion(
+                    builder, buffer.texture, spanX[0], spanZ[0]);
+                bytes += (size_t)width * height * sizeof(float);
+            }
+        }
+    }
+
+    buffer.window = mHeightsWindow;
+    buffer.version = mHeightsVersion;
+    buffer.bounds = mHeightsBounds;
+    buffer.uploading = true;
+
+    mLastBytesUploaded = bytes;
+}
+
+// ExposedRects:
+// Finds the samples in window "to" that are not in window "from", as at
+// most 2 rectangles (a strip of columns, and a strip of rows).
+void ToroidalHeightmap::exposedRects(const Window& from, const Window& to,
+                                     std::vector<SampleRect>& output) const {
+    const int resolution = mConfig.resolution;
+    const int dx = to.x - from.x;
+    const int dz = to.z - from.z;
+
+    if (!from.valid || abs(dx) >= resolution || abs(dz) >= resolution) {
+        output.push_back({to.x, to.z, resolution, resolution});
+        return;
+    }
+
+    if (dx > 0)
+        output.push_back({from.x + resolution, to.z, dx, resolution});
+    else if (dx < 0)
+        output.push_back({to.x, to.z, -dx, resolution});
+
+    // The rows skip the columns that were already added
+    const int overlapX = std::max(from.x, to.x);
+    const int overlapCount = resolution - abs(dx);
+    if (dz > 0)
+        output.push_back({overlapX, from.z + resolution, overlapCount, dz});
+    else if (dz < 0)
+        output.push_back({overlapX, to.z, overlapCount, -dz});
+}
+
+} // namespace Graphics
+} // namespace Engine
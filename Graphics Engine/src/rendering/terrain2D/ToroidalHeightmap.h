@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "math/Vector2.h"
+
+#include "MinMaxPyramid.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+struct Texture;
+class ResourceManager;
+class HeightMapGenerator;
+
+// ToroidalHeightmap Class:
+// A heightmap texture that follows the camera. Samples are addressed by
+// their world sample coordinate, and sample (x, z) is stored at texel
+// (x mod resolution, z mod resolution). So, when the window moves, the
+// samples still in the window stay where they are, and only the newly
+// exposed rows and columns need to be generated and uploaded.
+// Generation runs on the thread pool, and also builds a min / max pyramid of
+// the window for height bounds. The texture is double buffered:
+// changed regions are uploaded to the back texture, which becomes the front
+// texture once its upload is done. The shader only ever reads a complete
+// window, and moving the camera never waits on generation.
+class ToroidalHeightmap {
+  public:
+    struct Config {
+        Vector2 extents = Vector2(2500, 2500);
+        int resolution = 450;
+
+        // How far (in samples) the window can lag behind the camera before
+        // it is moved. Larger values move the window less often, by more.
+        int recenterThreshold = 16;
+    };
+
+    // Data for the terrain shader. The texel holding world position (x,z)
+    // is at uv ((x,z) - worldPosition) / worldExtents + uvOffset, using a
+    // wrapping sampler. Positions should be clamped to the window, which
+    // spans windowExtents from worldPosition.
+    struct ShaderData {
+        Vector2 worldPosition;
+        Vector2 worldExtents;
+        Vector2 uvOffset;
+        Vector2 windowExtents;
+    };
+
+  private:
+    // Window of samples, by the world sample coordinate of its minimum
+    // corner
+    struct Window {
+        int x = 0;
+        int z = 0;
+        bool valid = false;
+
+        bool operator==(const Window& other) const;
+    };
+    // Rectangle of samples, in world sample coordinates
+    struct SampleRect {
+        int x, z;
+        int countX, countZ;
+    };
+
+    struct Buffer {
+        std::shared_ptr<Texture> texture;
+        Window window;
+        uint32_t version = 0;
+        bool uploading = false;
+
+        // Bounds of the heights in the window
+        std::shared_ptr<const MinMaxPyramid> bounds;
+    };
+
+    Config mConfig;
+    Vector2 mSpacing;
+
+    ResourceManager* mResourceManager;
+    HeightMapGenerator* mHeightMap;
+
+    // CPU copy of the heights in the latest window. Sample (x, z) is at
+    // mHeights[Wrap(z) * resolution + Wrap(x)], matching the texture.
+    std::vector<float> mHeights;
+    Window mHeightsWindow;
+    uint32_t mHeightsVersion = 0;
+    std::shared_ptr<const MinMaxPyramid> mHeightsBounds;
+
+    // Generation job. Only the job touches mHeights while it runs.
+    std::future<void> mJob;
+    Window mJobWindow;
+    uint32_t mJobVersion = 0;
+    std::shared_ptr<const MinMaxPyramid> mJobBounds;
+    size_t mJobSamples = 0;
+    float mJobMs = 0.f;
+
+    Buffer mBuffers[2];
+    int mFront = 0;
+
+    // Statistics
+    size_t mLastSamplesGenerated = 0;
+    float mLastGenerationMs = 0.f;
+    size_t mLastBytesUploaded = 0;
+    size_t mWindowMoves = 0;
+
+  public:
+    ToroidalHeightmap(ResourceManager* resourceManager,
+                      HeightMapGenerator* heightMap, const Config& config);
+    ~ToroidalHeightmap();
+
+    // Moves the window towards center, and advances any generation or
+    // upload in flight. Never blocks.
+    void update(const Vector2& center);
+    // Waits for the generation job in flight. Must be called before
+    // modifying the height map generator.
+    void finish();
+    // Discards everything and starts over with a new config.
+    void reset(const Config& config);
+
+    // True once the front texture holds a complete window
+    bool ready() const;
+    const std::shared_ptr<Texture>& getTexture() const;
+    ShaderData getShaderData() const;
+    // Finds the range of heights the terrain shader reads for the world
+    // (x,z) positions in [minimum, maximum], from the front texture. The
+    // shader clamps positions to the window, and so does this.
+    // Returns false if not ready.
+    bool getHeightBounds(const Vector2& minimum, const Vector2& maximum,
+                         float& minHeight, float& maxHeight) const;
+    // World region spanned by the samples of the front texture, from the
+    // first sample to the last. Returns false if not ready.
+    bool getSampleRegion(Vector2& origin, Vector2& extents) const;
+    const Config& getConfig() const;
+
+    void imGui();
+
+  private:
+    Window computeWindow(const Vector2& center) const;
+    int wrap(int sample) const;
+
+    void startJob(const Window& target, bool full);
+    void completeJob();
+    void uploadChanges(Buffer& buffer);
+
+    void exposedRects(const Window& from, const Window& to,
+                      std::vector<SampleRect>& output) const;
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,408 @@
+#include "DensityStore.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "core/ThreadPool.h"
+
+namespace Engine {
+namespace Graphics {
+static constexpr int kMaxQuantized = INT16_MAX;
+
+// BrickOf:
+// The brick a sample is in. Rounds down, so negative samples work too.
+static int BrickOf(int sample) {
+    return sample >= 0 ? sample / DensityStore::kBrickSize
+                       : -((-sample - 1) / DensityStore::kBrickSize) - 1;
+}
+
+// ForEachBrick:
+// Calls visit(coord, brickMin, overlapMin, overlapMax) for each brick the
+// region touches, where the overlap is the part of the region in the brick.
+template <typename F>
+static void ForEachBrick(const DensityRegion& region, F&& visit) {
+    int first[3], last[3];
+    for (int a = 0; a < 3; a++) {
+        assert(region.minimum[a] <= region.maximum[a]);
+        first[a] = BrickOf(region.minimum[a]);
+        last[a] = BrickOf(region.maximum[a]);
+    }
+
+    for (int bz = first[2]; bz <= last[2]; bz++) {
+        for (int by = first[1]; by <= last[1]; by++) {
+            for (int bx = first[0]; bx <= last[0]; bx++) {
+                const DensityBrickCoord coord = {bx, by, bz, region.lod};
+                const int brickMin[3] = {bx * DensityStore::kBrickSize,
+                                         by * DensityStore::kBrickSize,
+                                         bz * DensityStore::kBrickSize};
+                int low[3], high[3];
+                for (int a = 0; a < 3; a++) {
+                    low[a] = std::max(region.minimum[a], brickMin[a]);
+                    high[a] = std::min(region.maximum[a],
+                                       brickMin[a] + DensityStore::kBrickSize -
+                                           1);
+                }
+                visit(coord, brickMin, low, high);
+            }
+        }
+    }
+}
+
+static size_t BrickIndex(int x, int y, int z) {
+    return ((size_t)z * DensityStore::kBrickSize + y) *
+               DensityStore::kBrickSize +
+           x;
+}
+
+DensityRegion DensityRegion::Chunk(const VolumeChunkCoord& chunk, int cells,
+                                   bool padding) {
+    const int pad = padding ? 1 : 0;
+
+    DensityRegion region;
+    region.lod = chunk.lod;
+    const int coords[3] = {chunk.x, chunk.y, chunk.z};
+    for (int a = 0; a < 3; a++) {
+        region.minimum[a] = coords[a] * cells - pad;
+        region.maximum[a] = coords[a] * cells + cells + pad;
+    }
+    return region;
+}
+
+size_t DensityRegion::getSampleCount() const {
+    size_t count = 1;
+    for (int a = 0; a < 3; a++)
+        count *= (size_t)(maximum[a] - minimum[a] + 1);
+    return count;
+}
+
+bool DensityRegion::overlaps(const DensityRegion& other) const {
+    if (lod != other.lod)
+        return false;
+    for (int a = 0; a < 3; a++) {
+        if (maximum[a] < other.minimum[a] || other.maximum[a] < minimum[a])
+            return false;
+    }
+    return true;
+}
+
+bool DensityBrickCoord::operator==(const DensityBrickCoord& other) const {
+    return x == other.x && y == other.y && z == other.z && lod == other.lod;
+}
+size_t DensityBrickCoordHash::operator()(const DensityBrickCoord& coord) const {
+    size_t hash = (size_t)coord.x * 73856093u;
+    hash ^= (size_t)coord.y * 19349663u;
+    hash ^= (size_t)coord.z * 83492791u;
+    return hash ^ ((size_t)coord.lod * 2654435761u);
+}
+
+DensityStore::DensityStore(float spacing, const DensityFunction& density,
+                           const Config& config)
+    : mSpacing(spacing), mConfig(config), mDensity(density) {
+    assert(spacing > 0 && config.maxDensity > 0);
+}
+
+// Generate:
+// Missing bricks are added to the map first, and then sampled in
+// parallel. Elements of an unordered_map don't move when it grows, so each
+// job can hold on to its brick.
+void DensityStore::generate(const std::vector<DensityRegion>& regions) {
+    mEpoch++;
+
+    std::vector<std::pair<DensityBrickCoord, Brick*>> missing;
+    for (const DensityRegion& region : regions) {
+        ForEachBrick(region, [&](const DensityBrickCoord& coord,
+                                 const int*, const int*, const int*) {
+            auto [iter, inserted] = mBricks.try_emplace(coord);
+            iter->second.epoch = mEpoch;
+            if (inserted)
+                missing.push_back({coord, &iter->second});
+        });
+    }
+
+    ParallelFor(missing.size(), [&](size_t index) {
+        float samples[kBrickSamples];
+        sampleBrick(missing[index].first, samples);
+        encodeBrick(samples, *missing[index].second);
+    });
+}
+
+void DensityStore::releaseUnused() {
+    for (auto iter = mBricks.begin(); iter != mBricks.end();) {
+        if (!iter->second.edited && iter->second.epoch != mEpoch)
+            iter = mBricks.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void DensityStore::read(const DensityRegion& region, float* output) const {
+    const int sizeX = region.maximum[0] - region.minimum[0] + 1;
+    const int sizeY = region.maximum[1] - region.minimum[1] + 1;
+
+    float samples[kBrickSamples];
+    ForEachBrick(region, [&](const DensityBrickCoord& coord,
+                             const int* brickMin, const int* low,
+                             const int* high) {
+        const auto iter = mBricks.find(coord);
+        if (iter == mBricks.end())
+            sampleBrick(coord, samples);
+        else if (iter->second.encoding == Uniform) {
+            const float value = dequantize(iter->second.minimum);
+            for (int z = low[2]; z <= high[2]; z++) {
+                for (int y = low[1]; y <= high[1]; y++) {
+                    float* row = output +
+                                 ((size_t)(z - region.minimum[2]) * sizeY +
+                                  (y - region.minimum[1])) *
+                                     sizeX +
+                                 (low[0] - region.minimum[0]);
+                    std::fill(row, row + (high[0] - low[0] + 1), value);
+                }
+            }
+            return;
+        } else
+            decodeBrick(iter->second, samples);
+
+        for (int z = low[2]; z <= high[2]; z++) {
+            for (int y = low[1]; y <= high[1]; y++) {
+                const float* source =
+                    samples + BrickIndex(low[0] - brickMin[0],
+                                         y - brickMin[1], z - brickMin[2]);
+                float* row = output +
+                             ((size_t)(z - region.minimum[2]) * sizeY +
+                              (y - region.minimum[1])) *
+                                 sizeX +
+                             (low[0] - region.minimum[0]);
+                std::copy(source, source + (high[0] - low[0] + 1), row);
+            }
+        }
+    });
+}
+
+void DensityStore::write(const DensityRegion& region, const float* samples) {
+    const int sizeX = region.maximum[0] - region.minimum[0] + 1;
+    const int sizeY = region.maximum[1] - region.minimum[1] + 1;
+
+    float values[kBrickSamples];
+    ForEachBrick(region, [&](const DensityBrickCoord& coord,
+                             const int* brickMin, const int* low,
+                             const int* high) {
+        auto [iter, inserted] = mBricks.try_emplace(coord);
+        Brick& brick = iter->second;
+        if (inserted)
+            sampleBrick(coord, values);
+        else
+            decodeBrick(brick, values);
+
+        for (int z = low[2]; z <= high[2]; z++) {
+            for (int y = low[1]; y <= high[1]; y++) {
+                const float* source =
+                    samples +
+                    ((size_t)(z - region.minimum[2]) * sizeY +
+                     (y - region.minimum[1])) *
+                        sizeX +
+                    (low[0] - region.minimum[0]);
+                std::copy(source, source + (high[0] - low[0] + 1),
+                          values + BrickIndex(low[0] - brickMin[0],
+                                              y - brickMin[1],
+                                              z - brickMin[2]));
+            }
+        }
+
+        encodeBrick(values, brick);
+        brick.edited = true;
+        brick.epoch = mEpoch;
+    });
+}
+
+// ApplyBrush:
+// Building takes the larger of the density and the brush's, and digging the
+// smaller of the density and the negated brush's. Outside the brush, that
+// never moves a sample to the other side of the surface, so only the
+// samples in the brush's bounds are written. The bounds are padded by two
+// samples, for the edges the brush's surface crosses and the gradients at
+// their ends.
+DensityRegion DensityStore::applyBrush(const VolumeBrush& brush, int lod,
+                                       float densityPerUnit) {
+    const float spacing = mSpacing * float(1 << lod);
+    const AABB bounds = brush.getBounds();
+
+    DensityRegion region;
+    region.lod = lod;
+    for (int a = 0; a < 3; a++) {
+        region.minimum[a] = int(floorf(bounds.getMin()[a] / spacing)) - 2;
+        region.maximum[a] = int(ceilf(bounds.getMax()[a] / spacing)) + 2;
+    }
+
+    const size_t count = region.getSampleCount();
+    std::vector<float> values(count);
+    read(region, values.data());
+
+    std::vector<float> x(count), y(count), z(count), distances(count);
+    size_t index = 0;
+    for (int k = region.minimum[2]; k <= region.maximum[2]; k++) {
+        for (int j = region.minimum[1]; j <= region.maximum[1]; j++) {
+            for (int i = region.minimum[0]; i <= region.maximum[0]; i++) {
+                x[index] = float(i) * spacing;
+                y[index] = float(j) * spacing;
+                z[index] = float(k) * spacing;
+                index++;
+            }
+        }
+    }
+    brush.compile().evaluate(x.data(), y.data(), z.data(), distances.data(),
+                             count);
+
+    for (size_t i = 0; i < count; i++) {
+        const float density = -distances[i] * densityPerUnit;
+        if (brush.operation == VolumeBrush::Build)
+            values[i] = std::max(values[i], density);
+        else
+            values[i] = std::min(values[i], -density);
+    }
+
+    write(region, values.data());
+    return region;
+}
+
+// MayHaveSurface:
+// A sample is inside if it's above 0, as in MarchingCube. Bricks that
+// aren't stored could be anything.
+bool DensityStore::mayHaveSurface(const DensityRegion& region) const {
+    bool inside = false;
+    bool outside = false;
+    bool missing = false;
+
+    ForEachBrick(region, [&](const DensityBrickCoord& coord, const int*,
+                             const int*, const int*) {
+        const auto iter = mBricks.find(coord);
+        if (iter == mBricks.end()) {
+            missing = true;
+            return;
+        }
+        inside |= iter->second.maximum > 0;
+        outside |= iter->second.minimum <= 0;
+    });
+
+    return missing || (inside && outside);
+}
+
+float DensityStore::getSpacing() const { return mSpacing; }
+const DensityStore::Config& DensityStore::getConfig() const {
+    return mConfig;
+}
+
+DensityStore::Stats DensityStore::getStats() const {
+    Stats stats;
+    for (const auto& [coord, brick] : mBricks) {
+        stats.bricks[brick.encoding]++;
+        stats.editedBricks += brick.edited;
+        stats.bytes += sizeof(Brick) + brick.data.size() * sizeof(int16_t);
+    }
+    stats.denseBytes = mBricks.size() * kBrickSamples * sizeof(float);
+    return stats;
+}
+
+void DensityStore::sampleBrick(const DensityBrickCoord& coord,
+                               float* output) const {
+    const float spacing = mSpacing * float(1 << coord.lod);
+
+    float x[kBrickSamples], y[kBrickSamples], z[kBrickSamples];
+    for (int k = 0; k < kBrickSize; k++) {
+        for (int j = 0; j < kBrickSize; j++) {
+            for (int i = 0; i < kBrickSize; i++) {
+                const size_t index = BrickIndex(i, j, k);
+                x[index] = float(coord.x * kBrickSize + i) * spacing;
+                y[index] = float(coord.y * kBrickSize + j) * spacing;
+                z[index] = float(coord.z * kBrickSize + k) * spacing;
+            }
+        }
+    }
+
+    mDensity(x, y, z, output, kBrickSamples);
+}
+
+// EncodeBrick:
+// Picks the smallest encoding. Run-length pairs are (count, value), and a
+// run is at most kMaxQuantized long, which is more than a brick holds.
+void DensityStore::encodeBrick(const float* samples, Brick& brick) const {
+    int16_t values[kBrickSamples];
+    for (int i = 0; i < kBrickSamples; i++)
+        values[i] = quantize(samples[i]);
+
+    const auto [minimum, maximum] =
+        std::minmax_element(values, values + kBrickSamples);
+    brick.minimum = *minimum;
+    brick.maximum = *maximum;
+    brick.data.clear();
+
+    if (brick.minimum == brick.maximum) {
+        brick.encoding = Uniform;
+        brick.data.shrink_to_fit();
+        return;
+    }
+
+    int runs = 1;
+    for (int i = 1; i < kBrickSamples; i++)
+        runs += values[i] != values[i - 1];
+
+    if (runs * 2 < kBrickSamples) {
+        brick.encoding = RunLength;
+        brick.data.reserve(runs * 2);
+        int start = 0;
+        for (int i = 1; i <= kBrickSamples; i++) {
+            if (i == kBrickSamples || values[i] != values[start]) {
+                brick.data.push_back(int16_t(i - start));
+                brick.data.push_back(values[start]);
+                start = i;
+            }
+        }
+    } else {
+        brick.encoding = Dense;
+        brick.data.assign(values, values + kBrickSamples);
+    }
+    brick.data.shrink_to_fit();
+}
+
+void DensityStore::decodeBrick(const Brick& brick, float* output) const {
+    switch (brick.encoding) {
+    case Uniform:
+        std::fill(output, output + kBrickSamples, dequantize(brick.minimum));
+        break;
+
+    case RunLength: {
+        float* next = output;
+        for (size_t i = 0; i < brick.data.size(); i += 2) {
+            const float value = dequantize(brick.data[i + 1]);
+            next = std::fill_n(next, brick.data[i], value);
+        }
+        assert(next == output + kBrickSamples);
+    } break;
+
+    case Dense:
+        for (int i = 0; i < kBrickSamples; i++)
+            output[i] = dequantize(brick.data[i]);
+        break;
+
+    default:
+        assert(false);
+    }
+}
+
+// Quantize:
+// Rounds to the nearest step, except that densities just above 0 round up,
+// so no sample changes sides of the surface.
+int16_t DensityStore::quantize(float density) const {
+    const float scaled = density / mConfig.maxDensity * kMaxQuantized;
+    const long value = lroundf(
+        std::clamp(scaled, -float(kMaxQuantized), float(kMaxQuantized)));
+    return int16_t(density > 0 ? std::max(value, 1L) : value);
+}
+float DensityStore::dequantize(int16_t value) const {
+    return float(value) * (mConfig.maxDensity / kMaxQuantized);
+}
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "VolumeBrush.h"
+#include "VolumeMesher.h"
+
+namespace Engine {
+namespace Graphics {
+// DensityRegion Struct:
+// An inclusive box of density samples at some LOD. Sample (x,y,z) at LOD l
+// is at (x,y,z) * spacing * 2^l.
+struct DensityRegion {
+    int lod = 0;
+    int minimum[3];
+    int maximum[3];
+
+    // Samples a chunk's field reads, including its padding. With padding
+    // off, only the samples the surface is found from.
+    static DensityRegion Chunk(const VolumeChunkCoord& chunk, int cells,
+                               bool padding);
+
+    size_t getSampleCount() const;
+    // True if the regions are at the same LOD and share samples
+    bool overlaps(const DensityRegion& other) const;
+};
+
+// DensityBrickCoord Struct:
+// A brick of kBrickSize^3 samples at some LOD, in units of bricks.
+struct DensityBrickCoord {
+    int x;
+    int y;
+    int z;
+    int lod;
+
+    bool operator==(const DensityBrickCoord& other) const;
+};
+struct DensityBrickCoordHash {
+    size_t operator()(const DensityBrickCoord& coord) const;
+};
+
+// DensityStore Class:
+// A sparse cache of density samples, split into bricks. Bricks are sampled
+// from the density function the first time they are needed, and can be
+// overwritten by edits, which the density function knows nothing about.
+//
+// Samples are clamped to [-maxDensity, maxDensity] and quantized to 16
+// bits. Far from the surface, the clamp makes whole bricks a single value,
+// which is stored without any samples. The rest are run-length encoded when
+// that is smaller, which suits edited bricks, where runs of the clamped
+// value are long. Each brick remembers if it has samples inside and outside
+// the surface, so a chunk can be known to be empty without reading it.
+//
+// Reads can happen from many threads at once, but generate, write and
+// releaseUnused need the store to themselves.
+class DensityStore {
+  public:
+    static constexpr int kBrickSize = 8;
+    static constexpr int kBrickSamples = kBrickSize * kBrickSize * kBrickSize;
+
+    struct Config {
+        // Must be beyond the density of any sample the surface or its
+        // normals are found from
+        float maxDensity = 4.f;
+    };
+
+    enum BrickEncoding { Uniform = 0, RunLength, Dense, NumEncodings };
+
+    struct Stats {
+        size_t bricks[NumEncodings] = {};
+        size_t editedBricks = 0;
+        size_t bytes = 0;
+        // Bytes the bricks would take as floats
+        size_t denseBytes = 0;
+    };
+
+  private:
+    struct Brick {
+        BrickEncoding encoding = Uniform;
+        // Uniform value, or smallest and largest sample
+        int16_t minimum = 0;
+        int16_t maximum = 0;
+        // Samples for Dense, or (count, value) pairs for RunLength
+        std::vector<int16_t> data;
+
+        bool edited = false;
+        uint32_t epoch = 0;
+    };
+
+    float mSpacing;
+    Config mConfig;
+    DensityFunction mDensity;
+
+    std::unordered_map<DensityBrickCoord, Brick, DensityBrickCoordHash>
+        mBricks;
+    uint32_t mEpoch = 0;
+
+  public:
+    DensityStore(float spacing, const DensityFunction& density,
+                 const Config& config);
+
+    // Samples every missing brick the regions touch, in parallel, and marks
+    // the bricks the regions touch as used
+    void generate(const std::vector<DensityRegion>& regions);
+    // Removes the bricks that weren't used by the last generate, and
+    // weren't edited
+    void releaseUnused();
+
+    // Reads a region's samples, x fastest. Missing bricks are sampled from
+    // the density function, but not kept.
+    void read(const DensityRegion& region, float* output) const;
+    // Overwrites a region's samples, x fastest, and marks its bricks as
+    // edited
+    void write(const DensityRegion& region, const float* samples);
+    // Applies a brush to the samples of one LOD, and returns the region it
+    // wrote. Inside the brush, the density rises by densityPerUnit for each
+    // unit of depth.
+    DensityRegion applyBrush(const VolumeBrush& brush, int lod,
+                             float densityPerUnit);
+
+    // False if the region's samples are certainly all inside, or all
+    // outside. Only looks at whole bricks, so it can give false positives.
+    bool mayHaveSurface(const DensityRegion& region) const;
+
+    float getSpacing() const;
+    const Config& getConfig() const;
+    Stats getStats() const;
+
+  private:
+    void sampleBrick(const DensityBrickCoord& coord, float* output) const;
+    void encodeBrick(const float* samples, Brick& brick) const;
+    void decodeBrick(const Brick& brick, float* output) const;
+
+    int16_t quantize(float density) const;
+    float dequantize(int16_t value) const;
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,755 @@
+#include "Terrain3DManager.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "core/ThreadPool.h"
+#include "math/SDFGraph.h"
+#include "utility/Stopwatch.h"
+
+#include "rendering/VisualSystem.h"
+#include "rendering/resources/MaterialManager.h"
+#include "rendering/resources/MeshBuilder.h"
+#include "rendering/resources/ResourceManager.h"
+
+#include "rendering/ImGui.h"
+
+namespace Engine {
+namespace Graphics {
+Terrain3DManager::Terrain3DManager(VisualSystem* visualSystem)
+    : Terrain3DManager(visualSystem, Config()) {}
+Terrain3DManager::Terrain3DManager(VisualSystem* visualSystem,
+                                   const Config& config)
+    : mVisualSystem(visualSystem) {
+    setConfig(config);
+
+    mMaterial = visualSystem->getMaterialManager()->createMaterial(
+        MaterialManager::DefaultMaterialParams());
+
+    ImGuiHelper::registerImGuiCallback("Render/Terrain3D",
+                                       [this]() { imGui(); });
+}
+Terrain3DManager::~Terrain3DManager() { finish(); }
+
+void Terrain3DManager::update(const Vector3& cameraPosition) {
+    mFrame++;
+    mCamera = cameraPosition;
+
+    if (!mConfig.enabled) {
+        if (!mChunks.empty() || mHasNext)
+            clearChunks();
+        mPendingEdits.clear();
+        return;
+    }
+
+    if (mJob.valid() &&
+        mJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        completeJob();
+
+    // Edits go ahead of selecting chunks again, so the camera moving doesn't
+    // hold them up
+    if (!mJob.valid() && !mPendingEdits.empty())
+        applyEdits();
+
+    auto uploaded = [this](const ChunkMap& chunks) {
+        bool ready = mMaterial->ready();
+        for (const auto& [key, chunk] : chunks) {
+            if (chunk.mesh && !chunk.mesh->ready)
+                ready = false;
+        }
+        return ready;
+    };
+
+    if (!mEditedChunks.empty() && !mJob.valid() && uploaded(mEditedChunks))
+        swapEditedChunks();
+    if (mHasNext && !mJob.valid() && uploaded(mNextChunks))
+        swapChunks();
+
+    if (!mHasNext && mEditedChunks.empty() && !mJob.valid() &&
+        (!mSelected || (cameraPosition - mSelectCamera).magnitude() >=
+                           mConfig.reselectDistance))
+        selectChunks(cameraPosition);
+}
+
+void Terrain3DManager::finish() {
+    if (mJob.valid())
+        completeJob();
+}
+
+void Terrain3DManager::edit(const VolumeBrush& brush) {
+    if (mPendingEdits.empty())
+        mEditFrame = mFrame;
+    mPendingEdits.push_back(brush);
+}
+
+// GetDensityFunction:
+// Density is the distance below the surface in heightScale units, offset
+// by fractal noise in [-noiseStrength, noiseStrength]. Where the noise
+// outweighs the height, it carves caves below the surface and leaves
+// overhangs above it.
+DensityFunction Terrain3DManager::getDensityFunction() const {
+    const Config config = mConfig;
+    const std::shared_ptr<const Noise> noise = mNoise;
+
+    return [config, noise](const float* x, const float* y, const float* z,
+                           float* output, size_t count) {
+        std::vector<float> nx(count), ny(count), nz(count);
+        for (size_t i = 0; i < count; i++) {
+            nx[i] = x[i] * config.frequency;
+            ny[i] = y[i] * config.frequency;
+            nz[i] = z[i] * config.frequency;
+        }
+        noise->octaveNoise3D(nx.data(), ny.data(), nz.data(), output, count,
+                             config.octaves, config.persistence);
+
+        for (size_t i = 0; i < count; i++) {
+            const float height =
+                (config.surfaceHeight - y[i]) / config.heightScale;
+            output[i] = height + config.noiseStrength * (2 * output[i] - 1);
+        }
+    };
+}
+
+const Terrain3DManager::Config& Terrain3DManager::getConfig() const {
+    return mConfig;
+}
+void Terrain3DManager::setConfig(const Config& config) {
+    // The meshes no longer match the config, so every chunk is meshed again
+    finish();
+    clearChunks();
+
+    if (mNoise == nullptr || config.seed != mConfig.seed)
+        mNoise = Noise::Create(NoiseType::Perlin, config.seed);
+    mConfig = config;
+
+    const VolumeMesher::Config& mesher = mConfig.mesher;
+    mStore = std::make_unique<DensityStore>(
+        mesher.chunkSize / mesher.cellsPerChunk, getDensityFunction(),
+        mConfig.store);
+}
+
+// SelectChunks:
+// Chunks that are already meshed are kept, and the rest are meshed by a
+// job.
+void Terrain3DManager::selectChunks(const Vector3& cameraPosition) {
+    mSelectCamera = cameraPosition;
+    mSelected = true;
+
+    const VolumeLOD lod(mConfig.mesher.chunkSize, mConfig.lod);
+    std::vector<VolumeChunkKey> keys;
+    lod.selectChunks(cameraPosition, keys);
+
+    bool changed = keys.size() != mChunks.size();
+    mNextChunks.clear();
+    mJobChunks.clear();
+
+    for (const VolumeChunkKey& key : keys) {
+        if (auto iter = mChunks.find(key); iter != mChunks.end())
+            mNextChunks[key] = iter->second;
+        else {
+            mJobChunks.push_back(key);
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        mNextChunks.clear();
+        return;
+    }
+
+    mHasNext = true;
+    mJobSelection = std::move(keys);
+    if (!mJobChunks.empty())
+        startJob(true);
+}
+
+// StartJob:
+// Meshes mJobChunks in the background. When selecting, the job also
+// samples the selection into the store, and releases what it no longer
+// needs. Edits have already written the store.
+void Terrain3DManager::startJob(bool select) {
+    mJobResults.assign(mJobChunks.size(), Chunk());
+    mJobIsEdit = !select;
+
+    auto mesh = [this, select, config = mConfig.mesher]() {
+        Utility::Stopwatch stopwatch;
+
+        if (select) {
+            std::vector<DensityRegion> regions;
+            regions.reserve(mJobSelection.size());
+            for (const VolumeChunkKey& key : mJobSelection) {
+                regions.push_back(DensityRegion::Chunk(
+                    key.coord, config.cellsPerChunk, true));
+            }
+            mStore->generate(regions);
+        }
+
+        std::vector<VolumeMesh> meshes;
+        VolumeMesher::MeshChunks(config, mJobChunks, *mStore, meshes);
+        if (select)
+            mStore->releaseUnused();
+
+        ResourceManager* resourceManager =
+            mVisualSystem->getResourceManager();
+        MeshBuilder builder;
+        builder.addLayout(POSITION);
+        builder.addLayout(TEXTURE);
+        builder.addLayout(NORMAL);
+
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const VolumeMesh& mesh = meshes[i];
+            Chunk& chunk = mJobResults[i];
+            if (mesh.indices.empty())
+                continue;
+
+            builder.reset();
+            for (size_t v = 0; v < mesh.positions.size(); v++) {
+                MeshVertex vertex;
+                vertex.position = mesh.positions[v];
+                vertex.normal = mesh.normals[v];
+                builder.addVertex(vertex);
+                chunk.bounds.expandToContain(mesh.positions[v]);
+            }
+            for (size_t t = 0; t < mesh.indices.size(); t += 3)
+                builder.addTriangle(mesh.indices[t], mesh.indices[t + 1],
+                                    mesh.indices[t + 2]);
+
+            chunk.mesh = resourceManager->requestMesh(builder);
+            chunk.triangles = mesh.getTriangleCount();
+        }
+
+        mJobMs = float(stopwatch.Duration() * 1000.0);
+    };
+
+    ThreadPool* pool = ThreadPool::GetThreadPool();
+    if (pool != nullptr) {
+        mJob = pool->scheduleJob(mesh);
+    } else {
+        std::promise<void> done;
+        mesh();
+        done.set_value();
+        mJob = done.get_future();
+    }
+}
+
+void Terrain3DManager::completeJob() {
+    mJob.get();
+
+    ChunkMap& output = mJobIsEdit ? mEditedChunks : mNextChunks;
+    for (size_t i = 0; i < mJobChunks.size(); i++)
+        output[mJobChunks[i]] = mJobResults[i];
+    if (mJobIsEdit)
+        mEditStats.ms = mJobMs;
+    mJobChunks.clear();
+    mJobResults.clear();
+    mStoreStats = mStore->getStats();
+}
+
+// SwapChunks:
+// Draws the next selection in place of the current one. Chunks in both
+// keep their draw blocks.
+void Terrain3DManager::swapChunks() {
+    RenderManager* renderManager = mVisualSystem->getRenderManager();
+
+    for (auto& [key, chunk] : mChunks) {
+        if (chunk.block != kInvalidDrawBlockKey && !mNextChunks.contains(key))
+            renderManager->removeDrawBlock(chunk.block);
+    }
+
+    for (auto& [key, chunk] : mNextChunks) {
+        if (chunk.mesh && chunk.block == kInvalidDrawBlockKey) {
+            DrawBlock drawBlock;
+            drawBlock.initialize(chunk.bounds, chunk.mesh.get(),
+                                 mMaterial.get());
+            chunk.block = renderManager->addDrawBlock(drawBlock);
+            renderManager->updateInstanceData(chunk.block, InstanceData());
+        }
+    }
+
+    mChunks = std::move(mNextChunks);
+    mNextChunks.clear();
+    mHasNext = false;
+}
+
+// ApplyEdits:
+// Writes the edits to every LOD of the store, then remeshes the chunks,
+// drawn or next, whose samples they touched.
+void Terrain3DManager::applyEdits() {
+    const int cells = mConfig.mesher.cellsPerChunk;
+    const float densityPerUnit = 1.f / mConfig.heightScale;
+
+    std::vector<DensityRegion> regions;
+    mEditStats = EditStats();
+    mEditStats.frame = mEditFrame;
+    for (const VolumeBrush& brush : mPendingEdits) {
+        for (int lod = 0; lod <= VolumeLOD::kMaxLOD; lod++) {
+            regions.push_back(mStore->applyBrush(brush, lod, densityPerUnit));
+            mEditStats.samples += regions.back().getSampleCount();
+        }
+    }
+    mPendingEdits.clear();
+
+    auto touched = [&](const VolumeChunkKey& key) {
+        const DensityRegion chunk =
+            DensityRegion::Chunk(key.coord, cells, true);
+        for (const DensityRegion& region : regions) {
+            if (region.overlaps(chunk))
+                return true;
+        }
+        return false;
+    };
+
+    mJobChunks.clear();
+    for (const auto& [key, chunk] : mChunks) {
+        if (touched(key))
+            mJobChunks.push_back(key);
+    }
+    for (const auto& [key, chunk] : mNextChunks) {
+        if (!mChunks.contains(key) && touched(key))
+            mJobChunks.push_back(key);
+    }
+
+    mEditStats.chunks = mJobChunks.size();
+    if (!mJobChunks.empty())
+        startJob(false);
+}
+
+// SwapEditedChunks:
+// Replaces chunks with their edited meshes. A chunk that is drawn and also
+// in the next selection shares its draw block, so both get the new one.
+void Terrain3DManager::swapEditedChunks() {
+    RenderManager* renderManager = mVisualSystem->getRenderManager();
+
+    for (auto& [key, edited] : mEditedChunks) {
+        const auto drawn = mChunks.find(key);
+        if (drawn != mChunks.end()) {
+            if (drawn->second.block != kInvalidDrawBlockKey)
+                renderManager->removeDrawBlock(drawn->second.block);
+
+            if (edited.mesh) {
+                DrawBlock drawBlock;
+                drawBlock.initialize(edited.bounds, edited.mesh.get(),
+                                     mMaterial.get());
+                edited.block = renderManager->addDrawBlock(drawBlock);
+                renderManager->updateInstanceData(edited.block,
+                                                  InstanceData());
+            }
+            drawn->second = edited;
+        }
+
+        const auto next = mNextChunks.find(key);
+        if (next != mNextChunks.end())
+            next->second = edited;
+    }
+
+    mEditedChunks.clear();
+    mEditStats.frames = int(mFrame - mEditStats.frame);
+}
+
+void Terrain3DManager::clearChunks() {
+    finish();
+
+    RenderManager* renderManager = mVisualSystem->getRenderManager();
+    for (auto& [key, chunk] : mChunks) {
+        if (chunk.block != kInvalidDrawBlockKey)
+            renderManager->removeDrawBlock(chunk.block);
+    }
+
+    mChunks.clear();
+    mNextChunks.clear();
+    mEditedChunks.clear();
+    mHasNext = false;
+    mSelected = false;
+}
+
+// RunMeshingBenchmark:
+// Meshes a slab of chunks around the surface on this thread, then in
+// parallel on the thread pool.
+void Terrain3DManager::runMeshingBenchmark() {
+    constexpr int kExtent = 4;
+
+    std::vector<VolumeChunkKey> chunks;
+    for (int x = -kExtent; x < kExtent; x++) {
+        for (int y = -1; y < 1; y++) {
+            for (int z = -kExtent; z < kExtent; z++)
+                chunks.push_back({{x, y, z}});
+        }
+    }
+
+    VolumeMesher::Config config = mConfig.mesher;
+    config.cellsPerChunk = mBenchmark.cells;
+    const DensityFunction density = getDensityFunction();
+
+    mBenchmark.chunks = chunks.size();
+    mBenchmark.results[0] = {"Serial"};
+    mBenchmark.results[1] = {"Parallel"};
+
+    std::vector<VolumeMesh> meshes(chunks.size());
+    Utility::Stopwatch stopwatch;
+
+    VolumeMesher mesher(config);
+    stopwatch.Reset();
+    for (size_t i = 0; i < chunks.size(); i++)
+        mesher.meshChunk(chunks[i], density, meshes[i]);
+    mBenchmark.results[0].ms = stopwatch.Duration() * 1000.0;
+
+    for (const VolumeMesh& mesh : meshes) {
+        mBenchmark.results[0].triangles += mesh.getTriangleCount();
+        mBenchmark.results[0].vertices += mesh.positions.size();
+    }
+
+    stopwatch.Reset();
+    VolumeMesher::MeshChunks(config, chunks, density, meshes);
+    mBenchmark.results[1].ms = stopwatch.Duration() * 1000.0;
+
+    for (const VolumeMesh& mesh : meshes) {
+        mBenchmark.results[1].triangles += mesh.getTriangleCount();
+        mBenchmark.results[1].vertices += mesh.positions.size();
+    }
+}
+
+// RunLODBenchmark:
+// Meshes the 2x2x2 roots around the origin twice, in parallel: every chunk
+// at full resolution, then the chunks selected for a camera on the surface
+// at the origin.
+void Terrain3DManager::runLODBenchmark() {
+    const VolumeMesher::Config& config = mConfig.mesher;
+    const DensityFunction density = getDensityFunction();
+
+    std::vector<VolumeChunkKey> chunks[2];
+    constexpr int kFullExtent = 1 << VolumeLOD::kMaxLOD;
+    for (int x = -kFullExtent; x < kFullExtent; x++) {
+        for (int y = -kFullExtent; y < kFullExtent; y++) {
+            for (int z = -kFullExtent; z < kFullExtent; z++)
+                chunks[0].push_back({{x, y, z}});
+        }
+    }
+    selectBenchmarkChunks(chunks[1]);
+
+    mLODBenchmark.results[0] = {"Full Resolution"};
+    mLODBenchmark.results[1] = {"LOD"};
+    mLODBenchmark.ran = true;
+
+    for (int i = 0; i < 2; i++) {
+        LODBenchmark::Result& result = mLODBenchmark.results[i];
+        std::vector<VolumeMesh> meshes;
+
+        Utility::Stopwatch stopwatch;
+        VolumeMesher::MeshChunks(config, chunks[i], density, meshes);
+        result.ms = stopwatch.Duration() * 1000.0;
+
+        result.chunks = chunks[i].size();
+        for (const VolumeMesh& mesh : meshes)
+            result.triangles += mesh.getTriangleCount();
+    }
+}
+
+// RunStoreBenchmark:
+// Meshes the LOD benchmark's selection straight from the density function,
+// then from a new store twice: first sampling the density into it, and
+// then reading the samples it kept.
+void Terrain3DManager::runStoreBenchmark() {
+    const VolumeMesher::Config& config = mConfig.mesher;
+    const DensityFunction density = getDensityFunction();
+
+    std::vector<VolumeChunkKey> chunks;
+    selectBenchmarkChunks(chunks);
+
+    std::vector<DensityRegion> regions;
+    for (const VolumeChunkKey& key : chunks) {
+        regions.push_back(
+            DensityRegion::Chunk(key.coord, config.cellsPerChunk, true));
+    }
+    DensityStore store(config.chunkSize / config.cellsPerChunk, density,
+                       mConfig.store);
+
+    mStoreBenchmark.results[0] = {"Density Function"};
+    mStoreBenchmark.results[1] = {"Store, Sampled"};
+    mStoreBenchmark.results[2] = {"Store, Kept"};
+
+    for (int i = 0; i < 3; i++) {
+        StoreBenchmark::Result& result = mStoreBenchmark.results[i];
+        std::vector<VolumeMesh> meshes;
+
+        Utility::Stopwatch stopwatch;
+        if (i == 0)
+            VolumeMesher::MeshChunks(config, chunks, density, meshes);
+        else {
+            if (i == 1)
+                store.generate(regions);
+            VolumeMesher::MeshChunks(config, chunks, store, meshes);
+        }
+        result.ms = stopwatch.Duration() * 1000.0;
+
+        for (const VolumeMesh& mesh : meshes)
+            result.triangles += mesh.getTriangleCount();
+    }
+
+    mStoreBenchmark.chunks = chunks.size();
+    mStoreBenchmark.skippedChunks = 0;
+    for (const VolumeChunkKey& key : chunks) {
+        const DensityRegion region =
+            DensityRegion::Chunk(key.coord, config.cellsPerChunk, false);
+        mStoreBenchmark.skippedChunks += !store.mayHaveSurface(region);
+    }
+    mStoreBenchmark.stats = store.getStats();
+    mStoreBenchmark.ran = true;
+}
+
+// RunSDFBenchmark:
+// Samples a CSG model on a 64^3 grid, walking its SDFGraph per point, then
+// with its compiled SDFProgram.
+void Terrain3DManager::runSDFBenchmark() {
+    SDFGraph graph;
+    const SDFGraph::Node body = graph.smoothUnite(
+        graph.translate(graph.sphere(3.f), Vector3(1, 2, 0)),
+        graph.rotate(graph.box(Vector3(2, 1, 3)),
+                     Quaternion::RotationAroundAxis(Vector3(1, 1, 0).unit(),
+                                                    0.7f)),
+        1.5f);
+    const SDFGraph::Node drilled =
+        graph.smoothSubtract(body, graph.cylinder(1.f, 5.f), 0.7f);
+    const SDFGraph::Node ring = graph.scale(
+        graph.translate(graph.torus(3.f, 0.5f), Vector3(0, -2, 0)), 1.5f);
+    const SDFGraph::Node cut = graph.subtract(
+        graph.unite(drilled, ring),
+        graph.capsule(Vector3(-4, 0, 0), Vector3(4, 1, 1), 0.8f));
+    const SDFGraph::Node root = graph.smoothIntersect(
+        cut, graph.plane(Vector3(0, 1, 0.2f), -3.f), 1.f);
+
+    constexpr int kSide = 64;
+    const size_t count = (size_t)kSide * kSide * kSide;
+    std::vector<float> x(count), y(count), z(count);
+    std::vector<float> tree(count), program(count);
+    size_t index = 0;
+    for (int k = 0; k < kSide; k++) {
+        for (int j = 0; j < kSide; j++) {
+            for (int i = 0; i < kSide; i++) {
+                x[index] = (i - kSide / 2) * 0.25f;
+                y[index] = (j - kSide / 2) * 0.25f;
+                z[index] = (k - kSide / 2) * 0.25f;
+                index++;
+            }
+        }
+    }
+
+    Utility::Stopwatch stopwatch;
+    for (size_t i = 0; i < count; i++)
+        tree[i] = graph.evaluate(root, Vector3(x[i], y[i], z[i]));
+    mSDFBenchmark.treeMs = stopwatch.Duration() * 1000.0;
+
+    stopwatch.Reset();
+    const SDFProgram compiled(graph, root);
+    compiled.evaluate(x.data(), y.data(), z.data(), program.data(), count);
+    mSDFBenchmark.programMs = stopwatch.Duration() * 1000.0;
+
+    mSDFBenchmark.maxError = 0.f;
+    for (size_t i = 0; i < count; i++) {
+        mSDFBenchmark.maxError =
+            std::max(mSDFBenchmark.maxError, fabsf(tree[i] - program[i]));
+    }
+    mSDFBenchmark.points = count;
+    mSDFBenchmark.nodes = graph.size();
+    mSDFBenchmark.instructions = compiled.getInstructionCount();
+    mSDFBenchmark.ran = true;
+}
+
+// SelectBenchmarkChunks:
+// The chunks of the 2x2x2 roots around the origin, selected for a camera
+// on the surface at the origin.
+void Terrain3DManager::selectBenchmarkChunks(
+    std::vector<VolumeChunkKey>& output) const {
+    VolumeLOD::Config lodConfig = mConfig.lod;
+    lodConfig.rootExtent = 1;
+    lodConfig.rootMinY = -1;
+    lodConfig.rootMaxY = 1;
+
+    const VolumeLOD lod(mConfig.mesher.chunkSize, lodConfig);
+    lod.selectChunks(Vector3(0, mConfig.surfaceHeight, 0), output);
+}
+
+void Terrain3DManager::imGui() {
+#if defined(IMGUI_ENABLED)
+    Config config = mConfig;
+    bool changed = false;
+
+    changed |= ImGui::SliderFloat("Surface Height", &config.surfaceHeight,
+                                  -200.f, 200.f);
+    changed |= ImGui::SliderFloat("Height Scale", &config.heightScale, 1.f,
+                                  200.f);
+    changed |=
+        ImGui::SliderFloat("Frequency", &config.frequency, 0.001f, 0.05f);
+    changed |= ImGui::SliderInt("Octaves", &config.octaves, 1, 8);
+    changed |=
+        ImGui::SliderFloat("Persistence", &config.persistence, 0.f, 1.f);
+    changed |= ImGui::SliderFloat("Noise Strength", &config.noiseStrength,
+                                  0.f, 4.f);
+    changed |= ImGui::Checkbox("Enabled", &config.enabled);
+    changed |= ImGui::SliderFloat("LOD Distance", &config.lod.lodDistance,
+                                  VolumeLOD::kMinLODDistance, 8.f);
+    if (changed)
+        setConfig(config);
+
+    size_t triangles = 0;
+    for (const auto& [key, chunk] : mChunks)
+        triangles += chunk.triangles;
+    ImGui::Text("# Chunks: %zu (%zu triangles)", mChunks.size(), triangles);
+    ImGui::Text("Meshing: %s (last job %.2f ms)",
+                mJob.valid() ? "running" : mHasNext ? "uploading" : "idle",
+                mJobMs);
+
+    if (ImGui::CollapsingHeader("LOD Benchmark")) {
+        if (ImGui::Button("Benchmark LOD"))
+            runLODBenchmark();
+
+        if (mLODBenchmark.ran && ImGui::BeginTable("LOD", 4)) {
+            ImGui::TableSetupColumn("Chunks");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableSetupColumn("ms");
+            ImGui::TableHeadersRow();
+
+            for (const LODBenchmark::Result& result : mLODBenchmark.results) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", result.name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%zu", result.chunks);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%zu", result.triangles);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.2f", result.ms);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Edit")) {
+        ImGui::Combo("Shape", (int*)&mBrush.shape, "Sphere\0Box\0Capsule\0");
+        ImGui::SliderFloat("Radius", &mBrush.radius, 1.f, 100.f);
+        ImGui::SliderFloat3("Half Extents", &mBrush.halfExtents.x, 1.f,
+                            100.f);
+        ImGui::SliderFloat3("Capsule Axis", &mBrush.axis.x, -100.f, 100.f);
+        ImGui::SliderFloat3("Camera Offset", &mBrushOffset.x, -200.f, 200.f);
+
+        VolumeBrush brush = mBrush;
+        brush.center = mCamera + mBrushOffset;
+        if (ImGui::Button("Dig")) {
+            brush.operation = VolumeBrush::Dig;
+            edit(brush);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Build")) {
+            brush.operation = VolumeBrush::Build;
+            edit(brush);
+        }
+
+        ImGui::Text("Last Edit: %zu samples, %zu chunks remeshed in %.2f ms",
+                    mEditStats.samples, mEditStats.chunks, mEditStats.ms);
+        if (mEditStats.frames >= 0)
+            ImGui::Text("Drawn after %d frames", mEditStats.frames);
+    }
+
+    if (ImGui::CollapsingHeader("Density Store")) {
+        const DensityStore::Stats& stats = mStoreStats;
+        ImGui::Text("Bricks: %zu uniform, %zu run-length, %zu dense",
+                    stats.bricks[DensityStore::Uniform],
+                    stats.bricks[DensityStore::RunLength],
+                    stats.bricks[DensityStore::Dense]);
+        ImGui::Text("Memory: %.1f KB (%.1f KB as floats)",
+                    stats.bytes / 1024.0, stats.denseBytes / 1024.0);
+
+        if (ImGui::Button("Benchmark Store"))
+            runStoreBenchmark();
+
+        if (mStoreBenchmark.ran) {
+            const DensityStore::Stats& benchmarkStats = mStoreBenchmark.stats;
+            ImGui::Text("Chunks skipped as empty: %zu / %zu",
+                        mStoreBenchmark.skippedChunks, mStoreBenchmark.chunks);
+            ImGui::Text("Store Memory: %.1f KB (%.1f KB as floats)",
+                        benchmarkStats.bytes / 1024.0,
+                        benchmarkStats.denseBytes / 1024.0);
+        }
+
+        if (mStoreBenchmark.ran && ImGui::BeginTable("Store", 3)) {
+            ImGui::TableSetupColumn("Meshing");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableSetupColumn("ms");
+            ImGui::TableHeadersRow();
+
+            for (const StoreBenchmark::Result& result :
+                 mStoreBenchmark.results) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", result.name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%zu", result.triangles);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f", result.ms);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    if (ImGui::CollapsingHeader("SDF Benchmark")) {
+        if (ImGui::Button("Benchmark SDF"))
+            runSDFBenchmark();
+
+        if (mSDFBenchmark.ran) {
+            const double points = double(mSDFBenchmark.points);
+            ImGui::Text("%zu nodes, compiled to %zu instructions",
+                        mSDFBenchmark.nodes, mSDFBenchmark.instructions);
+            ImGui::Text("Tree: %.2f ms (%.1f M points / s)",
+                        mSDFBenchmark.treeMs,
+                        points / mSDFBenchmark.treeMs / 1000.0);
+            ImGui::Text("Program: %.2f ms (%.1f M points / s)",
+                        mSDFBenchmark.programMs,
+                        points / mSDFBenchmark.programMs / 1000.0);
+            ImGui::Text("Max Difference: %g", mSDFBenchmark.maxError);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Meshing Benchmark")) {
+        ImGui::SliderInt("Cells / Chunk", &mBenchmark.cells, 4, 64);
+        if (ImGui::Button("Benchmark Meshing"))
+            runMeshingBenchmark();
+
+        if (mBenchmark.chunks > 0 && ImGui::BeginTable("Meshing", 5)) {
+            ImGui::TableSetupColumn("Meshing");
+            ImGui::TableSetupColumn("ms");
+            ImGui::TableSetupColumn("Chunks / s");
+            ImGui::TableSetupColumn("Triangles / s");
+            ImGui::TableSetupColumn("Vertices / Triangle");
+            ImGui::TableHeadersRow();
+
+            for (const MeshingBenchmark::Result& result : mBenchmark.results) {
+                const double seconds = result.ms / 1000.0;
+
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", result.name);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.2f", result.ms);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.0f", mBenchmark.chunks / seconds);
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.0f", result.triangles / seconds);
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%.2f",
+                            double(result.vertices) /
+                                std::max(result.triangles, size_t(1)));
+            }
+
+            ImGui::EndTable();
+        }
+    }
+#endif
+}
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "math/AABB.h"
+#include "math/Noise.h"
+#include "math/Vector3.h"
+
+#include "rendering/pipeline/RenderManager.h"
+
+#include "DensityStore.h"
+#include "VolumeLOD.h"
+#include "VolumeMesher.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+class VisualSystem;
+
+// Terrain3DManager Class:
+// Volumetric terrain, which can have caves and overhangs that a heightmap
+// can't. The terrain's density is the height above a base surface, offset
+// by 3D noise, and is meshed in chunks with marching cubes. Chunks get
+// coarser with distance from the camera, and are meshed in the background
+// from a sparse store of the density, which keeps the samples around the
+// selected chunks, and any edits made to them.
+class Terrain3DManager {
+  public:
+    struct Config {
+        // Off by default, as it overlaps the heightmap terrain
+        bool enabled = false;
+
+        VolumeMesher::Config mesher;
+        VolumeLOD::Config lod;
+        DensityStore::Config store;
+        // How far the camera moves before the chunks are selected again
+        float reselectDistance = 10.f;
+
+        unsigned int seed = 0;
+        // Height of the surface, before the noise offsets it
+        float surfaceHeight = 0.f;
+        // Units above the surface where density falls by 1
+        float heightScale = 40.f;
+        float frequency = 1.f / 150.f;
+        int octaves = 4;
+        float persistence = 0.5f;
+        // Density added at noise 1, and removed at noise 0
+        float noiseStrength = 1.f;
+    };
+
+  private:
+    VisualSystem* mVisualSystem;
+    Config mConfig;
+    std::shared_ptr<const Noise> mNoise;
+    std::unique_ptr<DensityStore> mStore;
+    std::shared_ptr<Material> mMaterial;
+
+    struct Chunk {
+        std::shared_ptr<Mesh> mesh;
+        AABB bounds;
+        size_t triangles = 0;
+        DrawBlockKey block = kInvalidDrawBlockKey;
+    };
+    using ChunkMap = std::unordered_map<VolumeChunkKey, Chunk,
+                                        VolumeChunkKeyHash>;
+
+    // Chunks being drawn, and the next selection. The next selection
+    // replaces the drawn chunks all at once, when every one of its meshes is
+    // uploaded, so that chunks of different selections never meet.
+    ChunkMap mChunks;
+    ChunkMap mNextChunks;
+    bool mHasNext = false;
+
+    Vector3 mSelectCamera;
+    bool mSelected = false;
+
+    // Edits waiting for the store, and the remeshed chunks waiting to be
+    // uploaded. Edited chunks replace the old ones wherever they are.
+    std::vector<VolumeBrush> mPendingEdits;
+    ChunkMap mEditedChunks;
+    uint64_t mFrame = 0;
+    uint64_t mEditFrame = 0;
+    Vector3 mCamera;
+
+    // Meshing Job. Only the job touches the store and mJobResults while it
+    // runs. The store keeps the samples of every selected chunk, and meshes
+    // the new ones.
+    std::future<void> mJob;
+    bool mJobIsEdit = false;
+    std::vector<VolumeChunkKey> mJobSelection;
+    std::vector<VolumeChunkKey> mJobChunks;
+    std::vector<Chunk> mJobResults;
+    float mJobMs = 0.f;
+    DensityStore::Stats mStoreStats;
+
+    struct EditStats {
+        size_t samples = 0;
+        size_t chunks = 0;
+        float ms = 0.f;
+        uint64_t frame = 0;
+        // Frames from the edit to it being drawn
+        int frames = -1;
+    } mEditStats;
+    VolumeBrush mBrush;
+    Vector3 mBrushOffset = Vector3(0, -20, 0);
+
+    struct MeshingBenchmark {
+        struct Result {
+            const char* name;
+            double ms = 0;
+            size_t triangles = 0;
+            size_t vertices = 0;
+        };
+
+        int cells = 16;
+        size_t chunks = 0;
+        Result results[2];
+    } mBenchmark;
+
+    struct LODBenchmark {
+        struct Result {
+            const char* name;
+            double ms = 0;
+            size_t chunks = 0;
+            size_t triangles = 0;
+        };
+
+        bool ran = false;
+        Result results[2];
+    } mLODBenchmark;
+
+    struct StoreBenchmark {
+        struct Result {
+            const char* name;
+            double ms = 0;
+            size_t triangles = 0;
+        };
+
+        bool ran = false;
+        size_t chunks = 0;
+        size_t skippedChunks = 0;
+        DensityStore::Stats stats;
+        Result results[3];
+    } mStoreBenchmark;
+
+    struct SDFBenchmark {
+        bool ran = false;
+        size_t points = 0;
+        size_t nodes = 0;
+        size_t instructions = 0;
+        double treeMs = 0;
+        double programMs = 0;
+        float maxError = 0.f;
+    } mSDFBenchmark;
+
+  public:
+    Terrain3DManager(VisualSystem* visualSystem);
+    Terrain3DManager(VisualSystem* visualSystem, const Config& config);
+    ~Terrain3DManager();
+
+    // Selects chunks around the camera, meshes the new ones in the
+    // background, and draws the latest selection that is ready.
+    void update(const Vector3& cameraPosition);
+    // Waits for the meshing job, if any
+    void finish();
+
+    // Queues an edit. It's written to the density store once no job is
+    // using it, and the chunks it touches are remeshed in the background.
+    // Edits only live in the store, so changing the config drops them.
+    void edit(const VolumeBrush& brush);
+
+    // Samples the terrain's density in bulk, with the current config. Can be
+    // called from any thread, and keeps working after the config changes.
+    DensityFunction getDensityFunction() const;
+
+    const Config& getConfig() const;
+    void setConfig(const Config& config);
+
+    void imGui();
+
+  private:
+    void selectChunks(const Vector3& cameraPosition);
+    void startJob(bool select);
+    void completeJob();
+    void swapChunks();
+    void applyEdits();
+    void swapEditedChunks();
+    void clearChunks();
+
+    void runMeshingBenchmark();
+    void runLODBenchmark();
+    void runStoreBenchmark();
+    void runSDFBenchmark();
+    void selectBenchmarkChunks(std::vector<VolumeChunkKey>& output) const;
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,68 @@
+#include "VolumeBrush.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include "math/SDF.h"
+
+namespace Engine {
+namespace Graphics {
+float VolumeBrush::distance(const Vector3& point) const {
+    switch (shape) {
+    case Sphere:
+        return SDFSphere(point - center, radius);
+    case Box:
+        return SDFBox(point - center, halfExtents);
+    case Capsule:
+        return SDFCapsule(point, center - axis, center + axis, radius);
+    default:
+        assert(false);
+        return 0.f;
+    }
+}
+
+SDFProgram VolumeBrush::compile() const {
+    SDFGraph graph;
+    SDFGraph::Node shapeNode;
+    switch (shape) {
+    case Sphere:
+        shapeNode = graph.translate(graph.sphere(radius), center);
+        break;
+    case Box:
+        shapeNode = graph.translate(graph.box(halfExtents), center);
+        break;
+    case Capsule:
+        shapeNode = graph.capsule(center - axis, center + axis, radius);
+        break;
+    default:
+        assert(false);
+        shapeNode = graph.sphere(radius);
+    }
+    return SDFProgram(graph, shapeNode);
+}
+
+AABB VolumeBrush::getBounds() const {
+    Vector3 extent;
+    switch (shape) {
+    case Sphere:
+        extent = Vector3(radius, radius, radius);
+        break;
+    case Box:
+        extent = halfExtents;
+        break;
+    case Capsule:
+        extent = Vector3(fabsf(axis.x), fabsf(axis.y), fabsf(axis.z)) +
+                 Vector3(radius, radius, radius);
+        break;
+    default:
+        assert(false);
+    }
+
+    AABB bounds;
+    bounds.expandToContain(center - extent);
+    bounds.expandToContain(center + extent);
+    return bounds;
+}
+
+} // namespace Graphics
+} // namespace Engine
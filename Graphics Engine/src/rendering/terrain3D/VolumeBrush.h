@@ -0,0 +1,36 @@
+#pragma once
+
+#include "math/AABB.h"
+#include "math/SDFGraph.h"
+#include "math/Vector3.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+// VolumeBrush Struct:
+// A shape that edits volumetric terrain, by building the shape up, or by
+// digging it out.
+struct VolumeBrush {
+    enum Shape { Sphere = 0, Box, Capsule };
+    enum Operation { Build = 0, Dig };
+
+    Shape shape = Sphere;
+    Operation operation = Dig;
+
+    Vector3 center;
+    // Sphere and capsule radius
+    float radius = 10.f;
+    // Box, from the center to the faces
+    Vector3 halfExtents = Vector3(10, 10, 10);
+    // Capsule, from the center to the end of its segment
+    Vector3 axis = Vector3(0, 10, 0);
+
+    // Signed distance from the surface of the shape, negative inside
+    float distance(const Vector3& point) const;
+    // The same distance, compiled for evaluating many points
+    SDFProgram compile() const;
+    AABB getBounds() const;
+};
+
+} // namespace Graphics
+} // namespace Engine
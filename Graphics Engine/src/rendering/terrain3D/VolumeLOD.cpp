@@ -0,0 +1,129 @@
+#include "VolumeLOD.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+
+namespace Engine {
+namespace Graphics {
+VolumeLOD::VolumeLOD(float chunkSize, const Config& config)
+    : mConfig(config), mChunkSize(chunkSize) {
+    mConfig.lodDistance = std::max(mConfig.lodDistance, kMinLODDistance);
+}
+
+void VolumeLOD::selectChunks(const Vector3& camera,
+                             std::vector<VolumeChunkKey>& output) const {
+    output.clear();
+
+    for (int x = -mConfig.rootExtent; x < mConfig.rootExtent; x++) {
+        for (int y = mConfig.rootMinY; y < mConfig.rootMaxY; y++) {
+            for (int z = -mConfig.rootExtent; z < mConfig.rootExtent; z++)
+                selectRecursive(camera, {x, y, z, kMaxLOD}, output);
+        }
+    }
+
+    for (VolumeChunkKey& chunk : output)
+        chunk.coarser = findCoarserNeighbors(camera, chunk.coord);
+}
+
+int VolumeLOD::lodAt(const Vector3& camera, const Vector3& point) const {
+    const float rootWidth = chunkWidth(kMaxLOD);
+    VolumeChunkCoord node = {int(floorf(point.x / rootWidth)),
+                             int(floorf(point.y / rootWidth)),
+                             int(floorf(point.z / rootWidth)), kMaxLOD};
+
+    if (node.x < -mConfig.rootExtent || node.x >= mConfig.rootExtent ||
+        node.y < mConfig.rootMinY || node.y >= mConfig.rootMaxY ||
+        node.z < -mConfig.rootExtent || node.z >= mConfig.rootExtent)
+        return -1;
+
+    while (shouldDivide(camera, node)) {
+        const float childWidth = chunkWidth(node.lod - 1);
+        node = {int(floorf(point.x / childWidth)),
+                int(floorf(point.y / childWidth)),
+                int(floorf(point.z / childWidth)), node.lod - 1};
+    }
+    return node.lod;
+}
+
+const VolumeLOD::Config& VolumeLOD::getConfig() const { return mConfig; }
+
+void VolumeLOD::selectRecursive(const Vector3& camera,
+                                const VolumeChunkCoord& node,
+                                std::vector<VolumeChunkKey>& output) const {
+    if (!shouldDivide(camera, node)) {
+        output.push_back({node, 0});
+        return;
+    }
+
+    for (int child = 0; child < 8; child++) {
+        const VolumeChunkCoord coord = {
+            node.x * 2 + (child & 1), node.y * 2 + (child >> 1 & 1),
+            node.z * 2 + (child >> 2 & 1), node.lod - 1};
+        selectRecursive(camera, coord, output);
+    }
+}
+
+// FindCoarserNeighbors:
+// Probes a point a quarter chunk past each face and edge of the chunk. A
+// coarser neighbor covers the whole face or edge, so it contains the point.
+uint32_t VolumeLOD::findCoarserNeighbors(const Vector3& camera,
+                                         const VolumeChunkCoord& chunk) const {
+    const float width = chunkWidth(chunk.lod);
+    const Vector3 center =
+        (Vector3(float(chunk.x), float(chunk.y), float(chunk.z)) +
+         Vector3(0.5f, 0.5f, 0.5f)) *
+        width;
+
+    uint32_t coarser = 0;
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dz = -1; dz <= 1; dz++) {
+                // Corners are samples of both grids, so they always match
+                const int numAxes = (dx != 0) + (dy != 0) + (dz != 0);
+                if (numAxes == 0 || numAxes == 3)
+                    continue;
+
+                const Vector3 probe =
+                    center + Vector3(float(dx), float(dy), float(dz)) *
+                                 (width * 0.75f);
+                const int lod = lodAt(camera, probe);
+                assert(lod <= chunk.lod + 1);
+                if (lod > chunk.lod)
+                    coarser |= VolumeNeighborBit(dx, dy, dz);
+            }
+        }
+    }
+    return coarser;
+}
+
+// ShouldDivide:
+// Compares the camera's distance to the node's box with its width.
+bool VolumeLOD::shouldDivide(const Vector3& camera,
+                             const VolumeChunkCoord& node) const {
+    if (node.lod == 0)
+        return false;
+
+    const float width = chunkWidth(node.lod);
+    const Vector3 minimum =
+        Vector3(float(node.x), float(node.y), float(node.z)) * width;
+
+    float distanceSquared = 0.f;
+    for (int a = 0; a < 3; a++) {
+        const float offset =
+            std::max({minimum[a] - camera[a], camera[a] - minimum[a] - width,
+                      0.f});
+        distanceSquared += offset * offset;
+    }
+
+    const float divideDistance = mConfig.lodDistance * width;
+    return distanceSquared < divideDistance * divideDistance;
+}
+
+float VolumeLOD::chunkWidth(int lod) const {
+    return mChunkSize * float(1 << lod);
+}
+
+} // namespace Graphics
+} // namespace Engine
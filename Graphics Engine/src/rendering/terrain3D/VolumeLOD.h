@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "math/Vector3.h"
+
+#include "VolumeMesher.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+// VolumeLOD Class:
+// Chooses the chunks volumetric terrain is meshed with. The terrain is a
+// grid of root chunks at the coarsest LOD, and each is an octree. A node
+// divides while the camera is within lodDistance node widths of it, so
+// chunks get coarser with distance, and each LOD meshes its chunks at half
+// the resolution of the last.
+// Because a node's divide distance grows with its size, neighboring
+// chunks are never more than 1 LOD apart, which the transitions between
+// chunks rely on.
+// The selection is a function of the camera position alone, so it can be
+// recomputed from scratch whenever the camera moves.
+class VolumeLOD {
+  public:
+    struct Config {
+        // Roots span [-rootExtent, rootExtent) on x and z, and
+        // [rootMinY, rootMaxY) on y, in root widths
+        int rootExtent = 4;
+        int rootMinY = -1;
+        int rootMaxY = 1;
+        // At least kMinLODDistance
+        float lodDistance = 2.5f;
+    };
+
+    static constexpr int kMaxLOD = 3;
+    // Below ~1.75 (sqrt(3)), neighbors could be 2 LODs apart
+    static constexpr float kMinLODDistance = 2.f;
+
+  private:
+    Config mConfig;
+    float mChunkSize;
+
+  public:
+    VolumeLOD(float chunkSize, const Config& config);
+
+    // Finds the leaf chunks for a camera position, and which of their
+    // neighbors are coarser.
+    void selectChunks(const Vector3& camera,
+                      std::vector<VolumeChunkKey>& output) const;
+
+    // LOD of the leaf chunk containing a point, or -1 if it's outside the
+    // roots
+    int lodAt(const Vector3& camera, const Vector3& point) const;
+
+    const Config& getConfig() const;
+
+  private:
+    void selectRecursive(const Vector3& camera, const VolumeChunkCoord& node,
+                         std::vector<VolumeChunkKey>& output) const;
+    uint32_t findCoarserNeighbors(const Vector3& camera,
+                                  const VolumeChunkCoord& chunk) const;
+
+    bool shouldDivide(const Vector3& camera,
+                      const VolumeChunkCoord& node) const;
+    float chunkWidth(int lod) const;
+};
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,515 @@
+#include "VolumeMesher.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "core/ThreadPool.h"
+
+#include "DensityStore.h"
+
+namespace Engine {
+namespace Graphics {
+static constexpr uint32_t kNoVertex = UINT32_MAX;
+
+// Edges of the marching cube, as the offset of their lower vertex and the
+// axis they run along. Matches the edge IDs in MarchingCube.cpp.
+static constexpr int kEdgeOffsets[12][3] = {
+    {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 0}, {0, 0, 1}, {1, 0, 1},
+    {0, 1, 1}, {0, 0, 1}, {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+static constexpr int kEdgeAxes[12] = {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2};
+
+// Offsets of the marching cube's vertices, in MarchingCube.cpp's order
+static constexpr int kCornerOffsets[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0},
+                                             {0, 1, 0}, {0, 0, 1}, {1, 0, 1},
+                                             {1, 1, 1}, {0, 1, 1}};
+
+DensityField::DensityField() {
+    mSpacing = 1.f;
+    mCells = 0;
+    mStride = 0;
+}
+
+void DensityField::fill(const Vector3& origin, float spacing, int cells,
+                        const DensityFunction& function) {
+    assert(cells > 0 && spacing > 0);
+    mOrigin = origin;
+    mSpacing = spacing;
+    mCells = cells;
+    mStride = cells + 3;
+
+    const size_t count = (size_t)mStride * mStride * mStride;
+    mValues.resize(count);
+
+    std::vector<float> x(count), y(count), z(count);
+    size_t index = 0;
+    for (int k = -1; k <= cells + 1; k++) {
+        for (int j = -1; j <= cells + 1; j++) {
+            for (int i = -1; i <= cells + 1; i++) {
+                x[index] = origin.x + i * spacing;
+                y[index] = origin.y + j * spacing;
+                z[index] = origin.z + k * spacing;
+                index++;
+            }
+        }
+    }
+
+    function(x.data(), y.data(), z.data(), mValues.data(), count);
+}
+
+void DensityField::fill(const DensityStore& store,
+                        const VolumeChunkCoord& chunk, int cells) {
+    assert(cells > 0);
+    mSpacing = store.getSpacing() * float(1 << chunk.lod);
+    mOrigin = Vector3(float(chunk.x), float(chunk.y), float(chunk.z)) *
+              (mSpacing * cells);
+    mCells = cells;
+    mStride = cells + 3;
+
+    mValues.resize((size_t)mStride * mStride * mStride);
+    store.read(DensityRegion::Chunk(chunk, cells, true), mValues.data());
+}
+
+Vector3 DensityField::position(int x, int y, int z) const {
+    return mOrigin + Vector3(float(x), float(y), float(z)) * mSpacing;
+}
+
+Vector3 DensityField::gradient(int x, int y, int z) const {
+    const float scale = 0.5f / mSpacing;
+    return Vector3(sample(x + 1, y, z) - sample(x - 1, y, z),
+                   sample(x, y + 1, z) - sample(x, y - 1, z),
+                   sample(x, y, z + 1) - sample(x, y, z - 1)) *
+           scale;
+}
+
+// MatchCoarserNeighbors:
+// The samples on the border with even coordinates are shared with the
+// coarser grid. The rest are replaced by the average of the shared samples
+// around them, which is how the coarser grid interpolates them. A sample
+// on a face or edge is replaced if any neighbor touching it is coarser.
+void DensityField::matchCoarserNeighbors(uint32_t coarser) {
+    if (coarser == 0)
+        return;
+    assert(mCells % 2 == 0);
+
+    for (int k = 0; k <= mCells; k++) {
+        for (int j = 0; j <= mCells; j++) {
+            for (int i = 0; i <= mCells; i++) {
+                const int coords[3] = {i, j, k};
+                int side[3];
+                for (int a = 0; a < 3; a++)
+                    side[a] = coords[a] == 0 ? -1 : coords[a] == mCells;
+                if (side[0] == 0 && side[1] == 0 && side[2] == 0)
+                    continue;
+
+                // Neighbors touching the sample differ from it along the
+                // axes it's on the border of
+                bool touchesCoarser = false;
+                for (int n = 1; n < 8; n++) {
+                    const int dx = (n & 1) ? side[0] : 0;
+                    const int dy = (n & 2) ? side[1] : 0;
+                    const int dz = (n & 4) ? side[2] : 0;
+                    if ((dx || dy || dz) &&
+                        (coarser & VolumeNeighborBit(dx, dy, dz)))
+                        touchesCoarser = true;
+                }
+
+                const int odd = (i & 1) | (j & 1) << 1 | (k & 1) << 2;
+                if (!touchesCoarser || odd == 0)
+                    continue;
+
+                float sum = 0.f;
+                int count = 0;
+                for (int n = 0; n < 8; n++) {
+                    if ((n & ~odd) != 0)
+                        continue;
+                    sum += sample(i + ((n & 1) ? 1 : (odd & 1) ? -1 : 0),
+                                  j + ((n & 2) ? 1 : (odd & 2) ? -1 : 0),
+                                  k + ((n & 4) ? 1 : (odd & 4) ? -1 : 0));
+                    count++;
+                }
+                mValues[((k + 1) * mStride + (j + 1)) * mStride + (i + 1)] =
+                    sum / count;
+            }
+        }
+    }
+}
+
+bool DensityField::hasSurface() const {
+    const bool inside = sample(0, 0, 0) > 0;
+    for (int k = 0; k <= mCells; k++) {
+        for (int j = 0; j <= mCells; j++) {
+            for (int i = 0; i <= mCells; i++) {
+                if ((sample(i, j, k) > 0) != inside)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+const Vector3& DensityField::getOrigin() const { return mOrigin; }
+float DensityField::getSpacing() const { return mSpacing; }
+int DensityField::getCells() const { return mCells; }
+
+void VolumeMesh::clear() {
+    positions.clear();
+    normals.clear();
+    indices.clear();
+}
+size_t VolumeMesh::getTriangleCount() const { return indices.size() / 3; }
+
+bool VolumeChunkCoord::operator==(const VolumeChunkCoord& other) const {
+    return x == other.x && y == other.y && z == other.z && lod == other.lod;
+}
+bool VolumeChunkKey::operator==(const VolumeChunkKey& other) const {
+    return coord == other.coord && coarser == other.coarser;
+}
+size_t VolumeChunkKeyHash::operator()(const VolumeChunkKey& key) const {
+    size_t hash = (size_t)key.coord.x * 73856093u;
+    hash ^= (size_t)key.coord.y * 19349663u;
+    hash ^= (size_t)key.coord.z * 83492791u;
+    hash ^= (size_t)key.coord.lod * 2654435761u;
+    return hash ^ ((size_t)key.coarser * 40503u);
+}
+
+// EdgePoint:
+// Where the surface crosses the edge from sample (x,y,z) along an axis,
+// found by linearly interpolating the density. The normal points against
+// the density gradient, out of the surface.
+static void EdgePoint(const DensityField& field, int x, int y, int z,
+                      int axis, Vector3& position, Vector3& normal) {
+    const int dx = axis == 0, dy = axis == 1, dz = axis == 2;
+
+    const float a = field.sample(x, y, z);
+    const float b = field.sample(x + dx, y + dy, z + dz);
+    const float t = a != b ? std::clamp(a / (a - b), 0.f, 1.f) : 0.5f;
+
+    const Vector3 base = Vector3(float(x), float(y), float(z));
+    const Vector3 offset = Vector3(float(dx), float(dy), float(dz)) * t;
+    position = field.getOrigin() + (base + offset) * field.getSpacing();
+
+    normal = -Vector3::Lerp(field.gradient(x, y, z),
+                            field.gradient(x + dx, y + dy, z + dz), t);
+    if (normal.magnitude() > 0)
+        normal.inplaceNormalize();
+    else
+        normal = Vector3::PositiveY();
+}
+
+// InteriorPoint:
+// The point inside cube (x,y,z) that MarchingCube calls edge 12, at the
+// average of the points on the edges the surface crosses.
+static void InteriorPoint(const DensityField& field, int x, int y, int z,
+                          Vector3& position, Vector3& normal) {
+    position = Vector3();
+    normal = Vector3();
+    int count = 0;
+
+    for (int edge = 0; edge < 12; edge++) {
+        const int* offset = kEdgeOffsets[edge];
+        const int axis = kEdgeAxes[edge];
+        const int ex = x + offset[0], ey = y + offset[1], ez = z + offset[2];
+
+        const float a = field.sample(ex, ey, ez);
+        const float b =
+            field.sample(ex + (axis == 0), ey + (axis == 1), ez + (axis == 2));
+        if ((a < 0 && b < 0) || (a > 0 && b > 0))
+            continue;
+
+        Vector3 edgePosition, edgeNormal;
+        EdgePoint(field, ex, ey, ez, axis, edgePosition, edgeNormal);
+        position += edgePosition;
+        normal += edgeNormal;
+        count++;
+    }
+    assert(count > 0);
+
+    position /= float(count);
+    if (normal.magnitude() > 0)
+        normal.inplaceNormalize();
+    else
+        normal = Vector3::PositiveY();
+}
+
+VolumeMesher::VolumeMesher() : VolumeMesher(Config()) {}
+VolumeMesher::VolumeMesher(const Config& config) : mConfig(config) {}
+
+// Mesh:
+// Marches every cube of the field. Cubes with all corners on one side of
+// the surface are skipped before reaching the tiling tables.
+void VolumeMesher::mesh(const DensityField& field, VolumeMesh& output,
+                        uint32_t coarser) {
+    const int cells = field.getCells();
+    if (!field.hasSurface())
+        return;
+    mCoarser = coarser;
+
+    const size_t samples = (size_t)(cells + 1) * (cells + 1) * (cells + 1);
+    mEdgeVertices.assign(samples * 3, kNoVertex);
+
+    float values[8];
+    char edges[36];
+    int numTriangles;
+
+    for (int k = 0; k < cells; k++) {
+        for (int j = 0; j < cells; j++) {
+            for (int i = 0; i < cells; i++) {
+                int numInside = 0;
+                for (int v = 0; v < 8; v++) {
+                    const int* offset = kCornerOffsets[v];
+                    values[v] = field.sample(i + offset[0], j + offset[1],
+                                             k + offset[2]);
+                    numInside += values[v] > 0;
+                }
+                if (numInside == 0 || numInside == 8)
+                    continue;
+
+                mCube.updateData(values[0], values[1], values[2], values[3],
+                                 values[4], values[5], values[6], values[7]);
+                mCube.generateEdges(edges, &numTriangles);
+
+                uint32_t interior = kNoVertex;
+                for (int t = 0; t < numTriangles; t++) {
+                    uint32_t triangle[3];
+
+                    for (int e = 0; e < 3; e++) {
+                        const int edge = edges[t * 3 + e];
+                        if (edge < 12) {
+                            const int* offset = kEdgeOffsets[edge];
+                            triangle[e] = edgeVertex(
+                                field, i + offset[0], j + offset[1],
+                                k + offset[2], kEdgeAxes[edge], output);
+                            continue;
+                        }
+
+                        // The interior point belongs to this cube alone,
+                        // so it is only shared by the cube's triangles
+                        if (interior == kNoVertex) {
+                            Vector3 position, normal;
+                            InteriorPoint(field, i, j, k, position, normal);
+
+                            interior = (uint32_t)output.positions.size();
+                            output.positions.push_back(position);
+                            output.normals.push_back(normal);
+                        }
+                        triangle[e] = interior;
+                    }
+
+                    // Flip the orientation of the triangle
+                    output.indices.push_back(triangle[0]);
+                    output.indices.push_back(triangle[2]);
+                    output.indices.push_back(triangle[1]);
+                }
+            }
+        }
+    }
+}
+
+void VolumeMesher::meshChunk(const VolumeChunkKey& chunk,
+                             const DensityFunction& density,
+                             VolumeMesh& output) {
+    const VolumeChunkCoord& coord = chunk.coord;
+    const float size = mConfig.chunkSize * float(1 << coord.lod);
+    const Vector3 origin = Vector3(coord.x * size, coord.y * size,
+                                   coord.z * size);
+
+    mField.fill(origin, size / mConfig.cellsPerChunk, mConfig.cellsPerChunk,
+                density);
+    mField.matchCoarserNeighbors(chunk.coarser);
+    mesh(mField, output, chunk.coarser);
+}
+
+void VolumeMesher::meshChunk(const VolumeChunkKey& chunk,
+                             const DensityStore& store, VolumeMesh& output) {
+    const int cells = mConfig.cellsPerChunk;
+    assert(fabsf(store.getSpacing() * cells - mConfig.chunkSize) <
+           mConfig.chunkSize * 1e-5f);
+
+    // Transitions only average samples with their neighbors, so an empty
+    // chunk stays empty
+    if (!store.mayHaveSurface(DensityRegion::Chunk(chunk.coord, cells, false)))
+        return;
+
+    mField.fill(store, chunk.coord, cells);
+    mField.matchCoarserNeighbors(chunk.coarser);
+    mesh(mField, output, chunk.coarser);
+}
+
+void VolumeMesher::MeshChunks(const Config& config,
+                              const std::vector<VolumeChunkKey>& chunks,
+                              const DensityFunction& density,
+                              std::vector<VolumeMesh>& output) {
+    output.resize(chunks.size());
+
+    ParallelFor(chunks.size(), [&](size_t index) {
+        output[index].clear();
+
+        VolumeMesher mesher(config);
+        mesher.meshChunk(chunks[index], density, output[index]);
+    });
+}
+
+void VolumeMesher::MeshChunks(const Config& config,
+                              const std::vector<VolumeChunkKey>& chunks,
+                              const DensityStore& store,
+                              std::vector<VolumeMesh>& output) {
+    output.resize(chunks.size());
+
+    ParallelFor(chunks.size(), [&](size_t index) {
+        output[index].clear();
+
+        VolumeMesher mesher(config);
+        mesher.meshChunk(chunks[index], store, output[index]);
+    });
+}
+
+const VolumeMesher::Config& VolumeMesher::getConfig() const {
+    return mConfig;
+}
+
+// EdgeVertex:
+// Returns the vertex on a grid edge, creating it the first time one of the
+// cubes sharing the edge asks for it.
+uint32_t VolumeMesher::edgeVertex(const DensityField& field, int x, int y,
+                                  int z, int axis, VolumeMesh& output) {
+    const int side = field.getCells() + 1;
+    const size_t key = (((size_t)axis * side + z) * side + y) * side + x;
+
+    uint32_t& vertex = mEdgeVertices[key];
+    if (vertex == kNoVertex) {
+        Vector3 position, normal;
+        EdgePoint(field, x, y, z, axis, position, normal);
+        if (mCoarser != 0)
+            snapToCoarser(field, x, y, z, axis, position);
+
+        vertex = (uint32_t)output.positions.size();
+        output.positions.push_back(position);
+        output.normals.push_back(normal);
+    }
+    return vertex;
+}
+
+// SnapToCoarser:
+// On a face shared with a coarser chunk, edges halfway between the coarser
+// grid's samples have no counterpart in the coarser mesh. The coarser chunk
+// crosses each of its cells on the face with straight segments, so the
+// vertex is moved onto the segment that its part of the contour follows.
+// The samples of the face are interpolated from the coarser grid, so the
+// contours have the same shape, and ambiguous cells are split the same way
+// MarchingCube does, by the asymptotic decider.
+void VolumeMesher::snapToCoarser(const DensityField& field, int x, int y,
+                                 int z, int axis, Vector3& position) const {
+    const int cells = field.getCells();
+    const int coords[3] = {x, y, z};
+
+    for (int normal = 0; normal < 3; normal++) {
+        if (normal == axis || (coords[normal] != 0 && coords[normal] != cells))
+            continue;
+        const int side = coords[normal] == 0 ? -1 : 1;
+        if (!(mCoarser & VolumeNeighborBit(normal == 0 ? side : 0,
+                                           normal == 1 ? side : 0,
+                                           normal == 2 ? side : 0)))
+            continue;
+
+        // Edges on the coarser grid's lines are split in two, and the
+        // vertex is already where the coarser one is
+        const int across = 3 - normal - axis;
+        if ((coords[across] & 1) == 0)
+            continue;
+
+        // The coarser cell, spanning (u,v) in [0,2] along (axis, across)
+        const int u0 = coords[axis] & ~1;
+        const int v0 = coords[across] - 1;
+        auto corner = [&](int u, int v, float* value) {
+            int sample[3];
+            sample[normal] = coords[normal];
+            sample[axis] = u0 + u;
+            sample[across] = v0 + v;
+            *value = field.sample(sample[0], sample[1], sample[2]);
+            return field.position(sample[0], sample[1], sample[2]);
+        };
+
+        float values[4];
+        const Vector3 corners[4] = {corner(0, 0, &values[0]),
+                                    corner(2, 0, &values[1]),
+                                    corner(2, 2, &values[2]),
+                                    corner(0, 2, &values[3])};
+
+        // Where the contour crosses each side of the cell, going around it
+        Vector3 crossings[4];
+        bool crosses[4];
+        int numCrossings = 0;
+        for (int c = 0; c < 4; c++) {
+            const float a = values[c];
+            const float b = values[(c + 1) % 4];
+            crosses[c] = (a > 0) != (b > 0);
+            if (crosses[c]) {
+                const float t = std::clamp(a / (a - b), 0.f, 1.f);
+                crossings[c] =
+                    Vector3::Lerp(corners[c], corners[(c + 1) % 4], t);
+                numCrossings++;
+            }
+        }
+
+        std::pair<int, int> segments[2];
+        int numSegments = 0;
+        if (numCrossings == 2) {
+            int first = -1;
+            for (int c = 0; c < 4; c++) {
+                if (!crosses[c])
+                    continue;
+                if (first < 0)
+                    first = c;
+                else
+                    segments[numSegments++] = {first, c};
+            }
+        } else if (numCrossings == 4) {
+            // The asymptotic decider: if the bilinear saddle has the sign of
+            // corners 0 and 2, they are joined, and corners 1 and 3 are cut
+            // off on their own
+            const float denominator =
+                values[0] + values[2] - values[1] - values[3];
+            const float numerator =
+                values[0] * values[2] - values[1] * values[3];
+            const bool joined = denominator != 0 &&
+                                (numerator / denominator > 0) ==
+                                    (values[0] > 0);
+            if (joined) {
+                segments[numSegments++] = {0, 1};
+                segments[numSegments++] = {2, 3};
+            } else {
+                segments[numSegments++] = {3, 0};
+                segments[numSegments++] = {1, 2};
+            }
+        }
+
+        float nearest = -1.f;
+        Vector3 snapped = position;
+        for (int s = 0; s < numSegments; s++) {
+            const Vector3& a = crossings[segments[s].first];
+            const Vector3& b = crossings[segments[s].second];
+            const Vector3 ab = b - a;
+
+            const float length = ab.dot(ab);
+            const float t =
+                length > 0
+                    ? std::clamp((position - a).dot(ab) / length, 0.f, 1.f)
+                    : 0.f;
+            const Vector3 point = a + ab * t;
+
+            const float distance = (point - position).magnitude();
+            if (nearest < 0 || distance < nearest) {
+                nearest = distance;
+                snapped = point;
+            }
+        }
+        position = snapped;
+        return;
+    }
+}
+
+} // namespace Graphics
+} // namespace Engine
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "datamodel/terrain/TerrainConfig.h"
+#include "math/Vector3.h"
+#include "rendering/util/MarchingCube.h"
+
+namespace Engine {
+using namespace Math;
+namespace Graphics {
+class DensityStore;
+struct VolumeChunkCoord;
+
+// DensityFunction:
+// Samples a density field at count points, given as separate coordinate
+// arrays. Density is positive inside the surface and negative outside, so
+// the density of an SDF is its negation.
+typedef std::function<void(const float* x, const float* y, const float* z,
+                           float* output, size_t count)>
+    DensityFunction;
+
+// DensityField Class:
+// Density samples on a grid covering one chunk, cells + 1 samples on a side.
+// The grid is padded by one sample on every side, so that gradients can be
+// taken at the chunk's border samples. Samples are indexed from -1 to
+// cells + 1.
+class DensityField {
+  private:
+    Vector3 mOrigin;
+    float mSpacing;
+    int mCells;
+    // Samples on a side, including the padding
+    int mStride;
+    std::vector<float> mValues;
+
+  public:
+    DensityField();
+
+    // Fills the field in one batch. Sample (x,y,z) is at
+    // origin + (x,y,z) * spacing.
+    void fill(const Vector3& origin, float spacing, int cells,
+              const DensityFunction& function);
+    // Fills the field of a chunk from a store, which must have a spacing of
+    // a chunk's size over cells
+    void fill(const DensityStore& store, const VolumeChunkCoord& chunk,
+              int cells);
+
+    inline float sample(int x, int y, int z) const {
+        return mValues[((z + 1) * mStride + (y + 1)) * mStride + (x + 1)];
+    }
+    Vector3 position(int x, int y, int z) const;
+    // Central difference gradient, in density per unit
+    Vector3 gradient(int x, int y, int z) const;
+
+    // Replaces the border samples that coarser neighbors also touch with
+    // the coarser grid's interpolation of them. See VolumeNeighborBit.
+    void matchCoarserNeighbors(uint32_t coarser);
+
+    // True if the samples of the chunk (excluding the padding) are not all
+    // inside or all outside, so the chunk may contain surface
+    bool hasSurface() const;
+
+    const Vector3& getOrigin() const;
+    float getSpacing() const;
+    int getCells() const;
+};
+
+// VolumeMesh Struct:
+// An indexed triangle mesh, in world space. Every vertex is shared by the
+// triangles of all cubes that touch it.
+struct VolumeMesh {
+    std::vector<Vector3> positions;
+    std::vector<Vector3> normals;
+    std::vector<uint32_t> indices;
+
+    void clear();
+    size_t getTriangleCount() const;
+};
+
+// VolumeChunkCoord Struct:
+// A chunk at some LOD. A chunk at LOD l is 2^l chunks wide, meshed with the
+// same number of cells, and (x,y,z) are in units of its width.
+struct VolumeChunkCoord {
+    int x;
+    int y;
+    int z;
+    int lod = 0;
+
+    bool operator==(const VolumeChunkCoord& other) const;
+};
+
+// VolumeNeighborBit:
+// Bit for the neighbor in direction (dx,dy,dz), where each is -1, 0 or 1.
+// Neighbors across faces and edges are included. Chunk neighbors are at
+// most 1 LOD apart.
+inline uint32_t VolumeNeighborBit(int dx, int dy, int dz) {
+    return 1u << ((dx + 1) * 9 + (dy + 1) * 3 + (dz + 1));
+}
+
+// VolumeChunkKey Struct:
+// A chunk, and which of its neighbors are coarser than it. A chunk's mesh
+// depends on both.
+struct VolumeChunkKey {
+    VolumeChunkCoord coord;
+    uint32_t coarser = 0;
+
+    bool operator==(const VolumeChunkKey& other) const;
+};
+struct VolumeChunkKeyHash {
+    size_t operator()(const VolumeChunkKey& key) const;
+};
+
+// VolumeMesher Class:
+// Meshes chunks of a density field with marching cubes. A vertex is placed
+// once per grid edge the surface crosses, and cached by that edge, so
+// neighboring cubes reuse it instead of duplicating it. A mesher keeps
+// scratch memory between chunks, and is used from one thread at a time.
+//
+// Chunks next to a coarser chunk are meshed with a transition: the border
+// they share matches the coarser grid, and the vertices on it are moved
+// onto the coarser chunk's contour, so the two meet without cracks.
+class VolumeMesher {
+  public:
+    struct Config {
+        float chunkSize = TERRAIN_CHUNK_SIZE;
+        // Must be even, so that a chunk's border lines up with the samples
+        // of a chunk one LOD coarser
+        int cellsPerChunk = 16;
+    };
+
+  private:
+    Config mConfig;
+
+    // Vertex index of the point on each grid edge, or kNoVertex. Indexed by
+    // the edge's axis and its lower sample.
+    std::vector<uint32_t> mEdgeVertices;
+    uint32_t mCoarser = 0;
+    Datamodel::MarchingCube mCube;
+    DensityField mField;
+
+  public:
+    VolumeMesher();
+    VolumeMesher(const Config& config);
+
+    // Meshes a filled field, appending to output. The field must already
+    // match the coarser neighbors.
+    void mesh(const DensityField& field, VolumeMesh& output,
+              uint32_t coarser = 0);
+    // Fills the chunk's field from the density function, and meshes it
+    void meshChunk(const VolumeChunkKey& chunk,
+                   const DensityFunction& density, VolumeMesh& output);
+    // Reads the chunk's field from a store instead. Chunks the store knows
+    // to be empty are skipped without reading them.
+    void meshChunk(const VolumeChunkKey& chunk, const DensityStore& store,
+                   VolumeMesh& output);
+
+    // MeshChunks:
+    // Meshes many chunks in parallel on the thread pool. output[i] is the
+    // mesh of chunks[i].
+    static void MeshChunks(const Config& config,
+                           const std::vector<VolumeChunkKey>& chunks,
+                           const DensityFunction& density,
+                           std::vector<VolumeMesh>& output);
+    // The store must already have generated the chunks' regions
+    static void MeshChunks(const Config& config,
+                           const std::vector<VolumeChunkKey>& chunks,
+                           const DensityStore& store,
+                           std::vector<VolumeMesh>& output);
+
+    const Config& getConfig() const;
+
+  private:
+    uint32_t edgeVertex(const DensityField& field, int x, int y, int z,
+                        int axis, VolumeMesh& output);
+    void snapToCoarser(const DensityField& field, int x, int y, int z,
+                       int axis, Vector3& position) const;
+};
+
+} // namespace Graphics
+} // namespace Engine
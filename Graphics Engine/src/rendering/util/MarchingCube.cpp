@@ -63,7 +63,24 @@ void MarchingCube::generateSurface(Triangle* triangle_output,
     assert(triangle_output != nullptr && num_triangles != nullptr);
 
     output_triangulation = triangle_output;
+    output_edges = nullptr;
     output_num_triangles = num_triangles;
+    triangulate();
+}
+
+void MarchingCube::generateEdges(char* edge_output, int* num_triangles) {
+    assert(edge_output != nullptr && num_triangles != nullptr);
+
+    output_triangulation = nullptr;
+    output_edges = edge_output;
+    output_num_triangles = num_triangles;
+    triangulate();
+}
+
+// Triangulate:
+// Looks up the cube's case in the tiling tables, resolving ambiguous faces
+// and interiors, and writes the triangles to the current output.
+void MarchingCube::triangulate() {
     (*output_num_triangles) = 0;
 
     const unsigned char vertexMask = computeVertexMask();
@@ -414,6 +431,14 @@ void MarchingCube::createTriangles(const char* edgeList, char numberTriangles) {
 
     (*output_num_triangles) = numberTriangles;
 
+    if (output_edges != nullptr) {
+        for (int i = 0; i < numberTriangles * 3; i++) {
+            assert(0 <= edgeList[i] && edgeList[i] <= 12);
+            output_edges[i] = edgeList[i];
+        }
+        return;
+    }
+
     for (int i = 0; i < numberTriangles; i++) {
         for (int t = 0; t < 3; t++) {
             const char edgeID = edgeList[i * 3 + t];
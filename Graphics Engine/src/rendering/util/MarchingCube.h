@@ -19,6 +19,7 @@ class MarchingCube {
 
     // Output fields
     Triangle* output_triangulation;
+    char* output_edges;
     int* output_num_triangles;
 
   public:
@@ -31,8 +32,15 @@ class MarchingCube {
     // Stream the triangulation of the data to the parameter output.
     // Expected that this output consists of 12 triangles or more.
     void generateSurface(Triangle* triangle_output, int* num_triangles);
+    // Stream the triangulation as edge IDs, 3 per triangle. IDs 0-11 are the
+    // cube's edges, and 12 is a point inside the cube, at the average of the
+    // points on the edges the surface crosses. Lets a caller place vertices
+    // itself, and share them with neighboring cubes.
+    // Expected that this output has room for 36 edges or more.
+    void generateEdges(char* edge_output, int* num_triangles);
 
   private:
+    void triangulate();
     void createTriangles(const char* edgeList, char numberTriangles);
 
     Vector3 generateVertexOnEdge(char edgeID);